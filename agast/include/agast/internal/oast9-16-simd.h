@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef AGAST_INTERNAL_OAST9_16_SIMD_H_
+#define AGAST_INTERNAL_OAST9_16_SIMD_H_
+
+#include <vector>
+
+#include <agast/wrap-opencv.h>
+
+namespace agast {
+namespace internal {
+// The thresholds and ring of the OAST 9-16 segment test.
+struct SegmentTestParams {
+  int offsets[16];  // Ring offsets in pixels, clockwise.
+  int b;
+  int cmpThreshold;
+  int lowerThreshold;
+  int upperThreshold;
+};
+
+// Whether DetectRowsSimd is implemented for this platform.
+bool HasSimdSegmentTest();
+
+// Restricts DetectRowsSimd to SSE2 if false, e.g. to test both paths on a CPU
+// with AVX2.
+void SetSegmentTestAvx2Enabled(bool enabled);
+
+// Vectorized segment test over rows [yBegin, yEnd) which appends the same
+// corners as the OAST 9-16 decision tree, in the same order: a pixel is a
+// corner if 9 consecutive ring pixels are all brighter or all darker than
+// the center by the (thrmap scaled) threshold. Pixels where mask is zero are
+// skipped, as are whole blocks of them. Returns false without touching
+// corners if the image or thresholds are not supported, in which case the
+// caller falls back to the tree.
+bool DetectRowsSimd(const unsigned char* im, const unsigned char* thrmap,
+                    const unsigned char* mask, int xsize, int yBegin, int yEnd,
+                    const SegmentTestParams& params,
+                    std::vector<agast::KeyPoint>& corners);
+}  // namespace internal
+}  // namespace agast
+
+#endif  // AGAST_INTERNAL_OAST9_16_SIMD_H_
@@ -33,6 +33,7 @@
 #include <stdint.h>
 #include <agast/wrap-opencv.h>
 #include <agast/ast-detector.h>
+#include <agast/internal/oast9-16-simd.h>
 
 namespace agast {
 
@@ -60,9 +61,15 @@ class Oast9_16_PatternAccessor {
 class OastDetector9_16 : public AstDetector {
  public:
   OastDetector9_16()
-      : AstDetector() { }
+      : AstDetector(),
+        numThreads_(1),
+        useSimd_(internal::HasSimdSegmentTest()),
+        mask_(0) { }
   OastDetector9_16(int width, int height, int thr)
-      : AstDetector(width, height, thr) {
+      : AstDetector(width, height, thr),
+        numThreads_(1),
+        useSimd_(internal::HasSimdSegmentTest()),
+        mask_(0) {
     init_pattern();
   }
   ~OastDetector9_16() { }
@@ -73,12 +80,45 @@ class OastDetector9_16 : public AstDetector {
   int get_borderWidth() {
     return borderWidth;
   }
+  // Number of horizontal bands detect scans concurrently. The corners are
+  // the same as for a single thread, in the same order.
+  void set_numThreads(int numThreads) {
+    numThreads_ = numThreads < 1 ? 1 : numThreads;
+  }
+  int get_numThreads() const {
+    return numThreads_;
+  }
+  // Run the segment test on 16 (SSE2) or 32 (AVX2) pixels at once instead of
+  // the decision tree. On by default where available. The corners are the
+  // same either way.
+  void set_useSimd(bool useSimd) {
+    useSimd_ = useSimd && internal::HasSimdSegmentTest();
+  }
+  bool get_useSimd() const {
+    return useSimd_;
+  }
+  // Pixels where the mask, of the image size, is zero are not tested. The
+  // mask is not copied and has to stay alive until detect returns. Pass 0
+  // to test all pixels again.
+  void set_mask(const unsigned char* mask) {
+    mask_ = mask;
+  }
   int cornerScore(const unsigned char* p);
   // Re-centering and re-scaling the FAST mask.
   int cornerScore(agast::Mat& img, float x, float y, float scale);
 
  private:
+  // Scans rows [yBegin, yEnd) and appends the corners to corners_all.
+  void detectRows(const unsigned char* im, int yBegin, int yEnd,
+                  std::vector<agast::KeyPoint>& corners_all,
+                  const agast::Mat* thrmap) const;
+
   static const int borderWidth = 3;
+  // Bands thinner than this are not worth a thread.
+  static const int kMinRowsPerBand = 32;
+  int numThreads_;
+  bool useSimd_;
+  const unsigned char* mask_;
   int_fast16_t s_offset0;
   int_fast16_t s_offset1;
   int_fast16_t s_offset2;
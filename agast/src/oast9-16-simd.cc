@@ -0,0 +1,393 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#ifndef __ARM_NEON
+#include <immintrin.h>
+#endif  // __ARM_NEON
+
+#include <agast/internal/oast9-16-simd.h>
+
+namespace agast {
+namespace internal {
+#ifdef __ARM_NEON
+bool HasSimdSegmentTest() {
+  return false;
+}
+
+void SetSegmentTestAvx2Enabled(bool) { }
+
+bool DetectRowsSimd(const unsigned char*, const unsigned char*,
+                    const unsigned char*, int, int, int,
+                    const SegmentTestParams&, std::vector<agast::KeyPoint>&) {
+  // Not implemented.
+  return false;
+}
+#else
+namespace {
+const int kBorder = 3;
+
+// x / 100 for 0 <= x < 65536 is ((x >> 2) * 20972) >> 19.
+const int kDivide100Magic = 20972;
+
+// Lanes are 8 bit, 0x00 for false and 0xff for true. The segment test looks
+// for 9 consecutive ring pixels that are brighter (darker) than the center,
+// i.e. for a run of 9 zeros in the "not brighter" ("not darker") masks.
+// Returns 0xff for lanes that have no such run.
+inline __m128i NoRunOfNine(const __m128i* notRing) {
+  __m128i run2[16];
+  __m128i run4[16];
+  for (int k = 0; k < 16; ++k)
+    run2[k] = _mm_or_si128(notRing[k], notRing[(k + 1) & 15]);
+  for (int k = 0; k < 16; ++k)
+    run4[k] = _mm_or_si128(run2[k], run2[(k + 2) & 15]);
+  __m128i noRun = _mm_set1_epi8(-1);
+  for (int k = 0; k < 16; ++k) {
+    const __m128i run9 = _mm_or_si128(
+        _mm_or_si128(run4[k], run4[(k + 4) & 15]), notRing[(k + 8) & 15]);
+    noRun = _mm_and_si128(noRun, run9);
+  }
+  return noRun;
+}
+
+struct Sse2Thresholds {
+  __m128i b;  // Without a threshold map.
+  __m128i b16;
+  __m128i cmp;
+  __m128i lower;
+  __m128i upper;
+};
+
+// The unsigned 8 bit equivalent of the per pixel threshold of the tree:
+// clamp(thrmap, lower, upper) * b / 100 saturates to 255, which keeps the
+// comparisons against center +- threshold the same.
+inline __m128i ScaledThresholds(__m128i thr, const Sse2Thresholds& t) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i magic = _mm_set1_epi16(kDivide100Magic);
+  const __m128i clamped = _mm_min_epu8(_mm_max_epu8(thr, t.lower), t.upper);
+  __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(clamped, zero), t.b16);
+  __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(clamped, zero), t.b16);
+  lo = _mm_srli_epi16(_mm_mulhi_epu16(_mm_srli_epi16(lo, 2), magic), 3);
+  hi = _mm_srli_epi16(_mm_mulhi_epu16(_mm_srli_epi16(hi, 2), magic), 3);
+  return _mm_packus_epi16(lo, hi);
+}
+
+// Corner bits of the 16 pixels starting at p.
+inline uint32_t CornerMaskSse2(const unsigned char* p, const unsigned char* thr,
+                               const int* offsets, const Sse2Thresholds& t) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i b2 = t.b;
+  __m128i valid = _mm_set1_epi8(-1);
+  if (thr != 0) {
+    const __m128i thresholds =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(thr));
+    valid = _mm_cmpeq_epi8(_mm_max_epu8(thresholds, t.cmp), thresholds);
+    b2 = ScaledThresholds(thresholds, t);
+  }
+  const __m128i center = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  const __m128i brighter = _mm_adds_epu8(center, b2);
+  const __m128i darker = _mm_subs_epu8(center, b2);
+
+  __m128i notBrighter[16];
+  __m128i notDarker[16];
+  // Any run of 9 covers two neighboring ones of the pixels 0, 4, 8 and 12.
+  for (int k = 0; k < 16; k += 4) {
+    const __m128i ring =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + offsets[k]));
+    notBrighter[k] = _mm_cmpeq_epi8(_mm_subs_epu8(ring, brighter), zero);
+    notDarker[k] = _mm_cmpeq_epi8(_mm_subs_epu8(darker, ring), zero);
+  }
+  const __m128i noBrighter = _mm_and_si128(
+      _mm_and_si128(_mm_or_si128(notBrighter[0], notBrighter[4]),
+                    _mm_or_si128(notBrighter[4], notBrighter[8])),
+      _mm_and_si128(_mm_or_si128(notBrighter[8], notBrighter[12]),
+                    _mm_or_si128(notBrighter[12], notBrighter[0])));
+  const __m128i noDarker = _mm_and_si128(
+      _mm_and_si128(_mm_or_si128(notDarker[0], notDarker[4]),
+                    _mm_or_si128(notDarker[4], notDarker[8])),
+      _mm_and_si128(_mm_or_si128(notDarker[8], notDarker[12]),
+                    _mm_or_si128(notDarker[12], notDarker[0])));
+  if (_mm_movemask_epi8(_mm_andnot_si128(_mm_and_si128(noBrighter, noDarker),
+                                         valid)) == 0)
+    return 0;
+
+  for (int k = 0; k < 16; ++k) {
+    if ((k & 3) == 0)
+      continue;
+    const __m128i ring =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + offsets[k]));
+    notBrighter[k] = _mm_cmpeq_epi8(_mm_subs_epu8(ring, brighter), zero);
+    notDarker[k] = _mm_cmpeq_epi8(_mm_subs_epu8(darker, ring), zero);
+  }
+  const __m128i notCorner = _mm_and_si128(NoRunOfNine(notBrighter),
+                                          NoRunOfNine(notDarker));
+  return _mm_movemask_epi8(_mm_andnot_si128(notCorner, valid));
+}
+
+__attribute__((target("avx2")))
+inline __m256i NoRunOfNineAvx2(const __m256i* notRing) {
+  __m256i run2[16];
+  __m256i run4[16];
+  for (int k = 0; k < 16; ++k)
+    run2[k] = _mm256_or_si256(notRing[k], notRing[(k + 1) & 15]);
+  for (int k = 0; k < 16; ++k)
+    run4[k] = _mm256_or_si256(run2[k], run2[(k + 2) & 15]);
+  __m256i noRun = _mm256_set1_epi8(-1);
+  for (int k = 0; k < 16; ++k) {
+    const __m256i run9 = _mm256_or_si256(
+        _mm256_or_si256(run4[k], run4[(k + 4) & 15]), notRing[(k + 8) & 15]);
+    noRun = _mm256_and_si256(noRun, run9);
+  }
+  return noRun;
+}
+
+struct Avx2Thresholds {
+  __m256i b;
+  __m256i b16;
+  __m256i cmp;
+  __m256i lower;
+  __m256i upper;
+};
+
+// The unpacking and packing both work within 128 bit lanes, so the lanes end
+// up in their original order.
+__attribute__((target("avx2")))
+inline __m256i ScaledThresholdsAvx2(__m256i thr, const Avx2Thresholds& t) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i magic = _mm256_set1_epi16(kDivide100Magic);
+  const __m256i clamped =
+      _mm256_min_epu8(_mm256_max_epu8(thr, t.lower), t.upper);
+  __m256i lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(clamped, zero), t.b16);
+  __m256i hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(clamped, zero), t.b16);
+  lo = _mm256_srli_epi16(
+      _mm256_mulhi_epu16(_mm256_srli_epi16(lo, 2), magic), 3);
+  hi = _mm256_srli_epi16(
+      _mm256_mulhi_epu16(_mm256_srli_epi16(hi, 2), magic), 3);
+  return _mm256_packus_epi16(lo, hi);
+}
+
+// Corner bits of the 32 pixels starting at p.
+__attribute__((target("avx2")))
+uint32_t CornerMaskAvx2(const unsigned char* p, const unsigned char* thr,
+                        const int* offsets, const Avx2Thresholds& t) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i b2 = t.b;
+  __m256i valid = _mm256_set1_epi8(-1);
+  if (thr != 0) {
+    const __m256i thresholds =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(thr));
+    valid = _mm256_cmpeq_epi8(_mm256_max_epu8(thresholds, t.cmp), thresholds);
+    b2 = ScaledThresholdsAvx2(thresholds, t);
+  }
+  const __m256i center =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  const __m256i brighter = _mm256_adds_epu8(center, b2);
+  const __m256i darker = _mm256_subs_epu8(center, b2);
+
+  __m256i notBrighter[16];
+  __m256i notDarker[16];
+  for (int k = 0; k < 16; k += 4) {
+    const __m256i ring =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + offsets[k]));
+    notBrighter[k] = _mm256_cmpeq_epi8(_mm256_subs_epu8(ring, brighter), zero);
+    notDarker[k] = _mm256_cmpeq_epi8(_mm256_subs_epu8(darker, ring), zero);
+  }
+  const __m256i noBrighter = _mm256_and_si256(
+      _mm256_and_si256(_mm256_or_si256(notBrighter[0], notBrighter[4]),
+                       _mm256_or_si256(notBrighter[4], notBrighter[8])),
+      _mm256_and_si256(_mm256_or_si256(notBrighter[8], notBrighter[12]),
+                       _mm256_or_si256(notBrighter[12], notBrighter[0])));
+  const __m256i noDarker = _mm256_and_si256(
+      _mm256_and_si256(_mm256_or_si256(notDarker[0], notDarker[4]),
+                       _mm256_or_si256(notDarker[4], notDarker[8])),
+      _mm256_and_si256(_mm256_or_si256(notDarker[8], notDarker[12]),
+                       _mm256_or_si256(notDarker[12], notDarker[0])));
+  if (_mm256_movemask_epi8(_mm256_andnot_si256(
+          _mm256_and_si256(noBrighter, noDarker), valid)) == 0)
+    return 0;
+
+  for (int k = 0; k < 16; ++k) {
+    if ((k & 3) == 0)
+      continue;
+    const __m256i ring =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + offsets[k]));
+    notBrighter[k] = _mm256_cmpeq_epi8(_mm256_subs_epu8(ring, brighter), zero);
+    notDarker[k] = _mm256_cmpeq_epi8(_mm256_subs_epu8(darker, ring), zero);
+  }
+  const __m256i notCorner = _mm256_and_si256(NoRunOfNineAvx2(notBrighter),
+                                             NoRunOfNineAvx2(notDarker));
+  return _mm256_movemask_epi8(_mm256_andnot_si256(notCorner, valid));
+}
+
+// Bits of the kWidth pixels starting at mask that are not masked out.
+template <int kWidth>
+inline uint32_t UnmaskedBits(const unsigned char* mask) {
+  const __m128i zero = _mm_setzero_si128();
+  uint32_t bits = 0;
+  for (int i = 0; i < kWidth; i += 16) {
+    const __m128i values =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+    bits |= static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(values, zero)) ^ 0xffff) << i;
+  }
+  return bits;
+}
+
+// Scans x = 3 .. xsize - 4 of every row in blocks of kWidth pixels. The last
+// block of a row overlaps its predecessor, whose pixels are dropped from it.
+// Blocks that are masked out entirely are skipped without testing them.
+template <int kWidth, typename CornerMask>
+void ScanRows(const unsigned char* im, const unsigned char* thrmap,
+              const unsigned char* pixelMask, int xsize, int yBegin, int yEnd,
+              const CornerMask& cornerMask,
+              std::vector<agast::KeyPoint>& corners) {
+  const int xEnd = xsize - kBorder;
+  agast::KeyPoint h;
+  for (int y = yBegin; y < yEnd; ++y) {
+    const int rowOffset = y * xsize;
+    int x = kBorder;
+    while (x < xEnd) {
+      const int blockX = x + kWidth > xEnd ? xEnd - kWidth : x;
+      uint32_t unmasked = ~uint32_t(0);
+      if (pixelMask != 0) {
+        unmasked = UnmaskedBits<kWidth>(pixelMask + rowOffset + blockX);
+        if (unmasked == 0) {
+          x = blockX + kWidth;
+          continue;
+        }
+      }
+      uint32_t mask = cornerMask(
+          im + rowOffset + blockX,
+          thrmap != 0 ? thrmap + rowOffset + blockX : 0) & unmasked;
+      mask >>= x - blockX;
+      while (mask != 0) {
+        agast::KeyPointX(h) = x + __builtin_ctz(mask);
+        agast::KeyPointY(h) = y;
+        corners.push_back(h);
+        mask &= mask - 1;
+      }
+      x = blockX + kWidth;
+    }
+  }
+}
+
+__attribute__((target("avx2")))
+void DetectRowsAvx2(const unsigned char* im, const unsigned char* thrmap,
+                    const unsigned char* pixelMask, int xsize, int yBegin,
+                    int yEnd, const SegmentTestParams& params,
+                    std::vector<agast::KeyPoint>& corners) {
+  Avx2Thresholds t;
+  t.b = _mm256_set1_epi8(static_cast<char>(params.b));
+  t.b16 = _mm256_set1_epi16(params.b);
+  t.cmp = _mm256_set1_epi8(static_cast<char>(params.cmpThreshold));
+  t.lower = _mm256_set1_epi8(static_cast<char>(params.lowerThreshold));
+  t.upper = _mm256_set1_epi8(static_cast<char>(params.upperThreshold));
+  const int* offsets = params.offsets;
+  ScanRows<32>(im, thrmap, pixelMask, xsize, yBegin, yEnd,
+               [&](const unsigned char* p, const unsigned char* thr) {
+                 return CornerMaskAvx2(p, thr, offsets, t);
+               }, corners);
+}
+
+std::atomic<bool> avx2_enabled(true);
+
+bool HasAvx2() {
+  static const bool supported = []() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return supported && avx2_enabled.load();
+}
+}  // namespace
+
+void SetSegmentTestAvx2Enabled(bool enabled) {
+  avx2_enabled.store(enabled);
+}
+
+bool HasSimdSegmentTest() {
+  return true;
+}
+
+bool DetectRowsSimd(const unsigned char* im, const unsigned char* thrmap,
+                    const unsigned char* mask, int xsize, int yBegin, int yEnd,
+                    const SegmentTestParams& params,
+                    std::vector<agast::KeyPoint>& corners) {
+  if (xsize - 2 * kBorder < 16)
+    return false;
+  if (params.b < 0 || params.b > 255)
+    return false;
+  // The thresholds only matter with a threshold map.
+  SegmentTestParams sanitized = params;
+  if (thrmap != 0) {
+    if (params.lowerThreshold < 0 || params.lowerThreshold > 255 ||
+        params.upperThreshold < 0 || params.upperThreshold > 255)
+      return false;
+    // No pixel passes the threshold map.
+    if (params.cmpThreshold > 255)
+      return true;
+    if (sanitized.cmpThreshold < 0)
+      sanitized.cmpThreshold = 0;
+  } else {
+    sanitized.cmpThreshold = 0;
+    sanitized.lowerThreshold = 0;
+    sanitized.upperThreshold = 255;
+  }
+
+  if (HasAvx2() && xsize - 2 * kBorder >= 32) {
+    DetectRowsAvx2(im, thrmap, mask, xsize, yBegin, yEnd, sanitized, corners);
+    return true;
+  }
+
+  Sse2Thresholds t;
+  t.b = _mm_set1_epi8(static_cast<char>(sanitized.b));
+  t.b16 = _mm_set1_epi16(sanitized.b);
+  t.cmp = _mm_set1_epi8(static_cast<char>(sanitized.cmpThreshold));
+  t.lower = _mm_set1_epi8(static_cast<char>(sanitized.lowerThreshold));
+  t.upper = _mm_set1_epi8(static_cast<char>(sanitized.upperThreshold));
+  const int* offsets = sanitized.offsets;
+  ScanRows<16>(im, thrmap, mask, xsize, yBegin, yEnd,
+               [&](const unsigned char* p, const unsigned char* thr) {
+                 return CornerMaskSse2(p, thr, offsets, t);
+               }, corners);
+  return true;
+}
+#endif  // __ARM_NEON
+}  // namespace internal
+}  // namespace agast
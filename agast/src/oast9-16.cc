@@ -35,6 +35,8 @@
 
 #include <stdint.h>																			
 #include <stdlib.h>
+#include <thread>
+#include <vector>
 #include <agast/wrap-opencv.h>
 #include <agast/oast9-16.h>
 
@@ -43,12 +45,79 @@ namespace agast {
 void OastDetector9_16::detect(const unsigned char* im,
                               std::vector<agast::KeyPoint>& corners_all,
                               const agast::Mat* thrmap) {
+  const int yBegin = borderWidth;
+  const int yEnd = ysize - borderWidth;
+  const int numRows = yEnd - yBegin;
+  int numBands = numThreads_;
+  if (numBands > numRows / kMinRowsPerBand)
+    numBands = numRows / kMinRowsPerBand;
+  if (numBands <= 1) {
+    detectRows(im, yBegin, yEnd, corners_all, thrmap);
+    return;
+  }
+
+  // Scan horizontal bands concurrently and concatenate the corners in band
+  // order, which keeps them sorted by rows as nms requires.
+  std::vector<std::vector<agast::KeyPoint> > bandCorners(numBands);
+  std::vector<std::thread> workers;
+  workers.reserve(numBands - 1);
+  for (int band = 1; band < numBands; ++band) {
+    workers.push_back(std::thread([&, band]() {
+      detectRows(im, yBegin + (band * numRows) / numBands,
+                 yBegin + ((band + 1) * numRows) / numBands,
+                 bandCorners[band], thrmap);
+    }));
+  }
+  detectRows(im, yBegin, yBegin + numRows / numBands, bandCorners[0], thrmap);
+  for (std::thread& worker : workers)
+    worker.join();
+
+  size_t total = 0;
+  for (const std::vector<agast::KeyPoint>& corners : bandCorners)
+    total += corners.size();
+  corners_all.resize(0);
+  corners_all.reserve(total);
+  for (const std::vector<agast::KeyPoint>& corners : bandCorners)
+    corners_all.insert(corners_all.end(), corners.begin(), corners.end());
+}
+
+void OastDetector9_16::detectRows(const unsigned char* im, int yBegin,
+                                  int yEnd,
+                                  std::vector<agast::KeyPoint>& corners_all,
+                                  const agast::Mat* thrmap) const {
+  if (useSimd_) {
+    internal::SegmentTestParams params;
+    params.offsets[0] = s_offset0;
+    params.offsets[1] = s_offset1;
+    params.offsets[2] = s_offset2;
+    params.offsets[3] = s_offset3;
+    params.offsets[4] = s_offset4;
+    params.offsets[5] = s_offset5;
+    params.offsets[6] = s_offset6;
+    params.offsets[7] = s_offset7;
+    params.offsets[8] = s_offset8;
+    params.offsets[9] = s_offset9;
+    params.offsets[10] = s_offset10;
+    params.offsets[11] = s_offset11;
+    params.offsets[12] = s_offset12;
+    params.offsets[13] = s_offset13;
+    params.offsets[14] = s_offset14;
+    params.offsets[15] = s_offset15;
+    params.b = b;
+    params.cmpThreshold = cmpThreshold_;
+    params.lowerThreshold = lowerThreshold_;
+    params.upperThreshold = upperThreshold_;
+    corners_all.resize(0);
+    if (internal::DetectRowsSimd(im, thrmap != 0 ? thrmap->data : 0, mask_,
+                                 xsize, yBegin, yEnd, params, corners_all))
+      return;
+  }
+
   int total = 0;
   int nExpectedCorners = corners_all.capacity();
   agast::KeyPoint h;
   register int x, y;
   register int xsizeB = xsize - 4;
-  register int ysizeB = ysize - 3;
   register int_fast16_t offset0, offset1, offset2, offset3, offset4, offset5,
       offset6, offset7, offset8, offset9, offset10, offset11, offset12,
       offset13, offset14, offset15;
@@ -76,13 +145,15 @@ void OastDetector9_16::detect(const unsigned char* im,
 
   int b2;
 
-  for (y = 3; y < ysizeB; y++) {
+  for (y = yBegin; y < yEnd; y++) {
     x = 2;
     while (1) {
       x++;
       if (x > xsizeB)
         break;
       else {
+        if (mask_ != 0 && *(mask_ + x + y * width) == 0)
+          continue;
         if (thrmap != 0) {
           int thrmapvalue = int(*(thrmap->data + x + y * width));
           if (thrmapvalue < cmpThreshold_)
@@ -42,14 +42,21 @@
 #define BRISK_BRISK_DESCRIPTOR_EXTRACTOR_H_
 
 #include <bitset>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <agast/wrap-opencv.h>
+#include <brisk/descriptor-buffer.h>
 #include <brisk/internal/helper-structures.h>
 #include <brisk/internal/macros.h>
+#include <brisk/internal/parallel-for.h>
+#include <brisk/internal/rotated-pattern-table.h>
+#include <brisk/prepared-image.h>
 
 namespace brisk {
+struct BriskPattern;
+
 #if HAVE_OPENCV
 class BriskDescriptorExtractor : public cv::Feature2D {
 #else
@@ -103,6 +110,22 @@ class BriskDescriptorExtractor {
   bool rotationInvariance;
   bool scaleInvariance;
 
+  // Number of threads the keypoints are distributed over during extraction.
+  // Defaults to one, i.e. serial extraction on the calling thread. The
+  // descriptors are identical for any number of threads.
+  void SetNumThreads(size_t num_threads);
+  // Run the extraction tasks on an external thread pool instead of spawning
+  // threads on every call. Pass an empty runner to restore the default.
+  void SetTaskRunner(const TaskRunner& task_runner);
+
+  // Sample 8 bit images with precompiled fixed-point boxes for the keypoint
+  // position rounded to a quarter pixel. This turns every sample into a few
+  // integer multiply-adds, but the descriptors are no longer bit-identical to
+  // the ones of the exact sampling. The boxes take about 3.5 MB per pattern
+  // scale used. Only takes effect on CPUs without AVX2, since the AVX2 kernel
+  // of the exact sampling is faster. Disabled by default.
+  void SetQuantizedSampling(bool enabled);
+
   // Opencv 2.1 {
   virtual void compute(const agast::Mat& image,
                        std::vector<agast::KeyPoint>& keypoints,
@@ -117,6 +140,41 @@ class BriskDescriptorExtractor {
     computeImpl(image, keypoints, descriptors);
   }
 
+  // Estimates the orientation of all keypoints from the long pair gradients
+  // and stores it in their angle, regardless of the current angle. Removes
+  // the keypoints the pattern does not fit around, like compute does.
+  // Allows to assign angles in bulk before extraction or without extracting
+  // any descriptors.
+  void ComputeOrientations(const agast::Mat& image,
+                           std::vector<agast::KeyPoint>& keypoints) const;
+  void ComputeOrientations(const PreparedImage& image,
+                           std::vector<agast::KeyPoint>& keypoints) const;
+
+  // Extract from a prepared image, reusing its integral image across calls,
+  // e.g. for keypoint subsets of the same frame.
+  void compute(const PreparedImage& image,
+               std::vector<agast::KeyPoint>& keypoints,
+               agast::Mat& descriptors) const;
+  void compute(const PreparedImage& image,
+               std::vector<agast::KeyPoint>& keypoints,
+               std::vector<std::bitset<kDescriptorLength> >& descriptors) const;
+
+  // Extract directly into caller-owned memory, see DescriptorBuffer. The
+  // stride must be at least descriptorSize(). The capacity must be at least
+  // keypoints.size(), since the keypoints too close to the border are only
+  // removed during the extraction. Otherwise, or if the image type is not
+  // supported, throws std::runtime_error before the keypoints or the memory
+  // are modified. Returns the number of rows written, which is the new size
+  // of keypoints.
+  size_t compute(const PreparedImage& image,
+                 std::vector<agast::KeyPoint>& keypoints, unsigned char* data,
+                 size_t stride, size_t capacity, size_t alignment = 1) const;
+  // Same, but appends the rows to the ones already in the buffer, which must
+  // have keypoints.size() rows available.
+  void compute(const PreparedImage& image,
+               std::vector<agast::KeyPoint>& keypoints,
+               DescriptorBuffer& descriptors) const;
+
   virtual void detectAndCompute(cv::InputArray image, cv::InputArray /*mask*/,
                                 std::vector<cv::KeyPoint>& keypoints,
                                 cv::OutputArray descriptors,
@@ -132,21 +190,47 @@ class BriskDescriptorExtractor {
       const agast::Mat& image, std::vector<agast::KeyPoint>& keypoints,
       std::vector<std::bitset<kDescriptorLength> >& descriptors) const;
 
+  // The rows of a DescriptorBuffer written by one compute call.
+  struct DescriptorRows {
+    explicit DescriptorRows(DescriptorBuffer* buffer)
+        : buffer(buffer),
+          first(nullptr) { }
+    DescriptorBuffer* buffer;
+    unsigned char* first;
+  };
+
   void setDescriptorBits(int keypoint_idx, const int* values,
                          agast::Mat* descriptors) const;
 
+  void setDescriptorBits(int keypoint_idx, const int* values,
+                         DescriptorRows* descriptors) const;
+
   void setDescriptorBits(
       int keypoint_idx, const int* values,
       std::vector<std::bitset<kDescriptorLength> >* descriptors) const;
 
   void AllocateDescriptors(size_t count, agast::Mat& descriptors) const;
 
+  void AllocateDescriptors(size_t count, DescriptorRows& descriptors) const;
+
   void AllocateDescriptors(
       size_t count,
       std::vector<std::bitset<kDescriptorLength> >& descriptors) const;
 
+  // Assigns the pattern scale to every keypoint and removes the keypoints
+  // too close to the image border for the pattern at this scale.
+  void RemoveBorderKeypoints(const agast::Mat& image,
+                             std::vector<agast::KeyPoint>& keypoints,
+                             std::vector<int>* kscales) const;
+
+  // Samples the unrotated pattern into values and returns the angle of the
+  // summed long pair gradients in degrees.
+  float EstimateAngle(const agast::Mat& image, const agast::Mat& integral,
+                      const float key_x, const float key_y,
+                      const unsigned int scale, int* values) const;
+
   template <typename DESCRIPTOR_CONTAINER>
-  void doDescriptorComputation(const agast::Mat& image,
+  void doDescriptorComputation(const PreparedImage& preparedImage,
                                std::vector<agast::KeyPoint>& keypoints,
                                DESCRIPTOR_CONTAINER& descriptors) const;
 
@@ -161,19 +245,29 @@ class BriskDescriptorExtractor {
 
   void InitFromStream(bool rotationInvariant, bool scaleInvariant,
                       std::istream& pattern_stream, float patternScale = 1.0);
+  void InitFromPattern(bool rotationInvariant, bool scaleInvariant,
+                       const BriskPattern& pattern, float patternScale = 1.0);
   template <typename ImgPixel_T, typename IntegralPixel_T>
   __inline__ IntegralPixel_T SmoothedIntensity(
       const agast::Mat& image, const agast::Mat& integral, const float key_x,
-      const float key_y, const unsigned int scale, const unsigned int rot,
-      const unsigned int point) const;
+      const float key_y, const brisk::BriskPatternPoint& briskPoint) const;
+  // Samples all points of one pattern rotation in an 8 or 16 bit image.
+  void SmoothedIntensities(const agast::Mat& image, const agast::Mat& integral,
+                           const float key_x, const float key_y,
+                           const unsigned int scale, const unsigned int rot,
+                           int* values) const;
+  // Samples all points of one pattern rotation in an 8 bit image. Uses the
+  // quantized boxes if enabled, else the AVX2 kernel if available and
+  // SmoothedIntensity otherwise.
+  void SmoothedIntensities8(const agast::Mat& image, const agast::Mat& integral,
+                            const float key_x, const float key_y,
+                            const unsigned int scale, const unsigned int rot,
+                            int* values) const;
   // Pattern properties.
-  brisk::BriskPatternPoint* patternPoints_;
+  // Scaled and rotated pattern points, shared between extractors.
+  std::shared_ptr<const RotatedPatternTable> patternTable_;
   // Total number of collocation points.
   unsigned int points_;
-  // Lists the scaling per scale index [scale].
-  float* scaleList_;
-  // Lists the total pattern size per scale index [scale].
-  unsigned int* sizeList_;
   // Scales discretization
   static const unsigned int scales_;
   // Span of sizes 40->4 Octaves - else, this needs to be adjusted...
@@ -199,6 +293,12 @@ class BriskDescriptorExtractor {
 
   // General size.
   static const float basicSize_;
+
+  // Threading.
+  size_t numThreads_;
+  TaskRunner taskRunner_;
+
+  bool quantizedSampling_;
 };
 }  // namespace brisk
 
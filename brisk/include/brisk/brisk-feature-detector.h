@@ -42,11 +42,17 @@
 
 #include <vector>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 #include <agast/wrap-opencv.h>
 #include <brisk/internal/macros.h>
+#include <brisk/internal/parallel-for.h>
+#include <brisk/prepared-image.h>
 
 namespace brisk {
+class BriskScaleSpace;
+
 #if HAVE_OPENCV
 class  BriskFeatureDetector : public cv::Feature2D {
 #else
@@ -55,7 +61,13 @@ class  BriskFeatureDetector : public cv::Feature2D {
  public:
   BriskFeatureDetector(int thresh, int octaves = 3,
                        bool suppressScaleNonmaxima = true);
-  virtual ~BriskFeatureDetector() { }
+  // A copy continues from the adaptive threshold of the original and keeps
+  // the persistent scale space mode, but neither shares them nor serializes
+  // its calls with the original: it gets its own threshold history, and its
+  // own scale space, which is allocated on its first detection.
+  BriskFeatureDetector(const BriskFeatureDetector& other);
+  BriskFeatureDetector& operator=(const BriskFeatureDetector& other);
+  virtual ~BriskFeatureDetector();
   int threshold;
   int octaves;
 #if !HAVE_OPENCV
@@ -64,7 +76,13 @@ class  BriskFeatureDetector : public cv::Feature2D {
               const agast::Mat& mask = agast::Mat()) const {
     detectImpl(image, keypoints, mask);
   }
+#else
+  using cv::Feature2D::detect;
 #endif
+  // Detects on a prepared image and reuses its pyramid images.
+  void detect(const PreparedImage& image,
+              std::vector<agast::KeyPoint>& keypoints,
+              const agast::Mat& mask = agast::Mat()) const;
 
   virtual void detectAndCompute(cv::InputArray image, cv::InputArray mask,
                                 std::vector<cv::KeyPoint>& keypoints,
@@ -75,11 +93,87 @@ class  BriskFeatureDetector : public cv::Feature2D {
 
   void ComputeScale(const agast::Mat& image,
                     std::vector<agast::KeyPoint>& keypoints) const;
+
+  // Number of threads the detection runs on. Defaults to one. The keypoints
+  // are identical for any number of threads.
+  void SetNumThreads(size_t num_threads);
+  // Run the detection tasks on an external thread pool instead of spawning
+  // threads on every call. Pass an empty runner to restore the default.
+  void SetTaskRunner(const TaskRunner& task_runner);
+
+  // Keep the scale space alive between calls: the pyramid images, score
+  // maps, threshold maps and Agast detectors are then only reset, which
+  // avoids allocating them for every frame of a stream of equally sized
+  // images. Calls on a detector in this mode are serialized.
+  void SetPersistentScaleSpace(bool persistent);
+
+  // Detect on the image passed to detect directly instead of on a copy of it.
+  // The image must not be modified until detect returns, e.g. by another
+  // thread that reuses the frame buffer. It is not read afterwards.
+  void SetBorrowImages(bool borrow);
+
+  // Closed-loop thresholding for video: after every detection the threshold
+  // for the next one is adapted from the numbers of keypoints of the last
+  // frames such that it yields between min_keypoints and max_keypoints
+  // keypoints. At most max_keypoints keypoints, those with the highest
+  // responses, are returned. Starts from threshold, and starts over from it
+  // whenever threshold is assigned another value. Pass max_keypoints = 0 to
+  // return to the fixed threshold.
+  // The cap is applied after the whole pyramid has been detected, scored and
+  // refined, so it does not bound the time of a detection: until the
+  // threshold has adapted, a frame that yields far more than max_keypoints
+  // keypoints takes as long as it does with the fixed threshold.
+  void SetTargetNumKeypoints(size_t min_keypoints, size_t max_keypoints);
+  // The threshold the next detection uses.
+  int GetThreshold() const;
 protected:
+  struct AdaptiveThreshold {
+    // Starts the adaptation over from start_threshold.
+    void Restart(int start_threshold);
+
+    std::mutex mutex;
+    int threshold;
+    // The value of threshold the adaptation started from.
+    int startThreshold;
+    // The previous detection.
+    int lastThreshold;
+    size_t lastNumKeypoints;
+    size_t minKeypoints;
+    size_t maxKeypoints;
+  };
+  // Adapts the threshold to the detected keypoints and caps their number.
+  // Restarts the adaptation first if threshold was assigned another value.
+  void AdaptThreshold(std::vector<agast::KeyPoint>* keypoints) const;
+
+  struct PersistentScaleSpace {
+    std::mutex mutex;
+    std::unique_ptr<BriskScaleSpace> scaleSpace;
+    int octaves;
+    bool suppressScaleNonmaxima;
+  };
+  // The settings and state of other, see the copy constructor.
+  void CopyFrom(const BriskFeatureDetector& other);
+
+  // Runs detection on the persistent scale space if there is one, otherwise
+  // on a new one.
+  void RunOnScaleSpace(
+      const std::function<void(BriskScaleSpace*)>& detection) const;
+
   virtual void detectImpl(const agast::Mat& image,
                           std::vector<agast::KeyPoint>& keypoints,
                           const agast::Mat& mask = agast::Mat()) const;
+  // Builds the pyramid from the layers of preparedImage if given, else from
+  // image, and detects, masks and adapts the threshold for both detect paths.
+  void DetectOnPyramid(const agast::Mat& image,
+                       const PreparedImage* preparedImage,
+                       const agast::Mat& mask,
+                       std::vector<agast::KeyPoint>& keypoints) const;
   bool m_suppressScaleNonmaxima;
+  size_t numThreads_;
+  TaskRunner taskRunner_;
+  bool borrowImages_;
+  std::unique_ptr<AdaptiveThreshold> adaptiveThreshold_;
+  std::unique_ptr<PersistentScaleSpace> persistentScaleSpace_;
 };
 }  // namespace brisk
 
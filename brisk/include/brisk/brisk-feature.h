@@ -46,6 +46,7 @@
 #include <agast/wrap-opencv.h>
 #include <brisk/harris-feature-detector.h>
 #include <brisk/harris-score-calculator.h>
+#include <brisk/prepared-image.h>
 #include <brisk/scale-space-feature-detector.h>
 
 #if HAVE_OPENCV
@@ -63,6 +64,11 @@ class BriskFeature : public cv::Feature2D {
 
   virtual ~BriskFeature() { }
 
+  // Budget for the keypoints of all scale space layers together.
+  void SetMaxNumKptTotal(size_t maxNumKptTotal) {
+    _briskDetector.SetMaxNumKptTotal(maxNumKptTotal);
+  }
+
   // Inherited from cv::DescriptorExtractor interface.
   virtual int descriptorSize() const {
     return _briskExtractor.descriptorSize();
@@ -85,11 +91,14 @@ class BriskFeature : public cv::Feature2D {
     agast::Mat image_ = image.getMat();
     agast::Mat mask_ = mask.getMat();
 
+    // Detection and extraction share the derived images.
+    PreparedImage preparedImage(image_);
+
     // Run the detection. Take provided keypoints.
-    _briskDetector.detect(image_, keypoints, mask_);
+    _briskDetector.detect(preparedImage, keypoints, mask_);
 
     // Run the extraction.
-    _briskExtractor.compute(image_, keypoints, descriptors_);
+    _briskExtractor.compute(preparedImage, keypoints, descriptors_);
     descriptors.getMatRef() = descriptors_;
   }
 
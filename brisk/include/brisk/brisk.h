@@ -45,9 +45,12 @@
 #include <brisk/brisk-feature.h>
 #include <brisk/brisk-feature-detector.h>
 #include <brisk/brute-force-matcher.h>
+#include <brisk/descriptor-buffer.h>
+#include <brisk/grid-feature-detector.h>
 #include <brisk/harris-feature-detector.h>
 #include <brisk/harris-score-calculator.h>
 #include <agast/wrap-opencv.h>
+#include <brisk/prepared-image.h>
 #include <brisk/scale-space-feature-detector.h>
 #include <brisk/cameras/cameras.h>
 #include <brisk/camera-aware-feature.h>
@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BRISK_DESCRIPTOR_BUFFER_H_
+#define BRISK_DESCRIPTOR_BUFFER_H_
+
+#include <cstddef>
+
+namespace brisk {
+// Caller-owned memory descriptors are written to without an intermediate
+// allocation or copy: Row k starts at data + k * stride and holds the
+// descriptor bytes followed by zero padding up to the stride. Rows are
+// appended after the ones already in the buffer. The buffer does not take
+// ownership of the memory.
+class DescriptorBuffer {
+ public:
+  // data and stride must be multiples of alignment, which must be a power of
+  // two. The memory must hold capacity rows.
+  DescriptorBuffer(unsigned char* data, size_t stride, size_t capacity,
+                   size_t alignment = 1);
+
+  unsigned char* data() const {
+    return data_;
+  }
+  size_t stride() const {
+    return stride_;
+  }
+  // Number of rows in use.
+  size_t size() const {
+    return size_;
+  }
+  size_t capacity() const {
+    return capacity_;
+  }
+  unsigned char* Row(size_t row) const {
+    return data_ + row * stride_;
+  }
+
+  // Rows that can still be appended.
+  size_t available() const {
+    return capacity_ - size_;
+  }
+
+  // Appends count uninitialized rows and returns the first of them. Throws
+  // std::runtime_error and leaves the buffer unchanged if fewer than count
+  // rows are available.
+  unsigned char* Append(size_t count);
+  // Forgets all rows, the memory is reused for the next ones.
+  void clear() {
+    size_ = 0;
+  }
+
+ private:
+  unsigned char* data_;
+  size_t stride_;
+  size_t capacity_;
+  size_t size_;
+};
+}  // namespace brisk
+
+#endif  // BRISK_DESCRIPTOR_BUFFER_H_
@@ -0,0 +1,144 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BRISK_GRID_FEATURE_DETECTOR_H_
+#define BRISK_GRID_FEATURE_DETECTOR_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <agast/wrap-opencv.h>
+#include <brisk/brisk-feature-detector.h>
+#include <brisk/internal/macros.h>
+#include <brisk/internal/parallel-for.h>
+
+namespace brisk {
+// Detects BRISK keypoints in a grid of cells. Every cell runs its own
+// BriskFeatureDetector on its part of the image widened by a margin, and
+// keeps the keypoints inside its part. The cells are detected concurrently
+// and adapt their thresholds separately, which spreads the keypoints evenly
+// over the image. Of the keypoints that neighboring cells found at the same
+// place on their common border, only the strongest is kept.
+#if HAVE_OPENCV
+class GridFeatureDetector : public cv::Feature2D {
+#else
+class GridFeatureDetector {
+#endif  // HAVE_OPENCV
+ public:
+  // With the default margin, the cells find about 99% of the keypoints of
+  // BriskFeatureDetector on the whole image at the same threshold, for up to
+  // 3 octaves. The rest differ because the layers of the cells are
+  // downsampled and thresholded in blocks starting elsewhere.
+  static const int kDefaultMargin = 48;
+
+  GridFeatureDetector(size_t cellsX, size_t cellsY, int threshold,
+                      int octaves = 3, int margin = kDefaultMargin);
+  virtual ~GridFeatureDetector() { }
+#if !HAVE_OPENCV
+  void detect(const agast::Mat& image,
+              std::vector<agast::KeyPoint>& keypoints,
+              const agast::Mat& mask = agast::Mat()) const {
+    detectImpl(image, keypoints, mask);
+  }
+#else
+  using cv::Feature2D::detect;
+#endif
+
+  virtual void detectAndCompute(cv::InputArray image, cv::InputArray mask,
+                                std::vector<cv::KeyPoint>& keypoints,
+                                cv::OutputArray /*descriptors*/,
+                                bool /*useProvidedKeypoints*/ = false) {
+    detectImpl(image.getMat(), keypoints, mask.getMat());
+  }
+
+  // Number of cells that are detected concurrently. Defaults to one. The
+  // keypoints are identical for any number of threads.
+  void SetNumThreads(size_t num_threads);
+  // Run the cells on an external thread pool instead of spawning threads on
+  // every call. Pass an empty runner to restore the default.
+  void SetTaskRunner(const TaskRunner& task_runner);
+
+  // Adapt the threshold of every cell such that the cells together yield
+  // between min_keypoints and max_keypoints keypoints, each its share by
+  // area, see BriskFeatureDetector::SetTargetNumKeypoints. Pass
+  // max_keypoints = 0 to return to the fixed threshold.
+  void SetTargetNumKeypoints(size_t min_keypoints, size_t max_keypoints);
+  // The threshold the next detection uses in a cell.
+  int GetThreshold(size_t cellX, size_t cellY) const;
+
+ protected:
+  // The part of the image a cell owns the keypoints of and the part it
+  // detects them in, in image coordinates. The detection part starts at a
+  // multiple of the largest layer scale, so that the cell layers sample the
+  // same pixels as the image layers.
+  struct CellRegion {
+    int coreX0, coreY0, coreX1, coreY1;
+    int x0, y0, x1, y1;
+  };
+  CellRegion GetCellRegion(size_t cell, int cols, int rows) const;
+
+  // Sets the keypoint bands of the cells for an image of the given size,
+  // scaled to the areas they detect in.
+  void UpdateCellTargets(int cols, int rows) const;
+
+  virtual void detectImpl(const agast::Mat& image,
+                          std::vector<agast::KeyPoint>& keypoints,
+                          const agast::Mat& mask = agast::Mat()) const;
+
+  size_t cellsX_;
+  size_t cellsY_;
+  int octaves_;
+  int margin_;
+  size_t numThreads_;
+  TaskRunner taskRunner_;
+  std::vector<std::unique_ptr<BriskFeatureDetector> > cells_;
+
+  // The band of SetTargetNumKeypoints, and the image size the bands of the
+  // cells are set for.
+  struct CellTargets {
+    std::mutex mutex;
+    size_t minKeypoints;
+    size_t maxKeypoints;
+    int cols;
+    int rows;
+  };
+  std::unique_ptr<CellTargets> cellTargets_;
+};
+}  // namespace brisk
+
+#endif  // BRISK_GRID_FEATURE_DETECTOR_H_
@@ -41,6 +41,10 @@
 #ifndef BRISK_HARRIS_SCORE_CALCULATOR_H_
 #define BRISK_HARRIS_SCORE_CALCULATOR_H_
 
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
 #include <agast/wrap-opencv.h>
 #include <brisk/internal/macros.h>
 #include <brisk/internal/score-calculator.h>
@@ -53,6 +57,12 @@ class HarrisScoreCalculator : public ScoreCalculator<int> {
  public:
   typedef ScoreCalculator<int> Base_t;
 
+  HarrisScoreCalculator()
+      : _lazyScores(false),
+        _numBlocksX(0),
+        _numBlocksY(0) {
+  }
+
   // Provide accessor implementations here in order to enable inlining.
   inline double Score(double u, double v) {
     // Simple bilinear interpolation - no checking (for speed).
@@ -61,6 +71,8 @@ class HarrisScoreCalculator : public ScoreCalculator<int> {
     if (u_int + 1 >= _scores.cols || v_int + 1 >= _scores.rows || u_int < 0
         || v_int < 0)
       return 0.0;
+    if (_lazyScores)
+      EnsureScores(u_int, v_int, u_int + 1, v_int + 1);
     const double ru = u - static_cast<double>(u_int);
     const double rv = v - static_cast<double>(v_int);
     const double oneMinus_ru = 1.0 - ru;
@@ -73,20 +85,53 @@ class HarrisScoreCalculator : public ScoreCalculator<int> {
                 + ru * _scores.at<int>(v_int + 1, u_int + 1));
   }
   inline Base_t::Score_t Score(int u, int v) {
+    if (_lazyScores)
+      EnsureScores(u, v, u, v);
     return _scores.at<int>(v, u);
   }
+  // Interpolates with SIMD, the results are the same as Score's.
+  virtual void Scores(const double* u, const double* v, size_t n,
+                      double* scores);
   virtual void Get2dMaxima(std::vector<PointWithScore>& points,  // NOLINT
                            int absoluteThreshold = 0);
 
  protected:
   // Calculates the Harris scores.
   virtual void InitializeScores();
+  // Without initial scores, Score computes blocks of kScoreBlockSize squared
+  // pixels when they are first accessed, e.g. around passed keypoints, and
+  // Get2dMaxima all the scores. The results are the same.
+  virtual void DeferScores();
+  // Computes the blocks overlapping [x0, x1] x [y0, y1] that are missing.
+  inline void EnsureScores(int x0, int y0, int x1, int y1) {
+    const int blockX0 = std::max(x0, 0) / kScoreBlockSize;
+    const int blockY0 = std::max(y0, 0) / kScoreBlockSize;
+    const int blockX1 = std::min(x1 / kScoreBlockSize, _numBlocksX - 1);
+    const int blockY1 = std::min(y1 / kScoreBlockSize, _numBlocksY - 1);
+    for (int blockY = blockY0; blockY <= blockY1; ++blockY) {
+      for (int blockX = blockX0; blockX <= blockX1; ++blockX) {
+        if (!_blockComputed[blockY * _numBlocksX + blockX])
+          ComputeScoreBlock(blockX, blockY);
+      }
+    }
+  }
+  void ComputeScoreBlock(int blockX, int blockY);
 
   // Harris specific.
   static void GetCovarEntries(const agast::Mat& src, agast::Mat& dxdx, agast::Mat& dydy,
                               agast::Mat& dxdy);
   static void CornerHarris(const agast::Mat& dxdxSmooth, const agast::Mat& dydySmooth,
                            const agast::Mat& dxdySmooth, agast::Mat& score);
+
+  // Reused across images by the score computation.
+  std::vector<int16_t> _productRows;
+
+  // Lazy score computation.
+  static const int kScoreBlockSize = 16;
+  bool _lazyScores;
+  int _numBlocksX;
+  int _numBlocksY;
+  std::vector<unsigned char> _blockComputed;
 };
 }  // namespace brisk
 #endif  // __ARM_NEON
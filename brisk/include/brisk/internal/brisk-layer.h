@@ -58,13 +58,46 @@ class  BriskLayer {
     static const int HALFSAMPLE = 0;
     static const int TWOTHIRDSAMPLE = 1;
   };
-  // Construct a base layer.
+  // An empty layer, to be assigned to.
+  BriskLayer();
+  // Construct a base layer. The threshold map may be deferred to a later
+  // CalculateThresholdMap call, e.g. to compute it concurrently with other
+  // layers.
   BriskLayer(const agast::Mat& img, unsigned char upper_threshold, unsigned char lower_threshold,
-             float scale = 1.0f, float offset = 0.0f);
+             float scale = 1.0f, float offset = 0.0f,
+             bool calculateThresholdMap = true);
   // Derive a layer.
   BriskLayer(const BriskLayer& layer, int mode, unsigned char upper_threshold,
              unsigned char lower_threshold);
 
+  // Reinitialize the layer in place. The scores, the threshold map and its
+  // temporaries, the derived images and the Agast detectors are reused if
+  // the size did not change, so a layer that is reset for every frame of a
+  // video stream does not allocate.
+  // Use img as the base layer image, like the constructor.
+  void Reset(const agast::Mat& img, unsigned char upper_threshold,
+             unsigned char lower_threshold, float scale = 1.0f,
+             float offset = 0.0f, bool calculateThresholdMap = true);
+  // Copy img into a buffer that is owned by the layer.
+  void ResetCopy(const agast::Mat& img, unsigned char upper_threshold,
+                 unsigned char lower_threshold,
+                 bool calculateThresholdMap = true);
+  // Derive the layer from another layer.
+  void Reset(const BriskLayer& layer, int mode, unsigned char upper_threshold,
+             unsigned char lower_threshold);
+
+  // Calculate threshold map.
+  void CalculateThresholdMap();
+
+  // Only detect corners where the mask, of the layer size, is nonzero. An
+  // empty mask detects everywhere. The mask is copied. Resetting the layer
+  // from an image clears the mask.
+  void SetMask(const agast::Mat& mask);
+  // Downsample the mask of the layer this one is derived from, as in
+  // Reset. A pixel stays valid if any pixel it is sampled from is valid.
+  // Derived layers get their mask like this in Reset.
+  void DeriveMask(const BriskLayer& layer, int mode);
+
   // Fast/Agast without non-max suppression.
   void GetAgastPoints(uint8_t threshold,
                       std::vector<agast::KeyPoint>* keypoints);
@@ -82,6 +115,12 @@ class  BriskLayer {
   inline const agast::Mat& scores() const {
     return scores_;
   }
+  inline const agast::Mat& thrmap() const {
+    return thrmap_;
+  }
+  inline bool masked() const {
+    return masked_;
+  }
   inline float scale() const {
     return scale_;
   }
@@ -97,14 +136,30 @@ class  BriskLayer {
  private:
   // Access gray values (smoothed/interpolated).
   uint8_t Value(const agast::Mat& mat, float xf, float yf, float scale);
-  // Calculate threshold map.
-  void CalculateThresholdMap();
+  // Clears the scores and (re)allocates the buffers for the size of img_.
+  void ResetBuffers();
+  // Grows mask_ into detectionMask_.
+  void GrowDetectionMask();
+  // Corners are also detected this many pixels away from the valid ones, so
+  // that the non-maximum suppression and the refinement of the corners inside
+  // the mask see the same scores as without it.
+  static const int kMaskMargin = 4;
   // The image.
   agast::Mat img_;
+  // Storage for copied and derived images, which img_ then refers to.
+  agast::Mat imgBuffer_;
   // Its Fast scores.
   agast::Mat scores_;
   // Its threshold map.
   agast::Mat thrmap_;
+  // Temporaries of the threshold map.
+  agast::Mat tmpmax_;
+  agast::Mat tmpmin_;
+  // The mask, as set or downsampled, and the grown one corners are detected
+  // in.
+  bool masked_;
+  agast::Mat mask_;
+  agast::Mat detectionMask_;
   // coordinate transformation.
   float scale_;
   float offset_;
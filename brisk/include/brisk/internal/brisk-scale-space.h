@@ -46,6 +46,8 @@
 #include <agast/wrap-opencv.h>
 #include <brisk/internal/brisk-layer.h>
 #include <brisk/internal/macros.h>
+#include <brisk/internal/parallel-for.h>
+#include <brisk/prepared-image.h>
 
 namespace brisk {
 class  BriskScaleSpace {
@@ -54,14 +56,41 @@ class  BriskScaleSpace {
   BriskScaleSpace(uint8_t octaves = 3, bool suppress_scale_nonmaxima = true);
   ~BriskScaleSpace();
 
+  // Number of threads the pyramid is constructed and the layers are
+  // searched with. Defaults to one. The pyramid and the keypoints do not
+  // depend on the number of threads.
+  void SetNumThreads(size_t num_threads);
+  // Run the tasks on an external thread pool.
+  void SetTaskRunner(const TaskRunner& task_runner);
+  // By default ConstructPyramid copies the image into a buffer of the base
+  // layer. With borrow set, the base layer refers to the image instead, which
+  // then must stay alive and unchanged until GetKeypoints returns.
+  // Non-continuous images are still copied.
+  void SetBorrowImage(bool borrow);
+  // Only detect keypoints where the mask, of the image size, is nonzero. The
+  // mask is downsampled into every layer with the image, and the masked out
+  // pixels of the layers are skipped by the corner detection. Keypoints near
+  // the border of the mask are still detected and need to be filtered with
+  // the mask afterwards. Applies to the following ConstructPyramid calls; an
+  // empty mask detects everywhere again.
+  void SetMask(const agast::Mat& mask);
+
   // Construct the image pyramids.
   void ConstructPyramid(const agast::Mat& image, unsigned char threshold,
                         unsigned char overwrite_lower_thres = kDefaultLowerThreshold);
+  // Construct the image pyramids from the layer images of a prepared image.
+  void ConstructPyramid(const PreparedImage& image, unsigned char threshold,
+                        unsigned char overwrite_lower_thres = kDefaultLowerThreshold);
 
   // Get Keypoints.
   void GetKeypoints(std::vector<agast::KeyPoint>* keypoints);
 
  protected:
+  // Copies or borrows the image into the base layer.
+  void ResetBaseLayer(const agast::Mat& image,
+                      unsigned char overwrite_lower_thres,
+                      bool calculateThresholdMap);
+
   // Nonmax suppression:
   __inline__ bool IsMax2D(const uint8_t layer, const int x_layer,
                           const int y_layer);
@@ -116,6 +145,14 @@ class  BriskScaleSpace {
   static const unsigned char kDefaultLowerThreshold;
 
   bool suppressScaleNonmaxima_;
+
+  bool borrowImage_;
+
+  agast::Mat mask_;
+
+  // Threading.
+  size_t numThreads_;
+  TaskRunner taskRunner_;
 };
 }  // namespace brisk
 #endif  // INTERNAL_BRISK_SCALE_SPACE_H_
@@ -0,0 +1,74 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INTERNAL_HARRIS_SCORES_AVX2_H_
+#define INTERNAL_HARRIS_SCORES_AVX2_H_
+
+#include <stdint.h>
+#include <cstddef>
+
+#include <agast/wrap-opencv.h>
+
+namespace brisk {
+// AVX2 versions of the Harris kernels, with results identical to the SSE
+// ones. Must only be called if CpuSupportsAvx2().
+
+// Scharr gradient products of row i of an 8 bit image, stored to the
+// columns [1, cols - 1) like the SSE row kernel of HarrisScoresSSE. Needs at
+// least 18 columns, as it stores 16 at a time.
+void HarrisProductsRowAvx2(const unsigned char* data, int stride, int cols,
+                           int i, int16_t* dxdx, int16_t* dxdy, int16_t* dydy);
+
+// Smooths the gradient products of the rows above, at and below and stores
+// the Harris scores of the row, with the two border columns on either side
+// set to zero. Needs at least 12 columns.
+void HarrisScoresRowAvx2(const int16_t* const dxdxRows[3],
+                         const int16_t* const dxdyRows[3],
+                         const int16_t* const dydyRows[3], int cols,
+                         int* scores);
+
+// HarrisScoreCalculator::GetCovarEntries.
+void GetCovarEntriesAvx2(const agast::Mat& src, agast::Mat& dxdx,
+                         agast::Mat& dydy, agast::Mat& dxdy);
+
+// HarrisScoresBilinear of a multiple of four points.
+void HarrisScoresBilinearAvx2(const agast::Mat& scores, const double* u,
+                              const double* v, size_t n,
+                              double* interpolated);
+}  // namespace brisk
+
+#endif  // INTERNAL_HARRIS_SCORES_AVX2_H_
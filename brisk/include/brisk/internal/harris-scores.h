@@ -41,8 +41,13 @@
 #ifndef INTERNAL_HARRIS_SCORES_H_
 #define INTERNAL_HARRIS_SCORES_H_
 
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
 #include <brisk/brisk.h>
 #include <agast/wrap-opencv.h>
+#include <brisk/internal/parallel-for.h>
 
 namespace brisk {
 #ifdef __ARM_NEON
@@ -51,6 +56,28 @@ namespace brisk {
 // SSE speeded up (dxdx dxdy and dydy only).
 // Based on harrisScores_basic_noMats(.).
 void HarrisScoresSSE(const agast::Mat& src, agast::Mat& scores);
+// The largest block HarrisScoresBlock computes at once.
+const int kHarrisScoresMaxBlock = 32;
+// Computes the scores of the pixels [x0, x1) x [y0, y1) only, the same as
+// HarrisScoresSSE does. Scores must have the size of the image.
+void HarrisScoresBlock(const agast::Mat& src, int x0, int y0, int x1, int y1,
+                       agast::Mat* scores);
+// Scratch memory for the gradient products of a few rows per stripe.
+typedef std::vector<int16_t> HarrisScoresBuffer;
+// Splits the image into horizontal stripes that are scored concurrently.
+// Every stripe recomputes the gradients of the row above and below it, so the
+// scores are identical to the single threaded ones. Scores is reused if it
+// already has the right size, and so is the buffer if given, so that
+// repeated calls do not allocate.
+void HarrisScoresSSE(const agast::Mat& src, agast::Mat& scores,
+                     size_t num_threads,
+                     const TaskRunner& task_runner = TaskRunner(),
+                     HarrisScoresBuffer* buffer = nullptr);
+// Bilinearly interpolates the scores at the n points (u[i], v[i]), with the
+// results of HarrisScoreCalculator::Score(double, double), which is zero if
+// the four pixels are not all inside the image.
+void HarrisScoresBilinear(const agast::Mat& scores, const double* u,
+                          const double* v, size_t n, double* interpolated);
 #endif  // __ARM_NEON
 }  // namespace brisk
 #endif  // INTERNAL_HARRIS_SCORES_H_
@@ -52,5 +52,13 @@ void Halfsample16(const agast::Mat& srcimg, agast::Mat& dstimg);
 void Halfsample8(const agast::Mat& srcimg, agast::Mat& dstimg);
 void Twothirdsample16(const agast::Mat& srcimg, agast::Mat& dstimg);
 void Twothirdsample8(const agast::Mat& srcimg, agast::Mat& dstimg);
+
+// Masks are 8 bit, with nonzero for valid pixels. A pixel of the downsampled
+// mask is 255 if any of the pixels it is sampled from is valid, else 0.
+void HalfsampleMask(const agast::Mat& srcmask, agast::Mat& dstmask);
+void TwothirdsampleMask(const agast::Mat& srcmask, agast::Mat& dstmask);
+// Sets the pixels of dstmask within radius (in the maximum norm) of a valid
+// pixel of srcmask to 255, the others to 0.
+void DilateMask(const agast::Mat& srcmask, int radius, agast::Mat& dstmask);
 }  // namespace brisk
 #endif  // INTERNAL_IMAGE_DOWN_SAMPLING_H_
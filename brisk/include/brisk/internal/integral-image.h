@@ -53,7 +53,7 @@
 #endif
 
 namespace brisk {
-void IntegralImage8(const agast::Mat& src, agast::Mat* dest) {
+inline void IntegralImage8(const agast::Mat& src, agast::Mat* dest) {
   CHECK_NOTNULL(dest);
   int x, y;
   const int cn = 1;
@@ -160,59 +160,64 @@ void IntegralImage8(const agast::Mat& src, agast::Mat* dest) {
   }
 }
 
-void IntegralImage16(const agast::Mat& src, agast::Mat* dest) {
+// Integral image of a 16 bit image. The sums are accumulated in 32 bit
+// unsigned integers that wrap around, which cancels out when taking the
+// difference of entries for any box with a sum below 2^32, i.e. up to 65537
+// pixels. Stored as CV_32SC1, the entries must be read as uint32_t.
+inline void IntegralImage16(const agast::Mat& src, agast::Mat* dest) {
   CHECK_NOTNULL(dest);
-  int x, y;
-  const int cn = 1;
+  CHECK_EQ(src.type(), CV_16UC1);
   const int srcstep = static_cast<int>(src.step / sizeof(uint16_t));
 
-  dest->create(src.rows + 1, src.cols + 1, CV_MAKETYPE(CV_32F, 1));
+  dest->create(src.rows + 1, src.cols + 1, CV_MAKETYPE(CV_32S, 1));
 
-  float float_val;
-  const int sumstep = static_cast<int>(dest->step / sizeof(float_val));
+  const int sumstep = static_cast<int>(dest->step / sizeof(uint32_t));
 
-  float* sum = reinterpret_cast<float*>(dest->data);
-  uint16_t* _src = reinterpret_cast<uint16_t*>(src.data);
+  uint32_t* sum = reinterpret_cast<uint32_t*>(dest->data);
+  const uint16_t* _src = reinterpret_cast<const uint16_t*>(src.data);
 
-  memset(sum, 0, (src.cols + cn) * sizeof(sum[0]));
+  memset(sum, 0, (src.cols + 1) * sizeof(sum[0]));
   sum += sumstep + 1;
 
-  const int maxRows = src.rows;
-  const int maxCols = src.cols - 4;
-  const float cvtScale = 1.0 / 65536.0;
-
-  for (y = 0; y < maxRows; y++, _src += srcstep, sum += sumstep) {
-    float s = sum[-1] = 0.0;
-    for (x = 0; x <= maxCols; x += 4) {
-      const int x1 = x + 1;
-      const int x2 = x + 2;
-      const int x3 = x + 3;
-
-      float s0 = s + _src[x] * cvtScale;
-      float s1 = s0 + _src[x1] * cvtScale;
-      float s2 = s1 + _src[x2] * cvtScale;
-      float s3 = s2 + _src[x3] * cvtScale;
-      s = s3;
-#ifdef __ARM_NEON
-      float tmp1[4] = {s0, s1, s2, s3};
-      float32x4_t  __src0 = vld1q_f32(tmp1);
-
-      float32x4_t  __sum = vld1q_f32(&sum[x - sumstep]);
-      __sum = vaddq_f32(__src0, __sum);
-      vst1q_f32(&sum[x], __sum);
-#else
-      __m128  __src0 = _mm_set_ps(s3, s2, s1, s0);
-
-      __m128  __sum = _mm_loadu_ps(&sum[x - sumstep]);
-      __sum = _mm_add_ps(__src0, __sum);
-      _mm_storeu_ps(&sum[x], __sum);
-#endif
+  for (int y = 0; y < src.rows; y++, _src += srcstep, sum += sumstep) {
+    sum[-1] = 0;
+    uint32_t s = 0;
+    int x = 0;
+#ifndef __ARM_NEON
+    // Prefix sums of 8 pixels at a time: shift and add within the register,
+    // then add the running row sum and the row above.
+    const __m128i zero = _mm_setzero_si128();
+    __m128i running = _mm_setzero_si128();
+    for (; x <= src.cols - 8; x += 8) {
+      const __m128i pixels =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(_src + x));
+      __m128i low = _mm_unpacklo_epi16(pixels, zero);
+      __m128i high = _mm_unpackhi_epi16(pixels, zero);
+      low = _mm_add_epi32(low, _mm_slli_si128(low, 4));
+      low = _mm_add_epi32(low, _mm_slli_si128(low, 8));
+      high = _mm_add_epi32(high, _mm_slli_si128(high, 4));
+      high = _mm_add_epi32(high, _mm_slli_si128(high, 8));
+      low = _mm_add_epi32(low, running);
+      high = _mm_add_epi32(high, _mm_shuffle_epi32(low, _MM_SHUFFLE(3, 3, 3,
+                                                                     3)));
+      running = _mm_shuffle_epi32(high, _MM_SHUFFLE(3, 3, 3, 3));
+
+      const __m128i above_low =
+          _mm_loadu_si128(reinterpret_cast<__m128i*>(&sum[x - sumstep]));
+      const __m128i above_high =
+          _mm_loadu_si128(reinterpret_cast<__m128i*>(&sum[x + 4 - sumstep]));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&sum[x]),
+                       _mm_add_epi32(low, above_low));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&sum[x + 4]),
+                       _mm_add_epi32(high, above_high));
     }
+    s = static_cast<uint32_t>(_mm_cvtsi128_si32(running));
+#endif  // __ARM_NEON
 
     // Finish the row.
-    for (int _x = x; _x < src.cols; ++_x) {
-      s += _src[_x];
-      sum[_x] = sum[_x - sumstep] + s;
+    for (; x < src.cols; ++x) {
+      s += _src[x];
+      sum[x] = sum[x - sumstep] + s;
     }
   }
 }
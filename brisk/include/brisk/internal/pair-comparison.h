@@ -0,0 +1,70 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INTERNAL_PAIR_COMPARISON_H_
+#define INTERNAL_PAIR_COMPARISON_H_
+
+#include <stdint.h>
+
+#include <brisk/internal/helper-structures.h>
+
+namespace brisk {
+// Compares the smoothed intensities of num_pairs point pairs and packs the
+// results into (num_pairs + 7) / 8 bytes: bit k of the output, i.e. bit k % 8
+// of byte k / 8, is set iff values[pairs[k].i] > values[pairs[k].j]. Unused
+// bits of the last byte are cleared. Compares 32 pairs at a time with AVX2 if
+// CpuSupportsAvx2().
+void CompareShortPairs(const int* values, const BriskShortPair* pairs,
+                       unsigned int num_pairs, unsigned char* bits);
+
+// Sums the intensity gradients along num_pairs long pairs, i.e.
+// (values[i] - values[j]) * weighted_dx / 1024 into direction0 and the same
+// with weighted_dy into direction1. The integer division truncates per pair
+// as in the scalar code, so the sums are exact. Handles 8 pairs at a time
+// with AVX2 if CpuSupportsAvx2().
+void SumLongPairGradients(const int* values, const BriskLongPair* pairs,
+                          unsigned int num_pairs, int* direction0,
+                          int* direction1);
+
+// The same with 64 bit products and sums, for the intensities of 16 bit
+// images, which are up to 256 times larger than those of 8 bit ones.
+void SumLongPairGradients(const int* values, const BriskLongPair* pairs,
+                          unsigned int num_pairs, int64_t* direction0,
+                          int64_t* direction1);
+}  // namespace brisk
+
+#endif  // INTERNAL_PAIR_COMPARISON_H_
@@ -0,0 +1,69 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INTERNAL_PARALLEL_FOR_H_
+#define INTERNAL_PARALLEL_FOR_H_
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace brisk {
+// A batch of independent tasks.
+typedef std::vector<std::function<void()> > TaskBatch;
+
+// Hook to run a batch of tasks on an external thread pool. The runner may
+// execute the tasks in any order and concurrently, but must only return once
+// all of them have finished.
+typedef std::function<void(TaskBatch* tasks)> TaskRunner;
+
+// Runs all tasks and blocks until they are done. Uses the given runner if set,
+// otherwise spawns one std::thread per task except for the first, which is
+// executed on the calling thread.
+void RunTasks(TaskBatch* tasks, const TaskRunner& task_runner = TaskRunner());
+
+// Splits [0, num_items) into at most num_threads contiguous ranges of at least
+// min_items_per_range items and calls range_task(begin, end) for each of them.
+// Falls back to a single call on the calling thread if there is nothing to
+// split.
+void ParallelFor(size_t num_items, size_t num_threads,
+                 size_t min_items_per_range,
+                 const std::function<void(size_t begin, size_t end)>& range_task,
+                 const TaskRunner& task_runner = TaskRunner());
+}  // namespace brisk
+
+#endif  // INTERNAL_PARALLEL_FOR_H_
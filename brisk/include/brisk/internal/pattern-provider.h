@@ -41,10 +41,44 @@
 #ifndef PATTERN_PROVIDER_H_
 #define PATTERN_PROVIDER_H_
 
+#include <istream>  // NOLINT
+#include <ostream>  // NOLINT
 #include <sstream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include <brisk/internal/helper-structures.h>
 
 namespace brisk {
+// A BRISK 2.0 pattern as stored in a pattern file: the unscaled points and
+// the point indices of the short and long pairs.
+struct BriskPattern {
+  std::vector<BriskPatternPoint> points;
+  std::vector<BriskShortPair> shortPairs;
+  std::vector<BriskShortPair> longPairs;
+};
+
+// The default pattern, compiled into the library.
+void GetDefaultPattern(BriskPattern* pattern);
+// The default pattern in the text format of brisk.ptn.
 void GetDefaultPatternAsStream(std::stringstream* pattern_stream);
+
+// The text format of brisk.ptn.
+bool ReadPatternText(std::istream& pattern_stream, BriskPattern* pattern);
+void WritePatternText(const BriskPattern& pattern,
+                      std::ostream* pattern_stream);
+
+// The binary format: the tag "BPTN", a uint32 format version, the number of
+// points followed by x, y and sigma of every point as float32, then the short
+// and long pairs each as a uint32 count followed by i, j as uint32. All values
+// are in host byte order. Counts that do not fit into the rest of the stream
+// fail the read before anything is allocated.
+bool ReadPatternBinary(std::istream& pattern_stream, BriskPattern* pattern);
+void WritePatternBinary(const BriskPattern& pattern,
+                        std::ostream* pattern_stream);
+
+// Reads a pattern file in either format. Returns false on failure.
+bool ReadPatternFile(const std::string& fname, BriskPattern* pattern);
 }  // namespace brisk
 
 #endif  // PATTERN_PROVIDER_H_
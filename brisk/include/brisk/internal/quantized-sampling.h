@@ -0,0 +1,90 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INTERNAL_QUANTIZED_SAMPLING_H_
+#define INTERNAL_QUANTIZED_SAMPLING_H_
+
+#include <stdint.h>
+
+#include <agast/wrap-opencv.h>
+#include <brisk/internal/helper-structures.h>
+
+namespace brisk {
+// Number of sub-pixel phases per axis the keypoint position is quantized to.
+static const int kSamplingPhases = 4;
+
+// Fractional bits of SamplingBox::inverseWidth.
+static const int kInverseWidthBits = 32;
+
+// The box filter of a pattern point along one axis, relative to the integer
+// keypoint position: the first and last pixel covered and the overlap of the
+// first one with the box in 1/1024. The overlap of the last one is the rest
+// of the box width.
+struct SamplingAxis {
+  int16_t lo;
+  int16_t hi;
+  uint16_t weightLo;
+};
+
+// The box filter of a pattern point for every sub-pixel phase. The box is
+// square and its width in 1/1024 pixels the same for all phases, so that
+// the normalization is a multiplication with its fixed-point inverse. Points
+// with a sigma below 0.5 are bilinearly interpolated, which is expressed as
+// a box with hi = lo + 1 and a width of 1024.
+struct SamplingBox {
+  SamplingAxis x[kSamplingPhases];
+  SamplingAxis y[kSamplingPhases];
+  uint32_t width;
+  // 2^kInverseWidthBits / width, rounded.
+  uint32_t inverseWidth;
+};
+
+// Compiles the boxes of count pattern points.
+void BuildSamplingBoxes(const BriskPatternPoint* points, unsigned int count,
+                        SamplingBox* boxes);
+
+// Samples the smoothed intensities of num_points pattern points around a
+// keypoint of an 8 bit image with the keypoint position rounded to the
+// nearest sub-pixel phase. The values are on the same scale as the ones of
+// BriskDescriptorExtractor::SmoothedIntensity, but not bit-identical.
+void QuantizedSmoothedIntensities(const agast::Mat& image,
+                                  const agast::Mat& integral, float key_x,
+                                  float key_y, const SamplingBox* boxes,
+                                  unsigned int num_points, int* values);
+}  // namespace brisk
+
+#endif  // INTERNAL_QUANTIZED_SAMPLING_H_
@@ -0,0 +1,145 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INTERNAL_ROTATED_PATTERN_TABLE_H_
+#define INTERNAL_ROTATED_PATTERN_TABLE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <brisk/internal/helper-structures.h>
+#include <brisk/internal/quantized-sampling.h>
+
+namespace brisk {
+// Unscaled and unrotated description of a sampling pattern.
+struct PatternDefinition {
+  enum Type {
+    // Points given by coordinates and smoothing sigma (BRISK 2.0).
+    kPoints,
+    // Points evenly distributed on concentric rings (legacy BRISK 1.0).
+    kRings
+  };
+  PatternDefinition() : type(kPoints) { }
+
+  Type type;
+  // kPoints: Coordinates and sigma of every point.
+  std::vector<BriskPatternPoint> points;
+  // kRings: Radius and number of points of every ring.
+  std::vector<float> ringRadii;
+  std::vector<int> ringNumPoints;
+
+  unsigned int NumPoints() const;
+};
+
+// Integer normalization factors of the box filter a point is smoothed with,
+// see BriskDescriptorExtractor::SmoothedIntensity. They depend on sigma only,
+// hence not on the rotation.
+struct BoxFilterScaling {
+  int scaling;
+  int scaling2;
+};
+
+// Immutable look-up of the scaled and rotated pattern points. Tables are
+// shared between all extractors using the same pattern and are built lazily
+// one scale at a time, so scales that are never sampled cost nothing.
+class RotatedPatternTable {
+ public:
+  // Returns the table for the given pattern. It is created on first request
+  // and released once the last user drops its reference.
+  static std::shared_ptr<const RotatedPatternTable> Get(
+      const PatternDefinition& pattern, float patternScale,
+      unsigned int numScales, unsigned int numRotations, float scaleRange);
+
+  RotatedPatternTable(const PatternDefinition& pattern, float patternScale,
+                      unsigned int numScales, unsigned int numRotations,
+                      float scaleRange);
+  ~RotatedPatternTable();
+
+  // The points of all rotations at the given scale, indexed by
+  // [rot * NumPoints() + point].
+  const BriskPatternPoint* GetScale(unsigned int scale) const;
+  // Total pattern size per scale, i.e. the border a keypoint needs.
+  unsigned int GetSize(unsigned int scale) const;
+  // Box filter normalization per point at the given scale, zero for points
+  // that are interpolated instead of box filtered.
+  const BoxFilterScaling* GetBoxFilterScalings(unsigned int scale) const;
+  // Fixed-point sampling boxes of all rotations at the given scale, indexed
+  // like the points. They are only built on request.
+  const SamplingBox* GetSamplingBoxes(unsigned int scale) const;
+
+  unsigned int NumPoints() const {
+    return numPoints_;
+  }
+  unsigned int NumScales() const {
+    return numScales_;
+  }
+  unsigned int NumRotations() const {
+    return numRotations_;
+  }
+
+ private:
+  struct ScaleEntry {
+    std::once_flag built;
+    std::vector<BriskPatternPoint> points;
+    std::vector<BoxFilterScaling> boxFilterScalings;
+    unsigned int size;
+    std::once_flag samplingBoxesBuilt;
+    std::vector<SamplingBox> samplingBoxes;
+  };
+
+  RotatedPatternTable(const RotatedPatternTable&) = delete;
+  RotatedPatternTable& operator=(const RotatedPatternTable&) = delete;
+
+  const ScaleEntry& GetScaleEntry(unsigned int scale) const;
+  void BuildScale(unsigned int scale, ScaleEntry* entry) const;
+  void BuildPoints(unsigned int scale, BriskPatternPoint* patternIterator,
+                   unsigned int* patternSize) const;
+
+  PatternDefinition pattern_;
+  float patternScale_;
+  unsigned int numPoints_;
+  unsigned int numScales_;
+  unsigned int numRotations_;
+  // Scaling per scale index [scale].
+  std::vector<float> scaleList_;
+  std::unique_ptr<ScaleEntry[]> scales_;
+};
+}  // namespace brisk
+
+#endif  // INTERNAL_ROTATED_PATTERN_TABLE_H_
@@ -42,6 +42,7 @@
 #define INTERNAL_SCALE_SPACE_LAYER_INL_H_
 
 #include <algorithm>
+#include <cstring>
 #include <vector>
 
 #include <brisk/internal/image-down-sampling.h>
@@ -71,6 +72,10 @@ void ScaleSpaceLayer<SCORE_CALCULATOR_T>::Create(const agast::Mat& img,
   _scoreCalculator.SetImage(img, initScores);
   _img = img;
 
+  // No mask (yet).
+  _masked = false;
+  _scoreCalculator.SetMask(agast::Mat());
+
   // Scales and offsets.
   _offset_above = -0.25;
   _offset_below = 1.0 / 6.0;
@@ -110,30 +115,29 @@ void ScaleSpaceLayer<SCORE_CALCULATOR_T>::Create(
   brisk::timing::Timer timerDownsample(
       "0.0 BRISK Detection: Creation&Downsampling (per layer)");
   int type = layerBelow->_img.type();
-  if (layerBelow->_isOctave) {
-    if (layerBelow->_layerNumber >= 2) {
-      // We can do the (cheaper) halfsampling.
-      _img.create(layerBelow->_belowLayer_ptr->_img.rows / 2,
-                  layerBelow->_belowLayer_ptr->_img.cols / 2, type);
-      Halfsample(layerBelow->_belowLayer_ptr->_img, _img);
-
-    } else {
-      // We do the two-third sampling.
-      _img.create((layerBelow->_img.rows / 3) * 2,
-                  (layerBelow->_img.cols / 3) * 2, type);
-      Twothirdsample(layerBelow->_img, _img);
-    }
-    // Keep track of where in the pyramid we are.
-    _isOctave = false;
+  agast::Mat img;
+  if (layerBelow->_isOctave && layerBelow->_layerNumber < 2) {
+    // We do the two-third sampling.
+    img.create((layerBelow->_img.rows / 3) * 2,
+               (layerBelow->_img.cols / 3) * 2, type);
+    Twothirdsample(layerBelow->_img, img);
   } else {
     // We can do the (cheaper) halfsampling.
-    _img.create(layerBelow->_belowLayer_ptr->_img.rows / 2,
-                layerBelow->_belowLayer_ptr->_img.cols / 2, type);
-    Halfsample(layerBelow->_belowLayer_ptr->_img, _img);
-
-    // Keep track of where in the pyramid we are.
-    _isOctave = true;
+    img.create(layerBelow->_belowLayer_ptr->_img.rows / 2,
+               layerBelow->_belowLayer_ptr->_img.cols / 2, type);
+    Halfsample(layerBelow->_belowLayer_ptr->_img, img);
   }
+  timerDownsample.Stop();
+  Create(layerBelow, img, initScores);
+}
+
+template<class SCORE_CALCULATOR_T>
+void ScaleSpaceLayer<SCORE_CALCULATOR_T>::Create(
+    ScaleSpaceLayer<ScoreCalculator_t>* layerBelow, const agast::Mat& img,
+    bool initScores) {
+  _img = img;
+  // Keep track of where in the pyramid we are.
+  _isOctave = !layerBelow->_isOctave;
   // Keep track.
   _layerNumber = layerBelow->_layerNumber + 1;
   _belowLayer_ptr = layerBelow;
@@ -155,7 +159,6 @@ void ScaleSpaceLayer<SCORE_CALCULATOR_T>::Create(
     _scale = pow(2.0, static_cast<double>(_layerNumber / 2)) * 1.5;
     _offset = _scale * 0.5 - 0.5;
   }
-  timerDownsample.Stop();
 
   // By default no uniformity radius.
   _radius = 1;
@@ -166,6 +169,13 @@ void ScaleSpaceLayer<SCORE_CALCULATOR_T>::Create(
   // Initialize the score calculation.
   _scoreCalculator.SetImage(_img, initScores);
 
+  // Downsample the mask like the image.
+  if (layerBelow->_isOctave && layerBelow->_layerNumber < 2) {
+    DeriveMask(*layerBelow, true);
+  } else {
+    DeriveMask(*layerBelow->_belowLayer_ptr, false);
+  }
+
   // The above layer is undefined:
   _aboveLayer_ptr = 0;
 
@@ -181,6 +191,49 @@ void ScaleSpaceLayer<SCORE_CALCULATOR_T>::Create(
   }
 }
 
+template<class SCORE_CALCULATOR_T>
+void ScaleSpaceLayer<SCORE_CALCULATOR_T>::SetMask(const agast::Mat& mask) {
+  _masked = !mask.empty();
+  if (!_masked) {
+    _scoreCalculator.SetMask(agast::Mat());
+    return;
+  }
+  CHECK_EQ(mask.type(), CV_8UC1);
+  CHECK_EQ(mask.rows, _img.rows);
+  CHECK_EQ(mask.cols, _img.cols);
+  _mask.create(_img.rows, _img.cols, CV_8U);
+  for (int row = 0; row < mask.rows; ++row) {
+    memcpy(_mask.data + row * _mask.cols, mask.data + row * mask.step,
+           mask.cols);
+  }
+  GrowDetectionMask();
+}
+
+template<class SCORE_CALCULATOR_T>
+void ScaleSpaceLayer<SCORE_CALCULATOR_T>::DeriveMask(
+    const ScaleSpaceLayer<ScoreCalculator_t>& layerBelow,
+    bool twothirdsample) {
+  _masked = layerBelow._masked;
+  if (!_masked) {
+    _scoreCalculator.SetMask(agast::Mat());
+    return;
+  }
+  _mask.create(_img.rows, _img.cols, CV_8U);
+  if (twothirdsample) {
+    TwothirdsampleMask(layerBelow._mask, _mask);
+  } else {
+    HalfsampleMask(layerBelow._mask, _mask);
+  }
+  GrowDetectionMask();
+}
+
+template<class SCORE_CALCULATOR_T>
+void ScaleSpaceLayer<SCORE_CALCULATOR_T>::GrowDetectionMask() {
+  _detectionMask.create(_img.rows, _img.cols, CV_8U);
+  DilateMask(_mask, 1, _detectionMask);
+  _scoreCalculator.SetMask(_detectionMask);
+}
+
 template<class SCORE_CALCULATOR_T>
 void ScaleSpaceLayer<SCORE_CALCULATOR_T>::SetUniformityRadius(double radius) {
   _radius = radius;
@@ -193,8 +246,26 @@ template<class SCORE_CALCULATOR_T>
 void ScaleSpaceLayer<SCORE_CALCULATOR_T>::DetectScaleSpaceMaxima(
     std::vector<agast::KeyPoint>& keypoints, bool enforceUniformity,
     bool doRefinement, bool usePassedKeypoints) {
-  // First get the maxima points inside this layer.
   std::vector<typename ScoreCalculator_t::PointWithScore> points;
+  GetScaleSpaceMaxima(keypoints, enforceUniformity, usePassedKeypoints,
+                      &points);
+  if (points.size() == 0)
+    return;
+  if (usePassedKeypoints)
+    keypoints.clear();
+  RefineScaleSpaceMaxima(points, doRefinement, &keypoints);
+}
+
+template<class SCORE_CALCULATOR_T>
+void ScaleSpaceLayer<SCORE_CALCULATOR_T>::GetScaleSpaceMaxima(
+    const std::vector<agast::KeyPoint>& keypoints, bool enforceUniformity,
+    bool usePassedKeypoints,
+    std::vector<typename ScoreCalculator_t::PointWithScore>* points_ptr) {
+  CHECK_NOTNULL(points_ptr);
+  std::vector<typename ScoreCalculator_t::PointWithScore>& points =
+      *points_ptr;
+  points.clear();
+  // First get the maxima points inside this layer.
   if (usePassedKeypoints) {
     points.reserve(keypoints.size());
     for (size_t k = 0; k < keypoints.size(); ++k) {
@@ -212,157 +283,30 @@ void ScaleSpaceLayer<SCORE_CALCULATOR_T>::DetectScaleSpaceMaxima(
     _scoreCalculator.Get2dMaxima(points, _absoluteThreshold);
     timerNonMaxSuppression2d.Stop();
   }
-  // Next check above and below. The code looks a bit stupid, but that's
-  // for speed. We don't want to make the distinction analyzing whether or
-  // not there is a layer above and below inside the loop.
-  if (!usePassedKeypoints) {
-    if (_aboveLayer_ptr != 0 && _belowLayer_ptr != 0) {
-      // Check above and below
-      brisk::timing::DebugTimer timerNonMaxSuppression3d(
-          "0.3 BRISK Detection: 3d nonmax suppression (per layer)");
-      std::vector<typename ScoreCalculator_t::PointWithScore> pt_tmp;
-      pt_tmp.reserve(points.size());
-      const int one_over_scale_above = 1.0 / _scale_above;
-      const int one_over_scale_below = 1.0 / _scale_below;
-      for (typename std::vector<
-          typename ScoreCalculator_t::PointWithScore>::const_iterator it =
-          points.begin(); it != points.end(); ++it) {
-        const typename ScoreCalculator_t::Score_t center = it->score;
-        const int x = it->x;
-        const int y = it->y;
-        if (center < (typename ScoreCalculator_t::Score_t) (_absoluteThreshold))
-          continue;
-        if (center < ScoreAbove(x, y))
-          continue;
-        if (center < ScoreAbove(x + one_over_scale_above, y))
-          continue;
-        if (center < ScoreAbove(x - one_over_scale_above, y))
-          continue;
-        if (center < ScoreAbove(x, y + one_over_scale_above))
-          continue;
-        if (center < ScoreAbove(x, y - one_over_scale_above))
-          continue;
-        if (center
-            < ScoreAbove(x + one_over_scale_above, y + one_over_scale_above))
-          continue;
-        if (center
-            < ScoreAbove(x + one_over_scale_above, y - one_over_scale_above))
-          continue;
-        if (center
-            < ScoreAbove(x - one_over_scale_above, y + one_over_scale_above))
-          continue;
-        if (center
-            < ScoreAbove(x - one_over_scale_above, y - one_over_scale_above))
-          continue;
-        if (center < ScoreBelow(x, y))
-          continue;
-        if (center < ScoreBelow(x + one_over_scale_below, y))
-          continue;
-        if (center < ScoreBelow(x - one_over_scale_below, y))
-          continue;
-        if (center < ScoreBelow(x, y + one_over_scale_below))
-          continue;
-        if (center < ScoreBelow(x, y - one_over_scale_below))
-          continue;
-        if (center
-            < ScoreBelow(x + one_over_scale_below, y + one_over_scale_below))
-          continue;
-        if (center
-            < ScoreBelow(x + one_over_scale_below, y - one_over_scale_below))
-          continue;
-        if (center
-            < ScoreBelow(x - one_over_scale_below, y + one_over_scale_below))
-          continue;
-        if (center
-            < ScoreBelow(x - one_over_scale_below, y - one_over_scale_below))
-          continue;
-        pt_tmp.push_back(*it);
-      }
-      points.assign(pt_tmp.begin(), pt_tmp.end());
-      timerNonMaxSuppression3d.Stop();
-    } else if (_aboveLayer_ptr != 0) {
-      // Check above.
-      brisk::timing::DebugTimer timerNonMaxSuppression3d(
-          "0.3 BRISK Detection: 3d nonmax suppression (per layer)");
-      std::vector<typename ScoreCalculator_t::PointWithScore> pt_tmp;
-      pt_tmp.reserve(points.size());
-      const int one_over_scale_above = 1.0 / _scale_above;
-      for (typename std::vector<
-          typename ScoreCalculator_t::PointWithScore>::const_iterator it =
-          points.begin(); it != points.end(); ++it) {
-        const typename ScoreCalculator_t::Score_t center = it->score;
-        if (center < (typename ScoreCalculator_t::Score_t) (_absoluteThreshold))
-          continue;
-        const int x = it->x;
-        const int y = it->y;
-        if (center < ScoreAbove(x, y))
-          continue;
-        if (center < ScoreAbove(x + one_over_scale_above, y))
-          continue;
-        if (center < ScoreAbove(x - one_over_scale_above, y))
-          continue;
-        if (center < ScoreAbove(x, y + one_over_scale_above))
-          continue;
-        if (center < ScoreAbove(x, y - one_over_scale_above))
-          continue;
-        if (center
-            < ScoreAbove(x + one_over_scale_above, y + one_over_scale_above))
-          continue;
-        if (center
-            < ScoreAbove(x + one_over_scale_above, y - one_over_scale_above))
-          continue;
-        if (center
-            < ScoreAbove(x - one_over_scale_above, y + one_over_scale_above))
-          continue;
-        if (center
-            < ScoreAbove(x - one_over_scale_above, y - one_over_scale_above))
-          continue;
-        pt_tmp.push_back(*it);
-      }
-      points.assign(pt_tmp.begin(), pt_tmp.end());
-      timerNonMaxSuppression3d.Stop();
-    } else if (_belowLayer_ptr != 0) {
-      // Check below.
-      brisk::timing::DebugTimer timerNonMaxSuppression3d(
-          "0.3 BRISK Detection: 3d nonmax suppression (per layer)");
-      std::vector<typename ScoreCalculator_t::PointWithScore> pt_tmp;
-      pt_tmp.reserve(points.size());
-      const int one_over_scale_below = 1.0 / _scale_below;
-      for (typename std::vector<
-          typename ScoreCalculator_t::PointWithScore>::const_iterator it =
-          points.begin(); it != points.end(); ++it) {
-        const typename ScoreCalculator_t::Score_t center = it->score;
-        if (center < (typename ScoreCalculator_t::Score_t) (_absoluteThreshold))
-          continue;
-        const int x = it->x;
-        const int y = it->y;
-        if (center < ScoreBelow(x, y))
-          continue;
-        if (center < ScoreBelow(x + one_over_scale_below, y))
-          continue;
-        if (center < ScoreBelow(x - one_over_scale_below, y))
-          continue;
-        if (center < ScoreBelow(x, y + one_over_scale_below))
-          continue;
-        if (center < ScoreBelow(x, y - one_over_scale_below))
-          continue;
-        if (center
-            < ScoreBelow(x + one_over_scale_below, y + one_over_scale_below))
-          continue;
-        if (center
-            < ScoreBelow(x + one_over_scale_below, y - one_over_scale_below))
-          continue;
-        if (center
-            < ScoreBelow(x - one_over_scale_below, y + one_over_scale_below))
-          continue;
-        if (center
-            < ScoreBelow(x - one_over_scale_below, y - one_over_scale_below))
-          continue;
-        pt_tmp.push_back(*it);
-      }
-      points.assign(pt_tmp.begin(), pt_tmp.end());
-      timerNonMaxSuppression3d.Stop();
+  // Next check above and below.
+  if (!usePassedKeypoints
+      && (_aboveLayer_ptr != nullptr || _belowLayer_ptr != nullptr)) {
+    brisk::timing::DebugTimer timerNonMaxSuppression3d(
+        "0.3 BRISK Detection: 3d nonmax suppression (per layer)");
+    const typename ScoreCalculator_t::Score_t threshold =
+        static_cast<typename ScoreCalculator_t::Score_t>(_absoluteThreshold);
+    points.erase(
+        std::remove_if(
+            points.begin(), points.end(),
+            [threshold](
+                const typename ScoreCalculator_t::PointWithScore& point) {
+              return point.score < threshold;
+            }),
+        points.end());
+    if (_aboveLayer_ptr != nullptr) {
+      SuppressNonMaxima(*_aboveLayer_ptr, _scale_above, _offset_above,
+                        &points);
+    }
+    if (_belowLayer_ptr != nullptr) {
+      SuppressNonMaxima(*_belowLayer_ptr, _scale_below, _offset_below,
+                        &points);
     }
+    timerNonMaxSuppression3d.Stop();
   }
 
   // Use uniformity enforcement or bucketing to achieve more uniform
@@ -376,13 +320,18 @@ void ScaleSpaceLayer<SCORE_CALCULATOR_T>::DetectScaleSpaceMaxima(
     KeyPointBucketing(_img.rows, _img.cols, _maxNumKpt,
                       _numBucketsU, _numBucketsV, &points);
   }
+}
 
+template<class SCORE_CALCULATOR_T>
+void ScaleSpaceLayer<SCORE_CALCULATOR_T>::RefineScaleSpaceMaxima(
+    const std::vector<typename ScoreCalculator_t::PointWithScore>& points,
+    bool doRefinement, std::vector<agast::KeyPoint>* keypoints_ptr) {
+  CHECK_NOTNULL(keypoints_ptr);
+  std::vector<agast::KeyPoint>& keypoints = *keypoints_ptr;
   // 3d(/2d) subpixel refinement.
   brisk::timing::DebugTimer timer_subpixel_refinement(
       "0.4 BRISK Detection: "
       "subpixel(&scale) refinement (per layer)");
-  if (usePassedKeypoints)
-    keypoints.clear();
   if (doRefinement) {
     for (typename std::vector<
         typename ScoreCalculator_t::PointWithScore>::const_iterator it =
@@ -429,16 +378,38 @@ void ScaleSpaceLayer<SCORE_CALCULATOR_T>::DetectScaleSpaceMaxima(
 
 // Utilities.
 template<class SCORE_CALCULATOR_T>
-inline double ScaleSpaceLayer<SCORE_CALCULATOR_T>::ScoreAbove(double u,
-                                                              double v) {
-  return _aboveLayer_ptr->_scoreCalculator.Score(
-      _scale_above * (u + _offset_above), _scale_above * (v + _offset_above));
-}
-template<class SCORE_CALCULATOR_T>
-inline double ScaleSpaceLayer<SCORE_CALCULATOR_T>::ScoreBelow(double u,
-                                                              double v) {
-  return _belowLayer_ptr->_scoreCalculator.Score(
-      _scale_below * (u + _offset_below), _scale_below * (v + _offset_below));
+void ScaleSpaceLayer<SCORE_CALCULATOR_T>::SuppressNonMaxima(
+    ScaleSpaceLayer& layer, double scale, double offset,
+    std::vector<typename ScoreCalculator_t::PointWithScore>* points_ptr) {
+  CHECK_NOTNULL(points_ptr);
+  std::vector<typename ScoreCalculator_t::PointWithScore>& points =
+      *points_ptr;
+  // The center first, as most points fail there. Below, the spacing rounds
+  // to zero and all nine are the center.
+  static const int kNeighbors[9][2] = {{0, 0}, {1, 0}, {-1, 0}, {0, 1},
+                                       {0, -1}, {1, 1}, {1, -1}, {-1, 1},
+                                       {-1, -1}};
+  const int spacing = 1.0 / scale;
+  const int numNeighbors = spacing == 0 ? 1 : 9;
+  std::vector<double> u(points.size());
+  std::vector<double> v(points.size());
+  std::vector<double> scores(points.size());
+  for (int k = 0; k < numNeighbors && !points.empty(); ++k) {
+    const int dx = spacing * kNeighbors[k][0];
+    const int dy = spacing * kNeighbors[k][1];
+    const size_t n = points.size();
+    for (size_t i = 0; i < n; ++i) {
+      u[i] = scale * (static_cast<double>(points[i].x + dx) + offset);
+      v[i] = scale * (static_cast<double>(points[i].y + dy) + offset);
+    }
+    layer._scoreCalculator.Scores(&u[0], &v[0], n, &scores[0]);
+    size_t numKept = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (!(points[i].score < scores[i]))
+        points[numKept++] = points[i];
+    }
+    points.resize(numKept);
+  }
 }
 
 template<class SCORE_CALCULATOR_T>
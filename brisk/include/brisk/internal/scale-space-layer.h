@@ -45,6 +45,7 @@
 
 #include <agast/wrap-opencv.h>
 #include <brisk/internal/macros.h>
+#include <brisk/internal/parallel-for.h>
 
 namespace brisk {
 
@@ -71,7 +72,8 @@ class ScaleSpaceLayer {
     _absoluteThreshold(0.0),
     _LUT(),
     _numBucketsU(4u),
-    _numBucketsV(4u) { }
+    _numBucketsV(4u),
+    _masked(false) { }
   ScaleSpaceLayer(const agast::Mat& img, bool initScores = true);  // Octave 0.
   ScaleSpaceLayer(ScaleSpaceLayer<ScoreCalculator_t>* layerBelow,
                   bool initScores = true);  // For successive construction.
@@ -79,6 +81,10 @@ class ScaleSpaceLayer {
   void Create(const agast::Mat& img, bool initScores = true);  // Octave 0.
   void Create(ScaleSpaceLayer<ScoreCalculator_t>* layerBelow, bool initScores =
                   true);  // For successive construction.
+  // For successive construction from the already downsampled image of this
+  // layer, e.g. from a PreparedImage.
+  void Create(ScaleSpaceLayer<ScoreCalculator_t>* layerBelow,
+              const agast::Mat& img, bool initScores = true);
 
   void SetUniformityRadius(double radius);
   void SetNumBuckets(size_t numBucketsU, size_t numBucketsV) {
@@ -91,12 +97,35 @@ class ScaleSpaceLayer {
   void SetAbsoluteThreshold(double absoluteThreshold) {
     _absoluteThreshold = absoluteThreshold;
   }
+  // Used when the scores are computed, i.e. must be set before Create.
+  void SetNumThreads(size_t numThreads) {
+    _scoreCalculator.SetNumThreads(numThreads);
+  }
+  void SetTaskRunner(const TaskRunner& taskRunner) {
+    _scoreCalculator.SetTaskRunner(taskRunner);
+  }
+  // Only detect maxima where the mask, of the layer size, is nonzero. An
+  // empty mask detects everywhere. Layers created from this one downsample
+  // the mask, keeping the pixels that are sampled from any valid pixel.
+  // Creating octave 0 clears the mask.
+  void SetMask(const agast::Mat& mask);
 
   // Feature detection.
   void DetectScaleSpaceMaxima(std::vector<agast::KeyPoint>& keypoints,  // NOLINT
                               bool enforceUniformity = true, bool doRefinement =
                                   true,
                               bool usePassedKeypoints = false);
+  // The two steps of DetectScaleSpaceMaxima, for selecting among the maxima
+  // of all layers before refining them:
+  // The maxima of this layer after uniformity enforcement or bucketing.
+  void GetScaleSpaceMaxima(
+      const std::vector<agast::KeyPoint>& keypoints,
+      bool enforceUniformity, bool usePassedKeypoints,
+      std::vector<typename ScoreCalculator_t::PointWithScore>* points);
+  // Appends the keypoints of the maxima.
+  void RefineScaleSpaceMaxima(
+      const std::vector<typename ScoreCalculator_t::PointWithScore>& points,
+      bool doRefinement, std::vector<agast::KeyPoint>* keypoints);
 
   // Subsampling.
   // Half sampling.
@@ -106,8 +135,14 @@ class ScaleSpaceLayer {
 
  protected:
   // Utilities.
-  inline double ScoreAbove(double u, double v);
-  inline double ScoreBelow(double u, double v);
+  // 3d nonmax suppression against the layer above or below, whose
+  // coordinates are scale * (x + offset): removes the points that score less
+  // than any of the nine points around them, int(1 / scale) pixels of this
+  // layer apart, in that layer. All points are interpolated in one batch per
+  // neighbor.
+  void SuppressNonMaxima(
+      ScaleSpaceLayer& layer, double scale, double offset,
+      std::vector<typename ScoreCalculator_t::PointWithScore>* points);
 
   // 1d (scale) refinement.
   __inline__ float Refine1D(const float s_05, const float s0, const float s05,
@@ -152,6 +187,16 @@ class ScaleSpaceLayer {
   // Key point bucketing related.
   size_t _numBucketsU;
   size_t _numBucketsV;
+
+  // Masking: the mask as set or downsampled, and the one grown by a pixel
+  // that the maxima are searched in, since the refinement can move them by
+  // up to a pixel.
+  void DeriveMask(const ScaleSpaceLayer<ScoreCalculator_t>& layerBelow,
+                  bool twothirdsample);
+  void GrowDetectionMask();
+  bool _masked;
+  agast::Mat _mask;
+  agast::Mat _detectionMask;
 };
 }  // namespace brisk
 
@@ -47,10 +47,12 @@
 #include <emmintrin.h>
 #include <tmmintrin.h>
 #endif  // __ARM_NEON
+#include <cstddef>
 #include <vector>
 
 #include <agast/wrap-opencv.h>
 #include <brisk/internal/macros.h>
+#include <brisk/internal/parallel-for.h>
 
 namespace brisk {
 
@@ -99,7 +101,8 @@ class ScoreCalculator {
 #endif
 
   // Constructor.
-  ScoreCalculator() {
+  ScoreCalculator()
+      : _numThreads(1) {
   }
   // Destructor.
   virtual ~ScoreCalculator() {
@@ -110,11 +113,34 @@ class ScoreCalculator {
     _img = img;
     if (initScores)
       InitializeScores();
+    else
+      DeferScores();
+  }
+
+  // Get2dMaxima skips the pixels where the mask, of the image size, is
+  // zero. An empty mask searches everywhere.
+  void SetMask(const agast::Mat& mask) {
+    _mask = mask;
+  }
+
+  // Threads that InitializeScores may split the image across, if the
+  // calculator supports it. The task runner executes them if set.
+  void SetNumThreads(size_t numThreads) {
+    _numThreads = numThreads > 0 ? numThreads : 1;
+  }
+  void SetTaskRunner(const TaskRunner& taskRunner) {
+    _taskRunner = taskRunner;
   }
 
   // Calculate/get score - implement floating point and integer access.
   virtual inline double Score(double u, double v)=0;
   virtual inline Score_t Score(int u, int v)=0;
+  // Score(u[i], v[i]) of n points at once, which calculators may vectorize.
+  virtual void Scores(const double* u, const double* v, size_t n,
+                      double* scores) {
+    for (size_t i = 0; i < n; ++i)
+      scores[i] = Score(u[i], v[i]);
+  }
 
   // 2d maximum query.
   virtual void Get2dMaxima(std::vector<PointWithScore>& points,  // NOLINT
@@ -123,7 +149,14 @@ class ScoreCalculator {
  protected:
   agast::Mat _img;  // The image we operate on.
   agast::Mat _scores;  // Store calculated scores.
+  agast::Mat _mask;  // Where to look for maxima.
+  size_t _numThreads;
+  TaskRunner _taskRunner;
   virtual void InitializeScores() = 0;
+  // Called instead of InitializeScores if the scores of the whole image are
+  // not needed up front. Calculators may compute them on demand.
+  virtual void DeferScores() {
+  }
 };
 }  // namespace brisk
 #endif  // INTERNAL_SCORE_CALCULATOR_H_
@@ -0,0 +1,59 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INTERNAL_SMOOTHED_INTENSITY_AVX2_H_
+#define INTERNAL_SMOOTHED_INTENSITY_AVX2_H_
+
+#include <agast/wrap-opencv.h>
+#include <brisk/internal/helper-structures.h>
+#include <brisk/internal/rotated-pattern-table.h>
+
+namespace brisk {
+// Samples the smoothed intensities of num_points pattern points around a
+// keypoint in an 8 bit image, eight points per iteration with gathers on the
+// image and its integral image. The values are identical to the ones of
+// BriskDescriptorExtractor::SmoothedIntensity<unsigned char, int>. Points
+// that need the interpolation or small box path are not handled and set to
+// -1 instead. Must only be called if CpuSupportsAvx2().
+void SmoothedIntensitiesAvx2(const agast::Mat& image,
+                             const agast::Mat& integral, float key_x,
+                             float key_y, const BriskPatternPoint* points,
+                             const BoxFilterScaling* scalings,
+                             unsigned int num_points, int* values);
+}  // namespace brisk
+
+#endif  // INTERNAL_SMOOTHED_INTENSITY_AVX2_H_
@@ -50,6 +50,7 @@
 #include <stdint.h>
 
 #include <agast/wrap-opencv.h>
+#include <brisk/internal/cpu-features.h>
 
 template<int X, int Y>
 __inline__ void Filter2D16S(agast::Mat& src, agast::Mat& dst, agast::Mat& kernel) {  // NOLINT
@@ -59,6 +60,10 @@ __inline__ void Filter2D16S(agast::Mat& src, agast::Mat& dst, agast::Mat& kernel
   assert(X == kernel.cols);
   assert(X % 2 != 0);
   assert(Y % 2 != 0);
+  if (brisk::CpuSupportsAvx2() && src.cols >= 18) {
+    brisk::Filter2D16SAvx2(src, dst, kernel, X, Y);
+    return;
+  }
   int cx = X / 2;
   int cy = Y / 2;
 
@@ -107,6 +112,10 @@ __inline__ void Filter2D8U(agast::Mat& src, agast::Mat& dst, agast::Mat& kernel)
   assert(X == kernel.cols);
   assert(X % 2 != 0);
   assert(Y % 2 != 0);
+  if (brisk::CpuSupportsAvx2()) {
+    brisk::Filter2D8UAvx2(src, dst, kernel, X, Y);
+    return;
+  }
   int cx = X / 2;
   int cy = Y / 2;
 
@@ -116,12 +125,10 @@ __inline__ void Filter2D8U(agast::Mat& src, agast::Mat& dst, agast::Mat& kernel)
   const unsigned int maxI = src.rows - 2;
   const unsigned int stride = src.cols;
 
-  __m128i mask_hi = _mm_set_epi8(0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF,
-                                 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00,
-                                 0xFF);
-  __m128i mask_lo = _mm_set_epi8(0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00,
-                                 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF,
-                                 0x00);
+  __m128i mask_hi = _mm_set_epi8(0, -1, 0, -1, 0, -1, 0, -1,
+                                 0, -1, 0, -1, 0, -1, 0, -1);
+  __m128i mask_lo = _mm_set_epi8(-1, 0, -1, 0, -1, 0, -1, 0,
+                                 -1, 0, -1, 0, -1, 0, -1, 0);
 
   for (unsigned int i = 0; i < maxI; ++i) {
     bool end = false;
@@ -70,6 +70,16 @@ void FilterGauss3by316S(agast::Mat& src, agast::Mat& dst);  // NOLINT
 // 3-by-3 Gaussian filter CV_32F to CV_32F.
 void FilterGauss3by332F(agast::Mat& src, agast::Mat& dst);  // NOLINT
 
+// AVX2 versions of the filters above, used by them if CpuSupportsAvx2(). They
+// write the same pixels with the same values, for the X by Y kernel of the
+// filter. The 16 bit ones need at least 18 columns.
+void Filter2D8UAvx2(const agast::Mat& src, agast::Mat& dst,  // NOLINT
+                    const agast::Mat& kernel, int X, int Y);
+void Filter2D16SAvx2(const agast::Mat& src, agast::Mat& dst,  // NOLINT
+                     const agast::Mat& kernel, int X, int Y);
+void FilterGauss3by316SAvx2(const agast::Mat& src, agast::Mat& dst);  // NOLINT
+void FilterGauss3by332FAvx2(const agast::Mat& src, agast::Mat& dst);  // NOLINT
+
 }  // namespace brisk
 #include "./vectorized-filters-inl.h"
 #endif  // __ARM_NEON
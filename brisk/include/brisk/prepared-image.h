@@ -0,0 +1,78 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BRISK_PREPARED_IMAGE_H_
+#define BRISK_PREPARED_IMAGE_H_
+
+#include <memory>
+
+#include <agast/wrap-opencv.h>
+
+namespace brisk {
+// A handle to an image together with the data derived from it during
+// detection and extraction: the integral image used for sampling the
+// descriptor pattern and the images of the scale space pyramid. These are
+// computed on first use and cached, so detector and extractor, or several
+// compute calls on keypoint subsets, only pay for them once per frame.
+// Copies of the handle share the cache. The image data is not copied unless
+// the image is not continuous, e.g. a region of interest, since the pyramid
+// and the integral image need continuous rows. Otherwise it must not be
+// modified while the handle is in use. Thread-safe.
+class PreparedImage {
+ public:
+  PreparedImage();
+  explicit PreparedImage(const agast::Mat& image);
+
+  bool empty() const;
+  const agast::Mat& GetImage() const;
+
+  // The integral image, see IntegralImage8 and IntegralImage16. Throws
+  // std::runtime_error for other image types.
+  const agast::Mat& GetIntegral() const;
+
+  // The image of pyramid layer layer: Layer 0 is the image itself, layer 1
+  // its two-third sampling and every further layer the half sampling of the
+  // layer two below. The layers up to layer are built if necessary.
+  agast::Mat GetLayer(size_t layer) const;
+
+ private:
+  struct Data;
+  std::shared_ptr<Data> data_;
+};
+}  // namespace brisk
+
+#endif  // BRISK_PREPARED_IMAGE_H_
@@ -43,11 +43,14 @@
 
 #include <algorithm>
 #include <limits>
+#include <utility>
 #include <vector>
 
 #include <agast/wrap-opencv.h>
 #include <brisk/internal/macros.h>
+#include <brisk/internal/parallel-for.h>
 #include <brisk/internal/scale-space-layer.h>
+#include <brisk/prepared-image.h>
 
 #if HAVE_OPENCV
 #include <agast/glog.h>
@@ -72,11 +75,32 @@ class ScaleSpaceFeatureDetector {
       : _octaves(octaves),
         _uniformityRadius(uniformityRadius),
         _absoluteThreshold(absoluteThreshold),
-        _maxNumKpt(maxNumKpt) {
+        _maxNumKpt(maxNumKpt),
+        _maxNumKptTotal(std::numeric_limits<size_t>::max()),
+        _numThreads(1) {
     scaleSpaceLayers.resize(std::max(_octaves * 2, size_t(1)));
   }
 
   typedef SCORE_CALCULATOR_T ScoreCalculator_t;
+  typedef typename ScoreCalculator_t::PointWithScore PointWithScore_t;
+
+  // Budget for the keypoints of all layers together, on top of the per layer
+  // maxNumKpt. The maxima with the highest scores are kept before they are
+  // refined. The scores of the layers are compared as they are, like in the
+  // non-maximum suppression across scales.
+  void SetMaxNumKptTotal(size_t maxNumKptTotal) {
+    _maxNumKptTotal = maxNumKptTotal;
+  }
+
+  // Threads for computing the scores of each layer, if the score calculator
+  // supports it. Runs them on the task runner if one is set.
+  void SetNumThreads(size_t numThreads) {
+    _numThreads = numThreads;
+  }
+  void SetTaskRunner(const TaskRunner& taskRunner) {
+    _taskRunner = taskRunner;
+  }
+
   void detect(const agast::Mat& image, std::vector<agast::KeyPoint>& keypoints,
               const agast::Mat& mask = agast::Mat()) const {
     if (image.empty()) {
@@ -89,6 +113,20 @@ class ScaleSpaceFeatureDetector {
     detectImpl(image, keypoints, mask);
   }
 
+  // Detects on a prepared image and reuses its pyramid images.
+  void detect(const PreparedImage& image,
+              std::vector<agast::KeyPoint>& keypoints,
+              const agast::Mat& mask = agast::Mat()) const {
+    if (image.empty()) {
+      return;
+    }
+    CHECK(
+        mask.empty()
+            || (mask.type() == CV_8UC1 && mask.rows == image.GetImage().rows
+                && mask.cols == image.GetImage().cols));
+    DetectOnLayers(image.GetImage(), &image, mask, keypoints);
+  }
+
   virtual void detectAndCompute(cv::InputArray image, cv::InputArray mask,
                                 std::vector<cv::KeyPoint>& keypoints,
                                 cv::OutputArray /*descriptors*/,
@@ -99,7 +137,17 @@ class ScaleSpaceFeatureDetector {
  protected:
   virtual void detectImpl(const agast::Mat& image,
                           std::vector<agast::KeyPoint>& keypoints,
-                          const agast::Mat& /*mask*/ = agast::Mat()) const {
+                          const agast::Mat& mask = agast::Mat()) const {
+    DetectOnLayers(image, nullptr, mask, keypoints);
+  }
+
+  // Takes the layer images from preparedImage if given, else downsamples
+  // them from image. The mask is downsampled into the layers, whose maxima
+  // are only searched where it is valid.
+  void DetectOnLayers(const agast::Mat& image,
+                      const PreparedImage* preparedImage,
+                      const agast::Mat& mask,
+                      std::vector<agast::KeyPoint>& keypoints) const {
     // Find out, if we should use the provided keypoints.
     bool usePassedKeypoints = false;
     if (keypoints.size() > 0)
@@ -108,22 +156,95 @@ class ScaleSpaceFeatureDetector {
       keypoints.reserve(4000);  // Possibly speeds up things.
 
     // Construct scale space layers.
+    for (size_t i = 0; i < scaleSpaceLayers.size(); ++i) {
+      scaleSpaceLayers[i].SetNumThreads(_numThreads);
+      scaleSpaceLayers[i].SetTaskRunner(_taskRunner);
+    }
     scaleSpaceLayers[0].Create(image, !usePassedKeypoints);
+    scaleSpaceLayers[0].SetMask(mask);
     scaleSpaceLayers[0].SetUniformityRadius(_uniformityRadius);
     scaleSpaceLayers[0].SetMaxNumKpt(_maxNumKpt);
     scaleSpaceLayers[0].SetAbsoluteThreshold(_absoluteThreshold);
     for (size_t i = 1; i < _octaves * 2; ++i) {
-      scaleSpaceLayers[i].Create(&scaleSpaceLayers[i - 1], !usePassedKeypoints);
+      if (preparedImage != nullptr) {
+        scaleSpaceLayers[i].Create(&scaleSpaceLayers[i - 1],
+                                   preparedImage->GetLayer(i),
+                                   !usePassedKeypoints);
+      } else {
+        scaleSpaceLayers[i].Create(&scaleSpaceLayers[i - 1],
+                                   !usePassedKeypoints);
+      }
       scaleSpaceLayers[i].SetUniformityRadius(_uniformityRadius);
       scaleSpaceLayers[i].SetMaxNumKpt(_maxNumKpt);
       scaleSpaceLayers[i].SetAbsoluteThreshold(_absoluteThreshold);
     }
     bool enforceUniformity = _uniformityRadius > 0.0;
+    if (!usePassedKeypoints &&
+        _maxNumKptTotal != std::numeric_limits<size_t>::max()) {
+      DetectWithTotalBudget(enforceUniformity, keypoints);
+    } else {
+      for (size_t i = 0; i < scaleSpaceLayers.size(); ++i) {
+        // Only do refinement, if no keypoints are passed.
+        scaleSpaceLayers[i].DetectScaleSpaceMaxima(keypoints,
+                                                   enforceUniformity,
+                                                   !usePassedKeypoints,
+                                                   usePassedKeypoints);
+      }
+    }
+    // Maxima next to the border of the mask may have been refined into it.
+    RemoveMaskedKeypoints(mask, keypoints);
+  }
+
+  static void RemoveMaskedKeypoints(const agast::Mat& mask,
+                                    std::vector<agast::KeyPoint>& keypoints) {
+    if (mask.empty())
+      return;
+    keypoints.erase(
+        std::remove_if(keypoints.begin(), keypoints.end(),
+                       [&mask](const agast::KeyPoint& keypoint) {
+          return mask.at<unsigned char>(
+              static_cast<int>(agast::KeyPointY(keypoint) + 0.5f),
+              static_cast<int>(agast::KeyPointX(keypoint) + 0.5f)) == 0;
+        }), keypoints.end());
+  }
+
+  // Collects the maxima of all layers, keeps the _maxNumKptTotal ones with the
+  // highest scores and refines only those. The keypoints are in the same
+  // order as without the budget.
+  void DetectWithTotalBudget(bool enforceUniformity,
+                             std::vector<agast::KeyPoint>& keypoints) const {
+    std::vector<std::vector<PointWithScore_t> > points(
+        scaleSpaceLayers.size());
+    std::vector<std::pair<size_t, size_t> > ranking;
+    for (size_t i = 0; i < scaleSpaceLayers.size(); ++i) {
+      scaleSpaceLayers[i].GetScaleSpaceMaxima(keypoints, enforceUniformity,
+                                              false, &points[i]);
+      for (size_t k = 0; k < points[i].size(); ++k) {
+        ranking.push_back(std::make_pair(i, k));
+      }
+    }
+    if (ranking.size() > _maxNumKptTotal) {
+      // Ties go to lower layers and earlier points.
+      auto stronger = [&points](const std::pair<size_t, size_t>& lhs,
+                                const std::pair<size_t, size_t>& rhs) {
+        const double lhs_score = points[lhs.first][lhs.second].score;
+        const double rhs_score = points[rhs.first][rhs.second].score;
+        if (lhs_score != rhs_score)
+          return lhs_score > rhs_score;
+        return lhs < rhs;
+      };
+      std::nth_element(ranking.begin(), ranking.begin() + _maxNumKptTotal,
+                       ranking.end(), stronger);
+      ranking.resize(_maxNumKptTotal);
+      std::sort(ranking.begin(), ranking.end());
+      std::vector<std::vector<PointWithScore_t> > kept(points.size());
+      for (const std::pair<size_t, size_t>& rank : ranking) {
+        kept[rank.first].push_back(points[rank.first][rank.second]);
+      }
+      points.swap(kept);
+    }
     for (size_t i = 0; i < scaleSpaceLayers.size(); ++i) {
-      // Only do refinement, if no keypoints are passed.
-      scaleSpaceLayers[i].DetectScaleSpaceMaxima(keypoints, enforceUniformity,
-                                                 !usePassedKeypoints,
-                                                 usePassedKeypoints);
+      scaleSpaceLayers[i].RefineScaleSpaceMaxima(points[i], true, &keypoints);
     }
   }
 
@@ -131,6 +252,9 @@ class ScaleSpaceFeatureDetector {
   double _uniformityRadius;
   double _absoluteThreshold;
   size_t _maxNumKpt;
+  size_t _maxNumKptTotal;
+  size_t _numThreads;
+  TaskRunner _taskRunner;
   mutable std::vector<brisk::ScaleSpaceLayer<ScoreCalculator_t> >
     scaleSpaceLayers;
 };
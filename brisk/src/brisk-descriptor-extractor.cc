@@ -38,22 +38,38 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <bitset>
+#include <cstring>
 #include <istream>  // NOLINT
 #include <fstream>  // NOLINT
 #include <iostream>  // NOLINT
 
 #include <stdexcept>
+#include <string>
 
 #include <brisk/brisk-descriptor-extractor.h>
 #include <agast/wrap-opencv.h>
+#include <brisk/internal/cpu-features.h>
 #include <brisk/internal/helper-structures.h>
 #include <brisk/internal/integral-image.h>
 #include <brisk/internal/macros.h>
+#include <brisk/internal/parallel-for.h>
+#include <brisk/internal/pair-comparison.h>
 #include <brisk/internal/pattern-provider.h>
+#include <brisk/internal/quantized-sampling.h>
+#include <brisk/internal/rotated-pattern-table.h>
+#include <brisk/internal/smoothed-intensity-16.h>
+#include <brisk/internal/smoothed-intensity-avx2.h>
 #include <brisk/internal/timer.h>
 
 namespace brisk {
+namespace {
+// Do not hand out fewer keypoints to a thread, the spawn overhead would
+// dominate.
+const size_t kMinKeypointsPerThread = 32;
+}  // namespace
+
 const float BriskDescriptorExtractor::basicSize_ = 12.0;
 const unsigned int BriskDescriptorExtractor::scales_ = 64;
 // 40->4 Octaves - else, this needs to be adjusted...
@@ -78,56 +94,13 @@ void BriskDescriptorExtractor::generateKernel(std::vector<float> &radiusList,
     points_ += numberList[ring];
   }
   // set up the patterns
-  patternPoints_ = new BriskPatternPoint[points_ * scales_ * n_rot_];
-  BriskPatternPoint* patternIterator = patternPoints_;
-
-  // define the scale discretization:
-  static const float lb_scale = log(scalerange_) / log(2.0);
-  static const float lb_scale_step = lb_scale / (scales_);
-
-  scaleList_ = new float[scales_];
-  sizeList_ = new unsigned int[scales_];
-
-  const float sigma_scale = 1.3;
-
-  for (unsigned int scale = 0; scale < scales_; ++scale) {
-    scaleList_[scale] = pow((double) 2.0, (double) (scale * lb_scale_step));
-    sizeList_[scale] = 0;
-
-    // generate the pattern points look-up
-    double alpha, theta;
-    for (size_t rot = 0; rot < n_rot_; ++rot) {
-      theta = double(rot) * 2 * M_PI / double(n_rot_);  // this is the rotation of the feature
-      for (int ring = 0; ring < rings; ++ring) {
-        for (int num = 0; num < numberList[ring]; ++num) {
-          // the actual coordinates on the circle
-          alpha = (double(num)) * 2 * M_PI / double(numberList[ring]);
-          patternIterator->x = scaleList_[scale] * radiusList[ring]
-              * cos(alpha + theta);  // feature rotation plus angle of the point
-          patternIterator->y = scaleList_[scale] * radiusList[ring]
-              * sin(alpha + theta);
-          // and the gaussian kernel sigma
-          if (ring == 0) {
-            patternIterator->sigma = sigma_scale * scaleList_[scale] * 0.5;
-          } else {
-            patternIterator->sigma = sigma_scale * scaleList_[scale]
-                * (double(radiusList[ring])) * sin(M_PI / numberList[ring]);
-          }
-
-          // adapt the sizeList if necessary
-          const unsigned int size = ceil(
-              ((scaleList_[scale] * radiusList[ring]) + patternIterator->sigma))
-              + 1;
-          if (sizeList_[scale] < size) {
-            sizeList_[scale] = size;
-          }
-
-          // increment the iterator
-          ++patternIterator;
-        }
-      }
-    }
-  }
+  PatternDefinition pattern;
+  pattern.type = PatternDefinition::kRings;
+  pattern.ringRadii = radiusList;
+  pattern.ringNumPoints = numberList;
+  patternTable_ = RotatedPatternTable::Get(pattern, 1.0, scales_, n_rot_,
+                                           scalerange_);
+  const BriskPatternPoint* patternPoints = patternTable_->GetScale(0);
 
   // now also generate pairings
   shortPairs_ = new BriskShortPair[points_ * (points_ - 1) / 2];
@@ -149,8 +122,8 @@ void BriskDescriptorExtractor::generateKernel(std::vector<float> &radiusList,
   for (unsigned int i = 1; i < points_; i++) {
     for (unsigned int j = 0; j < i; j++) {  //(find all the pairs)
       // point pair distance:
-      const float dx = patternPoints_[j].x - patternPoints_[i].x;
-      const float dy = patternPoints_[j].y - patternPoints_[i].y;
+      const float dx = patternPoints[j].x - patternPoints[i].x;
+      const float dy = patternPoints[j].y - patternPoints[i].y;
       const float norm_sq = (dx * dx + dy * dy);
       if (norm_sq > dMin_sq) {
         // save to long pairs
@@ -181,102 +154,55 @@ void BriskDescriptorExtractor::InitFromStream(bool rotationInvariant,
                                               bool scaleInvariant,
                                               std::istream& pattern_stream,
                                               float patternScale) {
+  assert(pattern_stream.good());
+  BriskPattern pattern;
+  CHECK(ReadPatternText(pattern_stream, &pattern))
+      << "Failed to parse the pattern stream.";
+  InitFromPattern(rotationInvariant, scaleInvariant, pattern, patternScale);
+}
+
+void BriskDescriptorExtractor::InitFromPattern(bool rotationInvariant,
+                                               bool scaleInvariant,
+                                               const BriskPattern& pattern,
+                                               float patternScale) {
   // Not in use.
   dMax_ = 0;
   dMin_ = 0;
   rotationInvariance = rotationInvariant;
   scaleInvariance = scaleInvariant;
 
-  assert(pattern_stream.good());
-
-  // Read number of points.
-  pattern_stream >> points_;
-
-  // Set up the patterns.
-  patternPoints_ = new brisk::BriskPatternPoint[points_ * scales_ * n_rot_];
-  brisk::BriskPatternPoint* patternIterator = patternPoints_;
-
-  // Define the scale discretization:
-  static const float lb_scale = log(scalerange_) / log(2.0);
-  static const float lb_scale_step = lb_scale / (scales_);
-
-  scaleList_ = new float[scales_];
-  sizeList_ = new unsigned int[scales_];
-
-  const float sigma_scale = 1.3;
+  points_ = pattern.points.size();
 
   // First fill the unscaled and unrotated pattern:
-  float* u_x = new float[points_];
-  float* u_y = new float[points_];
-  float* sigma = new float[points_];
-  for (unsigned int i = 0; i < points_; i++) {
-    pattern_stream >> u_x[i]; u_x[i]*=patternScale;
-    pattern_stream >> u_y[i]; u_y[i]*=patternScale;
-    pattern_stream >> sigma[i]; sigma[i]*=patternScale;
-  }
-
-  // Now fill all the scaled and rotated versions.
-  for (unsigned int scale = 0; scale < scales_; ++scale) {
-    scaleList_[scale] = pow(2.0, static_cast<double>(scale * lb_scale_step));
-    sizeList_[scale] = 0;
-
-    // Generate the pattern points look-up.
-    double theta;
-    for (size_t rot = 0; rot < n_rot_; ++rot) {
-      for (unsigned int i = 0; i < points_; i++) {
-        // This is the rotation of the feature.
-        theta = static_cast<double>(rot) * 2 * M_PI
-            / static_cast<double>(n_rot_);
-        // Feature rotation plus angle of the point.
-        patternIterator->x = scaleList_[scale]
-            * (u_x[i] * cos(theta) - u_y[i] * sin(theta));
-        patternIterator->y = scaleList_[scale]
-            * (u_x[i] * sin(theta) + u_y[i] * cos(theta));
-        // And the Gaussian kernel sigma.
-        patternIterator->sigma = sigma_scale * scaleList_[scale] * sigma[i];
-
-        // Adapt the sizeList if necessary.
-        const unsigned int size = ceil(
-            ((sqrt(
-                patternIterator->x * patternIterator->x
-                    + patternIterator->y * patternIterator->y))
-                + patternIterator->sigma)) + 1;
-        if (sizeList_[scale] < size) {
-          sizeList_[scale] = size;
-        }
+  PatternDefinition definition;
+  definition.type = PatternDefinition::kPoints;
+  definition.points = pattern.points;
 
-        // Increment the iterator.
-        ++patternIterator;
-      }
-    }
-  }
+  // The scaled and rotated versions are shared and built on demand.
+  patternTable_ = RotatedPatternTable::Get(definition, patternScale, scales_,
+                                           n_rot_, scalerange_);
 
   // Now also generate pairings.
-  pattern_stream >> noShortPairs_;
+  noShortPairs_ = pattern.shortPairs.size();
   shortPairs_ = new brisk::BriskShortPair[noShortPairs_];
-  for (unsigned int p = 0; p < noShortPairs_; p++) {
-    unsigned int i, j;
-    pattern_stream >> i;
-    shortPairs_[p].i = i;
-    pattern_stream >> j;
-    shortPairs_[p].j = j;
-  }
+  std::copy(pattern.shortPairs.begin(), pattern.shortPairs.end(), shortPairs_);
 
-  pattern_stream >> noLongPairs_;
+  noLongPairs_ = pattern.longPairs.size();
   longPairs_ = new brisk::BriskLongPair[noLongPairs_];
-  for (unsigned int p = 0; p < noLongPairs_; p++) {
-    unsigned int i, j;
-    pattern_stream >> i;
-    longPairs_[p].i = i;
-    pattern_stream >> j;
-    longPairs_[p].j = j;
-    float dx = (u_x[j] - u_x[i]);
-    float dy = (u_y[j] - u_y[i]);
-    float norm_sq = dx * dx + dy * dy;
-    longPairs_[p].weighted_dx =
-        static_cast<int>((dx / (norm_sq)) * 2048.0 + 0.5);
-    longPairs_[p].weighted_dy =
-        static_cast<int>((dy / (norm_sq)) * 2048.0 + 0.5);
+  brisk::BriskLongPair* longPair = longPairs_;
+  for (const BriskShortPair& pair : pattern.longPairs) {
+    const float dx = pattern.points[pair.j].x * patternScale
+        - pattern.points[pair.i].x * patternScale;
+    const float dy = pattern.points[pair.j].y * patternScale
+        - pattern.points[pair.i].y * patternScale;
+    const float norm_sq = dx * dx + dy * dy;
+    CHECK_GT(norm_sq, 0.0f) << "Long pair (" << pair.i << ", " << pair.j
+        << ") connects two identical points.";
+    longPair->i = pair.i;
+    longPair->j = pair.j;
+    longPair->weighted_dx = static_cast<int>((dx / (norm_sq)) * 2048.0 + 0.5);
+    longPair->weighted_dy = static_cast<int>((dy / (norm_sq)) * 2048.0 + 0.5);
+    ++longPair;
   }
 
   // Number of descriptor bits:
@@ -284,10 +210,6 @@ void BriskDescriptorExtractor::InitFromStream(bool rotationInvariant,
       * 4 * 4;
 
   CHECK_EQ(noShortPairs_, kDescriptorLength);
-
-  delete[] u_x;
-  delete[] u_y;
-  delete[] sigma;
 }
 
 BriskDescriptorExtractor::BriskDescriptorExtractor() :
@@ -307,12 +229,13 @@ BriskDescriptorExtractor::BriskDescriptorExtractor(bool rotationInvariant,
 BriskDescriptorExtractor::BriskDescriptorExtractor(bool rotationInvariant,
                                                    bool scaleInvariant,
                                                    int version,
-                                                   float patternScale) {
+                                                   float patternScale) :
+  numThreads_(1), quantizedSampling_(false) {
   CHECK(version == Version::briskV1 || version == Version::briskV2);
   if(version == Version::briskV2){
-    std::stringstream ss;
-    brisk::GetDefaultPatternAsStream(&ss);
-    InitFromStream(rotationInvariant, scaleInvariant, ss, patternScale);
+    BriskPattern pattern;
+    brisk::GetDefaultPattern(&pattern);
+    InitFromPattern(rotationInvariant, scaleInvariant, pattern, patternScale);
   } else if(version == Version::briskV1){
     std::vector<float> rList;
     std::vector<int> nList;
@@ -357,25 +280,21 @@ BriskDescriptorExtractor::BriskDescriptorExtractor(const std::string& fname,
 BriskDescriptorExtractor::BriskDescriptorExtractor(const std::string& fname,
                                                    bool rotationInvariant,
                                                    bool scaleInvariant,
-                                                   float patternScale) {
-  std::ifstream myfile(fname.c_str());
-  assert(myfile.is_open());
-
-  InitFromStream(rotationInvariant, scaleInvariant, myfile, patternScale);
-
-  myfile.close();
+                                                   float patternScale) :
+  numThreads_(1), quantizedSampling_(false) {
+  // Text (brisk.ptn) and binary pattern files are both accepted.
+  BriskPattern pattern;
+  CHECK(ReadPatternFile(fname, &pattern))
+      << "Failed to read the pattern file " << fname;
+  InitFromPattern(rotationInvariant, scaleInvariant, pattern, patternScale);
 }
 
 // Simple alternative:
 template<typename ImgPixel_T, typename IntegralPixel_T>
 __inline__ IntegralPixel_T BriskDescriptorExtractor::SmoothedIntensity(
     const agast::Mat& image, const agast::Mat& integral, const float key_x,
-    const float key_y, const unsigned int scale, const unsigned int rot,
-    const unsigned int point) const {
+    const float key_y, const brisk::BriskPatternPoint& briskPoint) const {
   // Get the float position.
-  const brisk::BriskPatternPoint& briskPoint = patternPoints_[scale * n_rot_
-      * points_ + rot * points_ + point];
-
   const float xf = briskPoint.x + key_x;
   const float yf = briskPoint.y + key_y;
   const int x = static_cast<int>(xf);
@@ -529,6 +448,56 @@ __inline__ IntegralPixel_T BriskDescriptorExtractor::SmoothedIntensity(
   return IntegralPixel_T((ret_val) / scaling2);
 }
 
+void BriskDescriptorExtractor::SmoothedIntensities8(
+    const agast::Mat& image, const agast::Mat& integral, const float key_x,
+    const float key_y, const unsigned int scale, const unsigned int rot,
+    int* values) const {
+  const brisk::BriskPatternPoint* points =
+      patternTable_->GetScale(scale) + rot * points_;
+  if (CpuSupportsAvx2()) {
+    SmoothedIntensitiesAvx2(image, integral, key_x, key_y, points,
+                            patternTable_->GetBoxFilterScalings(scale),
+                            points_, values);
+    // Fill in the points the kernel left to us.
+    for (unsigned int i = 0; i < points_; ++i) {
+      if (values[i] < 0) {
+        values[i] = SmoothedIntensity<unsigned char, int>(image, integral,
+                                                          key_x, key_y,
+                                                          points[i]);
+      }
+    }
+    return;
+  }
+  // The exact AVX2 kernel is faster, so the boxes only replace the scalar
+  // sampling.
+  if (quantizedSampling_) {
+    QuantizedSmoothedIntensities(
+        image, integral, key_x, key_y,
+        patternTable_->GetSamplingBoxes(scale) + rot * points_, points_,
+        values);
+    return;
+  }
+  for (unsigned int i = 0; i < points_; ++i) {
+    values[i] = SmoothedIntensity<unsigned char, int>(image, integral, key_x,
+                                                      key_y, points[i]);
+  }
+}
+
+void BriskDescriptorExtractor::SmoothedIntensities(
+    const agast::Mat& image, const agast::Mat& integral, const float key_x,
+    const float key_y, const unsigned int scale, const unsigned int rot,
+    int* values) const {
+  if (image.type() == CV_8UC1) {
+    SmoothedIntensities8(image, integral, key_x, key_y, scale, rot, values);
+    return;
+  }
+  const brisk::BriskPatternPoint* points =
+      patternTable_->GetScale(scale) + rot * points_;
+  for (unsigned int i = 0; i < points_; ++i) {
+    values[i] = SmoothedIntensity16(image, integral, key_x, key_y, points[i]);
+  }
+}
+
 bool RoiPredicate(const float minX, const float minY, const float maxX,
                   const float maxY, const agast::KeyPoint& keyPt) {
   return (agast::KeyPointX(keyPt) < minX) || (agast::KeyPointX(keyPt) >= maxX)
@@ -541,152 +510,259 @@ void BriskDescriptorExtractor::setDescriptorBits(int keypoint_idx,
   CHECK_NOTNULL(descriptors);
   unsigned char* ptr = descriptors->data + strings_ * keypoint_idx;
 
-  // Now iterate through all the pairings.
+  // Now iterate through all the pairings, this fills the whole row.
   //brisk::timing::DebugTimer timer_assemble_bits(
       //"1.3 Brisk Extraction: assemble bits (per keypoint)");
-  brisk::UINT32_ALIAS* ptr2 = reinterpret_cast<brisk::UINT32_ALIAS*>(ptr);
-  const brisk::BriskShortPair* max = shortPairs_ + noShortPairs_;
-  int shifter = 0;
-  for (brisk::BriskShortPair* iter = shortPairs_; iter < max; ++iter) {
-    int t1 = *(values + iter->i);
-    int t2 = *(values + iter->j);
-    if (t1 > t2) {
-      *ptr2 |= ((1) << shifter);
-    }  // Else already initialized with zero.
-    // Take care of the iterators:
-    ++shifter;
-    if (shifter == 32) {
-      shifter = 0;
-      ++ptr2;
-    }
-  }
+  CompareShortPairs(values, shortPairs_, noShortPairs_, ptr);
   //timer_assemble_bits.Stop();
 }
 
+void BriskDescriptorExtractor::setDescriptorBits(
+    int keypoint_idx, const int* values, DescriptorRows* descriptors) const {
+  CHECK_NOTNULL(descriptors);
+  const size_t stride = descriptors->buffer->stride();
+  unsigned char* ptr = descriptors->first + stride * keypoint_idx;
+  CompareShortPairs(values, shortPairs_, noShortPairs_, ptr);
+  // Zero the padding, the buffer is not initialized.
+  const size_t num_bytes = (noShortPairs_ + 7) / 8;
+  memset(ptr + num_bytes, 0, stride - num_bytes);
+}
+
 void BriskDescriptorExtractor::setDescriptorBits(
     int keypoint_idx,
     const int* values,
     std::vector<std::bitset<kDescriptorLength> >* descriptors) const {
   CHECK_NOTNULL(descriptors);
+  CHECK_LE(noShortPairs_, kDescriptorLength);
   std::bitset<kDescriptorLength>& descriptor = descriptors->at(keypoint_idx);
 
   // Now iterate through all the pairings.
   // brisk::timing::DebugTimer timer_assemble_bits(
       //"1.3 Brisk Extraction: assemble bits (per keypoint)");
-  const brisk::BriskShortPair* max = shortPairs_ + noShortPairs_;
-  int shifter = 0;
-  for (brisk::BriskShortPair* iter = shortPairs_; iter < max; ++iter) {
-    int t1 = *(values + iter->i);
-    int t2 = *(values + iter->j);
-    if (t1 > t2) {
-      descriptor.set(shifter, true);
-    }  // Else already initialized with zero.
-    ++shifter;
+  unsigned char bits[kDescriptorLength / 8] = {};
+  CompareShortPairs(values, shortPairs_, noShortPairs_, bits);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  // The bitset stores bit k in bit k % w of its w bit word k / w. On little
+  // endian machines this is bit k % 8 of byte k / 8, same as in the bytes.
+  static_assert(sizeof(descriptor) == sizeof(bits),
+                "The bitset is expected to consist of its words only.");
+  memcpy(&descriptor, bits, sizeof(bits));
+#else
+  descriptor.reset();
+  for (unsigned int k = 0; k < noShortPairs_; ++k) {
+    if (bits[k / 8] & (1 << (k % 8))) {
+      descriptor.set(k, true);
+    }
   }
+#endif
   //timer_assemble_bits.Stop();
 }
 
 void BriskDescriptorExtractor::computeImpl(
     const agast::Mat& image, std::vector<agast::KeyPoint>& keypoints,
     std::vector<std::bitset<kDescriptorLength> >& descriptors) const {
-  doDescriptorComputation(image, keypoints, descriptors);
+  doDescriptorComputation(PreparedImage(image), keypoints, descriptors);
 }
 
 void BriskDescriptorExtractor::computeImpl(const agast::Mat& image,
                                            std::vector<agast::KeyPoint>& keypoints,
                                            agast::Mat& descriptors) const {
+  doDescriptorComputation(PreparedImage(image), keypoints, descriptors);
+}
+
+void BriskDescriptorExtractor::compute(const PreparedImage& image,
+                                       std::vector<agast::KeyPoint>& keypoints,
+                                       agast::Mat& descriptors) const {
   doDescriptorComputation(image, keypoints, descriptors);
 }
 
+void BriskDescriptorExtractor::compute(
+    const PreparedImage& image, std::vector<agast::KeyPoint>& keypoints,
+    std::vector<std::bitset<kDescriptorLength> >& descriptors) const {
+  doDescriptorComputation(image, keypoints, descriptors);
+}
+
+size_t BriskDescriptorExtractor::compute(
+    const PreparedImage& image, std::vector<agast::KeyPoint>& keypoints,
+    unsigned char* data, size_t stride, size_t capacity,
+    size_t alignment) const {
+  DescriptorBuffer descriptors(data, stride, capacity, alignment);
+  compute(image, keypoints, descriptors);
+  return descriptors.size();
+}
+
+void BriskDescriptorExtractor::compute(const PreparedImage& image,
+                                       std::vector<agast::KeyPoint>& keypoints,
+                                       DescriptorBuffer& descriptors) const {
+  CHECK_GE(descriptors.stride(), static_cast<size_t>(strings_));
+  if (keypoints.size() > descriptors.available()) {
+    throw std::runtime_error("Descriptor buffer too small: "
+                             + std::to_string(descriptors.available())
+                             + " rows available for "
+                             + std::to_string(keypoints.size())
+                             + " keypoints.");
+  }
+  DescriptorRows rows(&descriptors);
+  doDescriptorComputation(image, keypoints, rows);
+}
+
 void BriskDescriptorExtractor::AllocateDescriptors(size_t count,
                                                    agast::Mat& descriptors) const {
   descriptors = agast::Mat::zeros(count, strings_, CV_8UC1);
 }
 
+void BriskDescriptorExtractor::AllocateDescriptors(
+    size_t count, DescriptorRows& descriptors) const {
+  descriptors.first = descriptors.buffer->Append(count);
+}
+
 void BriskDescriptorExtractor::AllocateDescriptors(
     size_t count,
     std::vector<std::bitset<kDescriptorLength> >& descriptors) const {
   descriptors.resize(count);
 }
 
-template<typename DESCRIPTOR_CONTAINER>
-void BriskDescriptorExtractor::doDescriptorComputation(
-    const agast::Mat& image,
-    std::vector<agast::KeyPoint>& keypoints,
-    DESCRIPTOR_CONTAINER& descriptors) const {
-  // Remove keypoints very close to the border.
-    size_t ksize = keypoints.size();
-    std::vector<int> kscales;  // Remember the scale per keypoint.
-    kscales.resize(ksize);
-    static const float log2 = 0.693147180559945;
-    static const float lb_scalerange = log(scalerange_) / (log2);
-
-    std::vector<agast::KeyPoint> valid_kp;
-    std::vector<int> valid_scales;
-    valid_kp.reserve(keypoints.size());
-    valid_scales.reserve(keypoints.size());
-
-    static const float basicSize06 = basicSize_ * 0.6;
-    unsigned int basicscale = 0;
-    if (!scaleInvariance)
-      basicscale = std::max(
+void BriskDescriptorExtractor::RemoveBorderKeypoints(
+    const agast::Mat& image, std::vector<agast::KeyPoint>& keypoints,
+    std::vector<int>* kscales) const {
+  CHECK_NOTNULL(kscales);
+  const size_t ksize = keypoints.size();
+  kscales->resize(ksize);
+  static const float log2 = 0.693147180559945;
+  static const float lb_scalerange = log(scalerange_) / (log2);
+
+  std::vector<agast::KeyPoint> valid_kp;
+  std::vector<int> valid_scales;
+  valid_kp.reserve(keypoints.size());
+  valid_scales.reserve(keypoints.size());
+
+  static const float basicSize06 = basicSize_ * 0.6;
+  unsigned int basicscale = 0;
+  if (!scaleInvariance)
+    basicscale = std::max(
+        static_cast<int>(scales_ / lb_scalerange
+            * (log(1.45 * basicSize_ / (basicSize06)) / log2) + 0.5),
+        0);
+  for (size_t k = 0; k < ksize; k++) {
+    unsigned int scale;
+    if (scaleInvariance) {
+      scale = std::max(
           static_cast<int>(scales_ / lb_scalerange
-              * (log(1.45 * basicSize_ / (basicSize06)) / log2) + 0.5),
+              * (log(agast::KeyPointSize(keypoints[k]) / (basicSize06)) / log2) + 0.5),
           0);
-    for (size_t k = 0; k < ksize; k++) {
-      unsigned int scale;
-      if (scaleInvariance) {
-        scale = std::max(
-            static_cast<int>(scales_ / lb_scalerange
-                * (log(agast::KeyPointSize(keypoints[k]) / (basicSize06)) / log2) + 0.5),
-            0);
-        // Saturate.
-        if (scale >= scales_)
-          scale = scales_ - 1;
-        kscales[k] = scale;
-      } else {
-        scale = basicscale;
-        kscales[k] = scale;
-      }
-      const int border = sizeList_[scale];
-      const int border_x = image.cols - border;
-      const int border_y = image.rows - border;
-      if (!RoiPredicate(border, border, border_x, border_y, keypoints[k])) {
-        valid_kp.push_back(keypoints[k]);
-        valid_scales.push_back(kscales[k]);
-      }
+      // Saturate.
+      if (scale >= scales_)
+        scale = scales_ - 1;
+      (*kscales)[k] = scale;
+    } else {
+      scale = basicscale;
+      (*kscales)[k] = scale;
+    }
+    const int border = patternTable_->GetSize(scale);
+    const int border_x = image.cols - border;
+    const int border_y = image.rows - border;
+    if (!RoiPredicate(border, border, border_x, border_y, keypoints[k])) {
+      valid_kp.push_back(keypoints[k]);
+      valid_scales.push_back((*kscales)[k]);
     }
+  }
 
-    keypoints.swap(valid_kp);
-    kscales.swap(valid_scales);
-    ksize = keypoints.size();
+  keypoints.swap(valid_kp);
+  kscales->swap(valid_scales);
+}
 
-    AllocateDescriptors(keypoints.size(), descriptors);
+float BriskDescriptorExtractor::EstimateAngle(const agast::Mat& image,
+                                              const agast::Mat& integral,
+                                              const float key_x,
+                                              const float key_y,
+                                              const unsigned int scale,
+                                              int* values) const {
+  // Get the gray values in the unrotated pattern.
+  //brisk::timing::DebugTimer timer_rotation_determination_sample_points(
+      //"1.1.1 Brisk Extraction: rotation determination: sample points "
+      //"(per keypoint)");
+  SmoothedIntensities(image, integral, key_x, key_y, scale, 0, values);
+  //timer_rotation_determination_sample_points.Stop();
+  // Now iterate through the long pairings.
+  //brisk::timing::DebugTimer timer_rotation_determination_gradient(
+      //"1.1.2 Brisk Extraction: rotation determination: calculate "
+      //"gradient (per keypoint)");
+  if (image.type() != CV_8UC1) {
+    // The full precision values of 16 bit images overflow 32 bit sums.
+    int64_t direction0 = 0;
+    int64_t direction1 = 0;
+    SumLongPairGradients(values, longPairs_, noLongPairs_, &direction0,
+                         &direction1);
+    return atan2(static_cast<float>(direction1),
+                 static_cast<float>(direction0)) / M_PI * 180.0;
+  }
+  int direction0 = 0;
+  int direction1 = 0;
+  SumLongPairGradients(values, longPairs_, noLongPairs_, &direction0,
+                       &direction1);
+  //timer_rotation_determination_gradient.Stop();
+  return atan2(static_cast<float>(direction1),
+               static_cast<float>(direction0)) / M_PI * 180.0;
+}
 
-    // First, calculate the integral image over the whole image:
-    // current integral image.
+void BriskDescriptorExtractor::ComputeOrientations(
+    const agast::Mat& image, std::vector<agast::KeyPoint>& keypoints) const {
+  ComputeOrientations(PreparedImage(image), keypoints);
+}
 
-    //brisk::timing::DebugTimer timer_integral_image(
-        //"1.0 Brisk Extraction: integral computation");
-    cv::Mat _integral;  // The integral image.
-    cv::Mat imageScaled;
-    if (image.type() == CV_16UC1) {
-      IntegralImage16(imageScaled, &_integral);
-    } else if (image.type() == CV_8UC1) {
-      IntegralImage8(image, &_integral);
-    } else {
-      throw std::runtime_error("Unsupported image format. Must be CV_16UC1 or CV_8UC1.");
+void BriskDescriptorExtractor::ComputeOrientations(
+    const PreparedImage& preparedImage,
+    std::vector<agast::KeyPoint>& keypoints) const {
+  const agast::Mat& image = preparedImage.GetImage();
+  const agast::Mat& _integral = preparedImage.GetIntegral();
+  std::vector<int> kscales;
+  RemoveBorderKeypoints(image, keypoints, &kscales);
+
+  auto orient_range = [&](size_t begin, size_t end) {
+    std::vector<int> values(points_);  // For temporary use.
+    for (size_t k = begin; k < end; ++k) {
+      agast::KeyPoint& kp = keypoints[k];
+      kp.angle = EstimateAngle(image, _integral, agast::KeyPointX(kp),
+                               agast::KeyPointY(kp), kscales[k],
+                               values.data());
     }
-    //timer_integral_image.Stop();
+  };
+  ParallelFor(keypoints.size(), numThreads_, kMinKeypointsPerThread,
+              orient_range, taskRunner_);
+}
 
-    int* _values = new int[points_];  // For temporary use.
+template<typename DESCRIPTOR_CONTAINER>
+void BriskDescriptorExtractor::doDescriptorComputation(
+    const PreparedImage& preparedImage,
+    std::vector<agast::KeyPoint>& keypoints,
+    DESCRIPTOR_CONTAINER& descriptors) const {
+  const agast::Mat& image = preparedImage.GetImage();
+  // First, get the integral image over the whole image. It is only
+  // computed once per prepared image, and throws for unsupported image
+  // types before the keypoints or the descriptors are touched.
+
+  //brisk::timing::DebugTimer timer_integral_image(
+      //"1.0 Brisk Extraction: integral computation");
+  const agast::Mat& _integral = preparedImage.GetIntegral();
+  //timer_integral_image.Stop();
 
-    // Now do the extraction for all keypoints:
-    for (size_t k = 0; k < ksize; ++k) {
+  // Remove keypoints very close to the border.
+  std::vector<int> kscales;  // Remember the scale per keypoint.
+  RemoveBorderKeypoints(image, keypoints, &kscales);
+  const size_t ksize = keypoints.size();
+
+  AllocateDescriptors(keypoints.size(), descriptors);
+
+  // Now do the extraction for all keypoints. Each range of keypoints gets
+  // its own scratch buffer and writes to its own descriptor rows, so the
+  // result does not depend on how the keypoints are split.
+  auto extract_range = [&](size_t begin, size_t end) {
+    std::vector<int> values(points_);  // For temporary use.
+    int* _values = values.data();
+    for (size_t k = begin; k < end; ++k) {
       int theta;
       agast::KeyPoint& kp = keypoints[k];
       const int& scale = kscales[k];
-      int* pvalues = _values;
       const float& x = agast::KeyPointX(kp);
       const float& y = agast::KeyPointY(kp);
       if (agast::KeyPointAngle(kp) == -1) {
@@ -694,43 +770,7 @@ void BriskDescriptorExtractor::doDescriptorComputation(
           // Don't compute the gradient direction, just assign a rotation of 0°.
           theta = 0;
         } else {
-          // Get the gray values in the unrotated pattern.
-          //brisk::timing::DebugTimer timer_rotation_determination_sample_points(
-              //"1.1.1 Brisk Extraction: rotation determination: sample points "
-              //"(per keypoint)");
-          if (image.type() == CV_8UC1) {
-            for (unsigned int i = 0; i < points_; i++) {
-              *(pvalues++) = SmoothedIntensity<unsigned char, int>(image, _integral, x, y,
-                                                           scale, 0, i);
-            }
-          } else {
-            for (unsigned int i = 0; i < points_; i++) {
-              *(pvalues++) = static_cast<int>(65536.0
-                  * SmoothedIntensity<float, float>(imageScaled, _integral, x, y,
-                                                    scale, 0, i));
-            }
-          }
-          //timer_rotation_determination_sample_points.Stop();
-          int direction0 = 0;
-          int direction1 = 0;
-          // Now iterate through the long pairings.
-          //brisk::timing::DebugTimer timer_rotation_determination_gradient(
-              //"1.1.2 Brisk Extraction: rotation determination: calculate "
-              //"gradient (per keypoint)");
-          const brisk::BriskLongPair* max = longPairs_ + noLongPairs_;
-          for (brisk::BriskLongPair* iter = longPairs_; iter < max; ++iter) {
-            int t1 = *(_values + iter->i);
-            int t2 = *(_values + iter->j);
-            const int delta_t = (t1 - t2);
-            // Update the direction:
-            const int tmp0 = delta_t * (iter->weighted_dx) / 1024;
-            const int tmp1 = delta_t * (iter->weighted_dy) / 1024;
-            direction0 += tmp0;
-            direction1 += tmp1;
-          }
-          //timer_rotation_determination_gradient.Stop();
-          kp.angle = atan2(static_cast<float>(direction1),
-                           static_cast<float>(direction0)) / M_PI * 180.0;
+          kp.angle = EstimateAngle(image, _integral, x, y, scale, _values);
           theta = static_cast<int>((n_rot_ * agast::KeyPointAngle(kp)) /
                                    (360.0) + 0.5);
           if (theta < 0)
@@ -745,36 +785,39 @@ void BriskDescriptorExtractor::doDescriptorComputation(
         } else {
           theta = static_cast<int>(n_rot_ * (agast::KeyPointAngle(kp) /
               (360.0)) + 0.5);
+          // Wrap angles outside of [0, 360) to a valid rotation index.
+          theta %= static_cast<int>(n_rot_);
           if (theta < 0)
             theta += n_rot_;
-          if (theta >= static_cast<int>(n_rot_))
-            theta -= n_rot_;
         }
       }
 
       // Now also extract the stuff for the actual direction:
       // Let us compute the smoothed values.
-      pvalues = _values;
       // Get the gray values in the rotated pattern.
       //brisk::timing::DebugTimer timer_sample_points(
           //"1.2 Brisk Extraction: sample points (per keypoint)");
-      if (image.type() == CV_8UC1) {
-        for (unsigned int i = 0; i < points_; i++) {
-          *(pvalues++) = SmoothedIntensity<unsigned char, int>(image, _integral, x, y,
-                                                       scale, theta, i);
-        }
-      } else {
-        for (unsigned int i = 0; i < points_; i++) {
-          *(pvalues++) = static_cast<int>(65536.0
-              * SmoothedIntensity<float, float>(imageScaled, _integral, x, y,
-                                                scale, theta, i));
-        }
-      }
+      SmoothedIntensities(image, _integral, x, y, scale, theta, _values);
       //timer_sample_points.Stop();
 
       setDescriptorBits(k, _values, &descriptors);
     }
-    delete[] _values;
+  };
+  ParallelFor(ksize, numThreads_, kMinKeypointsPerThread, extract_range,
+              taskRunner_);
+}
+
+void BriskDescriptorExtractor::SetNumThreads(size_t num_threads) {
+  CHECK_GT(num_threads, 0u);
+  numThreads_ = num_threads;
+}
+
+void BriskDescriptorExtractor::SetQuantizedSampling(bool enabled) {
+  quantizedSampling_ = enabled;
+}
+
+void BriskDescriptorExtractor::SetTaskRunner(const TaskRunner& task_runner) {
+  taskRunner_ = task_runner;
 }
 
 int BriskDescriptorExtractor::descriptorSize() const {
@@ -786,10 +829,7 @@ int BriskDescriptorExtractor::descriptorType() const {
 }
 
 BriskDescriptorExtractor::~BriskDescriptorExtractor() {
-  delete[] patternPoints_;
   delete[] shortPairs_;
   delete[] longPairs_;
-  delete[] scaleList_;
-  delete[] sizeList_;
 }
 }  // namespace brisk
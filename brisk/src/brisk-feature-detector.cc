@@ -39,6 +39,8 @@
  */
 
 #include <algorithm>
+#include <cmath>
+#include <functional>
 
 #include <agast/glog.h>
 #include <agast/wrap-opencv.h>
@@ -64,30 +66,258 @@ void RemoveInvalidKeyPoints(const agast::Mat& mask,
       std::remove_if(keypoints->begin(), keypoints->end(),
                      masking), keypoints->end());
 }
+
+// The range of adaptive thresholds.
+const int kMinAdaptiveThreshold = 1;
+const int kMaxAdaptiveThreshold = 254;
+
+// Keeps the max_keypoints keypoints with the highest responses, in their
+// order. Of equal responses the first ones are kept.
+void KeepStrongest(size_t max_keypoints,
+                   std::vector<agast::KeyPoint>* keypoints) {
+  CHECK_NOTNULL(keypoints);
+  if (keypoints->size() <= max_keypoints)
+    return;
+  std::vector<float> responses;
+  responses.reserve(keypoints->size());
+  for (const agast::KeyPoint& keypoint : *keypoints) {
+    responses.push_back(agast::KeyPointResponse(keypoint));
+  }
+  std::nth_element(responses.begin(), responses.begin() + max_keypoints - 1,
+                   responses.end(), std::greater<float>());
+  const float cutoff = responses[max_keypoints - 1];
+  size_t num_at_cutoff = max_keypoints;
+  for (const agast::KeyPoint& keypoint : *keypoints) {
+    if (agast::KeyPointResponse(keypoint) > cutoff)
+      --num_at_cutoff;
+  }
+  size_t num_kept = 0;
+  for (const agast::KeyPoint& keypoint : *keypoints) {
+    const float response = agast::KeyPointResponse(keypoint);
+    if (response > cutoff || (response == cutoff && num_at_cutoff-- > 0)) {
+      (*keypoints)[num_kept++] = keypoint;
+    }
+  }
+  keypoints->resize(num_kept);
+}
+
+// The threshold for the next frame. The number of keypoints drops about
+// exponentially with the threshold, so the logarithm of the number is
+// interpolated linearly through the last two frames if they were on either
+// side of the band or both outside it, and approached in steps otherwise.
+int NextThreshold(int threshold, size_t num_keypoints, int last_threshold,
+                  size_t last_num_keypoints, size_t min_keypoints,
+                  size_t max_keypoints) {
+  if (num_keypoints >= min_keypoints && num_keypoints <= max_keypoints)
+    return threshold;
+  const bool too_many = num_keypoints > max_keypoints;
+  // Steps if there is no slope.
+  int next = too_many ? threshold * 5 / 4 :
+      (num_keypoints < min_keypoints / 4 ? threshold / 2 : threshold * 4 / 5);
+  if (last_threshold != threshold && num_keypoints > 0 &&
+      last_num_keypoints > 0 && last_num_keypoints != num_keypoints) {
+    const double slope =
+        (std::log(static_cast<double>(num_keypoints)) -
+         std::log(static_cast<double>(last_num_keypoints))) /
+        (threshold - last_threshold);
+    if (slope < 0) {
+      // Aim at the middle of the band, and at most double or halve.
+      const double target = 0.5 * (min_keypoints + max_keypoints);
+      const double interpolated = threshold +
+          (std::log(target) - std::log(static_cast<double>(num_keypoints))) /
+          slope;
+      next = static_cast<int>(std::max(0.5 * threshold,
+          std::min(2.0 * threshold, interpolated)) + 0.5);
+    }
+  }
+  // Always move into the right direction.
+  next = too_many ? std::max(next, threshold + 1) :
+      std::min(next, threshold - 1);
+  return std::max(kMinAdaptiveThreshold,
+                  std::min(next, kMaxAdaptiveThreshold));
+}
 }  // namespace
 
 namespace brisk {
 BriskFeatureDetector::BriskFeatureDetector(int thresh, int octaves,
-                                           bool suppressScaleNonmaxima) {
+                                           bool suppressScaleNonmaxima)
+    : numThreads_(1),
+      borrowImages_(false) {
   threshold = thresh;
   this->octaves = octaves;
   m_suppressScaleNonmaxima = suppressScaleNonmaxima;
 }
 
+BriskFeatureDetector::BriskFeatureDetector(const BriskFeatureDetector& other)
+    : BriskFeatureDetector(other.threshold, other.octaves,
+                           other.m_suppressScaleNonmaxima) {
+  CopyFrom(other);
+}
+
+BriskFeatureDetector::~BriskFeatureDetector() { }
+
+BriskFeatureDetector& BriskFeatureDetector::operator=(
+    const BriskFeatureDetector& other) {
+  if (this != &other)
+    CopyFrom(other);
+  return *this;
+}
+
+void BriskFeatureDetector::CopyFrom(const BriskFeatureDetector& other) {
+  threshold = other.threshold;
+  octaves = other.octaves;
+  m_suppressScaleNonmaxima = other.m_suppressScaleNonmaxima;
+  numThreads_ = other.numThreads_;
+  taskRunner_ = other.taskRunner_;
+  borrowImages_ = other.borrowImages_;
+  adaptiveThreshold_.reset();
+  if (other.adaptiveThreshold_) {
+    AdaptiveThreshold& adaptive = *other.adaptiveThreshold_;
+    std::lock_guard<std::mutex> lock(adaptive.mutex);
+    adaptiveThreshold_.reset(new AdaptiveThreshold);
+    adaptiveThreshold_->threshold = adaptive.threshold;
+    adaptiveThreshold_->startThreshold = adaptive.startThreshold;
+    adaptiveThreshold_->lastThreshold = adaptive.lastThreshold;
+    adaptiveThreshold_->lastNumKeypoints = adaptive.lastNumKeypoints;
+    adaptiveThreshold_->minKeypoints = adaptive.minKeypoints;
+    adaptiveThreshold_->maxKeypoints = adaptive.maxKeypoints;
+  }
+  persistentScaleSpace_.reset();
+  SetPersistentScaleSpace(other.persistentScaleSpace_ != nullptr);
+}
+
+void BriskFeatureDetector::SetNumThreads(size_t num_threads) {
+  CHECK_GT(num_threads, 0u);
+  numThreads_ = num_threads;
+}
+
+void BriskFeatureDetector::SetTaskRunner(const TaskRunner& task_runner) {
+  taskRunner_ = task_runner;
+}
+
+void BriskFeatureDetector::SetBorrowImages(bool borrow) {
+  borrowImages_ = borrow;
+}
+
+void BriskFeatureDetector::SetTargetNumKeypoints(size_t min_keypoints,
+                                                 size_t max_keypoints) {
+  if (max_keypoints == 0) {
+    adaptiveThreshold_.reset();
+    return;
+  }
+  CHECK_LE(min_keypoints, max_keypoints);
+  adaptiveThreshold_.reset(new AdaptiveThreshold);
+  adaptiveThreshold_->Restart(threshold);
+  adaptiveThreshold_->minKeypoints = min_keypoints;
+  adaptiveThreshold_->maxKeypoints = max_keypoints;
+}
+
+void BriskFeatureDetector::AdaptiveThreshold::Restart(int start_threshold) {
+  threshold = std::max(kMinAdaptiveThreshold,
+                       std::min(start_threshold, kMaxAdaptiveThreshold));
+  startThreshold = start_threshold;
+  lastThreshold = threshold;
+  lastNumKeypoints = 0;
+}
+
+int BriskFeatureDetector::GetThreshold() const {
+  if (!adaptiveThreshold_)
+    return threshold;
+  std::lock_guard<std::mutex> lock(adaptiveThreshold_->mutex);
+  if (adaptiveThreshold_->startThreshold != threshold)
+    adaptiveThreshold_->Restart(threshold);
+  return adaptiveThreshold_->threshold;
+}
+
+void BriskFeatureDetector::AdaptThreshold(
+    std::vector<agast::KeyPoint>* keypoints) const {
+  CHECK_NOTNULL(keypoints);
+  if (!adaptiveThreshold_)
+    return;
+  AdaptiveThreshold& adaptive = *adaptiveThreshold_;
+  std::lock_guard<std::mutex> lock(adaptive.mutex);
+  if (adaptive.startThreshold != threshold)
+    adaptive.Restart(threshold);
+  const int next = NextThreshold(
+      adaptive.threshold, keypoints->size(), adaptive.lastThreshold,
+      adaptive.lastNumKeypoints, adaptive.minKeypoints, adaptive.maxKeypoints);
+  adaptive.lastThreshold = adaptive.threshold;
+  adaptive.lastNumKeypoints = keypoints->size();
+  adaptive.threshold = next;
+  KeepStrongest(adaptive.maxKeypoints, keypoints);
+}
+
+void BriskFeatureDetector::SetPersistentScaleSpace(bool persistent) {
+  if (!persistent) {
+    persistentScaleSpace_.reset();
+  } else if (!persistentScaleSpace_) {
+    persistentScaleSpace_.reset(new PersistentScaleSpace);
+  }
+}
+
+void BriskFeatureDetector::RunOnScaleSpace(
+    const std::function<void(BriskScaleSpace*)>& detection) const {
+  if (!persistentScaleSpace_) {
+    BriskScaleSpace briskScaleSpace(octaves, m_suppressScaleNonmaxima);
+    briskScaleSpace.SetNumThreads(numThreads_);
+    briskScaleSpace.SetTaskRunner(taskRunner_);
+    briskScaleSpace.SetBorrowImage(borrowImages_);
+    detection(&briskScaleSpace);
+    return;
+  }
+  PersistentScaleSpace& persistent = *persistentScaleSpace_;
+  std::lock_guard<std::mutex> lock(persistent.mutex);
+  if (!persistent.scaleSpace || persistent.octaves != octaves ||
+      persistent.suppressScaleNonmaxima != m_suppressScaleNonmaxima) {
+    persistent.scaleSpace.reset(
+        new BriskScaleSpace(octaves, m_suppressScaleNonmaxima));
+    persistent.octaves = octaves;
+    persistent.suppressScaleNonmaxima = m_suppressScaleNonmaxima;
+  }
+  persistent.scaleSpace->SetNumThreads(numThreads_);
+  persistent.scaleSpace->SetTaskRunner(taskRunner_);
+  persistent.scaleSpace->SetBorrowImage(borrowImages_);
+  detection(persistent.scaleSpace.get());
+}
+
 void BriskFeatureDetector::detectImpl(const agast::Mat& image,
                                       std::vector<agast::KeyPoint>& keypoints,
                                       const agast::Mat& mask) const {
+  DetectOnPyramid(image, nullptr, mask, keypoints);
+}
+
+void BriskFeatureDetector::detect(const PreparedImage& image,
+                                  std::vector<agast::KeyPoint>& keypoints,
+                                  const agast::Mat& mask) const {
+  DetectOnPyramid(image.GetImage(), &image, mask, keypoints);
+}
+
+void BriskFeatureDetector::DetectOnPyramid(
+    const agast::Mat& image, const PreparedImage* preparedImage,
+    const agast::Mat& mask, std::vector<agast::KeyPoint>& keypoints) const {
   keypoints.clear();
-  brisk::BriskScaleSpace briskScaleSpace(octaves, m_suppressScaleNonmaxima);
-  briskScaleSpace.ConstructPyramid(image, threshold);
-  briskScaleSpace.GetKeypoints(&keypoints);
+  const int detectionThreshold = GetThreshold();
+  RunOnScaleSpace([&](BriskScaleSpace* briskScaleSpace) {
+    briskScaleSpace->SetMask(mask);
+    if (preparedImage != nullptr) {
+      briskScaleSpace->ConstructPyramid(*preparedImage, detectionThreshold);
+    } else {
+      briskScaleSpace->ConstructPyramid(image, detectionThreshold);
+    }
+    briskScaleSpace->GetKeypoints(&keypoints);
+    briskScaleSpace->SetMask(agast::Mat());
+  });
+  // The masked out pixels were skipped by the detection, but the keypoints
+  // around the border of the mask still have to be filtered.
   RemoveInvalidKeyPoints(mask, &keypoints);
+  AdaptThreshold(&keypoints);
 }
 
 void BriskFeatureDetector::ComputeScale(
     const agast::Mat& image, std::vector<agast::KeyPoint>& keypoints) const {
-  BriskScaleSpace briskScaleSpace(octaves, m_suppressScaleNonmaxima);
-  briskScaleSpace.ConstructPyramid(image, threshold, 0);
-  briskScaleSpace.GetKeypoints(&keypoints);
+  RunOnScaleSpace([&](BriskScaleSpace* briskScaleSpace) {
+    briskScaleSpace->ConstructPyramid(image, threshold, 0);
+    briskScaleSpace->GetKeypoints(&keypoints);
+  });
 }
 }  // namespace brisk
@@ -38,6 +38,8 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <cstring>
+
 #include <brisk/internal/brisk-layer.h>
 #include <brisk/internal/image-down-sampling.h>
 
@@ -50,50 +52,153 @@
 
 namespace brisk {
 // Construct a layer.
+BriskLayer::BriskLayer()
+    : masked_(false),
+      scale_(1.0f),
+      offset_(0.0f),
+      upperThreshold_(0),
+      lowerThreshold_(0) { }
+
 BriskLayer::BriskLayer(const agast::Mat& img, unsigned char upperThreshold,
-                       unsigned char lowerThreshold, float scale, float offset) {
+                       unsigned char lowerThreshold, float scale, float offset,
+                       bool calculateThresholdMap)
+    : masked_(false) {
+  Reset(img, upperThreshold, lowerThreshold, scale, offset,
+        calculateThresholdMap);
+}
+// Derive a layer.
+BriskLayer::BriskLayer(const BriskLayer& layer, int mode, unsigned char upperThreshold,
+                       unsigned char lowerThreshold)
+    : masked_(false) {
+  Reset(layer, mode, upperThreshold, lowerThreshold);
+}
+
+void BriskLayer::Reset(const agast::Mat& img, unsigned char upperThreshold,
+                       unsigned char lowerThreshold, float scale, float offset,
+                       bool calculateThresholdMap) {
   upperThreshold_ = upperThreshold;
   lowerThreshold_ = lowerThreshold;
 
   img_ = img;
-  scores_ = agast::Mat::zeros(img.rows, img.cols, CV_8U);
   // Attention: this means that the passed image reference must point to
   // persistent memory.
   scale_ = scale;
   offset_ = offset;
-  // Create an agast detector.
-  oastDetector_.reset(new agast::OastDetector9_16(img.cols, img.rows, 0));
-  agastDetector_5_8_.reset(new agast::AgastDetector5_8(img.cols, img.rows, 0));
+  masked_ = false;
+  ResetBuffers();
 
   // Calculate threshold map.
-  CalculateThresholdMap();
+  if (calculateThresholdMap) {
+    CalculateThresholdMap();
+  }
 }
-// Derive a layer.
-BriskLayer::BriskLayer(const BriskLayer& layer, int mode, unsigned char upperThreshold,
+
+void BriskLayer::ResetCopy(const agast::Mat& img, unsigned char upperThreshold,
+                           unsigned char lowerThreshold,
+                           bool calculateThresholdMap) {
+  CHECK_EQ(img.type(), CV_8UC1);
+  if (imgBuffer_.rows != img.rows || imgBuffer_.cols != img.cols) {
+    imgBuffer_.create(img.rows, img.cols, CV_8U);
+  }
+  for (int row = 0; row < img.rows; ++row) {
+    memcpy(imgBuffer_.data + row * img.cols, img.data + row * img.step,
+           img.cols);
+  }
+  Reset(imgBuffer_, upperThreshold, lowerThreshold, 1.0f, 0.0f,
+        calculateThresholdMap);
+}
+
+void BriskLayer::Reset(const BriskLayer& layer, int mode,
+                       unsigned char upperThreshold,
                        unsigned char lowerThreshold) {
+  CHECK_NE(&layer, this);
   upperThreshold_ = upperThreshold;
   lowerThreshold_ = lowerThreshold;
 
+  int rows, cols;
   if (mode == CommonParams::HALFSAMPLE) {
-    img_.create(layer.img().rows / 2, layer.img().cols / 2, CV_8U);
-    Halfsample8(layer.img(), img_);
+    rows = layer.img().rows / 2;
+    cols = layer.img().cols / 2;
     scale_ = layer.scale() * 2;
-    offset_ = 0.5 * scale_ - 0.5;
   } else {
-    img_.create(2 * (layer.img().rows / 3), 2 * (layer.img().cols / 3), CV_8U);
-    Twothirdsample8(layer.img(), img_);
+    rows = 2 * (layer.img().rows / 3);
+    cols = 2 * (layer.img().cols / 3);
     scale_ = layer.scale() * 1.5;
-    offset_ = 0.5 * scale_ - 0.5;
   }
-  scores_ = agast::Mat::zeros(img_.rows, img_.cols, CV_8U);
-  oastDetector_.reset(new agast::OastDetector9_16(img_.cols, img_.rows, 0));
-  agastDetector_5_8_.reset(
-      new agast::AgastDetector5_8(img_.cols, img_.rows, 0));
+  offset_ = 0.5 * scale_ - 0.5;
+  if (imgBuffer_.rows != rows || imgBuffer_.cols != cols) {
+    imgBuffer_.create(rows, cols, CV_8U);
+  }
+  img_ = imgBuffer_;
+  if (mode == CommonParams::HALFSAMPLE) {
+    Halfsample8(layer.img(), img_);
+  } else {
+    Twothirdsample8(layer.img(), img_);
+  }
+  ResetBuffers();
+  DeriveMask(layer, mode);
 
   // Calculate threshold map.
   CalculateThresholdMap();
 }
 
+void BriskLayer::ResetBuffers() {
+  if (scores_.rows != img_.rows || scores_.cols != img_.cols) {
+    scores_ = agast::Mat::zeros(img_.rows, img_.cols, CV_8U);
+    // The threshold map only writes the inner pixels, so its buffers must
+    // start out zero.
+    tmpmax_ = agast::Mat::zeros(img_.rows, img_.cols, CV_8U);
+    tmpmin_ = agast::Mat::zeros(img_.rows, img_.cols, CV_8U);
+    thrmap_ = agast::Mat::zeros(img_.rows, img_.cols, CV_8U);
+    // Create agast detectors.
+    oastDetector_.reset(new agast::OastDetector9_16(img_.cols, img_.rows, 0));
+    agastDetector_5_8_.reset(
+        new agast::AgastDetector5_8(img_.cols, img_.rows, 0));
+  } else {
+    memset(scores_.data, 0, img_.rows * img_.cols);
+  }
+}
+
+void BriskLayer::SetMask(const agast::Mat& mask) {
+  masked_ = !mask.empty();
+  if (!masked_)
+    return;
+  CHECK_EQ(mask.type(), CV_8UC1);
+  CHECK_EQ(mask.rows, img_.rows);
+  CHECK_EQ(mask.cols, img_.cols);
+  if (mask_.rows != img_.rows || mask_.cols != img_.cols) {
+    mask_.create(img_.rows, img_.cols, CV_8U);
+  }
+  for (int row = 0; row < mask.rows; ++row) {
+    memcpy(mask_.data + row * mask_.cols, mask.data + row * mask.step,
+           mask.cols);
+  }
+  GrowDetectionMask();
+}
+
+void BriskLayer::DeriveMask(const BriskLayer& layer, int mode) {
+  CHECK_NE(&layer, this);
+  masked_ = layer.masked_;
+  if (!masked_)
+    return;
+  if (mask_.rows != img_.rows || mask_.cols != img_.cols) {
+    mask_.create(img_.rows, img_.cols, CV_8U);
+  }
+  if (mode == CommonParams::HALFSAMPLE) {
+    HalfsampleMask(layer.mask_, mask_);
+  } else {
+    TwothirdsampleMask(layer.mask_, mask_);
+  }
+  GrowDetectionMask();
+}
+
+void BriskLayer::GrowDetectionMask() {
+  if (detectionMask_.rows != img_.rows || detectionMask_.cols != img_.cols) {
+    detectionMask_.create(img_.rows, img_.cols, CV_8U);
+  }
+  DilateMask(mask_, kMaskMargin, detectionMask_);
+}
+
 // Fast/Agast.
 // Wraps the agast class.
 void BriskLayer::GetAgastPoints(uint8_t threshold,
@@ -101,6 +206,7 @@ void BriskLayer::GetAgastPoints(uint8_t threshold,
   CHECK_NOTNULL(keypoints);
   oastDetector_->set_threshold(threshold, upperThreshold_, lowerThreshold_);
   if (keypoints->empty()) {
+    oastDetector_->set_mask(masked_ ? detectionMask_.data : 0);
     oastDetector_->detect(img_.data, *keypoints, &thrmap_);
   }
   // Also write scores.
@@ -276,10 +382,10 @@ uint8_t BriskLayer::Value(const agast::Mat& mat, float xf, float yf, float scale
 
 // Threshold map.
 void BriskLayer::CalculateThresholdMap() {
-  // Allocate threshold map.
-  agast::Mat tmpmax = agast::Mat::zeros(img_.rows, img_.cols, CV_8U);
-  agast::Mat tmpmin = agast::Mat::zeros(img_.rows, img_.cols, CV_8U);
-  thrmap_ = agast::Mat::zeros(img_.rows, img_.cols, CV_8U);
+  // The buffers are allocated by ResetBuffers, and every call writes the
+  // same pixels.
+  agast::Mat& tmpmax = tmpmax_;
+  agast::Mat& tmpmin = tmpmin_;
 
   const int rowstride = img_.cols;
 
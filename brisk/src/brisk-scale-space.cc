@@ -52,7 +52,9 @@ const unsigned char BriskScaleSpace::kDefaultUpperThreshold = 230;
 
 // Construct telling the octaves number:
 BriskScaleSpace::BriskScaleSpace(uint8_t _octaves,
-                                 bool suppressScaleNonmaxima) {
+                                 bool suppressScaleNonmaxima)
+    : borrowImage_(false),
+      numThreads_(1) {
   suppressScaleNonmaxima_ = suppressScaleNonmaxima;
   if (_octaves == 0)
     layers_ = 1;
@@ -60,71 +62,172 @@ BriskScaleSpace::BriskScaleSpace(uint8_t _octaves,
     layers_ = 2 * _octaves;
 }
 BriskScaleSpace::~BriskScaleSpace() { }
+
+void BriskScaleSpace::SetNumThreads(size_t num_threads) {
+  CHECK_GT(num_threads, 0u);
+  numThreads_ = num_threads;
+}
+
+void BriskScaleSpace::SetTaskRunner(const TaskRunner& task_runner) {
+  taskRunner_ = task_runner;
+}
+
+void BriskScaleSpace::SetBorrowImage(bool borrow) {
+  borrowImage_ = borrow;
+}
+
+void BriskScaleSpace::SetMask(const agast::Mat& mask) {
+  CHECK(mask.empty() || mask.type() == CV_8UC1);
+  mask_ = mask;
+}
+
+void BriskScaleSpace::ResetBaseLayer(const agast::Mat& image,
+                                     unsigned char overwrite_lower_thres,
+                                     bool calculateThresholdMap) {
+  if (borrowImage_ && image.isContinuous()) {
+    pyramid_[0].Reset(image, kDefaultUpperThreshold, overwrite_lower_thres,
+                      1.0f, 0.0f, calculateThresholdMap);
+  } else {
+    pyramid_[0].ResetCopy(image, kDefaultUpperThreshold, overwrite_lower_thres,
+                          calculateThresholdMap);
+  }
+  pyramid_[0].SetMask(mask_);
+}
+
 // Construct the image pyramids.
 void BriskScaleSpace::ConstructPyramid(const agast::Mat& image, unsigned char threshold,
                                        unsigned char overwrite_lower_thres) {
-  // Set correct size:
-  pyramid_.clear();
-
   // Assign threshold.
   threshold_ = threshold;
 
+  // The layers are reset in place, so constructing pyramids of equally sized
+  // images reuses all of their buffers.
+  pyramid_.resize(layers_);
+
+  if (numThreads_ > 1 && layers_ > 1) {
+    // The octaves and the intra-octave layers form two independent chains
+    // after the base layer. Build them concurrently, each computing the
+    // threshold maps of its layers right after their images, while the
+    // threshold map of the base layer is computed on its own.
+    ResetBaseLayer(image, overwrite_lower_thres, false);
+    TaskBatch tasks;
+    tasks.push_back([this]() {
+      pyramid_[0].CalculateThresholdMap();
+    });
+    tasks.push_back([this, overwrite_lower_thres]() {
+      for (uint8_t i = 2; i < layers_; i += 2) {
+        pyramid_[i].Reset(pyramid_[i - 2], BriskLayer::CommonParams::HALFSAMPLE,
+                          kDefaultUpperThreshold, overwrite_lower_thres);
+      }
+    });
+    tasks.push_back([this, overwrite_lower_thres]() {
+      pyramid_[1].Reset(pyramid_[0], BriskLayer::CommonParams::TWOTHIRDSAMPLE,
+                        kDefaultUpperThreshold, overwrite_lower_thres);
+      for (uint8_t i = 3; i < layers_; i += 2) {
+        pyramid_[i].Reset(pyramid_[i - 2], BriskLayer::CommonParams::HALFSAMPLE,
+                          kDefaultUpperThreshold, overwrite_lower_thres);
+      }
+    });
+    RunTasks(&tasks, taskRunner_);
+    return;
+  }
+
   // Fill the pyramid:
-  pyramid_.push_back(
-      BriskLayer(image.clone(), kDefaultUpperThreshold, overwrite_lower_thres));
+  ResetBaseLayer(image, overwrite_lower_thres, true);
   if (layers_ > 1) {
-    pyramid_.push_back(
-        BriskLayer(pyramid_.back(), BriskLayer::CommonParams::TWOTHIRDSAMPLE,
-                   (kDefaultUpperThreshold), (overwrite_lower_thres)));
+    pyramid_[1].Reset(pyramid_[0], BriskLayer::CommonParams::TWOTHIRDSAMPLE,
+                      (kDefaultUpperThreshold), (overwrite_lower_thres));
   }
   const int octaves2 = layers_;
 
   for (uint8_t i = 2; i < octaves2; i += 2) {
-    pyramid_.push_back(
-        BriskLayer(pyramid_[i - 2], BriskLayer::CommonParams::HALFSAMPLE,
-                   (kDefaultUpperThreshold), (overwrite_lower_thres)));
-    pyramid_.push_back(
-        BriskLayer(pyramid_[i - 1], BriskLayer::CommonParams::HALFSAMPLE,
-                   (kDefaultUpperThreshold), (overwrite_lower_thres)));
+    pyramid_[i].Reset(pyramid_[i - 2], BriskLayer::CommonParams::HALFSAMPLE,
+                      (kDefaultUpperThreshold), (overwrite_lower_thres));
+    pyramid_[i + 1].Reset(pyramid_[i - 1],
+                          BriskLayer::CommonParams::HALFSAMPLE,
+                          (kDefaultUpperThreshold), (overwrite_lower_thres));
   }
 }
 
+void BriskScaleSpace::ConstructPyramid(const PreparedImage& image,
+                                       unsigned char threshold,
+                                       unsigned char overwrite_lower_thres) {
+  CHECK_EQ(image.GetImage().type(), CV_8UC1);
+  // Assign threshold.
+  threshold_ = threshold;
+  pyramid_.resize(layers_);
+
+  // Fill the pyramid with the same scales as derived layers get.
+  std::vector<float> scales;
+  for (uint8_t i = 0; i < layers_; ++i) {
+    float scale = 1.0f;
+    float offset = 0.0f;
+    if (i > 0) {
+      scale = i == 1 ? 1.5f : scales[i - 2] * 2;
+      offset = 0.5 * scale - 0.5;
+    }
+    scales.push_back(scale);
+    pyramid_[i].Reset(image.GetLayer(i), kDefaultUpperThreshold,
+                      overwrite_lower_thres, scale, offset, false);
+    if (i == 0) {
+      pyramid_[i].SetMask(mask_);
+    } else if (i == 1) {
+      pyramid_[i].DeriveMask(pyramid_[0],
+                             BriskLayer::CommonParams::TWOTHIRDSAMPLE);
+    } else {
+      pyramid_[i].DeriveMask(pyramid_[i - 2],
+                             BriskLayer::CommonParams::HALFSAMPLE);
+    }
+  }
+  // The images are ready, so the threshold maps are independent.
+  ParallelFor(layers_, numThreads_, 1, [this](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      pyramid_[i].CalculateThresholdMap();
+    }
+  }, taskRunner_);
+}
+
 void BriskScaleSpace::GetKeypoints(std::vector<agast::KeyPoint>* keypoints) {
   CHECK_NOTNULL(keypoints);
   std::vector<std::vector<agast::KeyPoint> > agastPoints;
   agastPoints.resize(layers_);
 
-  bool perform_2d_nonMax = true;
-
-  // Go through the octaves and intra layers and calculate fast corner scores:
-  for (uint8_t i = 0; i < layers_; ++i) {
-    BriskLayer& l = pyramid_[i];
-
-    // Compute scores for given keypoints or extract new kepoints.
-    if (!keypoints->empty()) {
-      perform_2d_nonMax = false;
-      // Compute the location for this layer:
-      for (const agast::KeyPoint& keypoint : *keypoints) {
-        agast::KeyPoint kp = keypoint;
-        agast::KeyPointX(kp) =
-            (static_cast<float>(agast::KeyPointX(keypoint))) /
-            l.scale() - l.offset();
-        agast::KeyPointY(kp) =
-            (static_cast<float>(agast::KeyPointY(keypoint))) /
-            l.scale() - l.offset();
-        if (agast::KeyPointX(kp) < 3 || agast::KeyPointY(kp) < 3 ||
-            agast::KeyPointX(kp) > l.cols() - 3 ||
-            agast::KeyPointY(kp) > l.rows() - 3) {
-          continue;
+  // Scores are only computed for the given keypoints if there are any.
+  const bool perform_2d_nonMax = keypoints->empty();
+
+  // Go through the octaves and intra layers and calculate fast corner scores.
+  // Each layer only touches its own image, scores and threshold map, so the
+  // layers are processed concurrently.
+  ParallelFor(layers_, numThreads_, 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      BriskLayer& l = pyramid_[i];
+
+      // Compute scores for given keypoints or extract new kepoints.
+      if (!perform_2d_nonMax) {
+        // Compute the location for this layer:
+        for (const agast::KeyPoint& keypoint : *keypoints) {
+          agast::KeyPoint kp = keypoint;
+          agast::KeyPointX(kp) =
+              (static_cast<float>(agast::KeyPointX(keypoint))) /
+              l.scale() - l.offset();
+          agast::KeyPointY(kp) =
+              (static_cast<float>(agast::KeyPointY(keypoint))) /
+              l.scale() - l.offset();
+          if (agast::KeyPointX(kp) < 3 || agast::KeyPointY(kp) < 3 ||
+              agast::KeyPointX(kp) > l.cols() - 3 ||
+              agast::KeyPointY(kp) > l.rows() - 3) {
+            continue;
+          }
+          // This calculates and stores the score of this keypoint in the
+          // score map.
+          l.GetAgastScore(agast::KeyPointX(kp), agast::KeyPointY(kp), 0);
+          agastPoints.at(i).push_back(kp);
         }
-        // This calculates and stores the score of this keypoint in the score map.
-        l.GetAgastScore(agast::KeyPointX(kp), agast::KeyPointY(kp), 0);
-        agastPoints.at(i).push_back(kp);
       }
-    }
 
-    l.GetAgastPoints(threshold_, &agastPoints[i]);
-  }
+      l.GetAgastPoints(threshold_, &agastPoints[i]);
+    }
+  }, taskRunner_);
 
   keypoints->clear();
 
@@ -0,0 +1,70 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdexcept>
+
+#include <glog/logging.h>
+
+#include <brisk/descriptor-buffer.h>
+
+namespace brisk {
+DescriptorBuffer::DescriptorBuffer(unsigned char* data, size_t stride,
+                                   size_t capacity, size_t alignment)
+    : data_(data),
+      stride_(stride),
+      capacity_(capacity),
+      size_(0) {
+  CHECK(data_ != nullptr || capacity_ == 0);
+  CHECK_GT(alignment, 0u);
+  CHECK_EQ(alignment & (alignment - 1), 0u) << "Alignment must be a power "
+      "of two.";
+  CHECK_EQ(reinterpret_cast<uintptr_t>(data_) % alignment, 0u)
+      << "Data is not aligned to " << alignment << " bytes.";
+  CHECK_EQ(stride_ % alignment, 0u)
+      << "Stride is not a multiple of the alignment " << alignment << ".";
+}
+
+unsigned char* DescriptorBuffer::Append(size_t count) {
+  if (count > available()) {
+    throw std::runtime_error("Descriptor buffer too small.");
+  }
+  unsigned char* first = Row(size_);
+  size_ += count;
+  return first;
+}
+}  // namespace brisk
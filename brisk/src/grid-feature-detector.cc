@@ -0,0 +1,267 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <agast/glog.h>
+#include <brisk/grid-feature-detector.h>
+
+namespace {
+// Keypoints of different cells are duplicates if they are closer than this
+// fraction of the smaller keypoint size and their sizes differ by less than
+// the ratio of neighboring layers.
+const float kDuplicateDistance = 0.125f;
+const float kDuplicateSizeRatio = 1.5f;
+
+// Suppresses all but the strongest of the duplicates at the borders of the
+// cells. borderDistances are the distances of the keypoints to the borders
+// their cells share with other cells. Ties go to the earlier keypoint.
+void SuppressDuplicates(const std::vector<size_t>& cells,
+                        const std::vector<float>& borderDistances,
+                        std::vector<agast::KeyPoint>* keypoints) {
+  CHECK_NOTNULL(keypoints);
+  float maxSize = 0.0f;
+  for (const agast::KeyPoint& keypoint : *keypoints) {
+    maxSize = std::max(maxSize, agast::KeyPointSize(keypoint));
+  }
+  const float maxDistance = kDuplicateDistance * maxSize;
+  // Only keypoints near a border can have duplicates in another cell.
+  std::vector<size_t> candidates;
+  for (size_t k = 0; k < keypoints->size(); ++k) {
+    if (borderDistances[k] < maxDistance)
+      candidates.push_back(k);
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [keypoints](size_t lhs, size_t rhs) {
+    return agast::KeyPointX((*keypoints)[lhs]) <
+        agast::KeyPointX((*keypoints)[rhs]);
+  });
+  std::vector<bool> suppressed(keypoints->size(), false);
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const agast::KeyPoint& first = (*keypoints)[candidates[i]];
+    for (size_t j = i + 1; j < candidates.size(); ++j) {
+      const agast::KeyPoint& second = (*keypoints)[candidates[j]];
+      const float dx = agast::KeyPointX(second) - agast::KeyPointX(first);
+      if (dx >= maxDistance)
+        break;
+      if (cells[candidates[i]] == cells[candidates[j]])
+        continue;
+      const float smallerSize = std::min(agast::KeyPointSize(first),
+                                         agast::KeyPointSize(second));
+      const float largerSize = std::max(agast::KeyPointSize(first),
+                                        agast::KeyPointSize(second));
+      if (largerSize >= kDuplicateSizeRatio * smallerSize)
+        continue;
+      const float dy = agast::KeyPointY(second) - agast::KeyPointY(first);
+      const float distance = kDuplicateDistance * smallerSize;
+      if (dx * dx + dy * dy >= distance * distance)
+        continue;
+      const float firstResponse = agast::KeyPointResponse(first);
+      const float secondResponse = agast::KeyPointResponse(second);
+      const bool firstIsWeaker = firstResponse != secondResponse ?
+          firstResponse < secondResponse : candidates[i] > candidates[j];
+      suppressed[firstIsWeaker ? candidates[i] : candidates[j]] = true;
+    }
+  }
+  size_t kept = 0;
+  for (size_t k = 0; k < keypoints->size(); ++k) {
+    if (!suppressed[k])
+      (*keypoints)[kept++] = (*keypoints)[k];
+  }
+  keypoints->resize(kept);
+}
+}  // namespace
+
+namespace brisk {
+GridFeatureDetector::GridFeatureDetector(size_t cellsX, size_t cellsY,
+                                         int threshold, int octaves,
+                                         int margin)
+    : cellsX_(cellsX),
+      cellsY_(cellsY),
+      octaves_(octaves),
+      margin_(margin),
+      numThreads_(1) {
+  CHECK_GT(cellsX, 0u);
+  CHECK_GT(cellsY, 0u);
+  CHECK_GE(margin, 0);
+  for (size_t cell = 0; cell < cellsX * cellsY; ++cell) {
+    // Every cell keeps the layers of its size between frames.
+    cells_.emplace_back(new BriskFeatureDetector(threshold, octaves));
+    cells_.back()->SetPersistentScaleSpace(true);
+  }
+}
+
+void GridFeatureDetector::SetNumThreads(size_t num_threads) {
+  CHECK_GT(num_threads, 0u);
+  numThreads_ = num_threads;
+}
+
+void GridFeatureDetector::SetTaskRunner(const TaskRunner& task_runner) {
+  taskRunner_ = task_runner;
+}
+
+void GridFeatureDetector::SetTargetNumKeypoints(size_t min_keypoints,
+                                                size_t max_keypoints) {
+  if (max_keypoints == 0) {
+    cellTargets_.reset();
+    for (std::unique_ptr<BriskFeatureDetector>& cell : cells_) {
+      cell->SetTargetNumKeypoints(0, 0);
+    }
+    return;
+  }
+  CHECK_LE(min_keypoints, max_keypoints);
+  cellTargets_.reset(new CellTargets);
+  cellTargets_->minKeypoints = min_keypoints;
+  cellTargets_->maxKeypoints = max_keypoints;
+  // Set for the first image.
+  cellTargets_->cols = 0;
+  cellTargets_->rows = 0;
+}
+
+int GridFeatureDetector::GetThreshold(size_t cellX, size_t cellY) const {
+  CHECK_LT(cellX, cellsX_);
+  CHECK_LT(cellY, cellsY_);
+  return cells_[cellY * cellsX_ + cellX]->GetThreshold();
+}
+
+GridFeatureDetector::CellRegion GridFeatureDetector::GetCellRegion(
+    size_t cell, int cols, int rows) const {
+  const int cellX = cell % cellsX_;
+  const int cellY = cell / cellsX_;
+  CellRegion region;
+  region.coreX0 = cellX * cols / cellsX_;
+  region.coreX1 = (cellX + 1) * cols / cellsX_;
+  region.coreY0 = cellY * rows / cellsY_;
+  region.coreY1 = (cellY + 1) * rows / cellsY_;
+  // The scale of the top layer is 1.5 * 2^(octaves - 1).
+  const int alignment = octaves_ > 0 ? 3 << (octaves_ - 1) : 1;
+  region.x0 = std::max(region.coreX0 - margin_, 0) / alignment * alignment;
+  region.y0 = std::max(region.coreY0 - margin_, 0) / alignment * alignment;
+  region.x1 = std::min(region.coreX1 + margin_, cols);
+  region.y1 = std::min(region.coreY1 + margin_, rows);
+  return region;
+}
+
+void GridFeatureDetector::UpdateCellTargets(int cols, int rows) const {
+  CHECK(cellTargets_);
+  std::lock_guard<std::mutex> lock(cellTargets_->mutex);
+  if (cellTargets_->cols == cols && cellTargets_->rows == rows)
+    return;
+  cellTargets_->cols = cols;
+  cellTargets_->rows = rows;
+  const double area = static_cast<double>(cols) * rows;
+  for (size_t cell = 0; cell < cells_.size(); ++cell) {
+    // The share of a cell includes the keypoints in its margins, which it
+    // detects but does not keep.
+    const CellRegion region = GetCellRegion(cell, cols, rows);
+    const double share = static_cast<double>(region.x1 - region.x0) *
+        (region.y1 - region.y0) / area;
+    const size_t maxKeypoints = std::max<size_t>(
+        1, std::ceil(cellTargets_->maxKeypoints * share));
+    const size_t minKeypoints = std::min<size_t>(
+        maxKeypoints, cellTargets_->minKeypoints * share);
+    cells_[cell]->SetTargetNumKeypoints(minKeypoints, maxKeypoints);
+  }
+}
+
+void GridFeatureDetector::detectImpl(const agast::Mat& image,
+                                     std::vector<agast::KeyPoint>& keypoints,
+                                     const agast::Mat& mask) const {
+  keypoints.clear();
+  if (image.empty())
+    return;
+  CHECK(mask.empty() || (mask.type() == CV_8UC1 && mask.rows == image.rows
+                         && mask.cols == image.cols));
+  if (cellTargets_) {
+    UpdateCellTargets(image.cols, image.rows);
+  }
+
+  // Detect the cells, keeping the keypoints in their cores.
+  std::vector<std::vector<agast::KeyPoint> > cellKeypoints(cells_.size());
+  std::vector<std::vector<float> > cellBorderDistances(cells_.size());
+  ParallelFor(cells_.size(), numThreads_, 1,
+              [&](size_t begin, size_t end) {
+    for (size_t cell = begin; cell < end; ++cell) {
+      const CellRegion region = GetCellRegion(cell, image.cols, image.rows);
+      const cv::Range rowRange(region.y0, region.y1);
+      const cv::Range colRange(region.x0, region.x1);
+      std::vector<agast::KeyPoint> detected;
+      cells_[cell]->detect(image(rowRange, colRange), detected,
+                           mask.empty() ? agast::Mat() :
+                               mask(rowRange, colRange));
+      std::vector<agast::KeyPoint>& kept = cellKeypoints[cell];
+      std::vector<float>& borderDistances = cellBorderDistances[cell];
+      for (agast::KeyPoint& keypoint : detected) {
+        const float x = agast::KeyPointX(keypoint) + region.x0;
+        const float y = agast::KeyPointY(keypoint) + region.y0;
+        if (x < region.coreX0 || x >= region.coreX1 || y < region.coreY0 ||
+            y >= region.coreY1)
+          continue;
+        agast::KeyPointX(keypoint) = x;
+        agast::KeyPointY(keypoint) = y;
+        kept.push_back(keypoint);
+        // The distance to the nearest border shared with another cell.
+        float distance = std::numeric_limits<float>::max();
+        if (region.coreX0 > 0)
+          distance = std::min(distance, x - region.coreX0);
+        if (region.coreY0 > 0)
+          distance = std::min(distance, y - region.coreY0);
+        if (region.coreX1 < image.cols)
+          distance = std::min(distance, region.coreX1 - x);
+        if (region.coreY1 < image.rows)
+          distance = std::min(distance, region.coreY1 - y);
+        borderDistances.push_back(distance);
+      }
+    }
+  }, taskRunner_);
+
+  std::vector<size_t> cells;
+  std::vector<float> borderDistances;
+  for (size_t cell = 0; cell < cells_.size(); ++cell) {
+    keypoints.insert(keypoints.end(), cellKeypoints[cell].begin(),
+                     cellKeypoints[cell].end());
+    cells.insert(cells.end(), cellKeypoints[cell].size(), cell);
+    borderDistances.insert(borderDistances.end(),
+                           cellBorderDistances[cell].begin(),
+                           cellBorderDistances[cell].end());
+  }
+  SuppressDuplicates(cells, borderDistances, &keypoints);
+}
+}  // namespace brisk
@@ -46,16 +46,56 @@
 #include <stdint.h>
 
 #include <brisk/harris-score-calculator.h>
+#include <brisk/internal/cpu-features.h>
+#include <brisk/internal/harris-scores-avx2.h>
 #include <brisk/internal/harris-scores.h>
 
 namespace brisk {
 
 void HarrisScoreCalculator::InitializeScores() {
-  HarrisScoresSSE(_img, _scores);
+  _lazyScores = false;
+  HarrisScoresSSE(_img, _scores, _numThreads, _taskRunner,
+                  &_productRows);
+}
+
+void HarrisScoreCalculator::DeferScores() {
+  if (_scores.rows != _img.rows || _scores.cols != _img.cols
+      || _scores.type() != CV_32S || !_scores.isContinuous()) {
+    _scores = agast::Mat(_img.rows, _img.cols, CV_32S);
+  }
+  _numBlocksX = (_img.cols + kScoreBlockSize - 1) / kScoreBlockSize;
+  _numBlocksY = (_img.rows + kScoreBlockSize - 1) / kScoreBlockSize;
+  _blockComputed.assign(_numBlocksX * _numBlocksY, 0);
+  _lazyScores = true;
+}
+
+void HarrisScoreCalculator::ComputeScoreBlock(int blockX, int blockY) {
+  const int x0 = blockX * kScoreBlockSize;
+  const int y0 = blockY * kScoreBlockSize;
+  HarrisScoresBlock(_img, x0, y0, std::min(x0 + kScoreBlockSize, _img.cols),
+                    std::min(y0 + kScoreBlockSize, _img.rows), &_scores);
+  _blockComputed[blockY * _numBlocksX + blockX] = 1;
+}
+
+void HarrisScoreCalculator::Scores(const double* u, const double* v,
+                                   size_t n, double* scores) {
+  if (_lazyScores) {
+    for (size_t i = 0; i < n; ++i) {
+      const int u_int = static_cast<int>(u[i]);
+      const int v_int = static_cast<int>(v[i]);
+      if (u_int + 1 < _scores.cols && v_int + 1 < _scores.rows && u_int >= 0
+          && v_int >= 0)
+        EnsureScores(u_int, v_int, u_int + 1, v_int + 1);
+    }
+  }
+  HarrisScoresBilinear(_scores, u, v, n, scores);
 }
 
 void HarrisScoreCalculator::Get2dMaxima(std::vector<PointWithScore>& points,  // NOLINT
                                         int absoluteThreshold) {
+  // The maxima are searched everywhere.
+  if (_lazyScores)
+    InitializeScores();
   // Do the 8-neighbor nonmax suppression.
   const int stride = _scores.cols;
   const int rows_end = _scores.rows - 2;
@@ -64,6 +104,9 @@ void HarrisScoreCalculator::Get2dMaxima(std::vector<PointWithScore>& points,  //
     const int* p = &_scores.at<int>(j, 2);
     const int* const p_begin = p;
     const int* const p_end = &_scores.at<int>(j, stride - 2);
+    // Starts at the same column as p.
+    const unsigned char* mask_p =
+        _mask.empty() ? 0 : &_mask.at<unsigned char>(j, 2);
     bool last = false;
     while (p < p_end) {
       const int center = *p;
@@ -73,6 +116,8 @@ void HarrisScoreCalculator::Get2dMaxima(std::vector<PointWithScore>& points,  //
         last = false;
         continue;
       }
+      if (mask_p != 0 && mask_p[center_p - p_begin] == 0)
+        continue;
       if (center < absoluteThreshold)
         continue;
       if (*(center_p + 1) > center)
@@ -108,6 +153,10 @@ void HarrisScoreCalculator::Get2dMaxima(std::vector<PointWithScore>& points,  //
 // X and Y denote the size of the mask.
 void HarrisScoreCalculator::GetCovarEntries(const agast::Mat& src, agast::Mat& dxdx,
                                             agast::Mat& dydy, agast::Mat& dxdy) {
+  if (CpuSupportsAvx2()) {
+    GetCovarEntriesAvx2(src, dxdx, dydy, dxdy);
+    return;
+  }
   // Sanity check.
   assert(src.type() == CV_8U);
   agast::Mat kernel = agast::Mat::zeros(3, 3, CV_16S);
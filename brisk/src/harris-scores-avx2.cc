@@ -0,0 +1,319 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __ARM_NEON
+#include <immintrin.h>
+#endif  // __ARM_NEON
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include <brisk/internal/harris-scores-avx2.h>
+
+namespace brisk {
+#ifdef __ARM_NEON
+void HarrisProductsRowAvx2(const unsigned char*, int, int, int, int16_t*,
+                           int16_t*, int16_t*) {
+  // Not implemented.
+  LOG(FATAL) << "AVX2 is not available on this platform.";
+}
+
+void HarrisScoresRowAvx2(const int16_t* const[3], const int16_t* const[3],
+                         const int16_t* const[3], int, int*) {
+  // Not implemented.
+  LOG(FATAL) << "AVX2 is not available on this platform.";
+}
+
+void GetCovarEntriesAvx2(const agast::Mat&, agast::Mat&, agast::Mat&,
+                         agast::Mat&) {
+  // Not implemented.
+  LOG(FATAL) << "AVX2 is not available on this platform.";
+}
+
+void HarrisScoresBilinearAvx2(const agast::Mat&, const double*, const double*,
+                              size_t, double*) {
+  // Not implemented.
+  LOG(FATAL) << "AVX2 is not available on this platform.";
+}
+#else
+namespace {
+// Sixteen pixels widened to 16 bit.
+__attribute__((target("avx2")))
+inline __m256i LoadPixels(const unsigned char* p) {
+  return _mm256_cvtepu8_epi16(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+__attribute__((target("avx2")))
+inline void Store(int16_t* p, __m256i value) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), value);
+}
+
+// Vertical [1 2 1] sums of the gradient products in the eight columns from j
+// on, in 32 bit.
+__attribute__((target("avx2")))
+inline __m256i VerticalSum(const int16_t* const rows[3], int j) {
+  const __m256i above = _mm256_cvtepi16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[0] + j)));
+  const __m256i center = _mm256_cvtepi16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[1] + j)));
+  const __m256i below = _mm256_cvtepi16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[2] + j)));
+  return _mm256_add_epi32(_mm256_add_epi32(above, below),
+                          _mm256_slli_epi32(center, 1));
+}
+
+// The 3x3 Gaussian is separable: the [1 2 1] of the vertical sums.
+__attribute__((target("avx2")))
+inline __m256i Smooth(const int16_t* const rows[3], int j) {
+  const __m256i left = VerticalSum(rows, j - 1);
+  const __m256i center = VerticalSum(rows, j);
+  const __m256i right = VerticalSum(rows, j + 1);
+  return _mm256_srai_epi32(
+      _mm256_add_epi32(_mm256_add_epi32(left, right),
+                       _mm256_slli_epi32(center, 1)), 4);
+}
+}  // namespace
+
+// Works on sixteen pixels at a time like the SSE kernel, but widens them
+// instead of splitting them into even and odd pixels.
+__attribute__((target("avx2")))
+void HarrisProductsRowAvx2(const unsigned char* data, int stride, int cols,
+                           int i, int16_t* dxdx, int16_t* dxdy,
+                           int16_t* dydy) {
+  CHECK_GE(cols, 18);
+  const unsigned char* const above = data + (i - 1) * stride;
+  const unsigned char* const row = data + i * stride;
+  const unsigned char* const below = data + (i + 1) * stride;
+  const int maxJ = cols - 1 - 16;
+  const __m256i const_3_epi16 = _mm256_set1_epi16(3);
+  const __m256i const_10_epi16 = _mm256_set1_epi16(10);
+
+  bool end = false;
+  for (int j = 1; j < cols - 1;) {
+    const __m256i src_m1_m1 = LoadPixels(above + j - 1);
+    const __m256i src_m1_0 = LoadPixels(above + j);
+    const __m256i src_m1_p1 = LoadPixels(above + j + 1);
+    const __m256i src_0_m1 = LoadPixels(row + j - 1);
+    const __m256i src_0_p1 = LoadPixels(row + j + 1);
+    const __m256i src_p1_m1 = LoadPixels(below + j - 1);
+    const __m256i src_p1_0 = LoadPixels(below + j);
+    const __m256i src_p1_p1 = LoadPixels(below + j + 1);
+
+    // Scharr x.
+    const __m256i dx = _mm256_slli_epi16(
+        _mm256_add_epi16(
+            _mm256_add_epi16(
+                _mm256_mullo_epi16(const_10_epi16,
+                                   _mm256_sub_epi16(src_0_m1, src_0_p1)),
+                _mm256_mullo_epi16(const_3_epi16,
+                                   _mm256_sub_epi16(src_m1_m1, src_m1_p1))),
+            _mm256_mullo_epi16(const_3_epi16,
+                               _mm256_sub_epi16(src_p1_m1, src_p1_p1))),
+        3);
+    // Scharr y.
+    const __m256i dy = _mm256_slli_epi16(
+        _mm256_add_epi16(
+            _mm256_add_epi16(
+                _mm256_mullo_epi16(const_10_epi16,
+                                   _mm256_sub_epi16(src_m1_0, src_p1_0)),
+                _mm256_mullo_epi16(const_3_epi16,
+                                   _mm256_sub_epi16(src_m1_m1, src_p1_m1))),
+            _mm256_mullo_epi16(const_3_epi16,
+                               _mm256_sub_epi16(src_m1_p1, src_p1_p1))),
+        3);
+
+    Store(dxdx + j, _mm256_mulhi_epi16(dx, dx));
+    Store(dxdy + j, _mm256_mulhi_epi16(dx, dy));
+    Store(dydy + j, _mm256_mulhi_epi16(dy, dy));
+
+    j += 16;
+    if (j > maxJ && !end) {
+      j = cols - 1 - 16;
+      end = true;
+    }
+  }
+}
+
+__attribute__((target("avx2")))
+void HarrisScoresRowAvx2(const int16_t* const dxdxRows[3],
+                         const int16_t* const dxdyRows[3],
+                         const int16_t* const dydyRows[3], int cols,
+                         int* scores) {
+  CHECK_GE(cols, 12);
+  scores[0] = scores[1] = 0;
+  for (int j = 2; j < cols - 2; j += 8) {
+    // The last eight scores overlap the ones before.
+    j = std::min(j, cols - 10);
+    const __m256i dxdx = Smooth(dxdxRows, j);
+    const __m256i dxdy = Smooth(dxdyRows, j);
+    const __m256i dydy = Smooth(dydyRows, j);
+    const __m256i trace_div_by_2 = _mm256_srai_epi32(
+        _mm256_add_epi32(dxdx, dydy), 1);
+    const __m256i score = _mm256_sub_epi32(
+        _mm256_sub_epi32(_mm256_mullo_epi32(dxdx, dydy),
+                         _mm256_mullo_epi32(dxdy, dxdy)),
+        _mm256_srai_epi32(_mm256_mullo_epi32(trace_div_by_2, trace_div_by_2),
+                          2));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(scores + j), score);
+  }
+  scores[cols - 2] = scores[cols - 1] = 0;
+}
+
+__attribute__((target("avx2")))
+void GetCovarEntriesAvx2(const agast::Mat& src, agast::Mat& dxdx,
+                         agast::Mat& dydy, agast::Mat& dxdy) {
+  CHECK_EQ(src.type(), CV_8U);
+  // Dest will be 16 bit.
+  dxdx = agast::Mat::zeros(src.rows, src.cols, CV_16S);
+  dydy = agast::Mat::zeros(src.rows, src.cols, CV_16S);
+  dxdy = agast::Mat::zeros(src.rows, src.cols, CV_16S);
+
+  const unsigned int maxJ = ((src.cols - 2) / 16) * 16;
+  const unsigned int maxI = src.rows - 2;
+  const unsigned int stride = src.cols;
+  // The Scharr kernel, times 8.
+  const __m256i const_24_epi16 = _mm256_set1_epi16(3 * 8);
+  const __m256i const_80_epi16 = _mm256_set1_epi16(10 * 8);
+
+  for (unsigned int i = 0; i < maxI; ++i) {
+    bool end = false;
+    for (unsigned int j = 0; j < maxJ;) {
+      const unsigned char* p = src.data + stride * i + j;
+      const __m256i src_0_0 = LoadPixels(p);
+      const __m256i src_0_1 = LoadPixels(p + 1);
+      const __m256i src_0_2 = LoadPixels(p + 2);
+      const __m256i src_1_0 = LoadPixels(p + stride);
+      const __m256i src_1_2 = LoadPixels(p + stride + 2);
+      const __m256i src_2_0 = LoadPixels(p + 2 * stride);
+      const __m256i src_2_1 = LoadPixels(p + 2 * stride + 1);
+      const __m256i src_2_2 = LoadPixels(p + 2 * stride + 2);
+
+      const __m256i dx = _mm256_add_epi16(
+          _mm256_add_epi16(
+              _mm256_mullo_epi16(const_24_epi16,
+                                 _mm256_sub_epi16(src_0_0, src_0_2)),
+              _mm256_mullo_epi16(const_80_epi16,
+                                 _mm256_sub_epi16(src_1_0, src_1_2))),
+          _mm256_mullo_epi16(const_24_epi16,
+                             _mm256_sub_epi16(src_2_0, src_2_2)));
+      const __m256i dy = _mm256_add_epi16(
+          _mm256_add_epi16(
+              _mm256_mullo_epi16(const_24_epi16,
+                                 _mm256_sub_epi16(src_0_0, src_2_0)),
+              _mm256_mullo_epi16(const_80_epi16,
+                                 _mm256_sub_epi16(src_0_1, src_2_1))),
+          _mm256_mullo_epi16(const_24_epi16,
+                             _mm256_sub_epi16(src_0_2, src_2_2)));
+
+      // Calculate covariance entries - remove precision (ends up being 4 bit),
+      // then remove 4 more bits.
+      const size_t offset = stride * (i + 1) + 1 + j;
+      Store(reinterpret_cast<int16_t*>(dxdx.data) + offset,
+            _mm256_srai_epi16(_mm256_mulhi_epi16(dx, dx), 4));
+      Store(reinterpret_cast<int16_t*>(dydy.data) + offset,
+            _mm256_srai_epi16(_mm256_mulhi_epi16(dy, dy), 4));
+      Store(reinterpret_cast<int16_t*>(dxdy.data) + offset,
+            _mm256_srai_epi16(_mm256_mulhi_epi16(dy, dx), 4));
+
+      // Take care about end.
+      j += 16;
+      if (j >= maxJ && !end) {
+        j = stride - 2 - 16;
+        end = true;
+      }
+    }
+  }
+}
+
+__attribute__((target("avx2")))
+void HarrisScoresBilinearAvx2(const agast::Mat& scores, const double* u,
+                              const double* v, size_t n,
+                              double* interpolated) {
+  CHECK_EQ(scores.type(), CV_32S);
+  CHECK_EQ(n % 4, 0u);
+  const int* const data = reinterpret_cast<const int*>(scores.data);
+  const int stride = scores.step[0] / sizeof(int);
+  const __m128i stride_epi32 = _mm_set1_epi32(stride);
+  const __m128i max_u_epi32 = _mm_set1_epi32(scores.cols - 1);
+  const __m128i max_v_epi32 = _mm_set1_epi32(scores.rows - 1);
+  const __m128i zero = _mm_setzero_si128();
+  const __m256d one = _mm256_set1_pd(1.0);
+  for (size_t i = 0; i < n; i += 4) {
+    const __m256d u_pd = _mm256_loadu_pd(u + i);
+    const __m256d v_pd = _mm256_loadu_pd(v + i);
+    // Truncated like the static_cast to int.
+    const __m128i u_int = _mm256_cvttpd_epi32(u_pd);
+    const __m128i v_int = _mm256_cvttpd_epi32(v_pd);
+    const __m128i inside = _mm_andnot_si128(
+        _mm_or_si128(_mm_cmplt_epi32(u_int, zero),
+                     _mm_cmplt_epi32(v_int, zero)),
+        _mm_and_si128(_mm_cmpgt_epi32(max_u_epi32, u_int),
+                      _mm_cmpgt_epi32(max_v_epi32, v_int)));
+
+    // Only the points inside are loaded.
+    const __m128i index = _mm_add_epi32(_mm_mullo_epi32(v_int, stride_epi32),
+                                        u_int);
+    const __m256d s_0_0 = _mm256_cvtepi32_pd(
+        _mm_mask_i32gather_epi32(zero, data, index, inside, 4));
+    const __m256d s_0_1 = _mm256_cvtepi32_pd(
+        _mm_mask_i32gather_epi32(zero, data + 1, index, inside, 4));
+    const __m256d s_1_0 = _mm256_cvtepi32_pd(
+        _mm_mask_i32gather_epi32(zero, data + stride, index, inside, 4));
+    const __m256d s_1_1 = _mm256_cvtepi32_pd(
+        _mm_mask_i32gather_epi32(zero, data + stride + 1, index, inside, 4));
+
+    // The same operations in the same order as the scalar interpolation,
+    // without fused multiply-adds, so the results are identical.
+    const __m256d ru = _mm256_sub_pd(u_pd, _mm256_cvtepi32_pd(u_int));
+    const __m256d rv = _mm256_sub_pd(v_pd, _mm256_cvtepi32_pd(v_int));
+    const __m256d oneMinus_ru = _mm256_sub_pd(one, ru);
+    const __m256d oneMinus_rv = _mm256_sub_pd(one, rv);
+    const __m256d top = _mm256_add_pd(_mm256_mul_pd(oneMinus_ru, s_0_0),
+                                      _mm256_mul_pd(ru, s_0_1));
+    const __m256d bottom = _mm256_add_pd(_mm256_mul_pd(oneMinus_ru, s_1_0),
+                                         _mm256_mul_pd(ru, s_1_1));
+    const __m256d result = _mm256_add_pd(_mm256_mul_pd(oneMinus_rv, top),
+                                         _mm256_mul_pd(rv, bottom));
+    _mm256_storeu_pd(
+        interpolated + i,
+        _mm256_and_pd(result,
+                      _mm256_castsi256_pd(_mm256_cvtepi32_epi64(inside))));
+  }
+}
+#endif  // __ARM_NEON
+}  // namespace brisk
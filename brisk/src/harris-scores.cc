@@ -43,239 +43,438 @@
 #else
 #include <emmintrin.h>
 #include <stdint.h>
+#include <string.h>
 #include <tmmintrin.h>
+#include <algorithm>
+#include <vector>
 
+#include <glog/logging.h>
+
+#include <brisk/internal/cpu-features.h>
+#include <brisk/internal/harris-scores-avx2.h>
 #include <brisk/internal/harris-scores.h>
 
 namespace brisk {
-// This is a straightforward harris corner implementation.
-// This is REALLY bad, it performs so many passes through the data...
-void HarrisScoresSSE(const agast::Mat& src, agast::Mat& scores) {
-  const int cols = src.cols;
-  const int rows = src.rows;
-  const int stride = src.step[0];
-  const int maxJ = cols - 1 - 16;
+namespace {
+// Below this, a stripe is not worth a thread.
+const size_t kMinRowsPerThread = 32;
 
-  // Allocate stuff.
-  int16_t *DxDx1, *DyDy1, *DxDy1;
-  scores = agast::Mat::zeros(rows, cols, CV_32S);
-  DxDx1 = new int16_t[rows * cols];
-  DxDy1 = new int16_t[rows * cols];
-  DyDy1 = new int16_t[rows * cols];
+// Scharr gradient products of row i, stored to the columns [1, cols - 1).
+void HarrisProductsRow(const unsigned char* data, int stride, int cols, int i,
+                       int16_t* DxDx1, int16_t* DxDy1, int16_t* DyDy1) {
+  const int maxJ = cols - 1 - 16;
 
   // Masks.
-  __m128i mask_lo = _mm_set_epi8(0, -1, 0, -1, 0, -1, 0, -1,
-                                 0, -1, 0, -1, 0, -1, 0, -1);
-  __m128i mask_hi = _mm_set_epi8(-1, 0, -1, 0, -1, 0, -1, 0,
-                                 -1, 0, -1, 0, -1, 0, -1, 0);
+  const __m128i mask_lo = _mm_set_epi8(0, -1, 0, -1, 0, -1, 0, -1,
+                                       0, -1, 0, -1, 0, -1, 0, -1);
+  const __m128i mask_hi = _mm_set_epi8(-1, 0, -1, 0, -1, 0, -1, 0,
+                                       -1, 0, -1, 0, -1, 0, -1, 0);
 
   // Consts.
-  __m128i const_3_epi16 = _mm_set_epi16(3, 3, 3, 3, 3, 3, 3, 3);
-  __m128i const_10_epi16 = _mm_set_epi16(10, 10, 10, 10, 10, 10, 10, 10);
+  const __m128i const_3_epi16 = _mm_set_epi16(3, 3, 3, 3, 3, 3, 3, 3);
+  const __m128i const_10_epi16 = _mm_set_epi16(10, 10, 10, 10, 10, 10, 10,
+                                               10);
+
+  bool end = false;
+  for (int j = 1; j < cols - 1;) {
+    // Load.
+    const __m128i src_m1_m1 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(data + (i - 1) * stride + j - 1));
+    const __m128i src_m1_0 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(data + (i - 1) * stride + j));
+    const __m128i src_m1_p1 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(data + (i - 1) * stride + j + 1));
+    const __m128i src_0_m1 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(data + (i) * stride + j - 1));
+    const __m128i src_0_p1 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(data + (i) * stride + j + 1));
+    const __m128i src_p1_m1 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(data + (i + 1) * stride + j - 1));
+    const __m128i src_p1_0 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(data + (i + 1) * stride + j));
+    const __m128i src_p1_p1 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(data + (i + 1) * stride + j + 1));
 
-  // Calculate gradients and products.
+    // Scharr x.
+    const __m128i dx_lo = _mm_slli_epi16(
+        _mm_add_epi16(
+            _mm_add_epi16(
+                _mm_mullo_epi16(
+                    const_10_epi16,
+                    _mm_sub_epi16(_mm_and_si128(mask_lo, src_0_m1),
+                                  _mm_and_si128(mask_lo, src_0_p1))),
+                _mm_mullo_epi16(
+                    const_3_epi16,
+                    _mm_sub_epi16(_mm_and_si128(mask_lo, src_m1_m1),
+                                  _mm_and_si128(mask_lo, src_m1_p1)))),
+            _mm_mullo_epi16(
+                const_3_epi16,
+                _mm_sub_epi16(_mm_and_si128(mask_lo, src_p1_m1),
+                              _mm_and_si128(mask_lo, src_p1_p1)))),
+        3);
+    const __m128i dx_hi = _mm_slli_epi16(
+        _mm_add_epi16(
+            _mm_add_epi16(
+                _mm_mullo_epi16(
+                    const_10_epi16,
+                    _mm_sub_epi16(
+                        _mm_srli_si128(_mm_and_si128(mask_hi, src_0_m1), 1),
+                        _mm_srli_si128(_mm_and_si128(mask_hi, src_0_p1), 1))),
+                _mm_mullo_epi16(
+                    const_3_epi16,
+                    _mm_sub_epi16(
+                        _mm_srli_si128(_mm_and_si128(mask_hi, src_m1_m1), 1),
+                        _mm_srli_si128(_mm_and_si128(mask_hi, src_m1_p1),
+                                       1)))),
+            _mm_mullo_epi16(
+                const_3_epi16,
+                _mm_sub_epi16(
+                    _mm_srli_si128(_mm_and_si128(mask_hi, src_p1_m1), 1),
+                    _mm_srli_si128(_mm_and_si128(mask_hi, src_p1_p1), 1)))),
+                    3);
+
+    // Scharr y.
+    const __m128i dy_lo = _mm_slli_epi16(
+        _mm_add_epi16(
+            _mm_add_epi16(
+                _mm_mullo_epi16(
+                    const_10_epi16,
+                    _mm_sub_epi16(_mm_and_si128(mask_lo, src_m1_0),
+                                  _mm_and_si128(mask_lo, src_p1_0))),
+                _mm_mullo_epi16(
+                    const_3_epi16,
+                    _mm_sub_epi16(_mm_and_si128(mask_lo, src_m1_m1),
+                                  _mm_and_si128(mask_lo, src_p1_m1)))),
+            _mm_mullo_epi16(
+                const_3_epi16,
+                _mm_sub_epi16(_mm_and_si128(mask_lo, src_m1_p1),
+                              _mm_and_si128(mask_lo, src_p1_p1)))),
+        3);
+    const __m128i dy_hi = _mm_slli_epi16(
+        _mm_add_epi16(
+            _mm_add_epi16(
+                _mm_mullo_epi16(
+                    const_10_epi16,
+                    _mm_sub_epi16(
+                        _mm_srli_si128(_mm_and_si128(mask_hi, src_m1_0), 1),
+                        _mm_srli_si128(_mm_and_si128(mask_hi, src_p1_0), 1))),
+                _mm_mullo_epi16(
+                    const_3_epi16,
+                    _mm_sub_epi16(
+                        _mm_srli_si128(_mm_and_si128(mask_hi, src_m1_m1), 1),
+                        _mm_srli_si128(_mm_and_si128(mask_hi, src_p1_m1),
+                                       1)))),
+            _mm_mullo_epi16(
+                const_3_epi16,
+                _mm_sub_epi16(
+                    _mm_srli_si128(_mm_and_si128(mask_hi, src_m1_p1), 1),
+                    _mm_srli_si128(_mm_and_si128(mask_hi, src_p1_p1), 1)))),
+        3);
+
+    // Calculate dxdx dxdy dydy - since we have technically still chars, we
+    // only need the lo part.
+    const __m128i i_lo_dx_dx = _mm_mulhi_epi16(dx_lo, dx_lo);
+    const __m128i i_lo_dy_dy = _mm_mulhi_epi16(dy_lo, dy_lo);
+    const __m128i i_lo_dx_dy = _mm_mulhi_epi16(dx_lo, dy_lo);
+    const __m128i i_hi_dx_dx = _mm_mulhi_epi16(dx_hi, dx_hi);
+    const __m128i i_hi_dy_dy = _mm_mulhi_epi16(dy_hi, dy_hi);
+    const __m128i i_hi_dx_dy = _mm_mulhi_epi16(dx_hi, dy_hi);
+
+    // Unpack - interleave, store.
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(DxDx1 + j),
+                     _mm_unpacklo_epi16(i_lo_dx_dx, i_hi_dx_dx));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(DxDx1 + j + 8),
+                     _mm_unpackhi_epi16(i_lo_dx_dx, i_hi_dx_dx));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(DxDy1 + j),
+                     _mm_unpacklo_epi16(i_lo_dx_dy, i_hi_dx_dy));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(DxDy1 + j + 8),
+                     _mm_unpackhi_epi16(i_lo_dx_dy, i_hi_dx_dy));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(DyDy1 + j),
+                     _mm_unpacklo_epi16(i_lo_dy_dy, i_hi_dy_dy));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(DyDy1 + j + 8),
+                     _mm_unpackhi_epi16(i_lo_dy_dy, i_hi_dy_dy));
+
+    j += 16;
+    if (j > maxJ && !end) {
+      j = cols - 1 - 16;
+      end = true;
+    }
+  }
+}
+
+// 3x3 Gaussian smoothing of a gradient product at column j, from the rows
+// above, at and below.
+inline int Smooth(const int16_t* const rows[3], int j) {
+  const int center = rows[1][j];
+  const int edges = rows[0][j] + rows[2][j] + rows[1][j - 1] + rows[1][j + 1];
+  const int corners = rows[0][j - 1] + rows[0][j + 1] + rows[2][j - 1]
+      + rows[2][j + 1];
+  return (4 * center + 2 * edges + corners) >> 4;
+}
+
+// The Harris score at column j of the smoothed gradient products.
+inline int HarrisResponse(const int16_t* const dxdxRows[3],
+                          const int16_t* const dxdyRows[3],
+                          const int16_t* const dydyRows[3], int j) {
+  const int dxdx = Smooth(dxdxRows, j);
+  const int dxdy = Smooth(dxdyRows, j);
+  const int dydy = Smooth(dydyRows, j);
+  const int trace_div_by_2 = (dxdx + dydy) >> 1;
+  return (dxdx * dydy - dxdy * dxdy)
+      - ((trace_div_by_2 * trace_div_by_2) >> 2);
+}
+
+// Harris scores of a row, from the gradient products of the rows above, at
+// and below. The two border columns on either side are zero.
+void HarrisScoresRow(const int16_t* const dxdxRows[3],
+                     const int16_t* const dxdyRows[3],
+                     const int16_t* const dydyRows[3], int cols, int* scores) {
+  scores[0] = scores[1] = 0;
+  for (int j = 2; j < cols - 2; j++) {
+    scores[j] = HarrisResponse(dxdxRows, dxdyRows, dydyRows, j);
+  }
+  scores[cols - 2] = scores[cols - 1] = 0;
+}
+
+// The gradient products of the pixel at p, like HarrisProductsRow.
+inline void HarrisProducts(const unsigned char* p, int stride, int16_t* dxdx,
+                           int16_t* dxdy, int16_t* dydy) {
+  const int dx = (10 * (p[-1] - p[1]) + 3 * (p[-stride - 1] - p[-stride + 1])
+      + 3 * (p[stride - 1] - p[stride + 1])) * 8;
+  const int dy = (10 * (p[-stride] - p[stride])
+      + 3 * (p[-stride - 1] - p[stride - 1])
+      + 3 * (p[-stride + 1] - p[stride + 1])) * 8;
+  // The high halves of the 16 bit products.
+  *dxdx = (dx * dx) >> 16;
+  *dxdy = (dx * dy) >> 16;
+  *dydy = (dy * dy) >> 16;
+}
+
+// HarrisProductsRow for rows narrower than its 16 columns plus the border,
+// which it would store before and past.
+const int kMinProductsRowCols = 18;
+void HarrisProductsRowNarrow(const unsigned char* data, int stride, int cols,
+                             int i, int16_t* dxdx, int16_t* dxdy,
+                             int16_t* dydy) {
+  const unsigned char* const row = data + i * stride;
+  for (int j = 1; j < cols - 1; ++j) {
+    HarrisProducts(row + j, stride, dxdx + j, dxdy + j, dydy + j);
+  }
+}
+
+// This is a straightforward harris corner implementation, fused into a
+// single pass over the rows [rowBegin, rowEnd), which must lie within
+// [2, rows - 2): each row computes the gradient products of the row below
+// it and then its scores. Only the last three rows of products are kept, in
+// a ring of kRingRows * 3 rows that is small enough to stay in the cache.
+const int kRingRows = 3;
+void HarrisScoresRows(const agast::Mat& src, int rowBegin, int rowEnd,
+                      int16_t* ring, agast::Mat* scores) {
+  const int cols = src.cols;
+  const int stride = src.step[0];
   const unsigned char* data = src.data;
-  for (int i = 1; i < rows - 1; ++i) {
-    bool end = false;
-    for (int j = 1; j < cols - 1;) {
-      // Load.
-      const __m128i src_m1_m1 = _mm_loadu_si128(
-          reinterpret_cast<const __m128i *>(data + (i - 1) * stride + j - 1));
-      const __m128i src_m1_0 = _mm_loadu_si128(
-          reinterpret_cast<const __m128i *>(data + (i - 1) * stride + j));
-      const __m128i src_m1_p1 = _mm_loadu_si128(
-          reinterpret_cast<const __m128i *>(data + (i - 1) * stride + j + 1));
-      const __m128i src_0_m1 = _mm_loadu_si128(
-          reinterpret_cast<const __m128i *>(data + (i) * stride + j - 1));
-      const __m128i src_0_p1 = _mm_loadu_si128(
-          reinterpret_cast<const __m128i *>(data + (i) * stride + j + 1));
-      const __m128i src_p1_m1 = _mm_loadu_si128(
-          reinterpret_cast<const __m128i *>(data + (i + 1) * stride + j - 1));
-      const __m128i src_p1_0 = _mm_loadu_si128(
-          reinterpret_cast<const __m128i *>(data + (i + 1) * stride + j));
-      const __m128i src_p1_p1 = _mm_loadu_si128(
-          reinterpret_cast<const __m128i *>(data + (i + 1) * stride + j + 1));
-
-      // Scharr x.
-      const __m128i dx_lo = _mm_slli_epi16(
-          _mm_add_epi16(
-              _mm_add_epi16(
-                  _mm_mullo_epi16(
-                      const_10_epi16,
-                      _mm_sub_epi16(_mm_and_si128(mask_lo, src_0_m1),
-                                    _mm_and_si128(mask_lo, src_0_p1))),
-                  _mm_mullo_epi16(
-                      const_3_epi16,
-                      _mm_sub_epi16(_mm_and_si128(mask_lo, src_m1_m1),
-                                    _mm_and_si128(mask_lo, src_m1_p1)))),
-              _mm_mullo_epi16(
-                  const_3_epi16,
-                  _mm_sub_epi16(_mm_and_si128(mask_lo, src_p1_m1),
-                                _mm_and_si128(mask_lo, src_p1_p1)))),
-          3);
-      const __m128i dx_hi = _mm_slli_epi16(
-          _mm_add_epi16(
-              _mm_add_epi16(
-                  _mm_mullo_epi16(
-                      const_10_epi16,
-                      _mm_sub_epi16(
-                          _mm_srli_si128(_mm_and_si128(mask_hi, src_0_m1), 1),
-                          _mm_srli_si128(_mm_and_si128(mask_hi, src_0_p1), 1))),
-                  _mm_mullo_epi16(
-                      const_3_epi16,
-                      _mm_sub_epi16(
-                          _mm_srli_si128(_mm_and_si128(mask_hi, src_m1_m1), 1),
-                          _mm_srli_si128(_mm_and_si128(mask_hi, src_m1_p1),
-                                         1)))),
-              _mm_mullo_epi16(
-                  const_3_epi16,
-                  _mm_sub_epi16(
-                      _mm_srli_si128(_mm_and_si128(mask_hi, src_p1_m1), 1),
-                      _mm_srli_si128(_mm_and_si128(mask_hi, src_p1_p1), 1)))),
-                      3);
-
-      // Scharr y.
-      const __m128i dy_lo = _mm_slli_epi16(
-          _mm_add_epi16(
-              _mm_add_epi16(
-                  _mm_mullo_epi16(
-                      const_10_epi16,
-                      _mm_sub_epi16(_mm_and_si128(mask_lo, src_m1_0),
-                                    _mm_and_si128(mask_lo, src_p1_0))),
-                  _mm_mullo_epi16(
-                      const_3_epi16,
-                      _mm_sub_epi16(_mm_and_si128(mask_lo, src_m1_m1),
-                                    _mm_and_si128(mask_lo, src_p1_m1)))),
-              _mm_mullo_epi16(
-                  const_3_epi16,
-                  _mm_sub_epi16(_mm_and_si128(mask_lo, src_m1_p1),
-                                _mm_and_si128(mask_lo, src_p1_p1)))),
-          3);
-      const __m128i dy_hi = _mm_slli_epi16(
-          _mm_add_epi16(
-              _mm_add_epi16(
-                  _mm_mullo_epi16(
-                      const_10_epi16,
-                      _mm_sub_epi16(
-                          _mm_srli_si128(_mm_and_si128(mask_hi, src_m1_0), 1),
-                          _mm_srli_si128(_mm_and_si128(mask_hi, src_p1_0), 1))),
-                  _mm_mullo_epi16(
-                      const_3_epi16,
-                      _mm_sub_epi16(
-                          _mm_srli_si128(_mm_and_si128(mask_hi, src_m1_m1), 1),
-                          _mm_srli_si128(_mm_and_si128(mask_hi, src_p1_m1),
-                                         1)))),
-              _mm_mullo_epi16(
-                  const_3_epi16,
-                  _mm_sub_epi16(
-                      _mm_srli_si128(_mm_and_si128(mask_hi, src_m1_p1), 1),
-                      _mm_srli_si128(_mm_and_si128(mask_hi, src_p1_p1), 1)))),
-          3);
-
-      // Calculate dxdx dxdy dydy - since we have technically still chars, we
-      // only need the lo part.
-      const __m128i i_lo_dx_dx = _mm_mulhi_epi16(dx_lo, dx_lo);
-      const __m128i i_lo_dy_dy = _mm_mulhi_epi16(dy_lo, dy_lo);
-      const __m128i i_lo_dx_dy = _mm_mulhi_epi16(dx_lo, dy_lo);
-      const __m128i i_hi_dx_dx = _mm_mulhi_epi16(dx_hi, dx_hi);
-      const __m128i i_hi_dy_dy = _mm_mulhi_epi16(dy_hi, dy_hi);
-      const __m128i i_hi_dx_dy = _mm_mulhi_epi16(dx_hi, dy_hi);
-
-      // Unpack - interleave, store.
-      _mm_storeu_si128(reinterpret_cast<__m128i *>(DxDx1 + i * cols + j),
-                       _mm_unpacklo_epi16(i_lo_dx_dx, i_hi_dx_dx));
-      _mm_storeu_si128(reinterpret_cast<__m128i *>(DxDx1 + i * cols + j + 8),
-                       _mm_unpackhi_epi16(i_lo_dx_dx, i_hi_dx_dx));
-      _mm_storeu_si128(reinterpret_cast<__m128i *>(DxDy1 + i * cols + j),
-                       _mm_unpacklo_epi16(i_lo_dx_dy, i_hi_dx_dy));
-      _mm_storeu_si128(reinterpret_cast<__m128i *>(DxDy1 + i * cols + j + 8),
-                       _mm_unpackhi_epi16(i_lo_dx_dy, i_hi_dx_dy));
-      _mm_storeu_si128(reinterpret_cast<__m128i *>(DyDy1 + i * cols + j),
-                       _mm_unpacklo_epi16(i_lo_dy_dy, i_hi_dy_dy));
-      _mm_storeu_si128(reinterpret_cast<__m128i *>(DyDy1 + i * cols + j + 8),
-                       _mm_unpackhi_epi16(i_lo_dy_dy, i_hi_dy_dy));
-
-      j += 16;
-      if (j > maxJ && !end) {
-        j = cols - 1 - 16;
-        end = true;
+  // All kernels give the same results. The vector products kernels need the
+  // most columns, more than HarrisScoresRowAvx2.
+  const bool narrow = cols < kMinProductsRowCols;
+  const bool avx2 = CpuSupportsAvx2() && !narrow;
+  auto productsRow = narrow ? HarrisProductsRowNarrow :
+      avx2 ? HarrisProductsRowAvx2 : HarrisProductsRow;
+  auto scoresRow = avx2 ? HarrisScoresRowAvx2 : HarrisScoresRow;
+  // Rows of the gradient products, by product and image row.
+  auto products = [ring, cols](int product, int row) {
+    return ring + (product * kRingRows + row % kRingRows) * cols;
+  };
+  for (int i = rowBegin - 1; i < rowBegin + 1; ++i) {
+    productsRow(data, stride, cols, i, products(0, i), products(1, i),
+                products(2, i));
+  }
+  for (int i = rowBegin; i < rowEnd; ++i) {
+    productsRow(data, stride, cols, i + 1, products(0, i + 1),
+                products(1, i + 1), products(2, i + 1));
+    const int16_t* const dxdxRows[3] = {products(0, i - 1), products(0, i),
+                                        products(0, i + 1)};
+    const int16_t* const dxdyRows[3] = {products(1, i - 1), products(1, i),
+                                        products(1, i + 1)};
+    const int16_t* const dydyRows[3] = {products(2, i - 1), products(2, i),
+                                        products(2, i + 1)};
+    scoresRow(dxdxRows, dxdyRows, dydyRows, cols,
+              reinterpret_cast<int*>(scores->data) + i * cols);
+  }
+}
+
+// HarrisScoreCalculator::Score(double, double).
+inline double BilinearScore(const int* data, int stride, int cols, int rows,
+                            double u, double v) {
+  const int u_int = static_cast<int>(u);
+  const int v_int = static_cast<int>(v);
+  if (u_int + 1 >= cols || v_int + 1 >= rows || u_int < 0 || v_int < 0)
+    return 0.0;
+  const int* const p = data + v_int * stride + u_int;
+  const double ru = u - static_cast<double>(u_int);
+  const double rv = v - static_cast<double>(v_int);
+  const double oneMinus_ru = 1.0 - ru;
+  const double oneMinus_rv = 1.0 - rv;
+  return oneMinus_rv * (oneMinus_ru * p[0] + ru * p[1])
+      + rv * (oneMinus_ru * p[stride] + ru * p[stride + 1]);
+}
+}  // namespace
+
+void HarrisScoresBlock(const agast::Mat& src, int x0, int y0, int x1, int y1,
+                       agast::Mat* scores_ptr) {
+  CHECK_NOTNULL(scores_ptr);
+  agast::Mat& scores = *scores_ptr;
+  CHECK_EQ(scores.type(), CV_32S);
+  CHECK_EQ(scores.rows, src.rows);
+  CHECK_EQ(scores.cols, src.cols);
+  CHECK(x0 >= 0 && y0 >= 0 && x1 <= src.cols && y1 <= src.rows);
+  CHECK_LE(x1 - x0, kHarrisScoresMaxBlock);
+  CHECK_LE(y1 - y0, kHarrisScoresMaxBlock);
+  // The scores are zero within two pixels of the border.
+  const int inner_x0 = std::max(x0, 2);
+  const int inner_y0 = std::max(y0, 2);
+  const int inner_x1 = std::min(x1, src.cols - 2);
+  const int inner_y1 = std::min(y1, src.rows - 2);
+  for (int y = y0; y < y1; ++y) {
+    int* const row = &scores.at<int>(y, 0);
+    for (int x = x0; x < x1; ++x) {
+      if (y < inner_y0 || y >= inner_y1 || x < inner_x0 || x >= inner_x1) {
+        row[x] = 0;
       }
     }
   }
+  if (inner_x0 >= inner_x1 || inner_y0 >= inner_y1) {
+    return;
+  }
 
-  // Smooth gradient products and calculate score.
-  for (int i = 2; i < rows - 2; ++i) {
-    for (int j = 2; j < cols - 2; j++) {
-      // Load.
-      // Calculate dxdx.
-      const int16_t dxdx_m1_m1 = DxDx1[(i - 1) * cols + j - 1];
-      const int16_t dxdx_m1_0 = DxDx1[(i - 1) * cols + j];
-      const int16_t dxdx_m1_p1 = DxDx1[(i - 1) * cols + j + 1];
-      const int16_t dxdx_0_m1 = DxDx1[(i) * cols + j - 1];
-      const int16_t dxdx_0_0 = DxDx1[(i) * cols + j];
-      const int16_t dxdx_0_p1 = DxDx1[(i) * cols + j + 1];
-      const int16_t dxdx_p1_m1 = DxDx1[(i + 1) * cols + j - 1];
-      const int16_t dxdx_p1_0 = DxDx1[(i + 1) * cols + j];
-      const int16_t dxdx_p1_p1 = DxDx1[(i + 1) * cols + j + 1];
-
-      // Gaussian smoothing.
-      int dxdx = ((4 * static_cast<int>(dxdx_0_0)
-          + 2 * (static_cast<int>(dxdx_m1_0) + static_cast<int>(dxdx_p1_0) +
-              static_cast<int>(dxdx_0_m1) + static_cast<int>(dxdx_0_p1)) +
-              (static_cast<int>(dxdx_m1_m1) + static_cast<int>(dxdx_m1_p1) +
-                  static_cast<int>(dxdx_p1_m1) + static_cast<int>(dxdx_p1_p1)))
-          >> 4);
-
-      // Calculate dxdy.
-      const int16_t dxdy_m1_m1 = DxDy1[(i - 1) * cols + j - 1];
-      const int16_t dxdy_m1_0 = DxDy1[(i - 1) * cols + j];
-      const int16_t dxdy_m1_p1 = DxDy1[(i - 1) * cols + j + 1];
-      const int16_t dxdy_0_m1 = DxDy1[(i) * cols + j - 1];
-      const int16_t dxdy_0_0 = DxDy1[(i) * cols + j];
-      const int16_t dxdy_0_p1 = DxDy1[(i) * cols + j + 1];
-      const int16_t dxdy_p1_m1 = DxDy1[(i + 1) * cols + j - 1];
-      const int16_t dxdy_p1_0 = DxDy1[(i + 1) * cols + j];
-      const int16_t dxdy_p1_p1 = DxDy1[(i + 1) * cols + j + 1];
-
-      // Gaussian smoothing.
-      int dxdy = ((4 * static_cast<int>(dxdy_0_0)
-          + 2 * (static_cast<int>(dxdy_m1_0) + static_cast<int>(dxdy_p1_0) +
-                  static_cast<int>(dxdy_0_m1) + static_cast<int>(dxdy_0_p1)) +
-                  (static_cast<int>(dxdy_m1_m1) + static_cast<int>(dxdy_m1_p1) +
-                      static_cast<int>(dxdy_p1_m1) +
-                      static_cast<int>(dxdy_p1_p1))) >> 4);
-
-      // Calculate dydy.
-      const int16_t dydy_m1_m1 = DyDy1[(i - 1) * cols + j - 1];
-      const int16_t dydy_m1_0 = DyDy1[(i - 1) * cols + j];
-      const int16_t dydy_m1_p1 = DyDy1[(i - 1) * cols + j + 1];
-      const int16_t dydy_0_m1 = DyDy1[(i) * cols + j - 1];
-      const int16_t dydy_0_0 = DyDy1[(i) * cols + j];
-      const int16_t dydy_0_p1 = DyDy1[(i) * cols + j + 1];
-      const int16_t dydy_p1_m1 = DyDy1[(i + 1) * cols + j - 1];
-      const int16_t dydy_p1_0 = DyDy1[(i + 1) * cols + j];
-      const int16_t dydy_p1_p1 = DyDy1[(i + 1) * cols + j + 1];
-
-      // Gaussian smoothing.
-      int dydy = ((4 * static_cast<int>(dydy_0_0)
-          + 2 * (static_cast<int>(dydy_m1_0) + static_cast<int>(dydy_p1_0) +
-                  static_cast<int>(dydy_0_m1) + static_cast<int>(dydy_0_p1))
-          + (static_cast<int>(dydy_m1_m1) + static_cast<int>(dydy_m1_p1) +
-              static_cast<int>(dydy_p1_m1) + static_cast<int>(dydy_p1_p1)))
-          >> 4);
-
-      int trace_div_by_2 = ((dxdx) + (dydy)) >> 1;
-      // The scores Mat has elements of integer size. By casting to (int *)
-      // we can use pointer arithmetic to find the offset to store the score.
-      *(reinterpret_cast<int*>(scores.data) + i * cols + j) =
-          ((((dxdx) * (dydy))) - (((dxdy) * (dxdy))))
-          - ((((trace_div_by_2)) * ((trace_div_by_2)) >> 2));
+  // The gradient products of the inner pixels and the ones around them.
+  const int stride = src.step[0];
+  const int width = inner_x1 - inner_x0 + 2;
+  const int height = inner_y1 - inner_y0 + 2;
+  const int kMaxSize = kHarrisScoresMaxBlock + 2;
+  int16_t products[3][kMaxSize * kMaxSize];
+  for (int r = 0; r < height; ++r) {
+    const unsigned char* p = src.data + (inner_y0 - 1 + r) * stride
+        + inner_x0 - 1;
+    for (int c = 0; c < width; ++c) {
+      HarrisProducts(p + c, stride, &products[0][r * width + c],
+                     &products[1][r * width + c], &products[2][r * width + c]);
+    }
+  }
+  for (int y = inner_y0; y < inner_y1; ++y) {
+    const int r = y - inner_y0;
+    const int16_t* const dxdxRows[3] = {
+        &products[0][r * width], &products[0][(r + 1) * width],
+        &products[0][(r + 2) * width]};
+    const int16_t* const dxdyRows[3] = {
+        &products[1][r * width], &products[1][(r + 1) * width],
+        &products[1][(r + 2) * width]};
+    const int16_t* const dydyRows[3] = {
+        &products[2][r * width], &products[2][(r + 1) * width],
+        &products[2][(r + 2) * width]};
+    int* const row = &scores.at<int>(y, 0);
+    for (int x = inner_x0; x < inner_x1; ++x) {
+      row[x] = HarrisResponse(dxdxRows, dxdyRows, dydyRows, x - inner_x0 + 1);
     }
   }
+}
+
+void HarrisScoresSSE(const agast::Mat& src, agast::Mat& scores) {
+  HarrisScoresSSE(src, scores, 1);
+}
 
-  delete[] DxDx1;
-  delete[] DxDy1;
-  delete[] DyDy1;
+void HarrisScoresSSE(const agast::Mat& src, agast::Mat& scores,
+                     size_t num_threads, const TaskRunner& task_runner,
+                     HarrisScoresBuffer* buffer) {
+  const int rows = src.rows;
+  const int cols = src.cols;
+  if (scores.rows != rows || scores.cols != cols || scores.type() != CV_32S
+      || !scores.isContinuous()) {
+    scores = agast::Mat(rows, cols, CV_32S);
+  }
+  if (rows < 5 || cols < 5) {
+    memset(scores.data, 0, rows * cols * sizeof(int));
+    return;
+  }
+  // The border rows, the border columns are written with the scores.
+  memset(scores.data, 0, 2 * cols * sizeof(int));
+  memset(scores.data + (rows - 2) * cols * sizeof(int), 0,
+         2 * cols * sizeof(int));
+
+  // One ring per stripe.
+  const size_t scoreRows = rows - 4;
+  const size_t stripes = std::max<size_t>(
+      std::min(num_threads, scoreRows / kMinRowsPerThread), 1);
+  HarrisScoresBuffer local_buffer;
+  if (buffer == nullptr) {
+    buffer = &local_buffer;
+  }
+  const size_t ringSize = 3 * kRingRows * cols;
+  if (buffer->size() < stripes * ringSize) {
+    buffer->resize(stripes * ringSize);
+  }
+  int16_t* const rings = buffer->data();
+  ParallelFor(stripes, stripes, 1,
+              [&src, &scores, rings, ringSize, stripes,
+               scoreRows](size_t begin, size_t end) {
+    for (size_t stripe = begin; stripe < end; ++stripe) {
+      const size_t rowBegin = 2 + scoreRows * stripe / stripes;
+      const size_t rowEnd = 2 + scoreRows * (stripe + 1) / stripes;
+      HarrisScoresRows(src, rowBegin, rowEnd, rings + stripe * ringSize,
+                       &scores);
+    }
+  }, task_runner);
+}
+
+void HarrisScoresBilinear(const agast::Mat& scores, const double* u,
+                          const double* v, size_t n, double* interpolated) {
+  CHECK_EQ(scores.type(), CV_32S);
+  const int* const data = reinterpret_cast<const int*>(scores.data);
+  const int stride = scores.step[0] / sizeof(int);
+  const int cols = scores.cols;
+  const int rows = scores.rows;
+  size_t i = 0;
+  if (CpuSupportsAvx2()) {
+    i = n - n % 4;
+    HarrisScoresBilinearAvx2(scores, u, v, i, interpolated);
+  }
+  // Two points at a time: the weights are vectorized, the scores gathered.
+  const __m128d one = _mm_set1_pd(1.0);
+  for (; i + 2 <= n; i += 2) {
+    const __m128d u_pd = _mm_loadu_pd(u + i);
+    const __m128d v_pd = _mm_loadu_pd(v + i);
+    const __m128i u_int = _mm_cvttpd_epi32(u_pd);
+    const __m128i v_int = _mm_cvttpd_epi32(v_pd);
+    const int u0 = _mm_cvtsi128_si32(u_int);
+    const int u1 = _mm_cvtsi128_si32(_mm_srli_si128(u_int, 4));
+    const int v0 = _mm_cvtsi128_si32(v_int);
+    const int v1 = _mm_cvtsi128_si32(_mm_srli_si128(v_int, 4));
+    const bool inside0 = u0 + 1 < cols && v0 + 1 < rows && u0 >= 0 && v0 >= 0;
+    const bool inside1 = u1 + 1 < cols && v1 + 1 < rows && u1 >= 0 && v1 >= 0;
+    if (!inside0 || !inside1) {
+      interpolated[i] = BilinearScore(data, stride, cols, rows, u[i], v[i]);
+      interpolated[i + 1] = BilinearScore(data, stride, cols, rows, u[i + 1],
+                                          v[i + 1]);
+      continue;
+    }
+    const int* const p0 = data + v0 * stride + u0;
+    const int* const p1 = data + v1 * stride + u1;
+    const __m128d ru = _mm_sub_pd(u_pd, _mm_cvtepi32_pd(u_int));
+    const __m128d rv = _mm_sub_pd(v_pd, _mm_cvtepi32_pd(v_int));
+    const __m128d oneMinus_ru = _mm_sub_pd(one, ru);
+    const __m128d oneMinus_rv = _mm_sub_pd(one, rv);
+    const __m128d top = _mm_add_pd(
+        _mm_mul_pd(oneMinus_ru, _mm_set_pd(p1[0], p0[0])),
+        _mm_mul_pd(ru, _mm_set_pd(p1[1], p0[1])));
+    const __m128d bottom = _mm_add_pd(
+        _mm_mul_pd(oneMinus_ru, _mm_set_pd(p1[stride], p0[stride])),
+        _mm_mul_pd(ru, _mm_set_pd(p1[stride + 1], p0[stride + 1])));
+    _mm_storeu_pd(interpolated + i,
+                  _mm_add_pd(_mm_mul_pd(oneMinus_rv, top),
+                             _mm_mul_pd(rv, bottom)));
+  }
+  for (; i < n; ++i) {
+    interpolated[i] = BilinearScore(data, stride, cols, rows, u[i], v[i]);
+  }
 }
 }  // namespace brisk
 
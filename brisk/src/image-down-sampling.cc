@@ -35,6 +35,8 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <vector>
+
 #include <brisk/internal/image-down-sampling.h>
 #include <brisk/internal/macros.h>
 #include <agast/glog.h>
@@ -785,4 +787,84 @@ void Twothirdsample8(const agast::Mat& srcimg, agast::Mat& dstimg) {
   }
 #endif  // __ARM_NEON
 }
+
+void HalfsampleMask(const agast::Mat& srcmask, agast::Mat& dstmask) {
+  CHECK_EQ(srcmask.type(), CV_8UC1);
+  CHECK_EQ(dstmask.type(), CV_8UC1);
+  CHECK_EQ(srcmask.cols / 2, dstmask.cols);
+  CHECK_EQ(srcmask.rows / 2, dstmask.rows);
+  for (int y = 0; y < dstmask.rows; ++y) {
+    const unsigned char* p1 = srcmask.data + 2 * y * srcmask.step;
+    const unsigned char* p2 = p1 + srcmask.step;
+    unsigned char* p_dest = dstmask.data + y * dstmask.step;
+    for (int x = 0; x < dstmask.cols; ++x) {
+      const int any = p1[2 * x] | p1[2 * x + 1] | p2[2 * x] | p2[2 * x + 1];
+      p_dest[x] = any != 0 ? 255 : 0;
+    }
+  }
+}
+
+void TwothirdsampleMask(const agast::Mat& srcmask, agast::Mat& dstmask) {
+  CHECK_EQ(srcmask.type(), CV_8UC1);
+  CHECK_EQ(dstmask.type(), CV_8UC1);
+  CHECK_EQ((srcmask.cols / 3) * 2, dstmask.cols);
+  CHECK_EQ((srcmask.rows / 3) * 2, dstmask.rows);
+  // Every 3x3 block becomes a 2x2 block whose pixels each overlap a 2x2
+  // corner of it.
+  for (int y = 0; y < dstmask.rows; ++y) {
+    const int y_src = y / 2 * 3 + (y & 1);
+    const unsigned char* p1 = srcmask.data + y_src * srcmask.step;
+    const unsigned char* p2 = p1 + srcmask.step;
+    unsigned char* p_dest = dstmask.data + y * dstmask.step;
+    for (int x = 0; x < dstmask.cols; ++x) {
+      const int x_src = x / 2 * 3 + (x & 1);
+      const int any = p1[x_src] | p1[x_src + 1] | p2[x_src] | p2[x_src + 1];
+      p_dest[x] = any != 0 ? 255 : 0;
+    }
+  }
+}
+
+void DilateMask(const agast::Mat& srcmask, int radius, agast::Mat& dstmask) {
+  CHECK_EQ(srcmask.type(), CV_8UC1);
+  CHECK_EQ(dstmask.type(), CV_8UC1);
+  CHECK_EQ(srcmask.cols, dstmask.cols);
+  CHECK_EQ(srcmask.rows, dstmask.rows);
+  CHECK_NE(srcmask.data, dstmask.data);
+  CHECK_GE(radius, 0);
+  const int rows = srcmask.rows;
+  const int cols = srcmask.cols;
+  // Number of valid pixels per column in the rows within radius of y.
+  std::vector<int> columnCounts(cols, 0);
+  for (int y = -radius; y < rows; ++y) {
+    const int y_add = y + radius;
+    if (y_add < rows) {
+      const unsigned char* p = srcmask.data + y_add * srcmask.step;
+      for (int x = 0; x < cols; ++x) {
+        columnCounts[x] += p[x] != 0;
+      }
+    }
+    const int y_remove = y - radius - 1;
+    if (y_remove >= 0) {
+      const unsigned char* p = srcmask.data + y_remove * srcmask.step;
+      for (int x = 0; x < cols; ++x) {
+        columnCounts[x] -= p[x] != 0;
+      }
+    }
+    if (y < 0)
+      continue;
+    // Same along the row, over the columns within radius of x.
+    unsigned char* p_dest = dstmask.data + y * dstmask.step;
+    int count = 0;
+    for (int x = 0; x < radius && x < cols; ++x) {
+      count += columnCounts[x] != 0;
+    }
+    for (int x = 0; x < cols; ++x) {
+      if (x + radius < cols)
+        count += columnCounts[x + radius] != 0;
+      if (x - radius - 1 >= 0)
+        count -= columnCounts[x - radius - 1] != 0;
+      p_dest[x] = count != 0 ? 255 : 0;
+    }
+  }
+}
 }  // namespace brisk
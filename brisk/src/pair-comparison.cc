@@ -0,0 +1,221 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef __ARM_NEON
+#include <immintrin.h>
+#endif  // __ARM_NEON
+
+#include <glog/logging.h>
+
+#include <brisk/internal/cpu-features.h>
+#include <brisk/internal/pair-comparison.h>
+
+namespace brisk {
+namespace {
+void CompareShortPairsScalar(const int* values, const BriskShortPair* pairs,
+                             unsigned int num_pairs, unsigned char* bits) {
+  memset(bits, 0, (num_pairs + 7) / 8);
+  for (unsigned int k = 0; k < num_pairs; ++k) {
+    if (values[pairs[k].i] > values[pairs[k].j]) {
+      bits[k / 8] |= 1 << (k % 8);
+    }
+  }
+}
+
+void SumLongPairGradientsScalar(const int* values, const BriskLongPair* pairs,
+                                unsigned int num_pairs, int* direction0,
+                                int* direction1) {
+  const BriskLongPair* max = pairs + num_pairs;
+  for (const BriskLongPair* iter = pairs; iter < max; ++iter) {
+    const int delta_t = values[iter->i] - values[iter->j];
+    *direction0 += delta_t * iter->weighted_dx / 1024;
+    *direction1 += delta_t * iter->weighted_dy / 1024;
+  }
+}
+
+#ifndef __ARM_NEON
+// Compares eight pairs and returns the results in the lowest eight bits.
+__attribute__((target("avx2")))
+inline uint32_t CompareEightPairs(const int* values, const BriskShortPair* pairs) {
+  static_assert(sizeof(BriskShortPair) == 2 * sizeof(int),
+                "The pairs are loaded as interleaved 32 bit indices.");
+  // Deinterleave (i0, j0, ..., i3, j3) to (i0, ..., i3, j0, ..., j3).
+  const __m256i deinterleave = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+  const __m256i pairs_low = _mm256_permutevar8x32_epi32(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs)),
+      deinterleave);
+  const __m256i pairs_high = _mm256_permutevar8x32_epi32(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs + 4)),
+      deinterleave);
+  const __m256i i = _mm256_permute2x128_si256(pairs_low, pairs_high, 0x20);
+  const __m256i j = _mm256_permute2x128_si256(pairs_low, pairs_high, 0x31);
+  const __m256i t1 = _mm256_i32gather_epi32(values, i, 4);
+  const __m256i t2 = _mm256_i32gather_epi32(values, j, 4);
+  return static_cast<uint32_t>(
+      _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(t1, t2))));
+}
+
+__attribute__((target("avx2")))
+void CompareShortPairsAvx2(const int* values, const BriskShortPair* pairs,
+                           unsigned int num_pairs, unsigned char* bits) {
+  unsigned int k = 0;
+  for (; k + 32 <= num_pairs; k += 32) {
+    const uint32_t word = CompareEightPairs(values, pairs + k)
+        | CompareEightPairs(values, pairs + k + 8) << 8
+        | CompareEightPairs(values, pairs + k + 16) << 16
+        | CompareEightPairs(values, pairs + k + 24) << 24;
+    // Bit n of the word goes to bit n % 8 of byte n / 8.
+    for (int byte = 0; byte < 4; ++byte) {
+      bits[k / 8 + byte] = static_cast<unsigned char>(word >> (8 * byte));
+    }
+  }
+  // The remaining pairs, if any.
+  CompareShortPairsScalar(values, pairs + k, num_pairs - k, bits + k / 8);
+}
+
+// x / 1024 rounded towards zero like the integer division.
+__attribute__((target("avx2")))
+inline __m256i DivideBy1024(__m256i x) {
+  const __m256i bias = _mm256_and_si256(_mm256_srai_epi32(x, 31),
+                                        _mm256_set1_epi32(1023));
+  return _mm256_srai_epi32(_mm256_add_epi32(x, bias), 10);
+}
+
+__attribute__((target("avx2")))
+inline int HorizontalSum(__m256i x) {
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(x),
+                              _mm256_extracti128_si256(x, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2")))
+void SumLongPairGradientsAvx2(const int* values, const BriskLongPair* pairs,
+                              unsigned int num_pairs, int* direction0,
+                              int* direction1) {
+  static_assert(sizeof(BriskLongPair) == 4 * sizeof(int),
+                "The pairs are loaded as four 32 bit fields.");
+  __m256i sum0 = _mm256_setzero_si256();
+  __m256i sum1 = _mm256_setzero_si256();
+  unsigned int k = 0;
+  for (; k + 8 <= num_pairs; k += 8) {
+    // Two pairs per register: (i0, j0, dx0, dy0, i1, j1, dx1, dy1).
+    const __m256i* block = reinterpret_cast<const __m256i*>(pairs + k);
+    const __m256i p01 = _mm256_loadu_si256(block);
+    const __m256i p23 = _mm256_loadu_si256(block + 1);
+    const __m256i p45 = _mm256_loadu_si256(block + 2);
+    const __m256i p67 = _mm256_loadu_si256(block + 3);
+    // Transpose to one field per register. The order of the pairs within
+    // the registers is (0, 2, 4, 6, 1, 3, 5, 7), which does not matter for
+    // the sums.
+    const __m256i ij0246 = _mm256_unpacklo_epi32(p01, p23);
+    const __m256i d0246 = _mm256_unpackhi_epi32(p01, p23);
+    const __m256i ij4657 = _mm256_unpacklo_epi32(p45, p67);
+    const __m256i d4657 = _mm256_unpackhi_epi32(p45, p67);
+    const __m256i i = _mm256_unpacklo_epi64(ij0246, ij4657);
+    const __m256i j = _mm256_unpackhi_epi64(ij0246, ij4657);
+    const __m256i dx = _mm256_unpacklo_epi64(d0246, d4657);
+    const __m256i dy = _mm256_unpackhi_epi64(d0246, d4657);
+
+    const __m256i delta_t = _mm256_sub_epi32(
+        _mm256_i32gather_epi32(values, i, 4),
+        _mm256_i32gather_epi32(values, j, 4));
+    sum0 = _mm256_add_epi32(
+        sum0, DivideBy1024(_mm256_mullo_epi32(delta_t, dx)));
+    sum1 = _mm256_add_epi32(
+        sum1, DivideBy1024(_mm256_mullo_epi32(delta_t, dy)));
+  }
+  *direction0 += HorizontalSum(sum0);
+  *direction1 += HorizontalSum(sum1);
+  // The remaining pairs, if any.
+  SumLongPairGradientsScalar(values, pairs + k, num_pairs - k, direction0,
+                             direction1);
+}
+#endif  // __ARM_NEON
+}  // namespace
+
+void CompareShortPairs(const int* values, const BriskShortPair* pairs,
+                       unsigned int num_pairs, unsigned char* bits) {
+  CHECK_NOTNULL(values);
+  CHECK_NOTNULL(pairs);
+  CHECK_NOTNULL(bits);
+#ifndef __ARM_NEON
+  if (CpuSupportsAvx2()) {
+    CompareShortPairsAvx2(values, pairs, num_pairs, bits);
+    return;
+  }
+#endif  // __ARM_NEON
+  CompareShortPairsScalar(values, pairs, num_pairs, bits);
+}
+
+void SumLongPairGradients(const int* values, const BriskLongPair* pairs,
+                          unsigned int num_pairs, int* direction0,
+                          int* direction1) {
+  CHECK_NOTNULL(values);
+  CHECK_NOTNULL(pairs);
+  CHECK_NOTNULL(direction0);
+  CHECK_NOTNULL(direction1);
+#ifndef __ARM_NEON
+  if (CpuSupportsAvx2()) {
+    SumLongPairGradientsAvx2(values, pairs, num_pairs, direction0,
+                             direction1);
+    return;
+  }
+#endif  // __ARM_NEON
+  SumLongPairGradientsScalar(values, pairs, num_pairs, direction0,
+                             direction1);
+}
+
+void SumLongPairGradients(const int* values, const BriskLongPair* pairs,
+                          unsigned int num_pairs, int64_t* direction0,
+                          int64_t* direction1) {
+  CHECK_NOTNULL(values);
+  CHECK_NOTNULL(pairs);
+  CHECK_NOTNULL(direction0);
+  CHECK_NOTNULL(direction1);
+  const BriskLongPair* max = pairs + num_pairs;
+  for (const BriskLongPair* iter = pairs; iter < max; ++iter) {
+    const int64_t delta_t = values[iter->i] - values[iter->j];
+    *direction0 += delta_t * iter->weighted_dx / 1024;
+    *direction1 += delta_t * iter->weighted_dy / 1024;
+  }
+}
+}  // namespace brisk
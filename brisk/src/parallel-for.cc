@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include <glog/logging.h>
+
+#include <brisk/internal/parallel-for.h>
+
+namespace brisk {
+void RunTasks(TaskBatch* tasks, const TaskRunner& task_runner) {
+  CHECK_NOTNULL(tasks);
+  if (tasks->empty()) {
+    return;
+  }
+  if (tasks->size() == 1) {
+    tasks->front()();
+    return;
+  }
+  if (task_runner) {
+    task_runner(tasks);
+    return;
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(tasks->size() - 1);
+  for (size_t i = 1; i < tasks->size(); ++i) {
+    threads.emplace_back((*tasks)[i]);
+  }
+  tasks->front()();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+void ParallelFor(size_t num_items, size_t num_threads,
+                 size_t min_items_per_range,
+                 const std::function<void(size_t begin, size_t end)>& range_task,
+                 const TaskRunner& task_runner) {
+  if (num_items == 0) {
+    return;
+  }
+  min_items_per_range = std::max<size_t>(min_items_per_range, 1);
+  const size_t max_ranges =
+      (num_items + min_items_per_range - 1) / min_items_per_range;
+  const size_t num_ranges =
+      std::max<size_t>(std::min(num_threads, max_ranges), 1);
+  if (num_ranges == 1) {
+    range_task(0, num_items);
+    return;
+  }
+
+  // Distribute the remainder over the first ranges.
+  const size_t items_per_range = num_items / num_ranges;
+  const size_t remainder = num_items % num_ranges;
+  TaskBatch tasks;
+  tasks.reserve(num_ranges);
+  size_t begin = 0;
+  for (size_t i = 0; i < num_ranges; ++i) {
+    const size_t end = begin + items_per_range + (i < remainder ? 1 : 0);
+    tasks.push_back([&range_task, begin, end]() { range_task(begin, end); });
+    begin = end;
+  }
+  CHECK_EQ(begin, num_items);
+  RunTasks(&tasks, task_runner);
+}
+}  // namespace brisk
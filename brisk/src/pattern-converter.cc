@@ -0,0 +1,83 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Converts BRISK pattern files between the text format of brisk.ptn and the
+// compact binary format read by BriskDescriptorExtractor.
+
+#include <fstream>  // NOLINT
+#include <iostream>  // NOLINT
+#include <string>
+
+#include <brisk/internal/pattern-provider.h>
+
+int main(int argc, char** argv) {
+  if (argc != 3 && !(argc == 4 && std::string(argv[1]) == "--to-text")) {
+    std::cout << "Usage: " << argv[0] << " [--to-text] <input pattern> "
+        "<output pattern>" << std::endl;
+    std::cout << "Writes the binary format unless --to-text is given. The "
+        "input format is detected automatically." << std::endl;
+    return 1;
+  }
+  const bool to_text = argc == 4;
+  const std::string input = argv[argc - 2];
+  const std::string output = argv[argc - 1];
+
+  brisk::BriskPattern pattern;
+  if (!brisk::ReadPatternFile(input, &pattern)) {
+    std::cerr << "Failed to read the pattern file " << input << std::endl;
+    return 1;
+  }
+
+  std::ofstream file(output.c_str(), std::ios::out | std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Failed to open " << output << " for writing." << std::endl;
+    return 1;
+  }
+  if (to_text) {
+    brisk::WritePatternText(pattern, &file);
+  } else {
+    brisk::WritePatternBinary(pattern, &file);
+  }
+  if (!file.good()) {
+    std::cerr << "Failed to write " << output << std::endl;
+    return 1;
+  }
+  std::cout << "Converted " << pattern.points.size() << " points, "
+      << pattern.shortPairs.size() << " short and " << pattern.longPairs.size()
+      << " long pairs." << std::endl;
+  return 0;
+}
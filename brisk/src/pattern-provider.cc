@@ -35,1322 +35,485 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <assert.h>
+#include <cstring>
+#include <fstream>  // NOLINT
+#include <iomanip>
+#include <stdint.h>
+
+#include <glog/logging.h>
+
 #include <brisk/internal/pattern-provider.h>
 
 namespace brisk {
-void GetDefaultPatternAsStream(std::stringstream* pattern_stream) {
-  assert(pattern_stream);
+namespace {
+// The default BRISK 2.0 pattern, see brisk.ptn.
+constexpr BriskPatternPoint kDefaultPatternPoints[] = {
+    {0.0f, 0.0f, 6.000000e-01f},
+    {1.190000e+00f, 0.0f, 6.000000e-01f},
+    {5.950000e-01f, 1.030570e+00f, 6.000000e-01f},
+    {-5.950000e-01f, 1.030570e+00f, 6.000000e-01f},
+    {-1.190000e+00f, 1.457330e-16f, 6.000000e-01f},
+    {-5.950000e-01f, -1.030570e+00f, 6.000000e-01f},
+    {5.950000e-01f, -1.030570e+00f, 6.000000e-01f},
+    {2.465000e+00f, 0.0f, 7.617269e-01f},
+    {1.994227e+00f, 1.448891e+00f, 7.617269e-01f},
+    {7.617269e-01f, 2.344354e+00f, 7.617269e-01f},
+    {-7.617269e-01f, 2.344354e+00f, 7.617269e-01f},
+    {-1.994227e+00f, 1.448891e+00f, 7.617269e-01f},
+    {-2.465000e+00f, 3.018754e-16f, 7.617269e-01f},
+    {-1.994227e+00f, -1.448891e+00f, 7.617269e-01f},
+    {-7.617269e-01f, -2.344354e+00f, 7.617269e-01f},
+    {7.617269e-01f, -2.344354e+00f, 7.617269e-01f},
+    {1.994227e+00f, -1.448891e+00f, 7.617269e-01f},
+    {4.165000e+00f, 0.0f, 9.267997e-01f},
+    {3.752535e+00f, 1.807126e+00f, 9.267997e-01f},
+    {2.596835e+00f, 3.256328e+00f, 9.267997e-01f},
+    {9.267997e-01f, 4.060575e+00f, 9.267997e-01f},
+    {-9.267997e-01f, 4.060575e+00f, 9.267997e-01f},
+    {-2.596835e+00f, 3.256328e+00f, 9.267997e-01f},
+    {-3.752535e+00f, 1.807126e+00f, 9.267997e-01f},
+    {-4.165000e+00f, 5.100654e-16f, 9.267997e-01f},
+    {-3.752535e+00f, -1.807126e+00f, 9.267997e-01f},
+    {-2.596835e+00f, -3.256328e+00f, 9.267997e-01f},
+    {-9.267997e-01f, -4.060575e+00f, 9.267997e-01f},
+    {9.267997e-01f, -4.060575e+00f, 9.267997e-01f},
+    {2.596835e+00f, -3.256328e+00f, 9.267997e-01f},
+    {3.752535e+00f, -1.807126e+00f, 9.267997e-01f},
+    {6.290000e+00f, 0.0f, 1.307765e+00f},
+    {5.746201e+00f, 2.558373e+00f, 1.307765e+00f},
+    {4.208832e+00f, 4.674381e+00f, 1.307765e+00f},
+    {1.943717e+00f, 5.982145e+00f, 1.307765e+00f},
+    {-6.574840e-01f, 6.255543e+00f, 1.307765e+00f},
+    {-3.145000e+00f, 5.447300e+00f, 1.307765e+00f},
+    {-5.088717e+00f, 3.697169e+00f, 1.307765e+00f},
+    {-6.152548e+00f, 1.307765e+00f, 1.307765e+00f},
+    {-6.152548e+00f, -1.307765e+00f, 1.307765e+00f},
+    {-5.088717e+00f, -3.697169e+00f, 1.307765e+00f},
+    {-3.145000e+00f, -5.447300e+00f, 1.307765e+00f},
+    {-6.574840e-01f, -6.255543e+00f, 1.307765e+00f},
+    {1.943717e+00f, -5.982145e+00f, 1.307765e+00f},
+    {4.208832e+00f, -4.674381e+00f, 1.307765e+00f},
+    {5.746201e+00f, -2.558373e+00f, 1.307765e+00f},
+    {9.180000e+00f, 0.0f, 1.436068e+00f},
+    {8.730699e+00f, 2.836776e+00f, 1.436068e+00f},
+    {7.426776e+00f, 5.395869e+00f, 1.436068e+00f},
+    {5.395869e+00f, 7.426776e+00f, 1.436068e+00f},
+    {2.836776e+00f, 8.730699e+00f, 1.436068e+00f},
+    {5.621129e-16f, 9.180000e+00f, 1.436068e+00f},
+    {-2.836776e+00f, 8.730699e+00f, 1.436068e+00f},
+    {-5.395869e+00f, 7.426776e+00f, 1.436068e+00f},
+    {-7.426776e+00f, 5.395869e+00f, 1.436068e+00f},
+    {-8.730699e+00f, 2.836776e+00f, 1.436068e+00f},
+    {-9.180000e+00f, 1.124226e-15f, 1.436068e+00f},
+    {-8.730699e+00f, -2.836776e+00f, 1.436068e+00f},
+    {-7.426776e+00f, -5.395869e+00f, 1.436068e+00f},
+    {-5.395869e+00f, -7.426776e+00f, 1.436068e+00f},
+    {-2.836776e+00f, -8.730699e+00f, 1.436068e+00f},
+    {-1.686339e-15f, -9.180000e+00f, 1.436068e+00f},
+    {2.836776e+00f, -8.730699e+00f, 1.436068e+00f},
+    {5.395869e+00f, -7.426776e+00f, 1.436068e+00f},
+    {7.426776e+00f, -5.395869e+00f, 1.436068e+00f},
+    {8.730699e+00f, -2.836776e+00f, 1.436068e+00f},
+};
+
+constexpr BriskShortPair kDefaultPatternShortPairs[] = {
+    {2, 1}, {3, 1}, {3, 2}, {4, 0}, {4, 1}, {4, 2}, {4, 3}, {5, 1}, {5, 2},
+    {5, 3}, {5, 4}, {6, 1}, {6, 2}, {6, 3}, {6, 4}, {6, 5}, {7, 1}, {7, 2},
+    {7, 6}, {8, 3}, {8, 6}, {8, 7}, {9, 0}, {9, 1}, {9, 3}, {9, 7}, {9, 8},
+    {10, 2}, {10, 4}, {10, 8}, {10, 9}, {11, 2}, {11, 3}, {11, 5}, {11, 9},
+    {11, 10}, {12, 3}, {12, 4}, {12, 5}, {12, 10}, {12, 11}, {13, 3}, {13, 5},
+    {13, 6}, {13, 11}, {13, 12}, {14, 4}, {14, 6}, {14, 12}, {14, 13}, {15, 0},
+    {15, 1}, {15, 5}, {15, 7}, {15, 13}, {15, 14}, {16, 1}, {16, 5}, {16, 6},
+    {16, 7}, {16, 8}, {16, 14}, {16, 15}, {17, 1}, {17, 7}, {17, 8}, {17, 16},
+    {18, 1}, {18, 2}, {18, 7}, {18, 8}, {18, 9}, {18, 17}, {19, 2}, {19, 7},
+    {19, 8}, {19, 9}, {19, 10}, {19, 17}, {19, 18}, {20, 2}, {20, 8}, {20, 9},
+    {20, 10}, {20, 18}, {20, 19}, {21, 3}, {21, 9}, {21, 10}, {21, 11},
+    {21, 19}, {21, 20}, {22, 3}, {22, 9}, {22, 10}, {22, 11}, {22, 12},
+    {22, 20}, {22, 21}, {23, 3}, {23, 4}, {23, 10}, {23, 11}, {23, 12},
+    {23, 21}, {23, 22}, {24, 4}, {24, 11}, {24, 12}, {24, 13}, {24, 22},
+    {24, 23}, {25, 5}, {25, 12}, {25, 13}, {25, 14}, {25, 23}, {25, 24},
+    {26, 5}, {26, 12}, {26, 13}, {26, 14}, {26, 15}, {26, 24}, {26, 25},
+    {27, 5}, {27, 13}, {27, 14}, {27, 15}, {27, 25}, {27, 26}, {28, 6},
+    {28, 14}, {28, 15}, {28, 16}, {28, 26}, {28, 27}, {29, 6}, {29, 7},
+    {29, 14}, {29, 15}, {29, 16}, {29, 17}, {29, 27}, {29, 28}, {30, 1},
+    {30, 6}, {30, 7}, {30, 15}, {30, 16}, {30, 17}, {30, 18}, {30, 28},
+    {30, 29}, {31, 7}, {31, 17}, {31, 18}, {31, 30}, {32, 17}, {32, 18},
+    {32, 19}, {32, 30}, {32, 31}, {33, 8}, {33, 9}, {33, 17}, {33, 18},
+    {33, 19}, {33, 20}, {33, 31}, {33, 32}, {34, 9}, {34, 18}, {34, 19},
+    {34, 20}, {34, 21}, {34, 32}, {34, 33}, {35, 9}, {35, 10}, {35, 19},
+    {35, 20}, {35, 21}, {35, 22}, {35, 33}, {35, 34}, {36, 10}, {36, 11},
+    {36, 20}, {36, 21}, {36, 22}, {36, 23}, {36, 34}, {36, 35}, {37, 11},
+    {37, 21}, {37, 22}, {37, 23}, {37, 24}, {37, 35}, {37, 36}, {38, 11},
+    {38, 12}, {38, 22}, {38, 23}, {38, 24}, {38, 25}, {38, 36}, {38, 37},
+    {39, 12}, {39, 13}, {39, 23}, {39, 24}, {39, 25}, {39, 26}, {39, 37},
+    {39, 38}, {40, 13}, {40, 24}, {40, 25}, {40, 26}, {40, 27}, {40, 38},
+    {40, 39}, {41, 13}, {41, 14}, {41, 25}, {41, 26}, {41, 27}, {41, 28},
+    {41, 39}, {41, 40}, {42, 14}, {42, 15}, {42, 26}, {42, 27}, {42, 28},
+    {42, 29}, {42, 40}, {42, 41}, {43, 15}, {43, 27}, {43, 28}, {43, 29},
+    {43, 30}, {43, 41}, {43, 42}, {44, 15}, {44, 16}, {44, 17}, {44, 28},
+    {44, 29}, {44, 30}, {44, 31}, {44, 42}, {44, 43}, {45, 16}, {45, 17},
+    {45, 18}, {45, 29}, {45, 30}, {45, 31}, {45, 32}, {45, 43}, {45, 44},
+    {46, 17}, {46, 31}, {46, 32}, {46, 45}, {47, 18}, {47, 31}, {47, 32},
+    {47, 33}, {47, 46}, {48, 31}, {48, 32}, {48, 33}, {48, 34}, {48, 46},
+    {48, 47}, {49, 19}, {49, 32}, {49, 33}, {49, 34}, {49, 47}, {49, 48},
+    {50, 20}, {50, 33}, {50, 34}, {50, 35}, {50, 48}, {50, 49}, {51, 34},
+    {51, 35}, {51, 36}, {51, 49}, {51, 50}, {52, 21}, {52, 34}, {52, 35},
+    {52, 36}, {52, 37}, {52, 50}, {52, 51}, {53, 22}, {53, 35}, {53, 36},
+    {53, 37}, {53, 51}, {53, 52}, {54, 36}, {54, 37}, {54, 38}, {54, 52},
+    {54, 53}, {55, 23}, {55, 37}, {55, 38}, {55, 39}, {55, 53}, {55, 54},
+    {56, 24}, {56, 37}, {56, 38}, {56, 39}, {56, 40}, {56, 54}, {56, 55},
+    {57, 25}, {57, 38}, {57, 39}, {57, 40}, {57, 55}, {57, 56}, {58, 39},
+    {58, 40}, {58, 41}, {58, 56}, {58, 57}, {59, 26}, {59, 40}, {59, 41},
+    {59, 42}, {59, 57}, {59, 58}, {60, 27}, {60, 40}, {60, 41}, {60, 42},
+    {60, 43}, {60, 58}, {60, 59}, {61, 41}, {61, 42}, {61, 43}, {61, 59},
+    {61, 60}, {62, 28}, {62, 42}, {62, 43}, {62, 44}, {62, 60}, {62, 61},
+    {63, 29}, {63, 43}, {63, 44}, {63, 45}, {63, 61}, {63, 62}, {64, 31},
+    {64, 43}, {64, 44}, {64, 45}, {64, 46}, {64, 62}, {64, 63}, {65, 30},
+    {65, 31}, {65, 44}, {65, 45}, {65, 46}, {65, 47}, {65, 63}, {65, 64},
+};
+
+constexpr BriskShortPair kDefaultPatternLongPairs[] = {
+    {1, 0}, {2, 0}, {2, 1}, {3, 0}, {3, 1}, {3, 2}, {4, 0}, {4, 1}, {4, 2},
+    {4, 3}, {5, 0}, {5, 1}, {5, 2}, {5, 3}, {5, 4}, {6, 0}, {6, 1}, {6, 2},
+    {6, 3}, {6, 4}, {6, 5}, {7, 0}, {7, 1}, {7, 2}, {7, 3}, {7, 4}, {7, 5},
+    {7, 6}, {8, 0}, {8, 1}, {8, 2}, {8, 3}, {8, 4}, {8, 5}, {8, 6}, {8, 7},
+    {9, 0}, {9, 1}, {9, 2}, {9, 3}, {9, 4}, {9, 5}, {9, 6}, {9, 7}, {9, 8},
+    {10, 0}, {10, 1}, {10, 2}, {10, 3}, {10, 4}, {10, 5}, {10, 6}, {10, 7},
+    {10, 8}, {10, 9}, {11, 0}, {11, 1}, {11, 2}, {11, 3}, {11, 4}, {11, 5},
+    {11, 6}, {11, 7}, {11, 8}, {11, 9}, {11, 10}, {12, 0}, {12, 1}, {12, 2},
+    {12, 3}, {12, 4}, {12, 5}, {12, 6}, {12, 8}, {12, 9}, {12, 10}, {12, 11},
+    {13, 0}, {13, 1}, {13, 2}, {13, 3}, {13, 4}, {13, 5}, {13, 6}, {13, 7},
+    {13, 9}, {13, 10}, {13, 11}, {13, 12}, {14, 0}, {14, 1}, {14, 2}, {14, 3},
+    {14, 4}, {14, 5}, {14, 6}, {14, 7}, {14, 8}, {14, 10}, {14, 11}, {14, 12},
+    {14, 13}, {15, 0}, {15, 1}, {15, 2}, {15, 3}, {15, 4}, {15, 5}, {15, 6},
+    {15, 7}, {15, 8}, {15, 9}, {15, 11}, {15, 12}, {15, 13}, {15, 14}, {16, 0},
+    {16, 1}, {16, 2}, {16, 3}, {16, 4}, {16, 5}, {16, 6}, {16, 7}, {16, 8},
+    {16, 9}, {16, 10}, {16, 12}, {16, 13}, {16, 14}, {16, 15}, {17, 0}, {17, 1},
+    {17, 2}, {17, 6}, {17, 7}, {17, 8}, {17, 9}, {17, 15}, {17, 16}, {18, 0},
+    {18, 1}, {18, 2}, {18, 3}, {18, 6}, {18, 7}, {18, 8}, {18, 9}, {18, 10},
+    {18, 15}, {18, 16}, {18, 17}, {19, 0}, {19, 1}, {19, 2}, {19, 3}, {19, 6},
+    {19, 7}, {19, 8}, {19, 9}, {19, 10}, {19, 11}, {19, 16}, {19, 17}, {19, 18},
+    {20, 0}, {20, 1}, {20, 2}, {20, 3}, {20, 4}, {20, 7}, {20, 8}, {20, 9},
+    {20, 10}, {20, 11}, {20, 12}, {20, 17}, {20, 18}, {20, 19}, {21, 0},
+    {21, 1}, {21, 2}, {21, 3}, {21, 4}, {21, 7}, {21, 8}, {21, 9}, {21, 10},
+    {21, 11}, {21, 12}, {21, 18}, {21, 19}, {21, 20}, {22, 0}, {22, 2}, {22, 3},
+    {22, 4}, {22, 5}, {22, 8}, {22, 9}, {22, 10}, {22, 11}, {22, 12}, {22, 13},
+    {22, 19}, {22, 20}, {22, 21}, {23, 0}, {23, 2}, {23, 3}, {23, 4}, {23, 5},
+    {23, 9}, {23, 10}, {23, 11}, {23, 12}, {23, 13}, {23, 14}, {23, 20},
+    {23, 21}, {23, 22}, {24, 0}, {24, 3}, {24, 4}, {24, 5}, {24, 10}, {24, 11},
+    {24, 12}, {24, 13}, {24, 14}, {24, 21}, {24, 22}, {24, 23}, {25, 0},
+    {25, 3}, {25, 4}, {25, 5}, {25, 6}, {25, 10}, {25, 11}, {25, 12}, {25, 13},
+    {25, 14}, {25, 15}, {25, 22}, {25, 23}, {25, 24}, {26, 0}, {26, 3}, {26, 4},
+    {26, 5}, {26, 6}, {26, 11}, {26, 12}, {26, 13}, {26, 14}, {26, 15},
+    {26, 16}, {26, 23}, {26, 24}, {26, 25}, {27, 0}, {27, 1}, {27, 4}, {27, 5},
+    {27, 6}, {27, 7}, {27, 12}, {27, 13}, {27, 14}, {27, 15}, {27, 16},
+    {27, 24}, {27, 25}, {27, 26}, {28, 0}, {28, 1}, {28, 4}, {28, 5}, {28, 6},
+    {28, 7}, {28, 12}, {28, 13}, {28, 14}, {28, 15}, {28, 16}, {28, 17},
+    {28, 25}, {28, 26}, {28, 27}, {29, 0}, {29, 1}, {29, 2}, {29, 5}, {29, 6},
+    {29, 7}, {29, 8}, {29, 13}, {29, 14}, {29, 15}, {29, 16}, {29, 17},
+    {29, 18}, {29, 26}, {29, 27}, {29, 28}, {30, 0}, {30, 1}, {30, 2}, {30, 5},
+    {30, 6}, {30, 7}, {30, 8}, {30, 9}, {30, 14}, {30, 15}, {30, 16}, {30, 17},
+    {30, 18}, {30, 19}, {30, 27}, {30, 28}, {30, 29}, {31, 1}, {31, 2}, {31, 6},
+    {31, 7}, {31, 8}, {31, 9}, {31, 15}, {31, 16}, {31, 17}, {31, 18}, {31, 19},
+    {31, 20}, {31, 28}, {31, 29}, {31, 30}, {32, 1}, {32, 2}, {32, 7}, {32, 8},
+    {32, 9}, {32, 10}, {32, 16}, {32, 17}, {32, 18}, {32, 19}, {32, 20},
+    {32, 21}, {32, 29}, {32, 30}, {32, 31}, {33, 1}, {33, 2}, {33, 3}, {33, 7},
+    {33, 8}, {33, 9}, {33, 10}, {33, 16}, {33, 17}, {33, 18}, {33, 19},
+    {33, 20}, {33, 21}, {33, 22}, {33, 30}, {33, 31}, {33, 32}, {34, 1},
+    {34, 2}, {34, 3}, {34, 7}, {34, 8}, {34, 9}, {34, 10}, {34, 11}, {34, 17},
+    {34, 18}, {34, 19}, {34, 20}, {34, 21}, {34, 22}, {34, 23}, {34, 31},
+    {34, 32}, {34, 33}, {35, 2}, {35, 3}, {35, 8}, {35, 9}, {35, 10}, {35, 11},
+    {35, 12}, {35, 18}, {35, 19}, {35, 20}, {35, 21}, {35, 22}, {35, 23},
+    {35, 32}, {35, 33}, {35, 34}, {36, 2}, {36, 3}, {36, 4}, {36, 8}, {36, 9},
+    {36, 10}, {36, 11}, {36, 12}, {36, 19}, {36, 20}, {36, 21}, {36, 22},
+    {36, 23}, {36, 24}, {36, 33}, {36, 34}, {36, 35}, {37, 3}, {37, 4}, {37, 9},
+    {37, 10}, {37, 11}, {37, 12}, {37, 13}, {37, 20}, {37, 21}, {37, 22},
+    {37, 23}, {37, 24}, {37, 25}, {37, 34}, {37, 35}, {37, 36}, {38, 3},
+    {38, 4}, {38, 5}, {38, 10}, {38, 11}, {38, 12}, {38, 13}, {38, 14},
+    {38, 21}, {38, 22}, {38, 23}, {38, 24}, {38, 25}, {38, 26}, {38, 35},
+    {38, 36}, {38, 37}, {39, 3}, {39, 4}, {39, 5}, {39, 10}, {39, 11}, {39, 12},
+    {39, 13}, {39, 14}, {39, 22}, {39, 23}, {39, 24}, {39, 25}, {39, 26},
+    {39, 27}, {39, 36}, {39, 37}, {39, 38}, {40, 4}, {40, 5}, {40, 11},
+    {40, 12}, {40, 13}, {40, 14}, {40, 15}, {40, 23}, {40, 24}, {40, 25},
+    {40, 26}, {40, 27}, {40, 28}, {40, 37}, {40, 38}, {40, 39}, {41, 4},
+    {41, 5}, {41, 6}, {41, 12}, {41, 13}, {41, 14}, {41, 15}, {41, 16},
+    {41, 24}, {41, 25}, {41, 26}, {41, 27}, {41, 28}, {41, 29}, {41, 38},
+    {41, 39}, {41, 40}, {42, 5}, {42, 6}, {42, 12}, {42, 13}, {42, 14},
+    {42, 15}, {42, 16}, {42, 25}, {42, 26}, {42, 27}, {42, 28}, {42, 29},
+    {42, 30}, {42, 39}, {42, 40}, {42, 41}, {43, 1}, {43, 5}, {43, 6}, {43, 7},
+    {43, 13}, {43, 14}, {43, 15}, {43, 16}, {43, 17}, {43, 25}, {43, 26},
+    {43, 27}, {43, 28}, {43, 29}, {43, 30}, {43, 31}, {43, 40}, {43, 41},
+    {43, 42}, {44, 1}, {44, 5}, {44, 6}, {44, 7}, {44, 8}, {44, 14}, {44, 15},
+    {44, 16}, {44, 17}, {44, 18}, {44, 26}, {44, 27}, {44, 28}, {44, 29},
+    {44, 30}, {44, 31}, {44, 32}, {44, 41}, {44, 42}, {44, 43}, {45, 1},
+    {45, 6}, {45, 7}, {45, 8}, {45, 14}, {45, 15}, {45, 16}, {45, 17}, {45, 18},
+    {45, 19}, {45, 27}, {45, 28}, {45, 29}, {45, 30}, {45, 31}, {45, 32},
+    {45, 33}, {45, 42}, {45, 43}, {45, 44}, {46, 7}, {46, 17}, {46, 18},
+    {46, 19}, {46, 29}, {46, 30}, {46, 31}, {46, 32}, {46, 33}, {46, 44},
+    {46, 45}, {47, 7}, {47, 8}, {47, 17}, {47, 18}, {47, 19}, {47, 30},
+    {47, 31}, {47, 32}, {47, 33}, {47, 34}, {47, 45}, {47, 46}, {48, 8},
+    {48, 17}, {48, 18}, {48, 19}, {48, 20}, {48, 31}, {48, 32}, {48, 33},
+    {48, 34}, {48, 35}, {48, 45}, {48, 46}, {48, 47}, {49, 8}, {49, 9},
+    {49, 18}, {49, 19}, {49, 20}, {49, 21}, {49, 31}, {49, 32}, {49, 33},
+    {49, 34}, {49, 35}, {49, 46}, {49, 47}, {49, 48}, {50, 9}, {50, 18},
+    {50, 19}, {50, 20}, {50, 21}, {50, 32}, {50, 33}, {50, 34}, {50, 35},
+    {50, 36}, {50, 47}, {50, 48}, {50, 49}, {51, 9}, {51, 10}, {51, 19},
+    {51, 20}, {51, 21}, {51, 22}, {51, 33}, {51, 34}, {51, 35}, {51, 36},
+    {51, 37}, {51, 48}, {51, 49}, {51, 50}, {52, 10}, {52, 20}, {52, 21},
+    {52, 22}, {52, 23}, {52, 33}, {52, 34}, {52, 35}, {52, 36}, {52, 37},
+    {52, 38}, {52, 49}, {52, 50}, {52, 51}, {53, 10}, {53, 11}, {53, 20},
+    {53, 21}, {53, 22}, {53, 23}, {53, 34}, {53, 35}, {53, 36}, {53, 37},
+    {53, 38}, {53, 50}, {53, 51}, {53, 52}, {54, 11}, {54, 21}, {54, 22},
+    {54, 23}, {54, 24}, {54, 35}, {54, 36}, {54, 37}, {54, 38}, {54, 39},
+    {54, 51}, {54, 52}, {54, 53}, {55, 11}, {55, 12}, {55, 22}, {55, 23},
+    {55, 24}, {55, 25}, {55, 36}, {55, 37}, {55, 38}, {55, 39}, {55, 40},
+    {55, 52}, {55, 53}, {55, 54}, {56, 12}, {56, 22}, {56, 23}, {56, 24},
+    {56, 25}, {56, 26}, {56, 36}, {56, 37}, {56, 38}, {56, 39}, {56, 40},
+    {56, 41}, {56, 53}, {56, 54}, {56, 55}, {57, 12}, {57, 13}, {57, 23},
+    {57, 24}, {57, 25}, {57, 26}, {57, 37}, {57, 38}, {57, 39}, {57, 40},
+    {57, 41}, {57, 54}, {57, 55}, {57, 56}, {58, 13}, {58, 24}, {58, 25},
+    {58, 26}, {58, 27}, {58, 38}, {58, 39}, {58, 40}, {58, 41}, {58, 42},
+    {58, 55}, {58, 56}, {58, 57}, {59, 13}, {59, 14}, {59, 25}, {59, 26},
+    {59, 27}, {59, 28}, {59, 39}, {59, 40}, {59, 41}, {59, 42}, {59, 43},
+    {59, 56}, {59, 57}, {59, 58}, {60, 14}, {60, 25}, {60, 26}, {60, 27},
+    {60, 28}, {60, 39}, {60, 40}, {60, 41}, {60, 42}, {60, 43}, {60, 44},
+    {60, 57}, {60, 58}, {60, 59}, {61, 14}, {61, 15}, {61, 26}, {61, 27},
+    {61, 28}, {61, 29}, {61, 40}, {61, 41}, {61, 42}, {61, 43}, {61, 44},
+    {61, 58}, {61, 59}, {61, 60}, {62, 15}, {62, 27}, {62, 28}, {62, 29},
+    {62, 30}, {62, 41}, {62, 42}, {62, 43}, {62, 44}, {62, 45}, {62, 59},
+    {62, 60}, {62, 61}, {63, 15}, {63, 16}, {63, 27}, {63, 28}, {63, 29},
+    {63, 30}, {63, 31}, {63, 42}, {63, 43}, {63, 44}, {63, 45}, {63, 46},
+    {63, 60}, {63, 61}, {63, 62}, {64, 16}, {64, 17}, {64, 28}, {64, 29},
+    {64, 30}, {64, 31}, {64, 32}, {64, 42}, {64, 43}, {64, 44}, {64, 45},
+    {64, 46}, {64, 47}, {64, 61}, {64, 62}, {64, 63}, {65, 7}, {65, 16},
+    {65, 17}, {65, 18}, {65, 29}, {65, 30}, {65, 31}, {65, 32}, {65, 43},
+    {65, 44}, {65, 45}, {65, 46}, {65, 47}, {65, 48}, {65, 62}, {65, 63},
+    {65, 64},
+};
+
+template<typename T, size_t N>
+constexpr size_t ArraySize(const T (&)[N]) {
+  return N;
+}
+static_assert(ArraySize(kDefaultPatternPoints) == 66,
+              "Unexpected number of default pattern points.");
+static_assert(ArraySize(kDefaultPatternShortPairs) == 384,
+              "The default pattern must have one short pair per bit.");
+static_assert(ArraySize(kDefaultPatternLongPairs) == 856,
+              "Unexpected number of default pattern long pairs.");
+
+// Binary pattern files start with this tag followed by the format version.
+const char kBinaryPatternTag[4] = {'B', 'P', 'T', 'N'};
+const uint32_t kBinaryPatternVersion = 1;
+// Bound on the points and pairs of a pattern file, far above any sensible
+// pattern, so corrupt counts fail to read instead of allocating gigabytes.
+const uint32_t kMaxPatternEntries = 1 << 20;
+// Bytes of a point and of a pair in the binary format.
+const size_t kBinaryPointSize = 3 * sizeof(float);
+const size_t kBinaryPairSize = 2 * sizeof(uint32_t);
+
+template<typename T>
+bool ReadBinary(std::istream& stream, T* value) {
+  stream.read(reinterpret_cast<char*>(value), sizeof(T));
+  return stream.good();
+}
+
+// Whether count entries of entry_size bytes can follow in the stream. The
+// rest of the stream is only checked if it can be measured.
+bool CountValid(std::istream& stream, uint32_t count, size_t entry_size) {
+  if (count > kMaxPatternEntries) {
+    return false;
+  }
+  const std::streampos position = stream.tellg();
+  if (position == std::streampos(-1)) {
+    return true;
+  }
+  stream.seekg(0, std::ios::end);
+  const std::streampos end = stream.tellg();
+  stream.seekg(position);
+  return stream.good() && end != std::streampos(-1) &&
+      static_cast<uint64_t>(end - position) >=
+      static_cast<uint64_t>(count) * entry_size;
+}
+
+template<typename T>
+void WriteBinary(const T& value, std::ostream* stream) {
+  stream->write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+bool ReadBinaryPairs(std::istream& stream, std::vector<BriskShortPair>* pairs) {
+  uint32_t count;
+  if (!ReadBinary(stream, &count) ||
+      !CountValid(stream, count, kBinaryPairSize)) {
+    return false;
+  }
+  pairs->resize(count);
+  for (BriskShortPair& pair : *pairs) {
+    uint32_t i, j;
+    if (!ReadBinary(stream, &i) || !ReadBinary(stream, &j)) {
+      return false;
+    }
+    pair.i = i;
+    pair.j = j;
+  }
+  return true;
+}
+
+void WriteBinaryPairs(const std::vector<BriskShortPair>& pairs,
+                      std::ostream* stream) {
+  WriteBinary(static_cast<uint32_t>(pairs.size()), stream);
+  for (const BriskShortPair& pair : pairs) {
+    WriteBinary(static_cast<uint32_t>(pair.i), stream);
+    WriteBinary(static_cast<uint32_t>(pair.j), stream);
+  }
+}
 
+bool ReadTextPairs(std::istream& stream, std::vector<BriskShortPair>* pairs) {
+  unsigned int count;
+  if (!(stream >> count) || count > kMaxPatternEntries) {
+    return false;
+  }
+  pairs->resize(count);
+  for (BriskShortPair& pair : *pairs) {
+    if (!(stream >> pair.i >> pair.j)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IndicesValid(const std::vector<BriskShortPair>& pairs,
+                  size_t num_points) {
+  for (const BriskShortPair& pair : pairs) {
+    if (pair.i >= num_points || pair.j >= num_points) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+void GetDefaultPattern(BriskPattern* pattern) {
+  CHECK_NOTNULL(pattern);
+  pattern->points.assign(
+      kDefaultPatternPoints,
+      kDefaultPatternPoints + ArraySize(kDefaultPatternPoints));
+  pattern->shortPairs.assign(
+      kDefaultPatternShortPairs,
+      kDefaultPatternShortPairs + ArraySize(kDefaultPatternShortPairs));
+  pattern->longPairs.assign(
+      kDefaultPatternLongPairs,
+      kDefaultPatternLongPairs + ArraySize(kDefaultPatternLongPairs));
+}
+
+void GetDefaultPatternAsStream(std::stringstream* pattern_stream) {
+  CHECK_NOTNULL(pattern_stream);
   pattern_stream->clear();
-  *pattern_stream << "66" << std::endl;
-  *pattern_stream << "0 0 6.000000e-01 " << std::endl;
-  *pattern_stream << "1.190000e+00 0 6.000000e-01 " << std::endl;
-  *pattern_stream << "5.950000e-01 1.030570e+00 6.000000e-01 " << std::endl;
-  *pattern_stream << "-5.950000e-01 1.030570e+00 6.000000e-01 " << std::endl;
-  *pattern_stream << "-1.190000e+00 1.457330e-16 6.000000e-01 " << std::endl;
-  *pattern_stream << "-5.950000e-01 -1.030570e+00 6.000000e-01 " << std::endl;
-  *pattern_stream << "5.950000e-01 -1.030570e+00 6.000000e-01 " << std::endl;
-  *pattern_stream << "2.465000e+00 0 7.617269e-01 " << std::endl;
-  *pattern_stream << "1.994227e+00 1.448891e+00 7.617269e-01 " << std::endl;
-  *pattern_stream << "7.617269e-01 2.344354e+00 7.617269e-01 " << std::endl;
-  *pattern_stream << "-7.617269e-01 2.344354e+00 7.617269e-01 " << std::endl;
-  *pattern_stream << "-1.994227e+00 1.448891e+00 7.617269e-01 " << std::endl;
-  *pattern_stream << "-2.465000e+00 3.018754e-16 7.617269e-01 " << std::endl;
-  *pattern_stream << "-1.994227e+00 -1.448891e+00 7.617269e-01 " << std::endl;
-  *pattern_stream << "-7.617269e-01 -2.344354e+00 7.617269e-01 " << std::endl;
-  *pattern_stream << "7.617269e-01 -2.344354e+00 7.617269e-01 " << std::endl;
-  *pattern_stream << "1.994227e+00 -1.448891e+00 7.617269e-01 " << std::endl;
-  *pattern_stream << "4.165000e+00 0 9.267997e-01 " << std::endl;
-  *pattern_stream << "3.752535e+00 1.807126e+00 9.267997e-01 " << std::endl;
-  *pattern_stream << "2.596835e+00 3.256328e+00 9.267997e-01 " << std::endl;
-  *pattern_stream << "9.267997e-01 4.060575e+00 9.267997e-01 " << std::endl;
-  *pattern_stream << "-9.267997e-01 4.060575e+00 9.267997e-01 " << std::endl;
-  *pattern_stream << "-2.596835e+00 3.256328e+00 9.267997e-01 " << std::endl;
-  *pattern_stream << "-3.752535e+00 1.807126e+00 9.267997e-01 " << std::endl;
-  *pattern_stream << "-4.165000e+00 5.100654e-16 9.267997e-01 " << std::endl;
-  *pattern_stream << "-3.752535e+00 -1.807126e+00 9.267997e-01 " << std::endl;
-  *pattern_stream << "-2.596835e+00 -3.256328e+00 9.267997e-01 " << std::endl;
-  *pattern_stream << "-9.267997e-01 -4.060575e+00 9.267997e-01 " << std::endl;
-  *pattern_stream << "9.267997e-01 -4.060575e+00 9.267997e-01 " << std::endl;
-  *pattern_stream << "2.596835e+00 -3.256328e+00 9.267997e-01 " << std::endl;
-  *pattern_stream << "3.752535e+00 -1.807126e+00 9.267997e-01 " << std::endl;
-  *pattern_stream << "6.290000e+00 0 1.307765e+00 " << std::endl;
-  *pattern_stream << "5.746201e+00 2.558373e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "4.208832e+00 4.674381e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "1.943717e+00 5.982145e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "-6.574840e-01 6.255543e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "-3.145000e+00 5.447300e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "-5.088717e+00 3.697169e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "-6.152548e+00 1.307765e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "-6.152548e+00 -1.307765e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "-5.088717e+00 -3.697169e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "-3.145000e+00 -5.447300e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "-6.574840e-01 -6.255543e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "1.943717e+00 -5.982145e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "4.208832e+00 -4.674381e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "5.746201e+00 -2.558373e+00 1.307765e+00 " << std::endl;
-  *pattern_stream << "9.180000e+00 0 1.436068e+00 " << std::endl;
-  *pattern_stream << "8.730699e+00 2.836776e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "7.426776e+00 5.395869e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "5.395869e+00 7.426776e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "2.836776e+00 8.730699e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "5.621129e-16 9.180000e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "-2.836776e+00 8.730699e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "-5.395869e+00 7.426776e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "-7.426776e+00 5.395869e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "-8.730699e+00 2.836776e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "-9.180000e+00 1.124226e-15 1.436068e+00 " << std::endl;
-  *pattern_stream << "-8.730699e+00 -2.836776e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "-7.426776e+00 -5.395869e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "-5.395869e+00 -7.426776e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "-2.836776e+00 -8.730699e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "-1.686339e-15 -9.180000e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "2.836776e+00 -8.730699e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "5.395869e+00 -7.426776e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "7.426776e+00 -5.395869e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "8.730699e+00 -2.836776e+00 1.436068e+00 " << std::endl;
-  *pattern_stream << "384" << std::endl;
-  *pattern_stream << "2 1 " << std::endl;
-  *pattern_stream << "3 1 " << std::endl;
-  *pattern_stream << "3 2 " << std::endl;
-  *pattern_stream << "4 0 " << std::endl;
-  *pattern_stream << "4 1 " << std::endl;
-  *pattern_stream << "4 2 " << std::endl;
-  *pattern_stream << "4 3 " << std::endl;
-  *pattern_stream << "5 1 " << std::endl;
-  *pattern_stream << "5 2 " << std::endl;
-  *pattern_stream << "5 3 " << std::endl;
-  *pattern_stream << "5 4 " << std::endl;
-  *pattern_stream << "6 1 " << std::endl;
-  *pattern_stream << "6 2 " << std::endl;
-  *pattern_stream << "6 3 " << std::endl;
-  *pattern_stream << "6 4 " << std::endl;
-  *pattern_stream << "6 5 " << std::endl;
-  *pattern_stream << "7 1 " << std::endl;
-  *pattern_stream << "7 2 " << std::endl;
-  *pattern_stream << "7 6 " << std::endl;
-  *pattern_stream << "8 3 " << std::endl;
-  *pattern_stream << "8 6 " << std::endl;
-  *pattern_stream << "8 7 " << std::endl;
-  *pattern_stream << "9 0 " << std::endl;
-  *pattern_stream << "9 1 " << std::endl;
-  *pattern_stream << "9 3 " << std::endl;
-  *pattern_stream << "9 7 " << std::endl;
-  *pattern_stream << "9 8 " << std::endl;
-  *pattern_stream << "10 2 " << std::endl;
-  *pattern_stream << "10 4 " << std::endl;
-  *pattern_stream << "10 8 " << std::endl;
-  *pattern_stream << "10 9 " << std::endl;
-  *pattern_stream << "11 2 " << std::endl;
-  *pattern_stream << "11 3 " << std::endl;
-  *pattern_stream << "11 5 " << std::endl;
-  *pattern_stream << "11 9 " << std::endl;
-  *pattern_stream << "11 10 " << std::endl;
-  *pattern_stream << "12 3 " << std::endl;
-  *pattern_stream << "12 4 " << std::endl;
-  *pattern_stream << "12 5 " << std::endl;
-  *pattern_stream << "12 10 " << std::endl;
-  *pattern_stream << "12 11 " << std::endl;
-  *pattern_stream << "13 3 " << std::endl;
-  *pattern_stream << "13 5 " << std::endl;
-  *pattern_stream << "13 6 " << std::endl;
-  *pattern_stream << "13 11 " << std::endl;
-  *pattern_stream << "13 12 " << std::endl;
-  *pattern_stream << "14 4 " << std::endl;
-  *pattern_stream << "14 6 " << std::endl;
-  *pattern_stream << "14 12 " << std::endl;
-  *pattern_stream << "14 13 " << std::endl;
-  *pattern_stream << "15 0 " << std::endl;
-  *pattern_stream << "15 1 " << std::endl;
-  *pattern_stream << "15 5 " << std::endl;
-  *pattern_stream << "15 7 " << std::endl;
-  *pattern_stream << "15 13 " << std::endl;
-  *pattern_stream << "15 14 " << std::endl;
-  *pattern_stream << "16 1 " << std::endl;
-  *pattern_stream << "16 5 " << std::endl;
-  *pattern_stream << "16 6 " << std::endl;
-  *pattern_stream << "16 7 " << std::endl;
-  *pattern_stream << "16 8 " << std::endl;
-  *pattern_stream << "16 14 " << std::endl;
-  *pattern_stream << "16 15 " << std::endl;
-  *pattern_stream << "17 1 " << std::endl;
-  *pattern_stream << "17 7 " << std::endl;
-  *pattern_stream << "17 8 " << std::endl;
-  *pattern_stream << "17 16 " << std::endl;
-  *pattern_stream << "18 1 " << std::endl;
-  *pattern_stream << "18 2 " << std::endl;
-  *pattern_stream << "18 7 " << std::endl;
-  *pattern_stream << "18 8 " << std::endl;
-  *pattern_stream << "18 9 " << std::endl;
-  *pattern_stream << "18 17 " << std::endl;
-  *pattern_stream << "19 2 " << std::endl;
-  *pattern_stream << "19 7 " << std::endl;
-  *pattern_stream << "19 8 " << std::endl;
-  *pattern_stream << "19 9 " << std::endl;
-  *pattern_stream << "19 10 " << std::endl;
-  *pattern_stream << "19 17 " << std::endl;
-  *pattern_stream << "19 18 " << std::endl;
-  *pattern_stream << "20 2 " << std::endl;
-  *pattern_stream << "20 8 " << std::endl;
-  *pattern_stream << "20 9 " << std::endl;
-  *pattern_stream << "20 10 " << std::endl;
-  *pattern_stream << "20 18 " << std::endl;
-  *pattern_stream << "20 19 " << std::endl;
-  *pattern_stream << "21 3 " << std::endl;
-  *pattern_stream << "21 9 " << std::endl;
-  *pattern_stream << "21 10 " << std::endl;
-  *pattern_stream << "21 11 " << std::endl;
-  *pattern_stream << "21 19 " << std::endl;
-  *pattern_stream << "21 20 " << std::endl;
-  *pattern_stream << "22 3 " << std::endl;
-  *pattern_stream << "22 9 " << std::endl;
-  *pattern_stream << "22 10 " << std::endl;
-  *pattern_stream << "22 11 " << std::endl;
-  *pattern_stream << "22 12 " << std::endl;
-  *pattern_stream << "22 20 " << std::endl;
-  *pattern_stream << "22 21 " << std::endl;
-  *pattern_stream << "23 3 " << std::endl;
-  *pattern_stream << "23 4 " << std::endl;
-  *pattern_stream << "23 10 " << std::endl;
-  *pattern_stream << "23 11 " << std::endl;
-  *pattern_stream << "23 12 " << std::endl;
-  *pattern_stream << "23 21 " << std::endl;
-  *pattern_stream << "23 22 " << std::endl;
-  *pattern_stream << "24 4 " << std::endl;
-  *pattern_stream << "24 11 " << std::endl;
-  *pattern_stream << "24 12 " << std::endl;
-  *pattern_stream << "24 13 " << std::endl;
-  *pattern_stream << "24 22 " << std::endl;
-  *pattern_stream << "24 23 " << std::endl;
-  *pattern_stream << "25 5 " << std::endl;
-  *pattern_stream << "25 12 " << std::endl;
-  *pattern_stream << "25 13 " << std::endl;
-  *pattern_stream << "25 14 " << std::endl;
-  *pattern_stream << "25 23 " << std::endl;
-  *pattern_stream << "25 24 " << std::endl;
-  *pattern_stream << "26 5 " << std::endl;
-  *pattern_stream << "26 12 " << std::endl;
-  *pattern_stream << "26 13 " << std::endl;
-  *pattern_stream << "26 14 " << std::endl;
-  *pattern_stream << "26 15 " << std::endl;
-  *pattern_stream << "26 24 " << std::endl;
-  *pattern_stream << "26 25 " << std::endl;
-  *pattern_stream << "27 5 " << std::endl;
-  *pattern_stream << "27 13 " << std::endl;
-  *pattern_stream << "27 14 " << std::endl;
-  *pattern_stream << "27 15 " << std::endl;
-  *pattern_stream << "27 25 " << std::endl;
-  *pattern_stream << "27 26 " << std::endl;
-  *pattern_stream << "28 6 " << std::endl;
-  *pattern_stream << "28 14 " << std::endl;
-  *pattern_stream << "28 15 " << std::endl;
-  *pattern_stream << "28 16 " << std::endl;
-  *pattern_stream << "28 26 " << std::endl;
-  *pattern_stream << "28 27 " << std::endl;
-  *pattern_stream << "29 6 " << std::endl;
-  *pattern_stream << "29 7 " << std::endl;
-  *pattern_stream << "29 14 " << std::endl;
-  *pattern_stream << "29 15 " << std::endl;
-  *pattern_stream << "29 16 " << std::endl;
-  *pattern_stream << "29 17 " << std::endl;
-  *pattern_stream << "29 27 " << std::endl;
-  *pattern_stream << "29 28 " << std::endl;
-  *pattern_stream << "30 1 " << std::endl;
-  *pattern_stream << "30 6 " << std::endl;
-  *pattern_stream << "30 7 " << std::endl;
-  *pattern_stream << "30 15 " << std::endl;
-  *pattern_stream << "30 16 " << std::endl;
-  *pattern_stream << "30 17 " << std::endl;
-  *pattern_stream << "30 18 " << std::endl;
-  *pattern_stream << "30 28 " << std::endl;
-  *pattern_stream << "30 29 " << std::endl;
-  *pattern_stream << "31 7 " << std::endl;
-  *pattern_stream << "31 17 " << std::endl;
-  *pattern_stream << "31 18 " << std::endl;
-  *pattern_stream << "31 30 " << std::endl;
-  *pattern_stream << "32 17 " << std::endl;
-  *pattern_stream << "32 18 " << std::endl;
-  *pattern_stream << "32 19 " << std::endl;
-  *pattern_stream << "32 30 " << std::endl;
-  *pattern_stream << "32 31 " << std::endl;
-  *pattern_stream << "33 8 " << std::endl;
-  *pattern_stream << "33 9 " << std::endl;
-  *pattern_stream << "33 17 " << std::endl;
-  *pattern_stream << "33 18 " << std::endl;
-  *pattern_stream << "33 19 " << std::endl;
-  *pattern_stream << "33 20 " << std::endl;
-  *pattern_stream << "33 31 " << std::endl;
-  *pattern_stream << "33 32 " << std::endl;
-  *pattern_stream << "34 9 " << std::endl;
-  *pattern_stream << "34 18 " << std::endl;
-  *pattern_stream << "34 19 " << std::endl;
-  *pattern_stream << "34 20 " << std::endl;
-  *pattern_stream << "34 21 " << std::endl;
-  *pattern_stream << "34 32 " << std::endl;
-  *pattern_stream << "34 33 " << std::endl;
-  *pattern_stream << "35 9 " << std::endl;
-  *pattern_stream << "35 10 " << std::endl;
-  *pattern_stream << "35 19 " << std::endl;
-  *pattern_stream << "35 20 " << std::endl;
-  *pattern_stream << "35 21 " << std::endl;
-  *pattern_stream << "35 22 " << std::endl;
-  *pattern_stream << "35 33 " << std::endl;
-  *pattern_stream << "35 34 " << std::endl;
-  *pattern_stream << "36 10 " << std::endl;
-  *pattern_stream << "36 11 " << std::endl;
-  *pattern_stream << "36 20 " << std::endl;
-  *pattern_stream << "36 21 " << std::endl;
-  *pattern_stream << "36 22 " << std::endl;
-  *pattern_stream << "36 23 " << std::endl;
-  *pattern_stream << "36 34 " << std::endl;
-  *pattern_stream << "36 35 " << std::endl;
-  *pattern_stream << "37 11 " << std::endl;
-  *pattern_stream << "37 21 " << std::endl;
-  *pattern_stream << "37 22 " << std::endl;
-  *pattern_stream << "37 23 " << std::endl;
-  *pattern_stream << "37 24 " << std::endl;
-  *pattern_stream << "37 35 " << std::endl;
-  *pattern_stream << "37 36 " << std::endl;
-  *pattern_stream << "38 11 " << std::endl;
-  *pattern_stream << "38 12 " << std::endl;
-  *pattern_stream << "38 22 " << std::endl;
-  *pattern_stream << "38 23 " << std::endl;
-  *pattern_stream << "38 24 " << std::endl;
-  *pattern_stream << "38 25 " << std::endl;
-  *pattern_stream << "38 36 " << std::endl;
-  *pattern_stream << "38 37 " << std::endl;
-  *pattern_stream << "39 12 " << std::endl;
-  *pattern_stream << "39 13 " << std::endl;
-  *pattern_stream << "39 23 " << std::endl;
-  *pattern_stream << "39 24 " << std::endl;
-  *pattern_stream << "39 25 " << std::endl;
-  *pattern_stream << "39 26 " << std::endl;
-  *pattern_stream << "39 37 " << std::endl;
-  *pattern_stream << "39 38 " << std::endl;
-  *pattern_stream << "40 13 " << std::endl;
-  *pattern_stream << "40 24 " << std::endl;
-  *pattern_stream << "40 25 " << std::endl;
-  *pattern_stream << "40 26 " << std::endl;
-  *pattern_stream << "40 27 " << std::endl;
-  *pattern_stream << "40 38 " << std::endl;
-  *pattern_stream << "40 39 " << std::endl;
-  *pattern_stream << "41 13 " << std::endl;
-  *pattern_stream << "41 14 " << std::endl;
-  *pattern_stream << "41 25 " << std::endl;
-  *pattern_stream << "41 26 " << std::endl;
-  *pattern_stream << "41 27 " << std::endl;
-  *pattern_stream << "41 28 " << std::endl;
-  *pattern_stream << "41 39 " << std::endl;
-  *pattern_stream << "41 40 " << std::endl;
-  *pattern_stream << "42 14 " << std::endl;
-  *pattern_stream << "42 15 " << std::endl;
-  *pattern_stream << "42 26 " << std::endl;
-  *pattern_stream << "42 27 " << std::endl;
-  *pattern_stream << "42 28 " << std::endl;
-  *pattern_stream << "42 29 " << std::endl;
-  *pattern_stream << "42 40 " << std::endl;
-  *pattern_stream << "42 41 " << std::endl;
-  *pattern_stream << "43 15 " << std::endl;
-  *pattern_stream << "43 27 " << std::endl;
-  *pattern_stream << "43 28 " << std::endl;
-  *pattern_stream << "43 29 " << std::endl;
-  *pattern_stream << "43 30 " << std::endl;
-  *pattern_stream << "43 41 " << std::endl;
-  *pattern_stream << "43 42 " << std::endl;
-  *pattern_stream << "44 15 " << std::endl;
-  *pattern_stream << "44 16 " << std::endl;
-  *pattern_stream << "44 17 " << std::endl;
-  *pattern_stream << "44 28 " << std::endl;
-  *pattern_stream << "44 29 " << std::endl;
-  *pattern_stream << "44 30 " << std::endl;
-  *pattern_stream << "44 31 " << std::endl;
-  *pattern_stream << "44 42 " << std::endl;
-  *pattern_stream << "44 43 " << std::endl;
-  *pattern_stream << "45 16 " << std::endl;
-  *pattern_stream << "45 17 " << std::endl;
-  *pattern_stream << "45 18 " << std::endl;
-  *pattern_stream << "45 29 " << std::endl;
-  *pattern_stream << "45 30 " << std::endl;
-  *pattern_stream << "45 31 " << std::endl;
-  *pattern_stream << "45 32 " << std::endl;
-  *pattern_stream << "45 43 " << std::endl;
-  *pattern_stream << "45 44 " << std::endl;
-  *pattern_stream << "46 17 " << std::endl;
-  *pattern_stream << "46 31 " << std::endl;
-  *pattern_stream << "46 32 " << std::endl;
-  *pattern_stream << "46 45 " << std::endl;
-  *pattern_stream << "47 18 " << std::endl;
-  *pattern_stream << "47 31 " << std::endl;
-  *pattern_stream << "47 32 " << std::endl;
-  *pattern_stream << "47 33 " << std::endl;
-  *pattern_stream << "47 46 " << std::endl;
-  *pattern_stream << "48 31 " << std::endl;
-  *pattern_stream << "48 32 " << std::endl;
-  *pattern_stream << "48 33 " << std::endl;
-  *pattern_stream << "48 34 " << std::endl;
-  *pattern_stream << "48 46 " << std::endl;
-  *pattern_stream << "48 47 " << std::endl;
-  *pattern_stream << "49 19 " << std::endl;
-  *pattern_stream << "49 32 " << std::endl;
-  *pattern_stream << "49 33 " << std::endl;
-  *pattern_stream << "49 34 " << std::endl;
-  *pattern_stream << "49 47 " << std::endl;
-  *pattern_stream << "49 48 " << std::endl;
-  *pattern_stream << "50 20 " << std::endl;
-  *pattern_stream << "50 33 " << std::endl;
-  *pattern_stream << "50 34 " << std::endl;
-  *pattern_stream << "50 35 " << std::endl;
-  *pattern_stream << "50 48 " << std::endl;
-  *pattern_stream << "50 49 " << std::endl;
-  *pattern_stream << "51 34 " << std::endl;
-  *pattern_stream << "51 35 " << std::endl;
-  *pattern_stream << "51 36 " << std::endl;
-  *pattern_stream << "51 49 " << std::endl;
-  *pattern_stream << "51 50 " << std::endl;
-  *pattern_stream << "52 21 " << std::endl;
-  *pattern_stream << "52 34 " << std::endl;
-  *pattern_stream << "52 35 " << std::endl;
-  *pattern_stream << "52 36 " << std::endl;
-  *pattern_stream << "52 37 " << std::endl;
-  *pattern_stream << "52 50 " << std::endl;
-  *pattern_stream << "52 51 " << std::endl;
-  *pattern_stream << "53 22 " << std::endl;
-  *pattern_stream << "53 35 " << std::endl;
-  *pattern_stream << "53 36 " << std::endl;
-  *pattern_stream << "53 37 " << std::endl;
-  *pattern_stream << "53 51 " << std::endl;
-  *pattern_stream << "53 52 " << std::endl;
-  *pattern_stream << "54 36 " << std::endl;
-  *pattern_stream << "54 37 " << std::endl;
-  *pattern_stream << "54 38 " << std::endl;
-  *pattern_stream << "54 52 " << std::endl;
-  *pattern_stream << "54 53 " << std::endl;
-  *pattern_stream << "55 23 " << std::endl;
-  *pattern_stream << "55 37 " << std::endl;
-  *pattern_stream << "55 38 " << std::endl;
-  *pattern_stream << "55 39 " << std::endl;
-  *pattern_stream << "55 53 " << std::endl;
-  *pattern_stream << "55 54 " << std::endl;
-  *pattern_stream << "56 24 " << std::endl;
-  *pattern_stream << "56 37 " << std::endl;
-  *pattern_stream << "56 38 " << std::endl;
-  *pattern_stream << "56 39 " << std::endl;
-  *pattern_stream << "56 40 " << std::endl;
-  *pattern_stream << "56 54 " << std::endl;
-  *pattern_stream << "56 55 " << std::endl;
-  *pattern_stream << "57 25 " << std::endl;
-  *pattern_stream << "57 38 " << std::endl;
-  *pattern_stream << "57 39 " << std::endl;
-  *pattern_stream << "57 40 " << std::endl;
-  *pattern_stream << "57 55 " << std::endl;
-  *pattern_stream << "57 56 " << std::endl;
-  *pattern_stream << "58 39 " << std::endl;
-  *pattern_stream << "58 40 " << std::endl;
-  *pattern_stream << "58 41 " << std::endl;
-  *pattern_stream << "58 56 " << std::endl;
-  *pattern_stream << "58 57 " << std::endl;
-  *pattern_stream << "59 26 " << std::endl;
-  *pattern_stream << "59 40 " << std::endl;
-  *pattern_stream << "59 41 " << std::endl;
-  *pattern_stream << "59 42 " << std::endl;
-  *pattern_stream << "59 57 " << std::endl;
-  *pattern_stream << "59 58 " << std::endl;
-  *pattern_stream << "60 27 " << std::endl;
-  *pattern_stream << "60 40 " << std::endl;
-  *pattern_stream << "60 41 " << std::endl;
-  *pattern_stream << "60 42 " << std::endl;
-  *pattern_stream << "60 43 " << std::endl;
-  *pattern_stream << "60 58 " << std::endl;
-  *pattern_stream << "60 59 " << std::endl;
-  *pattern_stream << "61 41 " << std::endl;
-  *pattern_stream << "61 42 " << std::endl;
-  *pattern_stream << "61 43 " << std::endl;
-  *pattern_stream << "61 59 " << std::endl;
-  *pattern_stream << "61 60 " << std::endl;
-  *pattern_stream << "62 28 " << std::endl;
-  *pattern_stream << "62 42 " << std::endl;
-  *pattern_stream << "62 43 " << std::endl;
-  *pattern_stream << "62 44 " << std::endl;
-  *pattern_stream << "62 60 " << std::endl;
-  *pattern_stream << "62 61 " << std::endl;
-  *pattern_stream << "63 29 " << std::endl;
-  *pattern_stream << "63 43 " << std::endl;
-  *pattern_stream << "63 44 " << std::endl;
-  *pattern_stream << "63 45 " << std::endl;
-  *pattern_stream << "63 61 " << std::endl;
-  *pattern_stream << "63 62 " << std::endl;
-  *pattern_stream << "64 31 " << std::endl;
-  *pattern_stream << "64 43 " << std::endl;
-  *pattern_stream << "64 44 " << std::endl;
-  *pattern_stream << "64 45 " << std::endl;
-  *pattern_stream << "64 46 " << std::endl;
-  *pattern_stream << "64 62 " << std::endl;
-  *pattern_stream << "64 63 " << std::endl;
-  *pattern_stream << "65 30 " << std::endl;
-  *pattern_stream << "65 31 " << std::endl;
-  *pattern_stream << "65 44 " << std::endl;
-  *pattern_stream << "65 45 " << std::endl;
-  *pattern_stream << "65 46 " << std::endl;
-  *pattern_stream << "65 47 " << std::endl;
-  *pattern_stream << "65 63 " << std::endl;
-  *pattern_stream << "65 64 " << std::endl;
-  *pattern_stream << "856" << std::endl;
-  *pattern_stream << "1 0 " << std::endl;
-  *pattern_stream << "2 0 " << std::endl;
-  *pattern_stream << "2 1 " << std::endl;
-  *pattern_stream << "3 0 " << std::endl;
-  *pattern_stream << "3 1 " << std::endl;
-  *pattern_stream << "3 2 " << std::endl;
-  *pattern_stream << "4 0 " << std::endl;
-  *pattern_stream << "4 1 " << std::endl;
-  *pattern_stream << "4 2 " << std::endl;
-  *pattern_stream << "4 3 " << std::endl;
-  *pattern_stream << "5 0 " << std::endl;
-  *pattern_stream << "5 1 " << std::endl;
-  *pattern_stream << "5 2 " << std::endl;
-  *pattern_stream << "5 3 " << std::endl;
-  *pattern_stream << "5 4 " << std::endl;
-  *pattern_stream << "6 0 " << std::endl;
-  *pattern_stream << "6 1 " << std::endl;
-  *pattern_stream << "6 2 " << std::endl;
-  *pattern_stream << "6 3 " << std::endl;
-  *pattern_stream << "6 4 " << std::endl;
-  *pattern_stream << "6 5 " << std::endl;
-  *pattern_stream << "7 0 " << std::endl;
-  *pattern_stream << "7 1 " << std::endl;
-  *pattern_stream << "7 2 " << std::endl;
-  *pattern_stream << "7 3 " << std::endl;
-  *pattern_stream << "7 4 " << std::endl;
-  *pattern_stream << "7 5 " << std::endl;
-  *pattern_stream << "7 6 " << std::endl;
-  *pattern_stream << "8 0 " << std::endl;
-  *pattern_stream << "8 1 " << std::endl;
-  *pattern_stream << "8 2 " << std::endl;
-  *pattern_stream << "8 3 " << std::endl;
-  *pattern_stream << "8 4 " << std::endl;
-  *pattern_stream << "8 5 " << std::endl;
-  *pattern_stream << "8 6 " << std::endl;
-  *pattern_stream << "8 7 " << std::endl;
-  *pattern_stream << "9 0 " << std::endl;
-  *pattern_stream << "9 1 " << std::endl;
-  *pattern_stream << "9 2 " << std::endl;
-  *pattern_stream << "9 3 " << std::endl;
-  *pattern_stream << "9 4 " << std::endl;
-  *pattern_stream << "9 5 " << std::endl;
-  *pattern_stream << "9 6 " << std::endl;
-  *pattern_stream << "9 7 " << std::endl;
-  *pattern_stream << "9 8 " << std::endl;
-  *pattern_stream << "10 0 " << std::endl;
-  *pattern_stream << "10 1 " << std::endl;
-  *pattern_stream << "10 2 " << std::endl;
-  *pattern_stream << "10 3 " << std::endl;
-  *pattern_stream << "10 4 " << std::endl;
-  *pattern_stream << "10 5 " << std::endl;
-  *pattern_stream << "10 6 " << std::endl;
-  *pattern_stream << "10 7 " << std::endl;
-  *pattern_stream << "10 8 " << std::endl;
-  *pattern_stream << "10 9 " << std::endl;
-  *pattern_stream << "11 0 " << std::endl;
-  *pattern_stream << "11 1 " << std::endl;
-  *pattern_stream << "11 2 " << std::endl;
-  *pattern_stream << "11 3 " << std::endl;
-  *pattern_stream << "11 4 " << std::endl;
-  *pattern_stream << "11 5 " << std::endl;
-  *pattern_stream << "11 6 " << std::endl;
-  *pattern_stream << "11 7 " << std::endl;
-  *pattern_stream << "11 8 " << std::endl;
-  *pattern_stream << "11 9 " << std::endl;
-  *pattern_stream << "11 10 " << std::endl;
-  *pattern_stream << "12 0 " << std::endl;
-  *pattern_stream << "12 1 " << std::endl;
-  *pattern_stream << "12 2 " << std::endl;
-  *pattern_stream << "12 3 " << std::endl;
-  *pattern_stream << "12 4 " << std::endl;
-  *pattern_stream << "12 5 " << std::endl;
-  *pattern_stream << "12 6 " << std::endl;
-  *pattern_stream << "12 8 " << std::endl;
-  *pattern_stream << "12 9 " << std::endl;
-  *pattern_stream << "12 10 " << std::endl;
-  *pattern_stream << "12 11 " << std::endl;
-  *pattern_stream << "13 0 " << std::endl;
-  *pattern_stream << "13 1 " << std::endl;
-  *pattern_stream << "13 2 " << std::endl;
-  *pattern_stream << "13 3 " << std::endl;
-  *pattern_stream << "13 4 " << std::endl;
-  *pattern_stream << "13 5 " << std::endl;
-  *pattern_stream << "13 6 " << std::endl;
-  *pattern_stream << "13 7 " << std::endl;
-  *pattern_stream << "13 9 " << std::endl;
-  *pattern_stream << "13 10 " << std::endl;
-  *pattern_stream << "13 11 " << std::endl;
-  *pattern_stream << "13 12 " << std::endl;
-  *pattern_stream << "14 0 " << std::endl;
-  *pattern_stream << "14 1 " << std::endl;
-  *pattern_stream << "14 2 " << std::endl;
-  *pattern_stream << "14 3 " << std::endl;
-  *pattern_stream << "14 4 " << std::endl;
-  *pattern_stream << "14 5 " << std::endl;
-  *pattern_stream << "14 6 " << std::endl;
-  *pattern_stream << "14 7 " << std::endl;
-  *pattern_stream << "14 8 " << std::endl;
-  *pattern_stream << "14 10 " << std::endl;
-  *pattern_stream << "14 11 " << std::endl;
-  *pattern_stream << "14 12 " << std::endl;
-  *pattern_stream << "14 13 " << std::endl;
-  *pattern_stream << "15 0 " << std::endl;
-  *pattern_stream << "15 1 " << std::endl;
-  *pattern_stream << "15 2 " << std::endl;
-  *pattern_stream << "15 3 " << std::endl;
-  *pattern_stream << "15 4 " << std::endl;
-  *pattern_stream << "15 5 " << std::endl;
-  *pattern_stream << "15 6 " << std::endl;
-  *pattern_stream << "15 7 " << std::endl;
-  *pattern_stream << "15 8 " << std::endl;
-  *pattern_stream << "15 9 " << std::endl;
-  *pattern_stream << "15 11 " << std::endl;
-  *pattern_stream << "15 12 " << std::endl;
-  *pattern_stream << "15 13 " << std::endl;
-  *pattern_stream << "15 14 " << std::endl;
-  *pattern_stream << "16 0 " << std::endl;
-  *pattern_stream << "16 1 " << std::endl;
-  *pattern_stream << "16 2 " << std::endl;
-  *pattern_stream << "16 3 " << std::endl;
-  *pattern_stream << "16 4 " << std::endl;
-  *pattern_stream << "16 5 " << std::endl;
-  *pattern_stream << "16 6 " << std::endl;
-  *pattern_stream << "16 7 " << std::endl;
-  *pattern_stream << "16 8 " << std::endl;
-  *pattern_stream << "16 9 " << std::endl;
-  *pattern_stream << "16 10 " << std::endl;
-  *pattern_stream << "16 12 " << std::endl;
-  *pattern_stream << "16 13 " << std::endl;
-  *pattern_stream << "16 14 " << std::endl;
-  *pattern_stream << "16 15 " << std::endl;
-  *pattern_stream << "17 0 " << std::endl;
-  *pattern_stream << "17 1 " << std::endl;
-  *pattern_stream << "17 2 " << std::endl;
-  *pattern_stream << "17 6 " << std::endl;
-  *pattern_stream << "17 7 " << std::endl;
-  *pattern_stream << "17 8 " << std::endl;
-  *pattern_stream << "17 9 " << std::endl;
-  *pattern_stream << "17 15 " << std::endl;
-  *pattern_stream << "17 16 " << std::endl;
-  *pattern_stream << "18 0 " << std::endl;
-  *pattern_stream << "18 1 " << std::endl;
-  *pattern_stream << "18 2 " << std::endl;
-  *pattern_stream << "18 3 " << std::endl;
-  *pattern_stream << "18 6 " << std::endl;
-  *pattern_stream << "18 7 " << std::endl;
-  *pattern_stream << "18 8 " << std::endl;
-  *pattern_stream << "18 9 " << std::endl;
-  *pattern_stream << "18 10 " << std::endl;
-  *pattern_stream << "18 15 " << std::endl;
-  *pattern_stream << "18 16 " << std::endl;
-  *pattern_stream << "18 17 " << std::endl;
-  *pattern_stream << "19 0 " << std::endl;
-  *pattern_stream << "19 1 " << std::endl;
-  *pattern_stream << "19 2 " << std::endl;
-  *pattern_stream << "19 3 " << std::endl;
-  *pattern_stream << "19 6 " << std::endl;
-  *pattern_stream << "19 7 " << std::endl;
-  *pattern_stream << "19 8 " << std::endl;
-  *pattern_stream << "19 9 " << std::endl;
-  *pattern_stream << "19 10 " << std::endl;
-  *pattern_stream << "19 11 " << std::endl;
-  *pattern_stream << "19 16 " << std::endl;
-  *pattern_stream << "19 17 " << std::endl;
-  *pattern_stream << "19 18 " << std::endl;
-  *pattern_stream << "20 0 " << std::endl;
-  *pattern_stream << "20 1 " << std::endl;
-  *pattern_stream << "20 2 " << std::endl;
-  *pattern_stream << "20 3 " << std::endl;
-  *pattern_stream << "20 4 " << std::endl;
-  *pattern_stream << "20 7 " << std::endl;
-  *pattern_stream << "20 8 " << std::endl;
-  *pattern_stream << "20 9 " << std::endl;
-  *pattern_stream << "20 10 " << std::endl;
-  *pattern_stream << "20 11 " << std::endl;
-  *pattern_stream << "20 12 " << std::endl;
-  *pattern_stream << "20 17 " << std::endl;
-  *pattern_stream << "20 18 " << std::endl;
-  *pattern_stream << "20 19 " << std::endl;
-  *pattern_stream << "21 0 " << std::endl;
-  *pattern_stream << "21 1 " << std::endl;
-  *pattern_stream << "21 2 " << std::endl;
-  *pattern_stream << "21 3 " << std::endl;
-  *pattern_stream << "21 4 " << std::endl;
-  *pattern_stream << "21 7 " << std::endl;
-  *pattern_stream << "21 8 " << std::endl;
-  *pattern_stream << "21 9 " << std::endl;
-  *pattern_stream << "21 10 " << std::endl;
-  *pattern_stream << "21 11 " << std::endl;
-  *pattern_stream << "21 12 " << std::endl;
-  *pattern_stream << "21 18 " << std::endl;
-  *pattern_stream << "21 19 " << std::endl;
-  *pattern_stream << "21 20 " << std::endl;
-  *pattern_stream << "22 0 " << std::endl;
-  *pattern_stream << "22 2 " << std::endl;
-  *pattern_stream << "22 3 " << std::endl;
-  *pattern_stream << "22 4 " << std::endl;
-  *pattern_stream << "22 5 " << std::endl;
-  *pattern_stream << "22 8 " << std::endl;
-  *pattern_stream << "22 9 " << std::endl;
-  *pattern_stream << "22 10 " << std::endl;
-  *pattern_stream << "22 11 " << std::endl;
-  *pattern_stream << "22 12 " << std::endl;
-  *pattern_stream << "22 13 " << std::endl;
-  *pattern_stream << "22 19 " << std::endl;
-  *pattern_stream << "22 20 " << std::endl;
-  *pattern_stream << "22 21 " << std::endl;
-  *pattern_stream << "23 0 " << std::endl;
-  *pattern_stream << "23 2 " << std::endl;
-  *pattern_stream << "23 3 " << std::endl;
-  *pattern_stream << "23 4 " << std::endl;
-  *pattern_stream << "23 5 " << std::endl;
-  *pattern_stream << "23 9 " << std::endl;
-  *pattern_stream << "23 10 " << std::endl;
-  *pattern_stream << "23 11 " << std::endl;
-  *pattern_stream << "23 12 " << std::endl;
-  *pattern_stream << "23 13 " << std::endl;
-  *pattern_stream << "23 14 " << std::endl;
-  *pattern_stream << "23 20 " << std::endl;
-  *pattern_stream << "23 21 " << std::endl;
-  *pattern_stream << "23 22 " << std::endl;
-  *pattern_stream << "24 0 " << std::endl;
-  *pattern_stream << "24 3 " << std::endl;
-  *pattern_stream << "24 4 " << std::endl;
-  *pattern_stream << "24 5 " << std::endl;
-  *pattern_stream << "24 10 " << std::endl;
-  *pattern_stream << "24 11 " << std::endl;
-  *pattern_stream << "24 12 " << std::endl;
-  *pattern_stream << "24 13 " << std::endl;
-  *pattern_stream << "24 14 " << std::endl;
-  *pattern_stream << "24 21 " << std::endl;
-  *pattern_stream << "24 22 " << std::endl;
-  *pattern_stream << "24 23 " << std::endl;
-  *pattern_stream << "25 0 " << std::endl;
-  *pattern_stream << "25 3 " << std::endl;
-  *pattern_stream << "25 4 " << std::endl;
-  *pattern_stream << "25 5 " << std::endl;
-  *pattern_stream << "25 6 " << std::endl;
-  *pattern_stream << "25 10 " << std::endl;
-  *pattern_stream << "25 11 " << std::endl;
-  *pattern_stream << "25 12 " << std::endl;
-  *pattern_stream << "25 13 " << std::endl;
-  *pattern_stream << "25 14 " << std::endl;
-  *pattern_stream << "25 15 " << std::endl;
-  *pattern_stream << "25 22 " << std::endl;
-  *pattern_stream << "25 23 " << std::endl;
-  *pattern_stream << "25 24 " << std::endl;
-  *pattern_stream << "26 0 " << std::endl;
-  *pattern_stream << "26 3 " << std::endl;
-  *pattern_stream << "26 4 " << std::endl;
-  *pattern_stream << "26 5 " << std::endl;
-  *pattern_stream << "26 6 " << std::endl;
-  *pattern_stream << "26 11 " << std::endl;
-  *pattern_stream << "26 12 " << std::endl;
-  *pattern_stream << "26 13 " << std::endl;
-  *pattern_stream << "26 14 " << std::endl;
-  *pattern_stream << "26 15 " << std::endl;
-  *pattern_stream << "26 16 " << std::endl;
-  *pattern_stream << "26 23 " << std::endl;
-  *pattern_stream << "26 24 " << std::endl;
-  *pattern_stream << "26 25 " << std::endl;
-  *pattern_stream << "27 0 " << std::endl;
-  *pattern_stream << "27 1 " << std::endl;
-  *pattern_stream << "27 4 " << std::endl;
-  *pattern_stream << "27 5 " << std::endl;
-  *pattern_stream << "27 6 " << std::endl;
-  *pattern_stream << "27 7 " << std::endl;
-  *pattern_stream << "27 12 " << std::endl;
-  *pattern_stream << "27 13 " << std::endl;
-  *pattern_stream << "27 14 " << std::endl;
-  *pattern_stream << "27 15 " << std::endl;
-  *pattern_stream << "27 16 " << std::endl;
-  *pattern_stream << "27 24 " << std::endl;
-  *pattern_stream << "27 25 " << std::endl;
-  *pattern_stream << "27 26 " << std::endl;
-  *pattern_stream << "28 0 " << std::endl;
-  *pattern_stream << "28 1 " << std::endl;
-  *pattern_stream << "28 4 " << std::endl;
-  *pattern_stream << "28 5 " << std::endl;
-  *pattern_stream << "28 6 " << std::endl;
-  *pattern_stream << "28 7 " << std::endl;
-  *pattern_stream << "28 12 " << std::endl;
-  *pattern_stream << "28 13 " << std::endl;
-  *pattern_stream << "28 14 " << std::endl;
-  *pattern_stream << "28 15 " << std::endl;
-  *pattern_stream << "28 16 " << std::endl;
-  *pattern_stream << "28 17 " << std::endl;
-  *pattern_stream << "28 25 " << std::endl;
-  *pattern_stream << "28 26 " << std::endl;
-  *pattern_stream << "28 27 " << std::endl;
-  *pattern_stream << "29 0 " << std::endl;
-  *pattern_stream << "29 1 " << std::endl;
-  *pattern_stream << "29 2 " << std::endl;
-  *pattern_stream << "29 5 " << std::endl;
-  *pattern_stream << "29 6 " << std::endl;
-  *pattern_stream << "29 7 " << std::endl;
-  *pattern_stream << "29 8 " << std::endl;
-  *pattern_stream << "29 13 " << std::endl;
-  *pattern_stream << "29 14 " << std::endl;
-  *pattern_stream << "29 15 " << std::endl;
-  *pattern_stream << "29 16 " << std::endl;
-  *pattern_stream << "29 17 " << std::endl;
-  *pattern_stream << "29 18 " << std::endl;
-  *pattern_stream << "29 26 " << std::endl;
-  *pattern_stream << "29 27 " << std::endl;
-  *pattern_stream << "29 28 " << std::endl;
-  *pattern_stream << "30 0 " << std::endl;
-  *pattern_stream << "30 1 " << std::endl;
-  *pattern_stream << "30 2 " << std::endl;
-  *pattern_stream << "30 5 " << std::endl;
-  *pattern_stream << "30 6 " << std::endl;
-  *pattern_stream << "30 7 " << std::endl;
-  *pattern_stream << "30 8 " << std::endl;
-  *pattern_stream << "30 9 " << std::endl;
-  *pattern_stream << "30 14 " << std::endl;
-  *pattern_stream << "30 15 " << std::endl;
-  *pattern_stream << "30 16 " << std::endl;
-  *pattern_stream << "30 17 " << std::endl;
-  *pattern_stream << "30 18 " << std::endl;
-  *pattern_stream << "30 19 " << std::endl;
-  *pattern_stream << "30 27 " << std::endl;
-  *pattern_stream << "30 28 " << std::endl;
-  *pattern_stream << "30 29 " << std::endl;
-  *pattern_stream << "31 1 " << std::endl;
-  *pattern_stream << "31 2 " << std::endl;
-  *pattern_stream << "31 6 " << std::endl;
-  *pattern_stream << "31 7 " << std::endl;
-  *pattern_stream << "31 8 " << std::endl;
-  *pattern_stream << "31 9 " << std::endl;
-  *pattern_stream << "31 15 " << std::endl;
-  *pattern_stream << "31 16 " << std::endl;
-  *pattern_stream << "31 17 " << std::endl;
-  *pattern_stream << "31 18 " << std::endl;
-  *pattern_stream << "31 19 " << std::endl;
-  *pattern_stream << "31 20 " << std::endl;
-  *pattern_stream << "31 28 " << std::endl;
-  *pattern_stream << "31 29 " << std::endl;
-  *pattern_stream << "31 30 " << std::endl;
-  *pattern_stream << "32 1 " << std::endl;
-  *pattern_stream << "32 2 " << std::endl;
-  *pattern_stream << "32 7 " << std::endl;
-  *pattern_stream << "32 8 " << std::endl;
-  *pattern_stream << "32 9 " << std::endl;
-  *pattern_stream << "32 10 " << std::endl;
-  *pattern_stream << "32 16 " << std::endl;
-  *pattern_stream << "32 17 " << std::endl;
-  *pattern_stream << "32 18 " << std::endl;
-  *pattern_stream << "32 19 " << std::endl;
-  *pattern_stream << "32 20 " << std::endl;
-  *pattern_stream << "32 21 " << std::endl;
-  *pattern_stream << "32 29 " << std::endl;
-  *pattern_stream << "32 30 " << std::endl;
-  *pattern_stream << "32 31 " << std::endl;
-  *pattern_stream << "33 1 " << std::endl;
-  *pattern_stream << "33 2 " << std::endl;
-  *pattern_stream << "33 3 " << std::endl;
-  *pattern_stream << "33 7 " << std::endl;
-  *pattern_stream << "33 8 " << std::endl;
-  *pattern_stream << "33 9 " << std::endl;
-  *pattern_stream << "33 10 " << std::endl;
-  *pattern_stream << "33 16 " << std::endl;
-  *pattern_stream << "33 17 " << std::endl;
-  *pattern_stream << "33 18 " << std::endl;
-  *pattern_stream << "33 19 " << std::endl;
-  *pattern_stream << "33 20 " << std::endl;
-  *pattern_stream << "33 21 " << std::endl;
-  *pattern_stream << "33 22 " << std::endl;
-  *pattern_stream << "33 30 " << std::endl;
-  *pattern_stream << "33 31 " << std::endl;
-  *pattern_stream << "33 32 " << std::endl;
-  *pattern_stream << "34 1 " << std::endl;
-  *pattern_stream << "34 2 " << std::endl;
-  *pattern_stream << "34 3 " << std::endl;
-  *pattern_stream << "34 7 " << std::endl;
-  *pattern_stream << "34 8 " << std::endl;
-  *pattern_stream << "34 9 " << std::endl;
-  *pattern_stream << "34 10 " << std::endl;
-  *pattern_stream << "34 11 " << std::endl;
-  *pattern_stream << "34 17 " << std::endl;
-  *pattern_stream << "34 18 " << std::endl;
-  *pattern_stream << "34 19 " << std::endl;
-  *pattern_stream << "34 20 " << std::endl;
-  *pattern_stream << "34 21 " << std::endl;
-  *pattern_stream << "34 22 " << std::endl;
-  *pattern_stream << "34 23 " << std::endl;
-  *pattern_stream << "34 31 " << std::endl;
-  *pattern_stream << "34 32 " << std::endl;
-  *pattern_stream << "34 33 " << std::endl;
-  *pattern_stream << "35 2 " << std::endl;
-  *pattern_stream << "35 3 " << std::endl;
-  *pattern_stream << "35 8 " << std::endl;
-  *pattern_stream << "35 9 " << std::endl;
-  *pattern_stream << "35 10 " << std::endl;
-  *pattern_stream << "35 11 " << std::endl;
-  *pattern_stream << "35 12 " << std::endl;
-  *pattern_stream << "35 18 " << std::endl;
-  *pattern_stream << "35 19 " << std::endl;
-  *pattern_stream << "35 20 " << std::endl;
-  *pattern_stream << "35 21 " << std::endl;
-  *pattern_stream << "35 22 " << std::endl;
-  *pattern_stream << "35 23 " << std::endl;
-  *pattern_stream << "35 32 " << std::endl;
-  *pattern_stream << "35 33 " << std::endl;
-  *pattern_stream << "35 34 " << std::endl;
-  *pattern_stream << "36 2 " << std::endl;
-  *pattern_stream << "36 3 " << std::endl;
-  *pattern_stream << "36 4 " << std::endl;
-  *pattern_stream << "36 8 " << std::endl;
-  *pattern_stream << "36 9 " << std::endl;
-  *pattern_stream << "36 10 " << std::endl;
-  *pattern_stream << "36 11 " << std::endl;
-  *pattern_stream << "36 12 " << std::endl;
-  *pattern_stream << "36 19 " << std::endl;
-  *pattern_stream << "36 20 " << std::endl;
-  *pattern_stream << "36 21 " << std::endl;
-  *pattern_stream << "36 22 " << std::endl;
-  *pattern_stream << "36 23 " << std::endl;
-  *pattern_stream << "36 24 " << std::endl;
-  *pattern_stream << "36 33 " << std::endl;
-  *pattern_stream << "36 34 " << std::endl;
-  *pattern_stream << "36 35 " << std::endl;
-  *pattern_stream << "37 3 " << std::endl;
-  *pattern_stream << "37 4 " << std::endl;
-  *pattern_stream << "37 9 " << std::endl;
-  *pattern_stream << "37 10 " << std::endl;
-  *pattern_stream << "37 11 " << std::endl;
-  *pattern_stream << "37 12 " << std::endl;
-  *pattern_stream << "37 13 " << std::endl;
-  *pattern_stream << "37 20 " << std::endl;
-  *pattern_stream << "37 21 " << std::endl;
-  *pattern_stream << "37 22 " << std::endl;
-  *pattern_stream << "37 23 " << std::endl;
-  *pattern_stream << "37 24 " << std::endl;
-  *pattern_stream << "37 25 " << std::endl;
-  *pattern_stream << "37 34 " << std::endl;
-  *pattern_stream << "37 35 " << std::endl;
-  *pattern_stream << "37 36 " << std::endl;
-  *pattern_stream << "38 3 " << std::endl;
-  *pattern_stream << "38 4 " << std::endl;
-  *pattern_stream << "38 5 " << std::endl;
-  *pattern_stream << "38 10 " << std::endl;
-  *pattern_stream << "38 11 " << std::endl;
-  *pattern_stream << "38 12 " << std::endl;
-  *pattern_stream << "38 13 " << std::endl;
-  *pattern_stream << "38 14 " << std::endl;
-  *pattern_stream << "38 21 " << std::endl;
-  *pattern_stream << "38 22 " << std::endl;
-  *pattern_stream << "38 23 " << std::endl;
-  *pattern_stream << "38 24 " << std::endl;
-  *pattern_stream << "38 25 " << std::endl;
-  *pattern_stream << "38 26 " << std::endl;
-  *pattern_stream << "38 35 " << std::endl;
-  *pattern_stream << "38 36 " << std::endl;
-  *pattern_stream << "38 37 " << std::endl;
-  *pattern_stream << "39 3 " << std::endl;
-  *pattern_stream << "39 4 " << std::endl;
-  *pattern_stream << "39 5 " << std::endl;
-  *pattern_stream << "39 10 " << std::endl;
-  *pattern_stream << "39 11 " << std::endl;
-  *pattern_stream << "39 12 " << std::endl;
-  *pattern_stream << "39 13 " << std::endl;
-  *pattern_stream << "39 14 " << std::endl;
-  *pattern_stream << "39 22 " << std::endl;
-  *pattern_stream << "39 23 " << std::endl;
-  *pattern_stream << "39 24 " << std::endl;
-  *pattern_stream << "39 25 " << std::endl;
-  *pattern_stream << "39 26 " << std::endl;
-  *pattern_stream << "39 27 " << std::endl;
-  *pattern_stream << "39 36 " << std::endl;
-  *pattern_stream << "39 37 " << std::endl;
-  *pattern_stream << "39 38 " << std::endl;
-  *pattern_stream << "40 4 " << std::endl;
-  *pattern_stream << "40 5 " << std::endl;
-  *pattern_stream << "40 11 " << std::endl;
-  *pattern_stream << "40 12 " << std::endl;
-  *pattern_stream << "40 13 " << std::endl;
-  *pattern_stream << "40 14 " << std::endl;
-  *pattern_stream << "40 15 " << std::endl;
-  *pattern_stream << "40 23 " << std::endl;
-  *pattern_stream << "40 24 " << std::endl;
-  *pattern_stream << "40 25 " << std::endl;
-  *pattern_stream << "40 26 " << std::endl;
-  *pattern_stream << "40 27 " << std::endl;
-  *pattern_stream << "40 28 " << std::endl;
-  *pattern_stream << "40 37 " << std::endl;
-  *pattern_stream << "40 38 " << std::endl;
-  *pattern_stream << "40 39 " << std::endl;
-  *pattern_stream << "41 4 " << std::endl;
-  *pattern_stream << "41 5 " << std::endl;
-  *pattern_stream << "41 6 " << std::endl;
-  *pattern_stream << "41 12 " << std::endl;
-  *pattern_stream << "41 13 " << std::endl;
-  *pattern_stream << "41 14 " << std::endl;
-  *pattern_stream << "41 15 " << std::endl;
-  *pattern_stream << "41 16 " << std::endl;
-  *pattern_stream << "41 24 " << std::endl;
-  *pattern_stream << "41 25 " << std::endl;
-  *pattern_stream << "41 26 " << std::endl;
-  *pattern_stream << "41 27 " << std::endl;
-  *pattern_stream << "41 28 " << std::endl;
-  *pattern_stream << "41 29 " << std::endl;
-  *pattern_stream << "41 38 " << std::endl;
-  *pattern_stream << "41 39 " << std::endl;
-  *pattern_stream << "41 40 " << std::endl;
-  *pattern_stream << "42 5 " << std::endl;
-  *pattern_stream << "42 6 " << std::endl;
-  *pattern_stream << "42 12 " << std::endl;
-  *pattern_stream << "42 13 " << std::endl;
-  *pattern_stream << "42 14 " << std::endl;
-  *pattern_stream << "42 15 " << std::endl;
-  *pattern_stream << "42 16 " << std::endl;
-  *pattern_stream << "42 25 " << std::endl;
-  *pattern_stream << "42 26 " << std::endl;
-  *pattern_stream << "42 27 " << std::endl;
-  *pattern_stream << "42 28 " << std::endl;
-  *pattern_stream << "42 29 " << std::endl;
-  *pattern_stream << "42 30 " << std::endl;
-  *pattern_stream << "42 39 " << std::endl;
-  *pattern_stream << "42 40 " << std::endl;
-  *pattern_stream << "42 41 " << std::endl;
-  *pattern_stream << "43 1 " << std::endl;
-  *pattern_stream << "43 5 " << std::endl;
-  *pattern_stream << "43 6 " << std::endl;
-  *pattern_stream << "43 7 " << std::endl;
-  *pattern_stream << "43 13 " << std::endl;
-  *pattern_stream << "43 14 " << std::endl;
-  *pattern_stream << "43 15 " << std::endl;
-  *pattern_stream << "43 16 " << std::endl;
-  *pattern_stream << "43 17 " << std::endl;
-  *pattern_stream << "43 25 " << std::endl;
-  *pattern_stream << "43 26 " << std::endl;
-  *pattern_stream << "43 27 " << std::endl;
-  *pattern_stream << "43 28 " << std::endl;
-  *pattern_stream << "43 29 " << std::endl;
-  *pattern_stream << "43 30 " << std::endl;
-  *pattern_stream << "43 31 " << std::endl;
-  *pattern_stream << "43 40 " << std::endl;
-  *pattern_stream << "43 41 " << std::endl;
-  *pattern_stream << "43 42 " << std::endl;
-  *pattern_stream << "44 1 " << std::endl;
-  *pattern_stream << "44 5 " << std::endl;
-  *pattern_stream << "44 6 " << std::endl;
-  *pattern_stream << "44 7 " << std::endl;
-  *pattern_stream << "44 8 " << std::endl;
-  *pattern_stream << "44 14 " << std::endl;
-  *pattern_stream << "44 15 " << std::endl;
-  *pattern_stream << "44 16 " << std::endl;
-  *pattern_stream << "44 17 " << std::endl;
-  *pattern_stream << "44 18 " << std::endl;
-  *pattern_stream << "44 26 " << std::endl;
-  *pattern_stream << "44 27 " << std::endl;
-  *pattern_stream << "44 28 " << std::endl;
-  *pattern_stream << "44 29 " << std::endl;
-  *pattern_stream << "44 30 " << std::endl;
-  *pattern_stream << "44 31 " << std::endl;
-  *pattern_stream << "44 32 " << std::endl;
-  *pattern_stream << "44 41 " << std::endl;
-  *pattern_stream << "44 42 " << std::endl;
-  *pattern_stream << "44 43 " << std::endl;
-  *pattern_stream << "45 1 " << std::endl;
-  *pattern_stream << "45 6 " << std::endl;
-  *pattern_stream << "45 7 " << std::endl;
-  *pattern_stream << "45 8 " << std::endl;
-  *pattern_stream << "45 14 " << std::endl;
-  *pattern_stream << "45 15 " << std::endl;
-  *pattern_stream << "45 16 " << std::endl;
-  *pattern_stream << "45 17 " << std::endl;
-  *pattern_stream << "45 18 " << std::endl;
-  *pattern_stream << "45 19 " << std::endl;
-  *pattern_stream << "45 27 " << std::endl;
-  *pattern_stream << "45 28 " << std::endl;
-  *pattern_stream << "45 29 " << std::endl;
-  *pattern_stream << "45 30 " << std::endl;
-  *pattern_stream << "45 31 " << std::endl;
-  *pattern_stream << "45 32 " << std::endl;
-  *pattern_stream << "45 33 " << std::endl;
-  *pattern_stream << "45 42 " << std::endl;
-  *pattern_stream << "45 43 " << std::endl;
-  *pattern_stream << "45 44 " << std::endl;
-  *pattern_stream << "46 7 " << std::endl;
-  *pattern_stream << "46 17 " << std::endl;
-  *pattern_stream << "46 18 " << std::endl;
-  *pattern_stream << "46 19 " << std::endl;
-  *pattern_stream << "46 29 " << std::endl;
-  *pattern_stream << "46 30 " << std::endl;
-  *pattern_stream << "46 31 " << std::endl;
-  *pattern_stream << "46 32 " << std::endl;
-  *pattern_stream << "46 33 " << std::endl;
-  *pattern_stream << "46 44 " << std::endl;
-  *pattern_stream << "46 45 " << std::endl;
-  *pattern_stream << "47 7 " << std::endl;
-  *pattern_stream << "47 8 " << std::endl;
-  *pattern_stream << "47 17 " << std::endl;
-  *pattern_stream << "47 18 " << std::endl;
-  *pattern_stream << "47 19 " << std::endl;
-  *pattern_stream << "47 30 " << std::endl;
-  *pattern_stream << "47 31 " << std::endl;
-  *pattern_stream << "47 32 " << std::endl;
-  *pattern_stream << "47 33 " << std::endl;
-  *pattern_stream << "47 34 " << std::endl;
-  *pattern_stream << "47 45 " << std::endl;
-  *pattern_stream << "47 46 " << std::endl;
-  *pattern_stream << "48 8 " << std::endl;
-  *pattern_stream << "48 17 " << std::endl;
-  *pattern_stream << "48 18 " << std::endl;
-  *pattern_stream << "48 19 " << std::endl;
-  *pattern_stream << "48 20 " << std::endl;
-  *pattern_stream << "48 31 " << std::endl;
-  *pattern_stream << "48 32 " << std::endl;
-  *pattern_stream << "48 33 " << std::endl;
-  *pattern_stream << "48 34 " << std::endl;
-  *pattern_stream << "48 35 " << std::endl;
-  *pattern_stream << "48 45 " << std::endl;
-  *pattern_stream << "48 46 " << std::endl;
-  *pattern_stream << "48 47 " << std::endl;
-  *pattern_stream << "49 8 " << std::endl;
-  *pattern_stream << "49 9 " << std::endl;
-  *pattern_stream << "49 18 " << std::endl;
-  *pattern_stream << "49 19 " << std::endl;
-  *pattern_stream << "49 20 " << std::endl;
-  *pattern_stream << "49 21 " << std::endl;
-  *pattern_stream << "49 31 " << std::endl;
-  *pattern_stream << "49 32 " << std::endl;
-  *pattern_stream << "49 33 " << std::endl;
-  *pattern_stream << "49 34 " << std::endl;
-  *pattern_stream << "49 35 " << std::endl;
-  *pattern_stream << "49 46 " << std::endl;
-  *pattern_stream << "49 47 " << std::endl;
-  *pattern_stream << "49 48 " << std::endl;
-  *pattern_stream << "50 9 " << std::endl;
-  *pattern_stream << "50 18 " << std::endl;
-  *pattern_stream << "50 19 " << std::endl;
-  *pattern_stream << "50 20 " << std::endl;
-  *pattern_stream << "50 21 " << std::endl;
-  *pattern_stream << "50 32 " << std::endl;
-  *pattern_stream << "50 33 " << std::endl;
-  *pattern_stream << "50 34 " << std::endl;
-  *pattern_stream << "50 35 " << std::endl;
-  *pattern_stream << "50 36 " << std::endl;
-  *pattern_stream << "50 47 " << std::endl;
-  *pattern_stream << "50 48 " << std::endl;
-  *pattern_stream << "50 49 " << std::endl;
-  *pattern_stream << "51 9 " << std::endl;
-  *pattern_stream << "51 10 " << std::endl;
-  *pattern_stream << "51 19 " << std::endl;
-  *pattern_stream << "51 20 " << std::endl;
-  *pattern_stream << "51 21 " << std::endl;
-  *pattern_stream << "51 22 " << std::endl;
-  *pattern_stream << "51 33 " << std::endl;
-  *pattern_stream << "51 34 " << std::endl;
-  *pattern_stream << "51 35 " << std::endl;
-  *pattern_stream << "51 36 " << std::endl;
-  *pattern_stream << "51 37 " << std::endl;
-  *pattern_stream << "51 48 " << std::endl;
-  *pattern_stream << "51 49 " << std::endl;
-  *pattern_stream << "51 50 " << std::endl;
-  *pattern_stream << "52 10 " << std::endl;
-  *pattern_stream << "52 20 " << std::endl;
-  *pattern_stream << "52 21 " << std::endl;
-  *pattern_stream << "52 22 " << std::endl;
-  *pattern_stream << "52 23 " << std::endl;
-  *pattern_stream << "52 33 " << std::endl;
-  *pattern_stream << "52 34 " << std::endl;
-  *pattern_stream << "52 35 " << std::endl;
-  *pattern_stream << "52 36 " << std::endl;
-  *pattern_stream << "52 37 " << std::endl;
-  *pattern_stream << "52 38 " << std::endl;
-  *pattern_stream << "52 49 " << std::endl;
-  *pattern_stream << "52 50 " << std::endl;
-  *pattern_stream << "52 51 " << std::endl;
-  *pattern_stream << "53 10 " << std::endl;
-  *pattern_stream << "53 11 " << std::endl;
-  *pattern_stream << "53 20 " << std::endl;
-  *pattern_stream << "53 21 " << std::endl;
-  *pattern_stream << "53 22 " << std::endl;
-  *pattern_stream << "53 23 " << std::endl;
-  *pattern_stream << "53 34 " << std::endl;
-  *pattern_stream << "53 35 " << std::endl;
-  *pattern_stream << "53 36 " << std::endl;
-  *pattern_stream << "53 37 " << std::endl;
-  *pattern_stream << "53 38 " << std::endl;
-  *pattern_stream << "53 50 " << std::endl;
-  *pattern_stream << "53 51 " << std::endl;
-  *pattern_stream << "53 52 " << std::endl;
-  *pattern_stream << "54 11 " << std::endl;
-  *pattern_stream << "54 21 " << std::endl;
-  *pattern_stream << "54 22 " << std::endl;
-  *pattern_stream << "54 23 " << std::endl;
-  *pattern_stream << "54 24 " << std::endl;
-  *pattern_stream << "54 35 " << std::endl;
-  *pattern_stream << "54 36 " << std::endl;
-  *pattern_stream << "54 37 " << std::endl;
-  *pattern_stream << "54 38 " << std::endl;
-  *pattern_stream << "54 39 " << std::endl;
-  *pattern_stream << "54 51 " << std::endl;
-  *pattern_stream << "54 52 " << std::endl;
-  *pattern_stream << "54 53 " << std::endl;
-  *pattern_stream << "55 11 " << std::endl;
-  *pattern_stream << "55 12 " << std::endl;
-  *pattern_stream << "55 22 " << std::endl;
-  *pattern_stream << "55 23 " << std::endl;
-  *pattern_stream << "55 24 " << std::endl;
-  *pattern_stream << "55 25 " << std::endl;
-  *pattern_stream << "55 36 " << std::endl;
-  *pattern_stream << "55 37 " << std::endl;
-  *pattern_stream << "55 38 " << std::endl;
-  *pattern_stream << "55 39 " << std::endl;
-  *pattern_stream << "55 40 " << std::endl;
-  *pattern_stream << "55 52 " << std::endl;
-  *pattern_stream << "55 53 " << std::endl;
-  *pattern_stream << "55 54 " << std::endl;
-  *pattern_stream << "56 12 " << std::endl;
-  *pattern_stream << "56 22 " << std::endl;
-  *pattern_stream << "56 23 " << std::endl;
-  *pattern_stream << "56 24 " << std::endl;
-  *pattern_stream << "56 25 " << std::endl;
-  *pattern_stream << "56 26 " << std::endl;
-  *pattern_stream << "56 36 " << std::endl;
-  *pattern_stream << "56 37 " << std::endl;
-  *pattern_stream << "56 38 " << std::endl;
-  *pattern_stream << "56 39 " << std::endl;
-  *pattern_stream << "56 40 " << std::endl;
-  *pattern_stream << "56 41 " << std::endl;
-  *pattern_stream << "56 53 " << std::endl;
-  *pattern_stream << "56 54 " << std::endl;
-  *pattern_stream << "56 55 " << std::endl;
-  *pattern_stream << "57 12 " << std::endl;
-  *pattern_stream << "57 13 " << std::endl;
-  *pattern_stream << "57 23 " << std::endl;
-  *pattern_stream << "57 24 " << std::endl;
-  *pattern_stream << "57 25 " << std::endl;
-  *pattern_stream << "57 26 " << std::endl;
-  *pattern_stream << "57 37 " << std::endl;
-  *pattern_stream << "57 38 " << std::endl;
-  *pattern_stream << "57 39 " << std::endl;
-  *pattern_stream << "57 40 " << std::endl;
-  *pattern_stream << "57 41 " << std::endl;
-  *pattern_stream << "57 54 " << std::endl;
-  *pattern_stream << "57 55 " << std::endl;
-  *pattern_stream << "57 56 " << std::endl;
-  *pattern_stream << "58 13 " << std::endl;
-  *pattern_stream << "58 24 " << std::endl;
-  *pattern_stream << "58 25 " << std::endl;
-  *pattern_stream << "58 26 " << std::endl;
-  *pattern_stream << "58 27 " << std::endl;
-  *pattern_stream << "58 38 " << std::endl;
-  *pattern_stream << "58 39 " << std::endl;
-  *pattern_stream << "58 40 " << std::endl;
-  *pattern_stream << "58 41 " << std::endl;
-  *pattern_stream << "58 42 " << std::endl;
-  *pattern_stream << "58 55 " << std::endl;
-  *pattern_stream << "58 56 " << std::endl;
-  *pattern_stream << "58 57 " << std::endl;
-  *pattern_stream << "59 13 " << std::endl;
-  *pattern_stream << "59 14 " << std::endl;
-  *pattern_stream << "59 25 " << std::endl;
-  *pattern_stream << "59 26 " << std::endl;
-  *pattern_stream << "59 27 " << std::endl;
-  *pattern_stream << "59 28 " << std::endl;
-  *pattern_stream << "59 39 " << std::endl;
-  *pattern_stream << "59 40 " << std::endl;
-  *pattern_stream << "59 41 " << std::endl;
-  *pattern_stream << "59 42 " << std::endl;
-  *pattern_stream << "59 43 " << std::endl;
-  *pattern_stream << "59 56 " << std::endl;
-  *pattern_stream << "59 57 " << std::endl;
-  *pattern_stream << "59 58 " << std::endl;
-  *pattern_stream << "60 14 " << std::endl;
-  *pattern_stream << "60 25 " << std::endl;
-  *pattern_stream << "60 26 " << std::endl;
-  *pattern_stream << "60 27 " << std::endl;
-  *pattern_stream << "60 28 " << std::endl;
-  *pattern_stream << "60 39 " << std::endl;
-  *pattern_stream << "60 40 " << std::endl;
-  *pattern_stream << "60 41 " << std::endl;
-  *pattern_stream << "60 42 " << std::endl;
-  *pattern_stream << "60 43 " << std::endl;
-  *pattern_stream << "60 44 " << std::endl;
-  *pattern_stream << "60 57 " << std::endl;
-  *pattern_stream << "60 58 " << std::endl;
-  *pattern_stream << "60 59 " << std::endl;
-  *pattern_stream << "61 14 " << std::endl;
-  *pattern_stream << "61 15 " << std::endl;
-  *pattern_stream << "61 26 " << std::endl;
-  *pattern_stream << "61 27 " << std::endl;
-  *pattern_stream << "61 28 " << std::endl;
-  *pattern_stream << "61 29 " << std::endl;
-  *pattern_stream << "61 40 " << std::endl;
-  *pattern_stream << "61 41 " << std::endl;
-  *pattern_stream << "61 42 " << std::endl;
-  *pattern_stream << "61 43 " << std::endl;
-  *pattern_stream << "61 44 " << std::endl;
-  *pattern_stream << "61 58 " << std::endl;
-  *pattern_stream << "61 59 " << std::endl;
-  *pattern_stream << "61 60 " << std::endl;
-  *pattern_stream << "62 15 " << std::endl;
-  *pattern_stream << "62 27 " << std::endl;
-  *pattern_stream << "62 28 " << std::endl;
-  *pattern_stream << "62 29 " << std::endl;
-  *pattern_stream << "62 30 " << std::endl;
-  *pattern_stream << "62 41 " << std::endl;
-  *pattern_stream << "62 42 " << std::endl;
-  *pattern_stream << "62 43 " << std::endl;
-  *pattern_stream << "62 44 " << std::endl;
-  *pattern_stream << "62 45 " << std::endl;
-  *pattern_stream << "62 59 " << std::endl;
-  *pattern_stream << "62 60 " << std::endl;
-  *pattern_stream << "62 61 " << std::endl;
-  *pattern_stream << "63 15 " << std::endl;
-  *pattern_stream << "63 16 " << std::endl;
-  *pattern_stream << "63 27 " << std::endl;
-  *pattern_stream << "63 28 " << std::endl;
-  *pattern_stream << "63 29 " << std::endl;
-  *pattern_stream << "63 30 " << std::endl;
-  *pattern_stream << "63 31 " << std::endl;
-  *pattern_stream << "63 42 " << std::endl;
-  *pattern_stream << "63 43 " << std::endl;
-  *pattern_stream << "63 44 " << std::endl;
-  *pattern_stream << "63 45 " << std::endl;
-  *pattern_stream << "63 46 " << std::endl;
-  *pattern_stream << "63 60 " << std::endl;
-  *pattern_stream << "63 61 " << std::endl;
-  *pattern_stream << "63 62 " << std::endl;
-  *pattern_stream << "64 16 " << std::endl;
-  *pattern_stream << "64 17 " << std::endl;
-  *pattern_stream << "64 28 " << std::endl;
-  *pattern_stream << "64 29 " << std::endl;
-  *pattern_stream << "64 30 " << std::endl;
-  *pattern_stream << "64 31 " << std::endl;
-  *pattern_stream << "64 32 " << std::endl;
-  *pattern_stream << "64 42 " << std::endl;
-  *pattern_stream << "64 43 " << std::endl;
-  *pattern_stream << "64 44 " << std::endl;
-  *pattern_stream << "64 45 " << std::endl;
-  *pattern_stream << "64 46 " << std::endl;
-  *pattern_stream << "64 47 " << std::endl;
-  *pattern_stream << "64 61 " << std::endl;
-  *pattern_stream << "64 62 " << std::endl;
-  *pattern_stream << "64 63 " << std::endl;
-  *pattern_stream << "65 7 " << std::endl;
-  *pattern_stream << "65 16 " << std::endl;
-  *pattern_stream << "65 17 " << std::endl;
-  *pattern_stream << "65 18 " << std::endl;
-  *pattern_stream << "65 29 " << std::endl;
-  *pattern_stream << "65 30 " << std::endl;
-  *pattern_stream << "65 31 " << std::endl;
-  *pattern_stream << "65 32 " << std::endl;
-  *pattern_stream << "65 43 " << std::endl;
-  *pattern_stream << "65 44 " << std::endl;
-  *pattern_stream << "65 45 " << std::endl;
-  *pattern_stream << "65 46 " << std::endl;
-  *pattern_stream << "65 47 " << std::endl;
-  *pattern_stream << "65 48 " << std::endl;
-  *pattern_stream << "65 62 " << std::endl;
-  *pattern_stream << "65 63 " << std::endl;
-  *pattern_stream << "65 64 " << std::endl;
+  BriskPattern pattern;
+  GetDefaultPattern(&pattern);
+  WritePatternText(pattern, pattern_stream);
+}
+
+bool ReadPatternText(std::istream& pattern_stream, BriskPattern* pattern) {
+  CHECK_NOTNULL(pattern);
+  unsigned int num_points;
+  if (!(pattern_stream >> num_points) || num_points > kMaxPatternEntries) {
+    return false;
+  }
+  pattern->points.resize(num_points);
+  for (BriskPatternPoint& point : pattern->points) {
+    if (!(pattern_stream >> point.x >> point.y >> point.sigma)) {
+      return false;
+    }
+  }
+  return ReadTextPairs(pattern_stream, &pattern->shortPairs) &&
+      ReadTextPairs(pattern_stream, &pattern->longPairs) &&
+      IndicesValid(pattern->shortPairs, num_points) &&
+      IndicesValid(pattern->longPairs, num_points);
+}
+
+void WritePatternText(const BriskPattern& pattern,
+                      std::ostream* pattern_stream) {
+  CHECK_NOTNULL(pattern_stream);
+  // Nine significant digits make floats survive the round trip.
+  *pattern_stream << std::setprecision(9) << pattern.points.size()
+      << std::endl;
+  for (const BriskPatternPoint& point : pattern.points) {
+    *pattern_stream << point.x << " " << point.y << " " << point.sigma
+        << std::endl;
+  }
+  *pattern_stream << pattern.shortPairs.size() << std::endl;
+  for (const BriskShortPair& pair : pattern.shortPairs) {
+    *pattern_stream << pair.i << " " << pair.j << std::endl;
+  }
+  *pattern_stream << pattern.longPairs.size() << std::endl;
+  for (const BriskShortPair& pair : pattern.longPairs) {
+    *pattern_stream << pair.i << " " << pair.j << std::endl;
+  }
+}
+
+bool ReadPatternBinary(std::istream& pattern_stream, BriskPattern* pattern) {
+  CHECK_NOTNULL(pattern);
+  char tag[sizeof(kBinaryPatternTag)];
+  pattern_stream.read(tag, sizeof(tag));
+  if (!pattern_stream.good() ||
+      memcmp(tag, kBinaryPatternTag, sizeof(tag)) != 0) {
+    return false;
+  }
+  uint32_t version;
+  if (!ReadBinary(pattern_stream, &version) ||
+      version != kBinaryPatternVersion) {
+    return false;
+  }
+  uint32_t num_points;
+  if (!ReadBinary(pattern_stream, &num_points) ||
+      !CountValid(pattern_stream, num_points, kBinaryPointSize)) {
+    return false;
+  }
+  pattern->points.resize(num_points);
+  for (BriskPatternPoint& point : pattern->points) {
+    if (!ReadBinary(pattern_stream, &point.x) ||
+        !ReadBinary(pattern_stream, &point.y) ||
+        !ReadBinary(pattern_stream, &point.sigma)) {
+      return false;
+    }
+  }
+  return ReadBinaryPairs(pattern_stream, &pattern->shortPairs) &&
+      ReadBinaryPairs(pattern_stream, &pattern->longPairs) &&
+      IndicesValid(pattern->shortPairs, num_points) &&
+      IndicesValid(pattern->longPairs, num_points);
+}
+
+void WritePatternBinary(const BriskPattern& pattern,
+                        std::ostream* pattern_stream) {
+  CHECK_NOTNULL(pattern_stream);
+  pattern_stream->write(kBinaryPatternTag, sizeof(kBinaryPatternTag));
+  WriteBinary(kBinaryPatternVersion, pattern_stream);
+  WriteBinary(static_cast<uint32_t>(pattern.points.size()), pattern_stream);
+  for (const BriskPatternPoint& point : pattern.points) {
+    WriteBinary(point.x, pattern_stream);
+    WriteBinary(point.y, pattern_stream);
+    WriteBinary(point.sigma, pattern_stream);
+  }
+  WriteBinaryPairs(pattern.shortPairs, pattern_stream);
+  WriteBinaryPairs(pattern.longPairs, pattern_stream);
+}
+
+bool ReadPatternFile(const std::string& fname, BriskPattern* pattern) {
+  CHECK_NOTNULL(pattern);
+  std::ifstream file(fname.c_str(), std::ios::in | std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  char tag[sizeof(kBinaryPatternTag)];
+  file.read(tag, sizeof(tag));
+  const bool is_binary = file.good() &&
+      memcmp(tag, kBinaryPatternTag, sizeof(tag)) == 0;
+  file.clear();
+  file.seekg(0);
+  if (is_binary) {
+    return ReadPatternBinary(file, pattern);
+  }
+  return ReadPatternText(file, pattern);
 }
 }  // namespace brisk
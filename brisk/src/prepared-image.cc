@@ -0,0 +1,121 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <brisk/internal/image-down-sampling.h>
+#include <brisk/internal/integral-image.h>
+#include <brisk/prepared-image.h>
+
+namespace brisk {
+struct PreparedImage::Data {
+  agast::Mat image;
+
+  std::once_flag integralBuilt;
+  agast::Mat integral;
+
+  std::mutex layersMutex;
+  std::vector<agast::Mat> layers;
+};
+
+PreparedImage::PreparedImage() : data_(new Data) { }
+
+PreparedImage::PreparedImage(const agast::Mat& image) : data_(new Data) {
+  data_->image = image.isContinuous() ? image : image.clone();
+  data_->layers.push_back(data_->image);
+}
+
+bool PreparedImage::empty() const {
+  return data_->image.empty();
+}
+
+const agast::Mat& PreparedImage::GetImage() const {
+  return data_->image;
+}
+
+const agast::Mat& PreparedImage::GetIntegral() const {
+  CHECK(!empty());
+  Data& data = *data_;
+  std::call_once(data.integralBuilt, [&data]() {
+    if (data.image.type() == CV_16UC1) {
+      IntegralImage16(data.image, &data.integral);
+    } else if (data.image.type() == CV_8UC1) {
+      IntegralImage8(data.image, &data.integral);
+    } else {
+      throw std::runtime_error(
+          "Unsupported image format. Must be CV_16UC1 or CV_8UC1.");
+    }
+  });
+  return data.integral;
+}
+
+agast::Mat PreparedImage::GetLayer(size_t layer) const {
+  CHECK(!empty());
+  CHECK(data_->image.type() == CV_8UC1 || data_->image.type() == CV_16UC1)
+      << "Unsupported image format. Must be CV_16UC1 or CV_8UC1.";
+  std::lock_guard<std::mutex> lock(data_->layersMutex);
+  std::vector<agast::Mat>& layers = data_->layers;
+  const bool is16Bit = data_->image.type() == CV_16UC1;
+  while (layers.size() <= layer) {
+    const size_t i = layers.size();
+    agast::Mat img;
+    if (i == 1) {
+      const agast::Mat& below = layers[0];
+      img.create((below.rows / 3) * 2, (below.cols / 3) * 2, below.type());
+      if (is16Bit) {
+        Twothirdsample16(below, img);
+      } else {
+        Twothirdsample8(below, img);
+      }
+    } else {
+      const agast::Mat& below = layers[i - 2];
+      img.create(below.rows / 2, below.cols / 2, below.type());
+      if (is16Bit) {
+        Halfsample16(below, img);
+      } else {
+        Halfsample8(below, img);
+      }
+    }
+    layers.push_back(img);
+  }
+  return layers[layer];
+}
+}  // namespace brisk
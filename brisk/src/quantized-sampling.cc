@@ -0,0 +1,192 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+
+#include <glog/logging.h>
+
+#include <brisk/internal/quantized-sampling.h>
+
+namespace brisk {
+namespace {
+// Boxes up to this width in 1/1024 pixels keep the products of the
+// normalization within 64 bit.
+const uint32_t kMaxBoxWidth = 1u << 22;
+
+SamplingAxis GetSamplingAxis(float position, float sigma_half) {
+  SamplingAxis axis;
+  if (sigma_half < 0.5) {
+    // Bilinear interpolation between two pixels.
+    const int lo = static_cast<int>(floor(position));
+    const int weightHi = static_cast<int>((position - lo) * 1024.0f + 0.5f);
+    axis.lo = lo;
+    axis.hi = lo + 1;
+    axis.weightLo = 1024 - weightHi;
+    return axis;
+  }
+  const float lo_border = position - sigma_half;
+  const float hi_border = position + sigma_half;
+  const int lo = static_cast<int>(floor(lo_border + 0.5f));
+  axis.lo = lo;
+  axis.hi = static_cast<int>(floor(hi_border + 0.5f));
+  axis.weightLo = static_cast<int>((lo - lo_border + 0.5f) * 1024.0f + 0.5f);
+  return axis;
+}
+
+// The weight of the last pixel of an axis of a box of the given width.
+inline int64_t WeightHi(const SamplingAxis& axis, int width) {
+  return width - axis.weightLo - ((axis.hi - axis.lo - 1) << 10);
+}
+
+// Sum of the pixels in columns [x0, x1] of row y.
+inline int RowSum(const int* integral, int integralcols, int y, int x0,
+                  int x1) {
+  const int* row = integral + y * integralcols;
+  const int* next_row = row + integralcols;
+  return next_row[x1 + 1] - row[x1 + 1] - next_row[x0] + row[x0];
+}
+
+// Sum of the pixels in rows [y0, y1] of column x.
+inline int ColumnSum(const int* integral, int integralcols, int x, int y0,
+                     int y1) {
+  const int* top = integral + y0 * integralcols;
+  const int* bottom = integral + (y1 + 1) * integralcols;
+  return bottom[x + 1] - bottom[x] - top[x + 1] + top[x];
+}
+
+// Sum of the pixels in [x0, x1] x [y0, y1].
+inline int BoxSum(const int* integral, int integralcols, int x0, int y0,
+                  int x1, int y1) {
+  const int* top = integral + y0 * integralcols;
+  const int* bottom = integral + (y1 + 1) * integralcols;
+  return bottom[x1 + 1] - bottom[x0] - top[x1 + 1] + top[x0];
+}
+
+// Splits a coordinate into its integer part and the nearest phase.
+inline void Quantize(float position, int* integer, int* phase) {
+  const int quantized =
+      static_cast<int>(floor(position * kSamplingPhases + 0.5f));
+  *integer = quantized >= 0 ? quantized / kSamplingPhases :
+      -((-quantized + kSamplingPhases - 1) / kSamplingPhases);
+  *phase = quantized - *integer * kSamplingPhases;
+}
+}  // namespace
+
+void BuildSamplingBoxes(const BriskPatternPoint* points, unsigned int count,
+                        SamplingBox* boxes) {
+  CHECK_NOTNULL(points);
+  CHECK_NOTNULL(boxes);
+  for (unsigned int i = 0; i < count; ++i) {
+    const uint32_t width = points[i].sigma < 0.5 ? 1024 :
+        static_cast<uint32_t>(2.0f * points[i].sigma * 1024.0f + 0.5f);
+    CHECK_LE(width, kMaxBoxWidth);
+    boxes[i].width = width;
+    boxes[i].inverseWidth = static_cast<uint32_t>(
+        ((static_cast<uint64_t>(1) << kInverseWidthBits) + width / 2) / width);
+    for (int phase = 0; phase < kSamplingPhases; ++phase) {
+      const float offset = static_cast<float>(phase) / kSamplingPhases;
+      boxes[i].x[phase] = GetSamplingAxis(points[i].x + offset,
+                                          points[i].sigma);
+      boxes[i].y[phase] = GetSamplingAxis(points[i].y + offset,
+                                          points[i].sigma);
+    }
+  }
+}
+
+void QuantizedSmoothedIntensities(const agast::Mat& image,
+                                  const agast::Mat& integral, float key_x,
+                                  float key_y, const SamplingBox* boxes,
+                                  unsigned int num_points, int* values) {
+  CHECK_NOTNULL(boxes);
+  CHECK_NOTNULL(values);
+  CHECK_EQ(image.type(), CV_8UC1);
+  CHECK_EQ(integral.type(), CV_32SC1);
+  const int imagecols = image.cols;
+  const int integralcols = imagecols + 1;
+  const unsigned char* image_data = image.data;
+  const int* integral_data = reinterpret_cast<const int*>(integral.data);
+
+  int key_x_int, key_y_int, phase_x, phase_y;
+  Quantize(key_x, &key_x_int, &phase_x);
+  Quantize(key_y, &key_y_int, &phase_y);
+
+  for (unsigned int i = 0; i < num_points; ++i) {
+    const SamplingBox& box = boxes[i];
+    const SamplingAxis& axis_x = box.x[phase_x];
+    const SamplingAxis& axis_y = box.y[phase_y];
+    const int x_lo = key_x_int + axis_x.lo;
+    const int x_hi = key_x_int + axis_x.hi;
+    const int y_lo = key_y_int + axis_y.lo;
+    const int y_hi = key_y_int + axis_y.hi;
+    const int64_t w_x_lo = axis_x.weightLo;
+    const int64_t w_x_hi = WeightHi(axis_x, box.width);
+    const int64_t w_y_lo = axis_y.weightLo;
+    const int64_t w_y_hi = WeightHi(axis_y, box.width);
+
+    // The corners.
+    const unsigned char* row_lo = image_data + y_lo * imagecols;
+    const unsigned char* row_hi = image_data + y_hi * imagecols;
+    int64_t ret_val = w_y_lo * (w_x_lo * row_lo[x_lo] + w_x_hi * row_lo[x_hi])
+        + w_y_hi * (w_x_lo * row_hi[x_lo] + w_x_hi * row_hi[x_hi]);
+    // The edges and the inside, which have a weight of 1024.
+    if (x_hi - x_lo > 1) {
+      ret_val += (w_y_lo * RowSum(integral_data, integralcols, y_lo, x_lo + 1,
+                                  x_hi - 1)
+          + w_y_hi * RowSum(integral_data, integralcols, y_hi, x_lo + 1,
+                            x_hi - 1)) << 10;
+    }
+    if (y_hi - y_lo > 1) {
+      ret_val += (w_x_lo * ColumnSum(integral_data, integralcols, x_lo,
+                                     y_lo + 1, y_hi - 1)
+          + w_x_hi * ColumnSum(integral_data, integralcols, x_hi, y_lo + 1,
+                               y_hi - 1)) << 10;
+      if (x_hi - x_lo > 1) {
+        ret_val += static_cast<int64_t>(BoxSum(integral_data, integralcols,
+                                               x_lo + 1, y_lo + 1, x_hi - 1,
+                                               y_hi - 1)) << 20;
+      }
+    }
+
+    // Normalize to 1024 times the mean intensity, i.e. multiply by 1024 and
+    // divide by the width twice. The sum is below 2^8 * width^2, so the
+    // first product stays below 2^62 and the second one below 2^50.
+    const int64_t inverse = box.inverseWidth;
+    const int64_t partial = (ret_val * inverse) >> (kInverseWidthBits - 10);
+    values[i] = static_cast<int>((partial * inverse) >> kInverseWidthBits);
+  }
+}
+}  // namespace brisk
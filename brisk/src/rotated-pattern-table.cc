@@ -0,0 +1,295 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <map>
+
+#include <glog/logging.h>
+
+#include <brisk/internal/rotated-pattern-table.h>
+
+namespace brisk {
+namespace {
+template<typename T>
+void AppendBytes(const T* data, size_t count, std::string* key) {
+  key->append(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+// Builds a key that uniquely identifies the content of a table.
+std::string GetTableKey(const PatternDefinition& pattern, float patternScale,
+                        unsigned int numScales, unsigned int numRotations,
+                        float scaleRange) {
+  std::string key;
+  const int type = pattern.type;
+  AppendBytes(&type, 1, &key);
+  AppendBytes(&patternScale, 1, &key);
+  AppendBytes(&numScales, 1, &key);
+  AppendBytes(&numRotations, 1, &key);
+  AppendBytes(&scaleRange, 1, &key);
+  const size_t numPoints = pattern.points.size();
+  AppendBytes(&numPoints, 1, &key);
+  for (const BriskPatternPoint& point : pattern.points) {
+    AppendBytes(&point.x, 1, &key);
+    AppendBytes(&point.y, 1, &key);
+    AppendBytes(&point.sigma, 1, &key);
+  }
+  const size_t numRings = pattern.ringRadii.size();
+  AppendBytes(&numRings, 1, &key);
+  AppendBytes(pattern.ringRadii.data(), numRings, &key);
+  AppendBytes(pattern.ringNumPoints.data(), numRings, &key);
+  return key;
+}
+}  // namespace
+
+unsigned int PatternDefinition::NumPoints() const {
+  if (type == kPoints) {
+    return points.size();
+  }
+  unsigned int numPoints = 0;
+  for (int ringNumPoint : ringNumPoints) {
+    numPoints += ringNumPoint;
+  }
+  return numPoints;
+}
+
+std::shared_ptr<const RotatedPatternTable> RotatedPatternTable::Get(
+    const PatternDefinition& pattern, float patternScale,
+    unsigned int numScales, unsigned int numRotations, float scaleRange) {
+  typedef std::map<std::string, std::weak_ptr<const RotatedPatternTable> >
+      TableMap;
+  static std::mutex mutex;
+  static TableMap tables;
+
+  const std::string key = GetTableKey(pattern, patternScale, numScales,
+                                      numRotations, scaleRange);
+  std::lock_guard<std::mutex> lock(mutex);
+  // Forget about tables nobody uses anymore.
+  for (TableMap::iterator it = tables.begin(); it != tables.end();) {
+    if (it->second.expired()) {
+      it = tables.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  std::shared_ptr<const RotatedPatternTable> table = tables[key].lock();
+  if (!table) {
+    table = std::make_shared<const RotatedPatternTable>(
+        pattern, patternScale, numScales, numRotations, scaleRange);
+    tables[key] = table;
+  }
+  return table;
+}
+
+RotatedPatternTable::RotatedPatternTable(const PatternDefinition& pattern,
+                                         float patternScale,
+                                         unsigned int numScales,
+                                         unsigned int numRotations,
+                                         float scaleRange)
+    : pattern_(pattern),
+      patternScale_(patternScale),
+      numPoints_(pattern.NumPoints()),
+      numScales_(numScales),
+      numRotations_(numRotations),
+      scaleList_(numScales),
+      scales_(new ScaleEntry[numScales]) {
+  CHECK_GT(numPoints_, 0u);
+  CHECK_GT(numScales_, 0u);
+  CHECK_GT(numRotations_, 0u);
+  if (pattern_.type == PatternDefinition::kRings) {
+    CHECK_EQ(pattern_.ringRadii.size(), pattern_.ringNumPoints.size());
+  }
+
+  // Define the scale discretization.
+  const float lb_scale = log(scaleRange) / log(2.0);
+  const float lb_scale_step = lb_scale / (numScales_);
+  for (unsigned int scale = 0; scale < numScales_; ++scale) {
+    scaleList_[scale] = pow(2.0, static_cast<double>(scale * lb_scale_step));
+  }
+}
+
+RotatedPatternTable::~RotatedPatternTable() { }
+
+const BriskPatternPoint* RotatedPatternTable::GetScale(
+    unsigned int scale) const {
+  return GetScaleEntry(scale).points.data();
+}
+
+unsigned int RotatedPatternTable::GetSize(unsigned int scale) const {
+  return GetScaleEntry(scale).size;
+}
+
+const BoxFilterScaling* RotatedPatternTable::GetBoxFilterScalings(
+    unsigned int scale) const {
+  return GetScaleEntry(scale).boxFilterScalings.data();
+}
+
+const SamplingBox* RotatedPatternTable::GetSamplingBoxes(
+    unsigned int scale) const {
+  const ScaleEntry& entry = GetScaleEntry(scale);
+  std::call_once(scales_[scale].samplingBoxesBuilt, [this, scale]() {
+    ScaleEntry& scaleEntry = scales_[scale];
+    scaleEntry.samplingBoxes.resize(scaleEntry.points.size());
+    BuildSamplingBoxes(scaleEntry.points.data(), scaleEntry.points.size(),
+                       scaleEntry.samplingBoxes.data());
+  });
+  return entry.samplingBoxes.data();
+}
+
+const RotatedPatternTable::ScaleEntry& RotatedPatternTable::GetScaleEntry(
+    unsigned int scale) const {
+  CHECK_LT(scale, numScales_);
+  ScaleEntry& entry = scales_[scale];
+  std::call_once(entry.built, &RotatedPatternTable::BuildScale, this, scale,
+                 &entry);
+  return entry;
+}
+
+void RotatedPatternTable::BuildScale(unsigned int scale,
+                                     ScaleEntry* entry) const {
+  CHECK_NOTNULL(entry);
+  entry->points.resize(numPoints_ * numRotations_);
+  entry->size = 0;
+  BuildPoints(scale, entry->points.data(), &entry->size);
+
+  // Sigma does not change with the rotation, the unrotated points suffice.
+  entry->boxFilterScalings.resize(numPoints_);
+  for (unsigned int i = 0; i < numPoints_; ++i) {
+    const float sigma_half = entry->points[i].sigma;
+    BoxFilterScaling& boxFilterScaling = entry->boxFilterScalings[i];
+    if (sigma_half < 0.5) {
+      boxFilterScaling.scaling = 0;
+      boxFilterScaling.scaling2 = 0;
+      continue;
+    }
+    // Same expressions as in SmoothedIntensity.
+    const float area = 4.0 * sigma_half * sigma_half;
+    const int scaling = 4194304.0 / area;
+    const int scaling2 = static_cast<float>(scaling) * area / 1024.0;
+    boxFilterScaling.scaling = scaling;
+    boxFilterScaling.scaling2 = scaling2;
+  }
+}
+
+void RotatedPatternTable::BuildPoints(unsigned int scale,
+                                      BriskPatternPoint* patternIterator,
+                                      unsigned int* patternSize) const {
+  const float sigma_scale = 1.3;
+  const float scaleFactor = scaleList_[scale];
+  unsigned int& maxSize = *patternSize;
+
+  if (pattern_.type == PatternDefinition::kPoints) {
+    // The unrotated pattern.
+    std::vector<float> u_x(numPoints_);
+    std::vector<float> u_y(numPoints_);
+    std::vector<float> sigma(numPoints_);
+    for (unsigned int i = 0; i < numPoints_; ++i) {
+      u_x[i] = pattern_.points[i].x;
+      u_x[i] *= patternScale_;
+      u_y[i] = pattern_.points[i].y;
+      u_y[i] *= patternScale_;
+      sigma[i] = pattern_.points[i].sigma;
+      sigma[i] *= patternScale_;
+    }
+
+    for (size_t rot = 0; rot < numRotations_; ++rot) {
+      // This is the rotation of the feature.
+      const double theta = static_cast<double>(rot) * 2 * M_PI
+          / static_cast<double>(numRotations_);
+      const double cos_theta = cos(theta);
+      const double sin_theta = sin(theta);
+      for (unsigned int i = 0; i < numPoints_; ++i) {
+        // Feature rotation plus angle of the point.
+        patternIterator->x = scaleFactor
+            * (u_x[i] * cos_theta - u_y[i] * sin_theta);
+        patternIterator->y = scaleFactor
+            * (u_x[i] * sin_theta + u_y[i] * cos_theta);
+        // And the Gaussian kernel sigma.
+        patternIterator->sigma = sigma_scale * scaleFactor * sigma[i];
+
+        // Adapt the size if necessary.
+        const unsigned int size = ceil(
+            ((sqrt(
+                patternIterator->x * patternIterator->x
+                    + patternIterator->y * patternIterator->y))
+                + patternIterator->sigma)) + 1;
+        if (maxSize < size) {
+          maxSize = size;
+        }
+        ++patternIterator;
+      }
+    }
+    return;
+  }
+
+  // Legacy BRISK 1.0 rings.
+  const std::vector<float>& radiusList = pattern_.ringRadii;
+  const std::vector<int>& numberList = pattern_.ringNumPoints;
+  const int rings = radiusList.size();
+  for (size_t rot = 0; rot < numRotations_; ++rot) {
+    // This is the rotation of the feature.
+    const double theta = double(rot) * 2 * M_PI / double(numRotations_);
+    for (int ring = 0; ring < rings; ++ring) {
+      for (int num = 0; num < numberList[ring]; ++num) {
+        // The actual coordinates on the circle.
+        const double alpha = (double(num)) * 2 * M_PI
+            / double(numberList[ring]);
+        // Feature rotation plus angle of the point.
+        patternIterator->x = scaleFactor * radiusList[ring]
+            * cos(alpha + theta);
+        patternIterator->y = scaleFactor * radiusList[ring]
+            * sin(alpha + theta);
+        // And the Gaussian kernel sigma.
+        if (ring == 0) {
+          patternIterator->sigma = sigma_scale * scaleFactor * 0.5;
+        } else {
+          patternIterator->sigma = sigma_scale * scaleFactor
+              * (double(radiusList[ring])) * sin(M_PI / numberList[ring]);
+        }
+
+        // Adapt the size if necessary.
+        const unsigned int size = ceil(
+            ((scaleFactor * radiusList[ring]) + patternIterator->sigma)) + 1;
+        if (maxSize < size) {
+          maxSize = size;
+        }
+        ++patternIterator;
+      }
+    }
+  }
+}
+}  // namespace brisk
@@ -0,0 +1,178 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+
+#include <brisk/internal/smoothed-intensity-16.h>
+
+namespace brisk {
+namespace {
+// The sum of a rectangle from four integral image entries. The integral image
+// wraps around at 32 bit, which cancels out for sums below 2^32.
+inline int64_t BoxSum(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+  return static_cast<uint32_t>(a - b + c - d);
+}
+}  // namespace
+
+int SmoothedIntensity16(const agast::Mat& image, const agast::Mat& integral,
+                        float key_x, float key_y,
+                        const BriskPatternPoint& briskPoint) {
+  // Get the float position.
+  const float xf = briskPoint.x + key_x;
+  const float yf = briskPoint.y + key_y;
+  const int x = static_cast<int>(xf);
+  const int y = static_cast<int>(yf);
+  const int& imagecols = image.cols;
+  const uint16_t* image_data = reinterpret_cast<const uint16_t*>(image.data);
+
+  // Get the sigma:
+  const float sigma_half = briskPoint.sigma;
+  const float area = 4.0 * sigma_half * sigma_half;
+
+  // Calculate output:
+  int64_t ret_val;
+  if (sigma_half < 0.5) {
+    // Interpolation multipliers:
+    const int r_x = (xf - x) * 1024;
+    const int r_y = (yf - y) * 1024;
+    const int r_x_1 = (1024 - r_x);
+    const int r_y_1 = (1024 - r_y);
+    const uint16_t* ptr = image_data + x + y * imagecols;
+    // Just interpolate:
+    ret_val = static_cast<int64_t>(r_x_1 * r_y_1) * ptr[0];
+    ret_val += static_cast<int64_t>(r_x * r_y_1) * ptr[1];
+    ret_val += static_cast<int64_t>(r_x * r_y) * ptr[imagecols + 1];
+    ret_val += static_cast<int64_t>(r_x_1 * r_y) * ptr[imagecols];
+    return static_cast<int>(ret_val / 1024);
+  }
+
+  // This is the standard case:
+  // Scaling:
+  const int scaling = 4194304.0 / area;
+  const int scaling2 = static_cast<float>(scaling) * area / 1024.0;
+
+  // The integral image is larger:
+  const int integralcols = imagecols + 1;
+
+  // Calculate borders.
+  const float x_1 = xf - sigma_half;
+  const float x1 = xf + sigma_half;
+  const float y_1 = yf - sigma_half;
+  const float y1 = yf + sigma_half;
+
+  const int x_left = static_cast<int>(x_1 + 0.5);
+  const int y_top = static_cast<int>(y_1 + 0.5);
+  const int x_right = static_cast<int>(x1 + 0.5);
+  const int y_bottom = static_cast<int>(y1 + 0.5);
+
+  // Overlap area - multiplication factors:
+  const float r_x_1 = static_cast<float>(x_left) - x_1 + 0.5;
+  const float r_y_1 = static_cast<float>(y_top) - y_1 + 0.5;
+  const float r_x1 = x1 - static_cast<float>(x_right) + 0.5;
+  const float r_y1 = y1 - static_cast<float>(y_bottom) + 0.5;
+  const int dx = x_right - x_left - 1;
+  const int dy = y_bottom - y_top - 1;
+  const int64_t A = static_cast<int>((r_x_1 * r_y_1) * scaling);
+  const int64_t B = static_cast<int>((r_x1 * r_y_1) * scaling);
+  const int64_t C = static_cast<int>((r_x1 * r_y1) * scaling);
+  const int64_t D = static_cast<int>((r_x_1 * r_y1) * scaling);
+  const int64_t r_x_1_i = static_cast<int>(r_x_1 * scaling);
+  const int64_t r_y_1_i = static_cast<int>(r_y_1 * scaling);
+  const int64_t r_x1_i = static_cast<int>(r_x1 * scaling);
+  const int64_t r_y1_i = static_cast<int>(r_y1 * scaling);
+
+  const uint16_t* ptr = image_data + x_left + imagecols * y_top;
+  if (dx + dy > 2) {
+    // First the corners, addressed exactly like the 8 bit version does.
+    ret_val = A * ptr[0];
+    ret_val += B * ptr[dx + 1];
+    ret_val += C * ptr[dy * imagecols + dx + 2];
+    ret_val += D * ptr[dy * imagecols + 1];
+
+    // Next the edges, same path through the surface corners as for 8 bit.
+    const uint32_t* ptr_integral = reinterpret_cast<const uint32_t*>(
+        integral.data) + x_left + integralcols * y_top + 1;
+    const uint32_t tmp1 = ptr_integral[0];
+    const uint32_t tmp2 = ptr_integral[dx];
+    const uint32_t tmp3 = ptr_integral[integralcols + dx];
+    const uint32_t tmp4 = ptr_integral[integralcols + dx + 1];
+    const uint32_t tmp5 = ptr_integral[(dy + 1) * integralcols + dx + 1];
+    const uint32_t tmp6 = ptr_integral[(dy + 1) * integralcols + dx];
+    const uint32_t tmp7 = ptr_integral[(dy + 2) * integralcols + dx];
+    const uint32_t tmp8 = ptr_integral[(dy + 2) * integralcols];
+    const uint32_t tmp9 = ptr_integral[(dy + 1) * integralcols];
+    const uint32_t tmp10 = ptr_integral[(dy + 1) * integralcols - 1];
+    const uint32_t tmp11 = ptr_integral[integralcols - 1];
+    const uint32_t tmp12 = ptr_integral[integralcols];
+
+    // Assign the weighted surface integrals:
+    const int64_t upper = BoxSum(tmp3, tmp2, tmp1, tmp12) * r_y_1_i;
+    const int64_t middle = BoxSum(tmp6, tmp3, tmp12, tmp9) * scaling;
+    const int64_t left = BoxSum(tmp9, tmp12, tmp11, tmp10) * r_x_1_i;
+    const int64_t right = BoxSum(tmp5, tmp4, tmp3, tmp6) * r_x1_i;
+    const int64_t bottom = BoxSum(tmp7, tmp6, tmp9, tmp8) * r_y1_i;
+
+    return static_cast<int>(
+        (ret_val + upper + middle + left + right + bottom) / scaling2);
+  }
+
+  // First row:
+  ret_val = A * ptr[0];
+  for (int i = 1; i <= dx; ++i) {
+    ret_val += r_y_1_i * ptr[i];
+  }
+  ret_val += B * ptr[dx + 1];
+  // Middle ones:
+  for (int j = 1; j <= dy; ++j) {
+    const uint16_t* row = ptr + j * imagecols;
+    ret_val += r_x_1_i * row[0];
+    for (int i = 1; i <= dx; ++i) {
+      ret_val += row[i] * static_cast<int64_t>(scaling);
+    }
+    ret_val += r_x1_i * row[dx + 1];
+  }
+  // Last row:
+  const uint16_t* row = ptr + (dy + 1) * imagecols;
+  ret_val += D * row[0];
+  for (int i = 1; i <= dx; ++i) {
+    ret_val += r_y1_i * row[i];
+  }
+  ret_val += C * row[dx + 1];
+
+  return static_cast<int>(ret_val / scaling2);
+}
+}  // namespace brisk
@@ -0,0 +1,267 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __ARM_NEON
+#include <immintrin.h>
+#endif  // __ARM_NEON
+
+#include <glog/logging.h>
+
+#include <brisk/internal/smoothed-intensity-avx2.h>
+
+namespace brisk {
+#ifdef __ARM_NEON
+void SmoothedIntensitiesAvx2(const agast::Mat&, const agast::Mat&, float,
+                             float, const BriskPatternPoint*,
+                             const BoxFilterScaling*, unsigned int, int*) {
+  // Not implemented.
+  LOG(FATAL) << "AVX2 is not available on this platform.";
+}
+#else
+namespace {
+// static_cast<int>(value + 0.5) for non-negative floats, where the addition
+// happens in double precision.
+__attribute__((target("avx2")))
+inline __m256i RoundHalfUp(__m256 value) {
+  const __m256i truncated = _mm256_cvttps_epi32(value);
+  const __m256 fraction = _mm256_sub_ps(value,
+                                        _mm256_cvtepi32_ps(truncated));
+  const __m256 round_up = _mm256_cmp_ps(fraction, _mm256_set1_ps(0.5f),
+                                        _CMP_GE_OQ);
+  // The comparison mask is -1 where we need to round up.
+  return _mm256_sub_epi32(truncated, _mm256_castps_si256(round_up));
+}
+
+// Exact truncating integer division of positive divisors. The quotient of two
+// 32 bit integers is far enough from the next integer to survive the
+// rounding to double.
+__attribute__((target("avx2")))
+inline __m256i Divide(__m256i dividend, __m256i divisor) {
+  const __m256d quotient_low = _mm256_div_pd(
+      _mm256_cvtepi32_pd(_mm256_castsi256_si128(dividend)),
+      _mm256_cvtepi32_pd(_mm256_castsi256_si128(divisor)));
+  const __m256d quotient_high = _mm256_div_pd(
+      _mm256_cvtepi32_pd(_mm256_extracti128_si256(dividend, 1)),
+      _mm256_cvtepi32_pd(_mm256_extracti128_si256(divisor, 1)));
+  return _mm256_setr_m128i(_mm256_cvttpd_epi32(quotient_low),
+                           _mm256_cvttpd_epi32(quotient_high));
+}
+
+__attribute__((target("avx2")))
+inline __m256i GatherMasked(const int* base, __m256i index, __m256i mask) {
+  return _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), base, index, mask,
+                                     4);
+}
+
+__attribute__((target("avx2")))
+inline __m256i GatherPixelsMasked(const unsigned char* base, __m256i index,
+                                  __m256i mask) {
+  // Loads the four bytes ending at each pixel and keeps the last one, so
+  // that a pixel at the end of the image is not read past. The first three
+  // pixels of the image are taken from the four bytes at its start.
+  const __m256i start = _mm256_max_epi32(
+      _mm256_sub_epi32(index, _mm256_set1_epi32(3)), _mm256_setzero_si256());
+  const __m256i pixels = _mm256_mask_i32gather_epi32(
+      _mm256_setzero_si256(), reinterpret_cast<const int*>(base), start,
+      mask, 1);
+  const __m256i shift = _mm256_slli_epi32(_mm256_sub_epi32(index, start), 3);
+  return _mm256_and_si256(_mm256_srlv_epi32(pixels, shift),
+                          _mm256_set1_epi32(0xff));
+}
+}  // namespace
+
+__attribute__((target("avx2")))
+void SmoothedIntensitiesAvx2(const agast::Mat& image,
+                             const agast::Mat& integral, float key_x,
+                             float key_y, const BriskPatternPoint* points,
+                             const BoxFilterScaling* scalings,
+                             unsigned int num_points, int* values) {
+  CHECK_NOTNULL(points);
+  CHECK_NOTNULL(scalings);
+  CHECK_NOTNULL(values);
+  CHECK_EQ(image.type(), CV_8UC1);
+  CHECK_EQ(integral.type(), CV_32SC1);
+  const int imagecols = image.cols;
+  const int integralcols = imagecols + 1;
+  const unsigned char* image_data = image.data;
+  const int* integral_data = reinterpret_cast<const int*>(integral.data);
+
+  // Strides of the gathers in ints.
+  const __m256i point_stride = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+  const __m256i scaling_stride = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+  const __m256 key_x_v = _mm256_set1_ps(key_x);
+  const __m256 key_y_v = _mm256_set1_ps(key_y);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i two = _mm256_set1_epi32(2);
+  const __m256i imagecols_v = _mm256_set1_epi32(imagecols);
+  const __m256i integralcols_v = _mm256_set1_epi32(integralcols);
+
+  unsigned int i = 0;
+  for (; i + 8 <= num_points; i += 8) {
+    const float* point = &points[i].x;
+    const __m256 sigma_half = _mm256_i32gather_ps(point + 2, point_stride, 4);
+    const __m256i scaling = _mm256_i32gather_epi32(&scalings[i].scaling,
+                                                   scaling_stride, 4);
+    __m256i scaling2 = _mm256_i32gather_epi32(&scalings[i].scaling2,
+                                              scaling_stride, 4);
+    const __m256 xf = _mm256_add_ps(
+        _mm256_i32gather_ps(point, point_stride, 4), key_x_v);
+    const __m256 yf = _mm256_add_ps(
+        _mm256_i32gather_ps(point + 1, point_stride, 4), key_y_v);
+
+    // Calculate borders.
+    const __m256 x_1 = _mm256_sub_ps(xf, sigma_half);
+    const __m256 x1 = _mm256_add_ps(xf, sigma_half);
+    const __m256 y_1 = _mm256_sub_ps(yf, sigma_half);
+    const __m256 y1 = _mm256_add_ps(yf, sigma_half);
+    const __m256i x_left = RoundHalfUp(x_1);
+    const __m256i y_top = RoundHalfUp(y_1);
+    const __m256i x_right = RoundHalfUp(x1);
+    const __m256i y_bottom = RoundHalfUp(y1);
+    const __m256i dx = _mm256_sub_epi32(_mm256_sub_epi32(x_right, x_left), one);
+    const __m256i dy = _mm256_sub_epi32(_mm256_sub_epi32(y_bottom, y_top), one);
+
+    // Only large boxes inside the image take the integral image path.
+    const __m256 inside = _mm256_and_ps(_mm256_cmp_ps(x_1, zero, _CMP_GE_OQ),
+                                        _mm256_cmp_ps(y_1, zero, _CMP_GE_OQ));
+    const __m256i valid = _mm256_and_si256(
+        _mm256_and_si256(_mm256_castps_si256(inside),
+                         _mm256_cmpgt_epi32(scaling, _mm256_setzero_si256())),
+        _mm256_cmpgt_epi32(_mm256_add_epi32(dx, dy), two));
+    scaling2 = _mm256_blendv_epi8(one, scaling2, valid);
+
+    // Overlap area - multiplication factors.
+    const __m256 r_x_1 = _mm256_add_ps(
+        _mm256_sub_ps(_mm256_cvtepi32_ps(x_left), x_1), half);
+    const __m256 r_y_1 = _mm256_add_ps(
+        _mm256_sub_ps(_mm256_cvtepi32_ps(y_top), y_1), half);
+    const __m256 r_x1 = _mm256_add_ps(
+        _mm256_sub_ps(x1, _mm256_cvtepi32_ps(x_right)), half);
+    const __m256 r_y1 = _mm256_add_ps(
+        _mm256_sub_ps(y1, _mm256_cvtepi32_ps(y_bottom)), half);
+    const __m256 scaling_f = _mm256_cvtepi32_ps(scaling);
+    const __m256i A = _mm256_cvttps_epi32(
+        _mm256_mul_ps(_mm256_mul_ps(r_x_1, r_y_1), scaling_f));
+    const __m256i B = _mm256_cvttps_epi32(
+        _mm256_mul_ps(_mm256_mul_ps(r_x1, r_y_1), scaling_f));
+    const __m256i C = _mm256_cvttps_epi32(
+        _mm256_mul_ps(_mm256_mul_ps(r_x1, r_y1), scaling_f));
+    const __m256i D = _mm256_cvttps_epi32(
+        _mm256_mul_ps(_mm256_mul_ps(r_x_1, r_y1), scaling_f));
+    const __m256i r_x_1_i = _mm256_cvttps_epi32(_mm256_mul_ps(r_x_1,
+                                                              scaling_f));
+    const __m256i r_y_1_i = _mm256_cvttps_epi32(_mm256_mul_ps(r_y_1,
+                                                              scaling_f));
+    const __m256i r_x1_i = _mm256_cvttps_epi32(_mm256_mul_ps(r_x1, scaling_f));
+    const __m256i r_y1_i = _mm256_cvttps_epi32(_mm256_mul_ps(r_y1, scaling_f));
+
+    // First the corners, in the same places as the scalar version.
+    const __m256i pixel_top_left = _mm256_add_epi32(
+        x_left, _mm256_mullo_epi32(y_top, imagecols_v));
+    const __m256i dx1 = _mm256_add_epi32(dx, one);
+    const __m256i dy_rows = _mm256_mullo_epi32(dy, imagecols_v);
+    const __m256i pixel_b = _mm256_add_epi32(pixel_top_left, dx1);
+    const __m256i pixel_c = _mm256_add_epi32(_mm256_add_epi32(pixel_b, dy_rows),
+                                             one);
+    const __m256i pixel_d = _mm256_sub_epi32(pixel_c, dx1);
+    __m256i ret_val = _mm256_mullo_epi32(
+        A, GatherPixelsMasked(image_data, pixel_top_left, valid));
+    ret_val = _mm256_add_epi32(ret_val, _mm256_mullo_epi32(
+        B, GatherPixelsMasked(image_data, pixel_b, valid)));
+    ret_val = _mm256_add_epi32(ret_val, _mm256_mullo_epi32(
+        C, GatherPixelsMasked(image_data, pixel_c, valid)));
+    ret_val = _mm256_add_epi32(ret_val, _mm256_mullo_epi32(
+        D, GatherPixelsMasked(image_data, pixel_d, valid)));
+
+    // Next the edges, from the twelve surface corners.
+    const __m256i idx1 = _mm256_add_epi32(
+        _mm256_add_epi32(x_left, _mm256_mullo_epi32(y_top, integralcols_v)),
+        one);
+    const __m256i idx12 = _mm256_add_epi32(idx1, integralcols_v);
+    const __m256i idx2 = _mm256_add_epi32(idx1, dx);
+    const __m256i idx3 = _mm256_add_epi32(idx2, integralcols_v);
+    const __m256i idx4 = _mm256_add_epi32(idx3, one);
+    const __m256i dy_integral_rows = _mm256_mullo_epi32(dy, integralcols_v);
+    const __m256i idx5 = _mm256_add_epi32(idx4, dy_integral_rows);
+    const __m256i idx6 = _mm256_sub_epi32(idx5, one);
+    const __m256i idx7 = _mm256_add_epi32(idx6, integralcols_v);
+    const __m256i idx9 = _mm256_add_epi32(idx12, dy_integral_rows);
+    const __m256i idx8 = _mm256_add_epi32(idx9, integralcols_v);
+    const __m256i idx10 = _mm256_sub_epi32(idx9, one);
+    const __m256i idx11 = _mm256_sub_epi32(idx12, one);
+    const __m256i tmp1 = GatherMasked(integral_data, idx1, valid);
+    const __m256i tmp2 = GatherMasked(integral_data, idx2, valid);
+    const __m256i tmp3 = GatherMasked(integral_data, idx3, valid);
+    const __m256i tmp4 = GatherMasked(integral_data, idx4, valid);
+    const __m256i tmp5 = GatherMasked(integral_data, idx5, valid);
+    const __m256i tmp6 = GatherMasked(integral_data, idx6, valid);
+    const __m256i tmp7 = GatherMasked(integral_data, idx7, valid);
+    const __m256i tmp8 = GatherMasked(integral_data, idx8, valid);
+    const __m256i tmp9 = GatherMasked(integral_data, idx9, valid);
+    const __m256i tmp10 = GatherMasked(integral_data, idx10, valid);
+    const __m256i tmp11 = GatherMasked(integral_data, idx11, valid);
+    const __m256i tmp12 = GatherMasked(integral_data, idx12, valid);
+
+    // Assign the weighted surface integrals.
+    const __m256i upper = _mm256_mullo_epi32(_mm256_sub_epi32(
+        _mm256_add_epi32(_mm256_sub_epi32(tmp3, tmp2), tmp1), tmp12), r_y_1_i);
+    const __m256i middle = _mm256_mullo_epi32(_mm256_sub_epi32(
+        _mm256_add_epi32(_mm256_sub_epi32(tmp6, tmp3), tmp12), tmp9), scaling);
+    const __m256i left = _mm256_mullo_epi32(_mm256_sub_epi32(
+        _mm256_add_epi32(_mm256_sub_epi32(tmp9, tmp12), tmp11), tmp10),
+                                            r_x_1_i);
+    const __m256i right = _mm256_mullo_epi32(_mm256_sub_epi32(
+        _mm256_add_epi32(_mm256_sub_epi32(tmp5, tmp4), tmp3), tmp6), r_x1_i);
+    const __m256i bottom = _mm256_mullo_epi32(_mm256_sub_epi32(
+        _mm256_add_epi32(_mm256_sub_epi32(tmp7, tmp6), tmp9), tmp8), r_y1_i);
+    ret_val = _mm256_add_epi32(ret_val, _mm256_add_epi32(
+        _mm256_add_epi32(upper, middle),
+        _mm256_add_epi32(_mm256_add_epi32(left, right), bottom)));
+
+    const __m256i result = _mm256_blendv_epi8(
+        _mm256_set1_epi32(-1), Divide(ret_val, scaling2), valid);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), result);
+  }
+  // The remainder is left to the scalar version.
+  for (; i < num_points; ++i) {
+    values[i] = -1;
+  }
+}
+#endif  // __ARM_NEON
+}  // namespace brisk
@@ -0,0 +1,469 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Timings of the detection and extraction kernels and of their variants.
+// The unit tests compare the results, this only measures. Run from the
+// build directory, optionally with a part of the benchmark names to run:
+//   brisk_benchmark [filter]
+
+#include <cstdlib>
+#include <iostream>  // NOLINT
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <agast/glog.h>
+#include <agast/internal/oast9-16-simd.h>
+#include <agast/oast9-16.h>
+#include <brisk/brisk.h>
+#include <brisk/internal/brisk-layer.h>
+#include <brisk/internal/cpu-features.h>
+#include <brisk/internal/harris-scores.h>
+#include <brisk/internal/timer.h>
+#include <brisk/internal/vectorized-filters.h>
+
+#include "./synthetic-data.h"
+
+namespace {
+const int kNumRuns = 20;
+
+cv::Mat LoadImage(const std::string& file) {
+  cv::Mat image = cv::imread(file, cv::IMREAD_GRAYSCALE);
+  CHECK(!image.empty()) << "Could not load " << file
+      << ", run from the build directory.";
+  return image;
+}
+
+void BenchmarkSampling() {
+  const cv::Mat image = LoadImage("./test_data/img1.pgm");
+  std::vector<agast::KeyPoint> keypoints, extracted;
+  brisk::GetSyntheticKeypoints(image, &keypoints);
+  brisk::BriskDescriptorExtractor extractor;
+  cv::Mat descriptors;
+  // Build the pattern tables outside of the timing.
+  extracted = keypoints;
+  extractor.compute(image, extracted, descriptors);
+  for (int run = 0; run < kNumRuns; ++run) {
+    for (bool avx2 : {false, true}) {
+      brisk::SetAvx2Enabled(avx2);
+      extracted = keypoints;
+      brisk::timing::Timer timer(avx2 ? "Extraction AVX2 sampling" :
+                                 "Extraction scalar sampling");
+      extractor.compute(image, extracted, descriptors);
+    }
+  }
+}
+
+void BenchmarkQuantizedSampling() {
+  const cv::Mat image = LoadImage("./test_data/img1.pgm");
+  std::vector<agast::KeyPoint> keypoints, extracted;
+  brisk::GetSyntheticKeypoints(image, &keypoints);
+  brisk::BriskDescriptorExtractor exact_extractor, quantized_extractor;
+  quantized_extractor.SetQuantizedSampling(true);
+  cv::Mat descriptors;
+  // The boxes only replace the scalar sampling, see BenchmarkSampling for
+  // the AVX2 one.
+  brisk::SetAvx2Enabled(false);
+  // Build the pattern tables and boxes outside of the timing.
+  extracted = keypoints;
+  exact_extractor.compute(image, extracted, descriptors);
+  extracted = keypoints;
+  quantized_extractor.compute(image, extracted, descriptors);
+  for (int run = 0; run < kNumRuns; ++run) {
+    extracted = keypoints;
+    {
+      brisk::timing::Timer timer("Extraction exact sampling");
+      exact_extractor.compute(image, extracted, descriptors);
+    }
+    extracted = keypoints;
+    {
+      brisk::timing::Timer timer("Extraction quantized sampling");
+      quantized_extractor.compute(image, extracted, descriptors);
+    }
+  }
+  brisk::SetAvx2Enabled(true);
+}
+
+void BenchmarkExtraction16Bit() {
+  const cv::Mat image = LoadImage("./test_data/img1.pgm");
+  std::vector<agast::KeyPoint> keypoints, extracted;
+  brisk::GetSyntheticKeypoints(image, &keypoints);
+  cv::Mat image16(image.rows, image.cols, CV_16UC1);
+  std::srand(42);
+  for (int row = 0; row < image.rows; ++row) {
+    for (int col = 0; col < image.cols; ++col) {
+      const int value = image.at<unsigned char>(row, col);
+      image16.at<uint16_t>(row, col) = value * 257 ^ (std::rand() % 64);
+    }
+  }
+  brisk::BriskDescriptorExtractor extractor;
+  cv::Mat descriptors;
+  extracted = keypoints;
+  extractor.compute(image16, extracted, descriptors);
+  for (int run = 0; run < kNumRuns; ++run) {
+    extracted = keypoints;
+    brisk::timing::Timer timer("Extraction 16 bit");
+    extractor.compute(image16, extracted, descriptors);
+  }
+}
+
+void BenchmarkParallelPyramid() {
+  const cv::Mat image = LoadImage("./test_data/img1.pgm");
+  brisk::BriskFeatureDetector detector(30, 4);
+  brisk::BriskFeatureDetector parallel_detector(30, 4);
+  parallel_detector.SetNumThreads(4);
+  std::vector<agast::KeyPoint> keypoints;
+  for (int run = 0; run < kNumRuns; ++run) {
+    {
+      brisk::timing::Timer timer("Detection 1 thread");
+      detector.detect(image, keypoints);
+    }
+    {
+      brisk::timing::Timer timer("Detection 4 threads");
+      parallel_detector.detect(image, keypoints);
+    }
+  }
+}
+
+void BenchmarkOastRowBands() {
+  const cv::Mat tile = LoadImage("./test_data/img1.pgm");
+  // Tile the image to a size where the bands pay off.
+  const int kTiles = 3;
+  cv::Mat image(tile.rows * kTiles, tile.cols * kTiles, CV_8UC1);
+  for (int y = 0; y < image.rows; ++y) {
+    for (int x = 0; x < image.cols; ++x) {
+      image.data[y * image.cols + x] =
+          tile.data[(y % tile.rows) * tile.cols + x % tile.cols];
+    }
+  }
+  agast::OastDetector9_16 detector(image.cols, image.rows, 30);
+  detector.set_threshold(30);
+  std::vector<agast::KeyPoint> corners;
+  for (int run = 0; run < kNumRuns; ++run) {
+    detector.set_numThreads(1);
+    {
+      brisk::timing::Timer timer("Oast 1 thread");
+      detector.detect(image.data, corners);
+    }
+    detector.set_numThreads(4);
+    {
+      brisk::timing::Timer timer("Oast 4 threads");
+      detector.detect(image.data, corners);
+    }
+  }
+}
+
+void BenchmarkOastSimd() {
+  for (const std::string& file : {"./test_data/img1.pgm",
+                                  "./test_data/img2.pgm"}) {
+    const cv::Mat image = LoadImage(file);
+    // The threshold map of a BRISK layer.
+    brisk::BriskLayer layer(image, 120, 50);
+    agast::OastDetector9_16 detector(image.cols, image.rows, 30);
+    detector.set_threshold(30, 120, 50);
+    std::vector<agast::KeyPoint> corners;
+    for (int run = 0; run < kNumRuns; ++run) {
+      detector.set_useSimd(false);
+      {
+        brisk::timing::Timer timer("Oast tree");
+        detector.detect(image.data, corners, &layer.thrmap());
+      }
+      if (!agast::internal::HasSimdSegmentTest()) {
+        continue;
+      }
+      detector.set_useSimd(true);
+      agast::internal::SetSegmentTestAvx2Enabled(false);
+      {
+        brisk::timing::Timer timer("Oast SSE2");
+        detector.detect(image.data, corners, &layer.thrmap());
+      }
+      agast::internal::SetSegmentTestAvx2Enabled(true);
+      {
+        brisk::timing::Timer timer("Oast AVX2");
+        detector.detect(image.data, corners, &layer.thrmap());
+      }
+    }
+  }
+}
+
+void BenchmarkPersistentScaleSpace() {
+  const cv::Mat image1 = LoadImage("./test_data/img1.pgm");
+  const cv::Mat image2 = LoadImage("./test_data/img2.pgm");
+  brisk::BriskFeatureDetector detector(30, 4);
+  brisk::BriskFeatureDetector persistent_detector(30, 4);
+  persistent_detector.SetPersistentScaleSpace(true);
+  std::vector<agast::KeyPoint> keypoints;
+  for (int run = 0; run < kNumRuns; ++run) {
+    for (const cv::Mat* image : {&image1, &image2}) {
+      {
+        brisk::timing::Timer timer("Detection new scale space");
+        detector.detect(*image, keypoints);
+      }
+      {
+        brisk::timing::Timer timer("Detection persistent scale space");
+        persistent_detector.detect(*image, keypoints);
+      }
+    }
+  }
+}
+
+void BenchmarkMaskedDetection() {
+  const cv::Mat image = LoadImage("./test_data/img1.pgm");
+  const cv::Mat mask = brisk::RobotMask(image.rows, image.cols);
+  brisk::BriskFeatureDetector detector(30, 3);
+  std::vector<agast::KeyPoint> keypoints;
+  for (int run = 0; run < kNumRuns; ++run) {
+    {
+      brisk::timing::Timer timer("Detection, filtered afterwards");
+      detector.detect(image, keypoints);
+    }
+    {
+      brisk::timing::Timer timer("Detection, masked in the layers");
+      detector.detect(image, keypoints, mask);
+    }
+  }
+}
+
+void BenchmarkGridDetection() {
+  const cv::Mat image = LoadImage("./test_data/img1.pgm");
+  brisk::GridFeatureDetector grid(4, 4, 30, 3);
+  grid.SetTargetNumKeypoints(400, 800);
+  grid.SetNumThreads(4);
+  std::vector<agast::KeyPoint> keypoints;
+  for (int run = 0; run < kNumRuns; ++run) {
+    brisk::timing::Timer timer("Grid detection");
+    grid.detect(image, keypoints);
+  }
+}
+
+#ifndef __ARM_NEON
+void BenchmarkTotalKeypointBudget() {
+  const cv::Mat image = LoadImage("./test_data/img1.pgm");
+  brisk::ScaleSpaceFeatureDetector<brisk::HarrisScoreCalculator>
+      detector(4, 0, 20, 2000);
+  std::vector<agast::KeyPoint> keypoints;
+  for (int run = 0; run < kNumRuns; ++run) {
+    // Passed keypoints would only be refined.
+    keypoints.clear();
+    detector.SetMaxNumKptTotal(std::numeric_limits<size_t>::max());
+    {
+      brisk::timing::Timer timer("Detection without total budget");
+      detector.detect(image, keypoints);
+    }
+    keypoints.clear();
+    detector.SetMaxNumKptTotal(500);
+    {
+      brisk::timing::Timer timer("Detection with total budget");
+      detector.detect(image, keypoints);
+    }
+  }
+}
+
+void BenchmarkHarrisScoreStripes() {
+  const cv::Mat image = LoadImage("./test_data/img1.pgm");
+  cv::Mat scores;
+  brisk::HarrisScoresBuffer buffer;
+  for (int run = 0; run < kNumRuns; ++run) {
+    {
+      brisk::timing::Timer timer("Harris scores 1 thread");
+      brisk::HarrisScoresSSE(image, scores, 1, brisk::TaskRunner(), &buffer);
+    }
+    {
+      brisk::timing::Timer timer("Harris scores 4 stripes");
+      brisk::HarrisScoresSSE(image, scores, 4, brisk::TaskRunner(), &buffer);
+    }
+  }
+}
+
+class CovarEntries : public brisk::HarrisScoreCalculator {
+ public:
+  using brisk::HarrisScoreCalculator::GetCovarEntries;
+};
+
+void BenchmarkHarrisKernels() {
+  cv::Mat image = LoadImage("./test_data/img1.pgm");
+  cv::Mat kernel8(3, 3, CV_8SC1);
+  cv::Mat kernel16(3, 3, CV_16SC1);
+  std::srand(7);
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 3; ++x) {
+      kernel8.at<char>(y, x) = std::rand() % 21 - 10;
+      kernel16.at<int16_t>(y, x) = std::rand() % 21 - 10;
+    }
+  }
+  kernel8.at<char>(1, 1) = 0;
+  kernel16.at<int16_t>(1, 1) = 0;
+
+  cv::Mat dxdx, dydy, dxdy;
+  CovarEntries::GetCovarEntries(image, dxdx, dydy, dxdy);
+  cv::Mat dxdx_float(dxdx.rows, dxdx.cols, CV_32FC1);
+  for (int y = 0; y < dxdx.rows; ++y) {
+    for (int x = 0; x < dxdx.cols; ++x) {
+      dxdx_float.at<float>(y, x) = dxdx.at<int16_t>(y, x);
+    }
+  }
+  cv::Mat scores, filtered8, filtered16, smoothed;
+  brisk::HarrisScoresBuffer buffer;
+  for (int run = 0; run < kNumRuns; ++run) {
+    for (bool avx2 : {false, true}) {
+      brisk::SetAvx2Enabled(avx2);
+      const std::string suffix = avx2 ? " AVX2" : " SSE";
+      {
+        brisk::timing::Timer timer("Harris scores" + suffix);
+        brisk::HarrisScoresSSE(image, scores, 1, brisk::TaskRunner(),
+                               &buffer);
+      }
+      {
+        brisk::timing::Timer timer("Covariance entries" + suffix);
+        CovarEntries::GetCovarEntries(image, dxdx, dydy, dxdy);
+      }
+      {
+        brisk::timing::Timer timer("Filter2D 8U" + suffix);
+        Filter2D<3, 3>(image, filtered8, kernel8);
+      }
+      {
+        brisk::timing::Timer timer("Filter2D 16S" + suffix);
+        Filter2D<3, 3>(filtered8, filtered16, kernel16);
+      }
+      {
+        brisk::timing::Timer timer("Gauss 3x3 16S" + suffix);
+        brisk::FilterGauss3by316S(dxdx, smoothed);
+      }
+      {
+        brisk::timing::Timer timer("Gauss 3x3 32F" + suffix);
+        brisk::FilterGauss3by332F(dxdx_float, smoothed);
+      }
+    }
+  }
+}
+
+void BenchmarkLazyHarrisScores() {
+  const cv::Mat image = LoadImage("./test_data/img1.pgm");
+  // Keypoints of octave 0 as if they were tracked from the last frame.
+  brisk::ScaleSpaceFeatureDetector<brisk::HarrisScoreCalculator> detector(
+      0, 0, 10, 100000);
+  std::vector<agast::KeyPoint> tracked, refined;
+  detector.detect(image, tracked);
+  brisk::ScaleSpaceLayer<brisk::HarrisScoreCalculator> layer;
+  for (int run = 0; run < kNumRuns; ++run) {
+    for (bool dense : {true, false}) {
+      refined = tracked;
+      brisk::timing::Timer timer(dense ? "Harris refinement dense scores" :
+                                 "Harris refinement lazy scores");
+      layer.Create(image, dense);
+      layer.SetMaxNumKpt(tracked.size());
+      layer.DetectScaleSpaceMaxima(refined, false, true, true);
+    }
+  }
+}
+
+void BenchmarkBilinearScores() {
+  const cv::Mat image = LoadImage("./test_data/img1.pgm");
+  brisk::HarrisScoreCalculator calculator;
+  calculator.SetImage(image);
+  // Where the 3d nonmax suppression of the 2d maxima of a dense frame
+  // samples the layer above.
+  std::vector<brisk::HarrisScoreCalculator::PointWithScore> maxima;
+  calculator.Get2dMaxima(maxima, 0);
+  std::vector<double> u, v;
+  for (const brisk::HarrisScoreCalculator::PointWithScore& point : maxima) {
+    u.push_back(2.0 / 3.0 * (point.x - 0.25));
+    v.push_back(2.0 / 3.0 * (point.y - 0.25));
+  }
+  const size_t n = u.size();
+  std::vector<double> scores(n);
+  for (int run = 0; run < kNumRuns; ++run) {
+    {
+      brisk::timing::Timer timer("Bilinear scores one by one");
+      for (size_t i = 0; i < n; ++i) {
+        scores[i] = calculator.Score(u[i], v[i]);
+      }
+    }
+    brisk::SetAvx2Enabled(false);
+    {
+      brisk::timing::Timer timer("Bilinear scores SSE");
+      calculator.Scores(&u[0], &v[0], n, &scores[0]);
+    }
+    brisk::SetAvx2Enabled(true);
+    {
+      brisk::timing::Timer timer("Bilinear scores AVX2");
+      calculator.Scores(&u[0], &v[0], n, &scores[0]);
+    }
+  }
+}
+#endif  // __ARM_NEON
+
+struct Benchmark {
+  const char* name;
+  void (*run)();
+};
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::string filter = argc > 1 ? argv[1] : "";
+  const Benchmark benchmarks[] = {
+      {"Sampling", &BenchmarkSampling},
+      {"QuantizedSampling", &BenchmarkQuantizedSampling},
+      {"Extraction16Bit", &BenchmarkExtraction16Bit},
+      {"ParallelPyramid", &BenchmarkParallelPyramid},
+      {"OastRowBands", &BenchmarkOastRowBands},
+      {"OastSimd", &BenchmarkOastSimd},
+      {"PersistentScaleSpace", &BenchmarkPersistentScaleSpace},
+      {"MaskedDetection", &BenchmarkMaskedDetection},
+      {"GridDetection", &BenchmarkGridDetection},
+#ifndef __ARM_NEON
+      {"TotalKeypointBudget", &BenchmarkTotalKeypointBudget},
+      {"HarrisScoreStripes", &BenchmarkHarrisScoreStripes},
+      {"HarrisKernels", &BenchmarkHarrisKernels},
+      {"LazyHarrisScores", &BenchmarkLazyHarrisScores},
+      {"BilinearScores", &BenchmarkBilinearScores},
+#endif  // __ARM_NEON
+  };
+  if (!brisk::CpuSupportsAvx2()) {
+    std::cout << "AVX2 not supported, the AVX2 timings use the fallbacks."
+        << std::endl;
+  }
+  for (const Benchmark& benchmark : benchmarks) {
+    if (std::string(benchmark.name).find(filter) == std::string::npos) {
+      continue;
+    }
+    std::cout << "Running " << benchmark.name << std::endl;
+    benchmark.run();
+  }
+  brisk::timing::Timing::Print(std::cout);
+  return 0;
+}
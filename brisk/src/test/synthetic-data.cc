@@ -0,0 +1,79 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <agast/glog.h>
+
+#include "./synthetic-data.h"
+
+namespace brisk {
+
+void GetSyntheticKeypoints(const cv::Mat& image,
+                           std::vector<agast::KeyPoint>* keypoints) {
+  CHECK_NOTNULL(keypoints);
+  keypoints->clear();
+  int index = 0;
+  for (float y = 3.37f; y < image.rows; y += 13.1f) {
+    for (float x = 5.71f; x < image.cols; x += 11.3f, ++index) {
+      agast::KeyPoint keypoint;
+      agast::KeyPointX(keypoint) = x;
+      agast::KeyPointY(keypoint) = y;
+      agast::KeyPointSize(keypoint) = 4.0f * pow(1.037f, index % 128);
+      // Every other keypoint gets its orientation estimated.
+      agast::KeyPointAngle(keypoint) =
+          index % 2 == 0 ? -1.0f : fmod(index * 7.31f, 360.0f);
+      keypoints->push_back(keypoint);
+    }
+  }
+}
+
+cv::Mat RobotMask(int rows, int cols) {
+  cv::Mat mask(rows, cols, CV_8UC1);
+  for (int y = 0; y < rows; ++y) {
+    for (int x = 0; x < cols; ++x) {
+      const bool sky = y < rows / 5;
+      const bool chassis = y >= rows - rows / 5;
+      const bool pole = x >= cols / 2 && x < cols / 2 + cols / 20;
+      mask.data[y * cols + x] = sky || chassis || pole ? 0 : 255;
+    }
+  }
+  return mask;
+}
+
+}  // namespace brisk
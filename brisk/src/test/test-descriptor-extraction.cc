@@ -0,0 +1,708 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <atomic>
+#include <bitset>
+#include <cstdlib>
+#include <fstream>  // NOLINT
+#include <sstream>  // NOLINT
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <agast/glog.h>
+#include <brisk/brisk.h>
+#include <brisk/internal/cpu-features.h>
+#include <brisk/internal/pair-comparison.h>
+#include <brisk/internal/pattern-provider.h>
+#include <brisk/internal/rotated-pattern-table.h>
+#include <gtest/gtest.h>
+
+#include "./synthetic-data.h"
+
+#ifndef TEST
+#define TEST(a, b) void Test_##a##_##b()
+#endif
+
+namespace {
+void DetectKeypoints(const cv::Mat& image,
+                     std::vector<agast::KeyPoint>* keypoints) {
+  CHECK_NOTNULL(keypoints);
+  brisk::BriskFeatureDetector detector(30, 2);
+  detector.detect(image, *keypoints);
+  ASSERT_FALSE(keypoints->empty());
+}
+
+void ExpectPatternsEqual(const brisk::BriskPattern& expected,
+                         const brisk::BriskPattern& actual) {
+  ASSERT_EQ(expected.points.size(), actual.points.size());
+  for (size_t i = 0; i < expected.points.size(); ++i) {
+    EXPECT_EQ(expected.points[i].x, actual.points[i].x);
+    EXPECT_EQ(expected.points[i].y, actual.points[i].y);
+    EXPECT_EQ(expected.points[i].sigma, actual.points[i].sigma);
+  }
+  ASSERT_EQ(expected.shortPairs.size(), actual.shortPairs.size());
+  for (size_t i = 0; i < expected.shortPairs.size(); ++i) {
+    EXPECT_EQ(expected.shortPairs[i].i, actual.shortPairs[i].i);
+    EXPECT_EQ(expected.shortPairs[i].j, actual.shortPairs[i].j);
+  }
+  ASSERT_EQ(expected.longPairs.size(), actual.longPairs.size());
+  for (size_t i = 0; i < expected.longPairs.size(); ++i) {
+    EXPECT_EQ(expected.longPairs[i].i, actual.longPairs[i].i);
+    EXPECT_EQ(expected.longPairs[i].j, actual.longPairs[i].j);
+  }
+}
+
+// The mean Hamming distance between the descriptors of the 8 bit image and
+// those of the 16 bit one at the same keypoints.
+double MeanDistanceTo8Bit(const cv::Mat& image, const cv::Mat& image16,
+                          const std::vector<agast::KeyPoint>& keypoints) {
+  typedef std::bitset<brisk::BriskDescriptorExtractor::kDescriptorLength>
+      Descriptor;
+  brisk::BriskDescriptorExtractor extractor;
+  std::vector<agast::KeyPoint> keypoints_8 = keypoints;
+  std::vector<agast::KeyPoint> keypoints_16 = keypoints;
+  std::vector<Descriptor> descriptors_8, descriptors_16;
+  extractor.compute(image, keypoints_8, descriptors_8);
+  extractor.compute(image16, keypoints_16, descriptors_16);
+  EXPECT_GT(descriptors_8.size(), 1000u);
+  EXPECT_EQ(descriptors_8.size(), descriptors_16.size());
+  if (descriptors_8.empty() || descriptors_8.size() != descriptors_16.size())
+    return 256.0;
+  size_t total_distance = 0;
+  for (size_t k = 0; k < descriptors_8.size(); ++k) {
+    total_distance += (descriptors_8[k] ^ descriptors_16[k]).count();
+  }
+  return static_cast<double>(total_distance) / descriptors_8.size();
+}
+}  // namespace
+
+TEST(BriskDescriptorExtraction, ParallelIsBitIdentical) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  std::vector<agast::KeyPoint> keypoints;
+  DetectKeypoints(image, &keypoints);
+
+  brisk::BriskDescriptorExtractor extractor;
+  std::vector<agast::KeyPoint> keypoints_serial = keypoints;
+  cv::Mat descriptors_serial;
+  extractor.compute(image, keypoints_serial, descriptors_serial);
+
+  for (size_t num_threads : {2u, 3u, 8u}) {
+    extractor.SetNumThreads(num_threads);
+    std::vector<agast::KeyPoint> keypoints_parallel = keypoints;
+    cv::Mat descriptors_parallel;
+    extractor.compute(image, keypoints_parallel, descriptors_parallel);
+
+    ASSERT_EQ(keypoints_serial.size(), keypoints_parallel.size());
+    ASSERT_EQ(descriptors_serial.rows, descriptors_parallel.rows);
+    for (size_t k = 0; k < keypoints_serial.size(); ++k) {
+      EXPECT_EQ(agast::KeyPointAngle(keypoints_serial[k]),
+                agast::KeyPointAngle(keypoints_parallel[k]));
+    }
+    EXPECT_EQ(0, memcmp(descriptors_serial.data, descriptors_parallel.data,
+                        descriptors_serial.rows * descriptors_serial.cols));
+
+    std::vector<agast::KeyPoint> keypoints_bitset = keypoints;
+    std::vector<std::bitset<brisk::BriskDescriptorExtractor::kDescriptorLength>
+        > descriptors_bitset;
+    extractor.compute(image, keypoints_bitset, descriptors_bitset);
+    ASSERT_EQ(descriptors_bitset.size(),
+              static_cast<size_t>(descriptors_serial.rows));
+    for (size_t k = 0; k < descriptors_bitset.size(); ++k) {
+      for (size_t bit = 0;
+          bit < brisk::BriskDescriptorExtractor::kDescriptorLength; ++bit) {
+        const bool bit_serial =
+            descriptors_serial.at<unsigned char>(k, bit / 8) & (1 << (bit % 8));
+        ASSERT_EQ(bit_serial, descriptors_bitset[k][bit]);
+      }
+    }
+  }
+}
+
+TEST(BriskDescriptorExtraction, ExternalTaskRunner) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  std::vector<agast::KeyPoint> keypoints;
+  DetectKeypoints(image, &keypoints);
+
+  brisk::BriskDescriptorExtractor extractor;
+  std::vector<agast::KeyPoint> keypoints_serial = keypoints;
+  cv::Mat descriptors_serial;
+  extractor.compute(image, keypoints_serial, descriptors_serial);
+
+  std::atomic<size_t> num_tasks(0);
+  extractor.SetNumThreads(4);
+  extractor.SetTaskRunner([&num_tasks](brisk::TaskBatch* tasks) {
+    std::vector<std::thread> threads;
+    for (std::function<void()>& task : *tasks) {
+      threads.emplace_back(task);
+      ++num_tasks;
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  });
+  cv::Mat descriptors_parallel;
+  extractor.compute(image, keypoints, descriptors_parallel);
+  EXPECT_EQ(4u, num_tasks);
+  ASSERT_EQ(descriptors_serial.rows, descriptors_parallel.rows);
+  EXPECT_EQ(0, memcmp(descriptors_serial.data, descriptors_parallel.data,
+                      descriptors_serial.rows * descriptors_serial.cols));
+}
+
+TEST(BriskDescriptorExtraction, RotatedPatternTableIsShared) {
+  brisk::PatternDefinition pattern;
+  pattern.type = brisk::PatternDefinition::kRings;
+  pattern.ringRadii = {0.0f, 2.5f, 4.2f};
+  pattern.ringNumPoints = {1, 10, 14};
+
+  std::shared_ptr<const brisk::RotatedPatternTable> table1 =
+      brisk::RotatedPatternTable::Get(pattern, 1.0f, 64, 1024, 30.0f);
+  std::shared_ptr<const brisk::RotatedPatternTable> table2 =
+      brisk::RotatedPatternTable::Get(pattern, 1.0f, 64, 1024, 30.0f);
+  std::shared_ptr<const brisk::RotatedPatternTable> table_scaled =
+      brisk::RotatedPatternTable::Get(pattern, 1.5f, 64, 1024, 30.0f);
+  EXPECT_EQ(table1.get(), table2.get());
+  EXPECT_NE(table1.get(), table_scaled.get());
+  EXPECT_EQ(25u, table1->NumPoints());
+
+  // The center point does not move under rotation.
+  const brisk::BriskPatternPoint* points = table1->GetScale(10);
+  for (unsigned int rot = 0; rot < table1->NumRotations(); ++rot) {
+    EXPECT_EQ(0.0f, points[rot * table1->NumPoints()].x);
+  }
+  EXPECT_LT(table1->GetSize(0), table1->GetSize(63));
+
+  // Tables are released with their last user and rebuilt on demand.
+  const brisk::RotatedPatternTable* address = table1.get();
+  table1.reset();
+  EXPECT_EQ(address, brisk::RotatedPatternTable::Get(
+      pattern, 1.0f, 64, 1024, 30.0f).get());
+  table2.reset();
+  std::shared_ptr<const brisk::RotatedPatternTable> table3 =
+      brisk::RotatedPatternTable::Get(pattern, 1.0f, 64, 1024, 30.0f);
+  EXPECT_EQ(1, table3.use_count());
+}
+
+TEST(BriskDescriptorExtraction, PatternFormats) {
+  brisk::BriskPattern pattern;
+  brisk::GetDefaultPattern(&pattern);
+  ASSERT_EQ(static_cast<size_t>(
+      brisk::BriskDescriptorExtractor::kDescriptorLength),
+            pattern.shortPairs.size());
+
+  std::stringstream text_stream;
+  brisk::WritePatternText(pattern, &text_stream);
+  brisk::BriskPattern pattern_text;
+  ASSERT_TRUE(brisk::ReadPatternText(text_stream, &pattern_text));
+  ExpectPatternsEqual(pattern, pattern_text);
+
+  std::stringstream binary_stream;
+  brisk::WritePatternBinary(pattern, &binary_stream);
+  brisk::BriskPattern pattern_binary;
+  ASSERT_TRUE(brisk::ReadPatternBinary(binary_stream, &pattern_binary));
+  ExpectPatternsEqual(pattern, pattern_binary);
+
+  // Truncated files are rejected.
+  std::string truncated = binary_stream.str();
+  truncated.resize(truncated.size() / 2);
+  std::stringstream truncated_stream(truncated);
+  EXPECT_FALSE(brisk::ReadPatternBinary(truncated_stream, &pattern_binary));
+
+  // So are corrupt counts of points and pairs, without allocating them.
+  const size_t points_offset = 8;
+  const size_t long_pairs_offset = points_offset + 4 +
+      pattern.points.size() * 3 * sizeof(float) + 4 +
+      pattern.shortPairs.size() * 2 * sizeof(uint32_t);
+  for (size_t offset : {points_offset, long_pairs_offset}) {
+    for (uint32_t count : {0xfffffff0u, 1u << 20, 100000u}) {
+      std::string corrupt = binary_stream.str();
+      memcpy(&corrupt[offset], &count, sizeof(count));
+      std::stringstream corrupt_stream(corrupt);
+      EXPECT_FALSE(brisk::ReadPatternBinary(corrupt_stream, &pattern_binary));
+    }
+  }
+}
+
+TEST(BriskDescriptorExtraction, BinaryPatternFile) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  std::vector<agast::KeyPoint> keypoints;
+  DetectKeypoints(image, &keypoints);
+
+  brisk::BriskPattern pattern;
+  brisk::GetDefaultPattern(&pattern);
+  const std::string fname = "./test_data/tmp/default_pattern.bptn";
+  {
+    std::ofstream file(fname.c_str(), std::ios::out | std::ios::binary);
+    ASSERT_TRUE(file.is_open());
+    brisk::WritePatternBinary(pattern, &file);
+  }
+
+  brisk::BriskDescriptorExtractor extractor_default;
+  brisk::BriskDescriptorExtractor extractor_file(fname);
+  std::vector<agast::KeyPoint> keypoints_default = keypoints;
+  cv::Mat descriptors_default, descriptors_file;
+  extractor_default.compute(image, keypoints_default, descriptors_default);
+  extractor_file.compute(image, keypoints, descriptors_file);
+  ASSERT_EQ(descriptors_default.rows, descriptors_file.rows);
+  EXPECT_EQ(0, memcmp(descriptors_default.data, descriptors_file.data,
+                      descriptors_default.rows * descriptors_default.cols));
+}
+
+TEST(BriskDescriptorExtraction, SamplingAvx2MatchesScalar) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  std::vector<agast::KeyPoint> keypoints;
+  brisk::GetSyntheticKeypoints(image, &keypoints);
+  if (!brisk::CpuSupportsAvx2()) {
+    std::cout << "AVX2 not supported, comparing the reference only."
+        << std::endl;
+  }
+
+  brisk::BriskDescriptorExtractor extractor;
+  std::vector<agast::KeyPoint> keypoints_scalar = keypoints;
+  std::vector<agast::KeyPoint> keypoints_avx2 = keypoints;
+  cv::Mat descriptors_scalar, descriptors_avx2;
+  brisk::SetAvx2Enabled(false);
+  extractor.compute(image, keypoints_scalar, descriptors_scalar);
+  brisk::SetAvx2Enabled(true);
+  extractor.compute(image, keypoints_avx2, descriptors_avx2);
+
+  ASSERT_GT(keypoints_scalar.size(), 1000u);
+  ASSERT_EQ(keypoints_scalar.size(), keypoints_avx2.size());
+  for (size_t k = 0; k < keypoints_scalar.size(); ++k) {
+    ASSERT_EQ(agast::KeyPointAngle(keypoints_scalar[k]),
+              agast::KeyPointAngle(keypoints_avx2[k]));
+  }
+  ASSERT_EQ(descriptors_scalar.rows, descriptors_avx2.rows);
+  EXPECT_EQ(0, memcmp(descriptors_scalar.data, descriptors_avx2.data,
+                      descriptors_scalar.rows * descriptors_scalar.cols));
+}
+
+#if defined(__linux__)
+TEST(BriskDescriptorExtraction, SamplingAtTheEndOfTheImage) {
+  cv::Mat source = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(source.empty());
+  // The image ends right before a page that must not be read.
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t image_size = source.rows * source.cols;
+  const size_t pages = (image_size + page_size - 1) / page_size + 1;
+  unsigned char* memory = static_cast<unsigned char*>(
+      mmap(nullptr, pages * page_size, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  ASSERT_NE(MAP_FAILED, static_cast<void*>(memory));
+  unsigned char* guard = memory + (pages - 1) * page_size;
+  ASSERT_EQ(0, mprotect(guard, page_size, PROT_NONE));
+  cv::Mat image(source.rows, source.cols, CV_8UC1, guard - image_size);
+  source.copyTo(image);
+
+  // Keypoints of all scales as close to the bottom right corner as the
+  // extractor lets them.
+  std::vector<agast::KeyPoint> keypoints;
+  for (int index = 0; index < 4096; ++index) {
+    agast::KeyPoint keypoint;
+    agast::KeyPointX(keypoint) = image.cols - 1 - (index % 64) * 0.37f;
+    agast::KeyPointY(keypoint) = image.rows - 1 - (index / 64) * 0.41f;
+    agast::KeyPointSize(keypoint) = 4.0f * pow(1.037f, (index * 7) % 128);
+    agast::KeyPointAngle(keypoint) = fmod(index * 7.31f, 360.0f);
+    keypoints.push_back(keypoint);
+  }
+  brisk::BriskDescriptorExtractor extractor;
+  std::vector<agast::KeyPoint> keypoints_scalar = keypoints;
+  std::vector<agast::KeyPoint> keypoints_avx2 = keypoints;
+  cv::Mat descriptors_scalar, descriptors_avx2;
+  brisk::SetAvx2Enabled(false);
+  extractor.compute(image, keypoints_scalar, descriptors_scalar);
+  brisk::SetAvx2Enabled(true);
+  extractor.compute(image, keypoints_avx2, descriptors_avx2);
+  ASSERT_GT(keypoints_scalar.size(), 100u);
+  ASSERT_EQ(descriptors_scalar.rows, descriptors_avx2.rows);
+  EXPECT_EQ(0, memcmp(descriptors_scalar.data, descriptors_avx2.data,
+                      descriptors_scalar.rows * descriptors_scalar.cols));
+  munmap(memory, pages * page_size);
+}
+#endif  // __linux__
+
+TEST(BriskDescriptorExtraction, QuantizedSamplingIsClose) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  std::vector<agast::KeyPoint> keypoints;
+  brisk::GetSyntheticKeypoints(image, &keypoints);
+
+  typedef std::bitset<brisk::BriskDescriptorExtractor::kDescriptorLength>
+      Descriptor;
+  brisk::BriskDescriptorExtractor extractor;
+  std::vector<agast::KeyPoint> keypoints_exact = keypoints;
+  std::vector<agast::KeyPoint> keypoints_quantized = keypoints;
+  std::vector<Descriptor> descriptors_exact, descriptors_quantized;
+  brisk::SetAvx2Enabled(false);
+  extractor.compute(image, keypoints_exact, descriptors_exact);
+  extractor.SetQuantizedSampling(true);
+  extractor.compute(image, keypoints_quantized, descriptors_quantized);
+  brisk::SetAvx2Enabled(true);
+
+  // The AVX2 kernel takes precedence and stays exact.
+  if (brisk::CpuSupportsAvx2()) {
+    std::vector<agast::KeyPoint> keypoints_avx2 = keypoints;
+    std::vector<Descriptor> descriptors_avx2;
+    extractor.compute(image, keypoints_avx2, descriptors_avx2);
+    ASSERT_EQ(descriptors_exact.size(), descriptors_avx2.size());
+    for (size_t k = 0; k < descriptors_exact.size(); ++k) {
+      EXPECT_EQ(descriptors_exact[k], descriptors_avx2[k]);
+    }
+  }
+
+  ASSERT_EQ(descriptors_exact.size(), descriptors_quantized.size());
+  ASSERT_GT(descriptors_exact.size(), 1000u);
+  size_t total_distance = 0;
+  size_t max_distance = 0;
+  for (size_t k = 0; k < descriptors_exact.size(); ++k) {
+    const size_t distance =
+        (descriptors_exact[k] ^ descriptors_quantized[k]).count();
+    total_distance += distance;
+    max_distance = std::max(max_distance, distance);
+  }
+  const double mean_distance =
+      static_cast<double>(total_distance) / descriptors_exact.size();
+  std::cout << "Mean Hamming distance to the exact sampling: "
+      << mean_distance << ", max: " << max_distance << std::endl;
+  EXPECT_LT(mean_distance, 20.0);
+}
+
+TEST(BriskDescriptorExtraction, PairComparisonAvx2MatchesScalar) {
+  // An odd number of pairs also exercises the remainder handling.
+  const unsigned int kNumPoints = 60;
+  const unsigned int kNumPairs = 371;
+  std::vector<int> values(kNumPoints);
+  std::vector<brisk::BriskShortPair> pairs(kNumPairs);
+  std::srand(42);
+  for (int& value : values) {
+    value = std::rand() % 512 - 256;
+  }
+  for (brisk::BriskShortPair& pair : pairs) {
+    pair.i = std::rand() % kNumPoints;
+    pair.j = std::rand() % kNumPoints;
+  }
+  const size_t kNumBytes = (kNumPairs + 7) / 8;
+  std::vector<unsigned char> bits_scalar(kNumBytes, 0xff);
+  std::vector<unsigned char> bits_avx2(kNumBytes, 0xff);
+  brisk::SetAvx2Enabled(false);
+  brisk::CompareShortPairs(values.data(), pairs.data(), kNumPairs,
+                           bits_scalar.data());
+  brisk::SetAvx2Enabled(true);
+  brisk::CompareShortPairs(values.data(), pairs.data(), kNumPairs,
+                           bits_avx2.data());
+  for (unsigned int k = 0; k < kNumPairs; ++k) {
+    const bool expected = values[pairs[k].i] > values[pairs[k].j];
+    ASSERT_EQ(expected, (bits_scalar[k / 8] & (1 << (k % 8))) != 0);
+  }
+  // Unused bits are cleared.
+  EXPECT_EQ(0, bits_scalar.back() >> (kNumPairs % 8));
+  EXPECT_EQ(bits_scalar, bits_avx2);
+}
+
+TEST(BriskDescriptorExtraction, LongPairGradientsAvx2MatchesScalar) {
+  const unsigned int kNumPoints = 60;
+  const unsigned int kNumPairs = 870;
+  std::vector<int> values(kNumPoints);
+  std::vector<brisk::BriskLongPair> pairs(kNumPairs);
+  std::srand(42);
+  for (int& value : values) {
+    value = std::rand() % 256;
+  }
+  for (brisk::BriskLongPair& pair : pairs) {
+    pair.i = std::rand() % kNumPoints;
+    pair.j = std::rand() % kNumPoints;
+    pair.weighted_dx = std::rand() % 2048 - 1024;
+    pair.weighted_dy = std::rand() % 2048 - 1024;
+  }
+  int direction0_scalar = 0, direction1_scalar = 0;
+  brisk::SetAvx2Enabled(false);
+  brisk::SumLongPairGradients(values.data(), pairs.data(), kNumPairs,
+                              &direction0_scalar, &direction1_scalar);
+  brisk::SetAvx2Enabled(true);
+  int direction0_avx2 = 0, direction1_avx2 = 0;
+  brisk::SumLongPairGradients(values.data(), pairs.data(), kNumPairs,
+                              &direction0_avx2, &direction1_avx2);
+  EXPECT_EQ(direction0_scalar, direction0_avx2);
+  EXPECT_EQ(direction1_scalar, direction1_avx2);
+}
+
+TEST(BriskDescriptorExtraction, LongPairGradients64Bit) {
+  const unsigned int kNumPoints = 60;
+  const unsigned int kNumPairs = 870;
+  std::vector<int> values(kNumPoints);
+  std::vector<brisk::BriskLongPair> pairs(kNumPairs);
+  std::srand(42);
+  for (int& value : values) {
+    value = std::rand() % 256;
+  }
+  for (brisk::BriskLongPair& pair : pairs) {
+    pair.i = std::rand() % kNumPoints;
+    pair.j = std::rand() % kNumPoints;
+    pair.weighted_dx = std::rand() % 2048 - 1024;
+    pair.weighted_dy = std::rand() % 2048 - 1024;
+  }
+  int direction0 = 0, direction1 = 0;
+  brisk::SumLongPairGradients(values.data(), pairs.data(), kNumPairs,
+                              &direction0, &direction1);
+  int64_t direction0_64 = 0, direction1_64 = 0;
+  brisk::SumLongPairGradients(values.data(), pairs.data(), kNumPairs,
+                              &direction0_64, &direction1_64);
+  EXPECT_EQ(direction0, direction0_64);
+  EXPECT_EQ(direction1, direction1_64);
+
+  // The full precision intensities of 16 bit images, which overflow 32 bit.
+  for (int& value : values) {
+    value = value * 257 * 1024;
+  }
+  int64_t direction0_16 = 0, direction1_16 = 0;
+  brisk::SumLongPairGradients(values.data(), pairs.data(), kNumPairs,
+                              &direction0_16, &direction1_16);
+  EXPECT_NEAR(direction0 * 257 * 1024.0, direction0_16,
+              kNumPairs * 257 * 1024.0);
+  EXPECT_NEAR(direction1 * 257 * 1024.0, direction1_16,
+              kNumPairs * 257 * 1024.0);
+}
+
+TEST(BriskDescriptorExtraction, ComputeOrientations) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  std::vector<agast::KeyPoint> keypoints;
+  DetectKeypoints(image, &keypoints);
+  // Keypoints at the border are removed by both.
+  agast::KeyPoint border_keypoint = keypoints.front();
+  agast::KeyPointX(border_keypoint) = 1.0f;
+  keypoints.push_back(border_keypoint);
+
+  brisk::BriskDescriptorExtractor extractor;
+  extractor.SetNumThreads(4);
+  std::vector<agast::KeyPoint> keypoints_compute = keypoints;
+  cv::Mat descriptors;
+  extractor.compute(image, keypoints_compute, descriptors);
+
+  // Overwrites given angles.
+  std::vector<agast::KeyPoint> keypoints_oriented = keypoints;
+  for (agast::KeyPoint& keypoint : keypoints_oriented) {
+    agast::KeyPointAngle(keypoint) = 42.0f;
+  }
+  extractor.ComputeOrientations(image, keypoints_oriented);
+  ASSERT_EQ(keypoints_compute.size(), keypoints_oriented.size());
+  ASSERT_LT(keypoints_oriented.size(), keypoints.size());
+  for (size_t k = 0; k < keypoints_compute.size(); ++k) {
+    EXPECT_EQ(agast::KeyPointX(keypoints_compute[k]),
+              agast::KeyPointX(keypoints_oriented[k]));
+    EXPECT_EQ(agast::KeyPointAngle(keypoints_compute[k]),
+              agast::KeyPointAngle(keypoints_oriented[k]));
+  }
+}
+
+TEST(BriskDescriptorExtraction, PreparedImageSubsets) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  std::vector<agast::KeyPoint> keypoints;
+  DetectKeypoints(image, &keypoints);
+
+  brisk::BriskDescriptorExtractor extractor;
+  std::vector<agast::KeyPoint> keypoints_all = keypoints;
+  cv::Mat descriptors_all;
+  extractor.compute(image, keypoints_all, descriptors_all);
+
+  // Extract the same keypoints in batches from one prepared image.
+  brisk::PreparedImage preparedImage(image);
+  const size_t kBatchSize = 100;
+  size_t num_extracted = 0;
+  for (size_t begin = 0; begin < keypoints.size(); begin += kBatchSize) {
+    std::vector<agast::KeyPoint> batch(
+        keypoints.begin() + begin,
+        keypoints.begin() + std::min(begin + kBatchSize, keypoints.size()));
+    cv::Mat descriptors;
+    extractor.compute(preparedImage, batch, descriptors);
+    ASSERT_EQ(batch.size(), static_cast<size_t>(descriptors.rows));
+    ASSERT_LE(num_extracted + batch.size(), keypoints_all.size());
+    for (size_t k = 0; k < batch.size(); ++k) {
+      EXPECT_EQ(agast::KeyPointAngle(keypoints_all[num_extracted + k]),
+                agast::KeyPointAngle(batch[k]));
+    }
+    EXPECT_EQ(0, memcmp(descriptors_all.ptr(num_extracted), descriptors.data,
+                        descriptors.rows * descriptors.cols));
+    num_extracted += batch.size();
+  }
+  EXPECT_EQ(keypoints_all.size(), num_extracted);
+}
+
+TEST(BriskDescriptorExtraction, CallerOwnedBuffer) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  std::vector<agast::KeyPoint> keypoints;
+  DetectKeypoints(image, &keypoints);
+
+  brisk::BriskDescriptorExtractor extractor;
+  std::vector<agast::KeyPoint> keypoints_mat = keypoints;
+  cv::Mat descriptors_mat;
+  extractor.compute(image, keypoints_mat, descriptors_mat);
+
+  // A 64 byte aligned arena with 64 byte rows, filled with garbage.
+  const size_t kAlignment = 64;
+  const size_t kStride = 64;
+  const size_t capacity = 2 * keypoints.size();
+  std::vector<unsigned char> memory(capacity * kStride + kAlignment, 0xab);
+  unsigned char* data = memory.data() + kAlignment -
+      reinterpret_cast<uintptr_t>(memory.data()) % kAlignment;
+
+  brisk::PreparedImage preparedImage(image);
+  std::vector<agast::KeyPoint> keypoints_buffer = keypoints;
+  const size_t num_rows = extractor.compute(preparedImage, keypoints_buffer,
+                                            data, kStride, capacity,
+                                            kAlignment);
+  ASSERT_EQ(keypoints_mat.size(), num_rows);
+  ASSERT_EQ(keypoints_mat.size(), keypoints_buffer.size());
+  const size_t descriptor_size = extractor.descriptorSize();
+  for (size_t k = 0; k < num_rows; ++k) {
+    const unsigned char* row = data + k * kStride;
+    EXPECT_EQ(0, memcmp(descriptors_mat.ptr(k), row, descriptor_size));
+    for (size_t i = descriptor_size; i < kStride; ++i) {
+      ASSERT_EQ(0, row[i]);
+    }
+  }
+
+  // Append the same descriptors a second time.
+  brisk::DescriptorBuffer buffer(data, kStride, capacity, kAlignment);
+  keypoints_buffer = keypoints;
+  extractor.compute(preparedImage, keypoints_buffer, buffer);
+  ASSERT_EQ(num_rows, buffer.size());
+  keypoints_buffer = keypoints;
+  extractor.compute(preparedImage, keypoints_buffer, buffer);
+  ASSERT_EQ(2 * num_rows, buffer.size());
+  EXPECT_EQ(0, memcmp(buffer.Row(0), buffer.Row(num_rows), num_rows * kStride));
+}
+
+TEST(BriskDescriptorExtraction, CallerOwnedBufferErrors) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  std::vector<agast::KeyPoint> keypoints;
+  DetectKeypoints(image, &keypoints);
+  ASSERT_GT(keypoints.size(), 1u);
+
+  brisk::BriskDescriptorExtractor extractor;
+  const size_t kStride = 64;
+  std::vector<unsigned char> memory(keypoints.size() * kStride, 0xab);
+  const std::vector<unsigned char> memory_before = memory;
+
+  // The capacity must cover the keypoints before the border removal.
+  brisk::DescriptorBuffer buffer(memory.data(), kStride,
+                                 keypoints.size() - 1);
+  std::vector<agast::KeyPoint> keypoints_buffer = keypoints;
+  EXPECT_THROW(extractor.compute(brisk::PreparedImage(image),
+                                 keypoints_buffer, buffer),
+               std::runtime_error);
+  EXPECT_EQ(0u, buffer.size());
+  EXPECT_EQ(keypoints.size(), keypoints_buffer.size());
+  EXPECT_THROW(buffer.Append(keypoints.size()), std::runtime_error);
+  EXPECT_EQ(0u, buffer.size());
+
+  // Unsupported images fail before the buffer is touched.
+  cv::Mat float_image(image.rows, image.cols, CV_32FC1);
+  brisk::DescriptorBuffer large_buffer(memory.data(), kStride,
+                                       keypoints.size());
+  EXPECT_THROW(extractor.compute(brisk::PreparedImage(float_image),
+                                 keypoints_buffer, large_buffer),
+               std::runtime_error);
+  EXPECT_EQ(0u, large_buffer.size());
+  EXPECT_EQ(keypoints.size(), keypoints_buffer.size());
+  EXPECT_TRUE(memory_before == memory);
+}
+
+TEST(BriskDescriptorExtraction, Extraction16Bit) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  std::vector<agast::KeyPoint> keypoints;
+  brisk::GetSyntheticKeypoints(image, &keypoints);
+
+  // The 8 bit image rescaled to the full range, and the same with noise in
+  // the lower bits, give nearly the descriptors of the 8 bit image. They are
+  // not identical since the 16 bit path keeps the fractions of the means,
+  // which break the ties of the 8 bit values.
+  cv::Mat image_rescaled(image.rows, image.cols, CV_16UC1);
+  cv::Mat image_noisy(image.rows, image.cols, CV_16UC1);
+  std::srand(42);
+  for (int row = 0; row < image.rows; ++row) {
+    for (int col = 0; col < image.cols; ++col) {
+      const int value = image.at<unsigned char>(row, col);
+      image_rescaled.at<uint16_t>(row, col) = value * 257;
+      image_noisy.at<uint16_t>(row, col) = value * 257 ^ (std::rand() % 64);
+    }
+  }
+  EXPECT_LT(MeanDistanceTo8Bit(image, image_rescaled, keypoints), 1.0);
+  EXPECT_LT(MeanDistanceTo8Bit(image, image_noisy, keypoints), 2.0);
+}
+
+TEST(BriskDescriptorExtraction, Extraction12Bit) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  std::vector<agast::KeyPoint> keypoints;
+  brisk::GetSyntheticKeypoints(image, &keypoints);
+
+  // 12 bit data in the lower bits of the 16 bit image, once rescaled to the
+  // 12 bit range and once as a dim image whose contrast spans only 256 of
+  // the 4096 levels. The descriptors of both must not lose the detail that
+  // the upper byte of the samples does not resolve.
+  cv::Mat image_rescaled(image.rows, image.cols, CV_16UC1);
+  cv::Mat image_dim(image.rows, image.cols, CV_16UC1);
+  for (int row = 0; row < image.rows; ++row) {
+    for (int col = 0; col < image.cols; ++col) {
+      const int value = image.at<unsigned char>(row, col);
+      image_rescaled.at<uint16_t>(row, col) = value * 4095 / 255;
+      image_dim.at<uint16_t>(row, col) = 2048 + value;
+    }
+  }
+  EXPECT_LT(MeanDistanceTo8Bit(image, image_rescaled, keypoints), 1.0);
+  EXPECT_LT(MeanDistanceTo8Bit(image, image_dim, keypoints), 1.0);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
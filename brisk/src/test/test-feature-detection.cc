@@ -0,0 +1,772 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <agast/glog.h>
+#include <agast/internal/oast9-16-simd.h>
+#include <agast/oast9-16.h>
+#include <brisk/brisk.h>
+#include <brisk/internal/brisk-layer.h>
+#include <brisk/internal/harris-scores.h>
+#include <brisk/internal/image-down-sampling.h>
+#include <gtest/gtest.h>
+
+#include "./synthetic-data.h"
+
+#ifndef TEST
+#define TEST(a, b) void Test_##a##_##b()
+#endif
+
+namespace {
+void ExpectKeypointsEqual(const std::vector<agast::KeyPoint>& expected,
+                          const std::vector<agast::KeyPoint>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t k = 0; k < expected.size(); ++k) {
+    EXPECT_EQ(agast::KeyPointX(expected[k]), agast::KeyPointX(actual[k]));
+    EXPECT_EQ(agast::KeyPointY(expected[k]), agast::KeyPointY(actual[k]));
+    EXPECT_EQ(agast::KeyPointSize(expected[k]),
+              agast::KeyPointSize(actual[k]));
+    EXPECT_EQ(agast::KeyPointResponse(expected[k]),
+              agast::KeyPointResponse(actual[k]));
+  }
+}
+
+std::vector<agast::KeyPoint> Masked(const std::vector<agast::KeyPoint>& all,
+                                    const cv::Mat& mask) {
+  std::vector<agast::KeyPoint> masked;
+  for (const agast::KeyPoint& keypoint : all) {
+    if (mask.at<unsigned char>(
+            static_cast<int>(agast::KeyPointY(keypoint) + 0.5f),
+            static_cast<int>(agast::KeyPointX(keypoint) + 0.5f)) != 0) {
+      masked.push_back(keypoint);
+    }
+  }
+  return masked;
+}
+
+std::tuple<int, int, int> RoundedKeypoint(const agast::KeyPoint& keypoint) {
+  return std::make_tuple(
+      static_cast<int>(std::round(agast::KeyPointX(keypoint) * 10)),
+      static_cast<int>(std::round(agast::KeyPointY(keypoint) * 10)),
+      static_cast<int>(std::round(agast::KeyPointSize(keypoint) * 10)));
+}
+
+std::vector<agast::KeyPoint> SortedByPosition(
+    std::vector<agast::KeyPoint> keypoints) {
+  std::sort(keypoints.begin(), keypoints.end(),
+            [](const agast::KeyPoint& lhs, const agast::KeyPoint& rhs) {
+    if (agast::KeyPointY(lhs) != agast::KeyPointY(rhs))
+      return agast::KeyPointY(lhs) < agast::KeyPointY(rhs);
+    if (agast::KeyPointX(lhs) != agast::KeyPointX(rhs))
+      return agast::KeyPointX(lhs) < agast::KeyPointX(rhs);
+    return agast::KeyPointSize(lhs) < agast::KeyPointSize(rhs);
+  });
+  return keypoints;
+}
+}  // namespace
+
+TEST(BriskFeatureDetection, PreparedImagePyramid) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  brisk::PreparedImage preparedImage(image);
+  EXPECT_EQ(image.data, preparedImage.GetLayer(0).data);
+  cv::Mat layer1 = preparedImage.GetLayer(1);
+  EXPECT_EQ((image.rows / 3) * 2, layer1.rows);
+  EXPECT_EQ((image.cols / 3) * 2, layer1.cols);
+  cv::Mat layer5 = preparedImage.GetLayer(5);
+  EXPECT_EQ(layer1.rows / 4, layer5.rows);
+  EXPECT_EQ(layer1.cols / 4, layer5.cols);
+  // The layers are cached.
+  EXPECT_EQ(layer1.data, preparedImage.GetLayer(1).data);
+  EXPECT_EQ(&preparedImage.GetIntegral(), &preparedImage.GetIntegral());
+  EXPECT_EQ(image.rows + 1, preparedImage.GetIntegral().rows);
+}
+
+#ifndef __ARM_NEON
+TEST(BriskFeatureDetection, PreparedImageHarris) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  brisk::ScaleSpaceFeatureDetector<brisk::HarrisScoreCalculator>
+      detector(2, 30, 20, 1000);
+  std::vector<agast::KeyPoint> keypoints, keypoints_prepared;
+  detector.detect(image, keypoints);
+  brisk::PreparedImage preparedImage(image);
+  detector.detect(preparedImage, keypoints_prepared);
+  ASSERT_FALSE(keypoints.empty());
+  ExpectKeypointsEqual(keypoints, keypoints_prepared);
+
+  brisk::BriskFeature feature(2, 30, 20, 1000);
+  std::vector<agast::KeyPoint> keypoints_feature;
+  cv::Mat descriptors_feature;
+  feature.detectAndCompute(image, cv::noArray(), keypoints_feature,
+                           descriptors_feature);
+  brisk::BriskDescriptorExtractor extractor;
+  cv::Mat descriptors;
+  extractor.compute(image, keypoints, descriptors);
+  ExpectKeypointsEqual(keypoints, keypoints_feature);
+  ASSERT_EQ(descriptors.rows, descriptors_feature.rows);
+  EXPECT_EQ(0, memcmp(descriptors.data, descriptors_feature.data,
+                      descriptors.rows * descriptors.cols));
+}
+
+TEST(BriskFeatureDetection, MaskedHarris) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  const cv::Mat mask = brisk::RobotMask(image.rows, image.cols);
+  // Without a keypoint limit, masking before the refinement finds the same
+  // keypoints as filtering them afterwards, up to the order the bucketing
+  // leaves them in.
+  brisk::ScaleSpaceFeatureDetector<brisk::HarrisScoreCalculator>
+      detector(2, 0, 20, 100000);
+  std::vector<agast::KeyPoint> keypoints, keypoints_masked;
+  detector.detect(image, keypoints);
+  detector.detect(image, keypoints_masked, mask);
+  ASSERT_FALSE(keypoints_masked.empty());
+  ExpectKeypointsEqual(SortedByPosition(Masked(keypoints, mask)),
+                       SortedByPosition(keypoints_masked));
+
+  // With a limit, the masked out maxima no longer count against it.
+  brisk::ScaleSpaceFeatureDetector<brisk::HarrisScoreCalculator>
+      limited_detector(2, 30, 20, 200);
+  keypoints.clear();
+  keypoints_masked.clear();
+  limited_detector.detect(image, keypoints);
+  limited_detector.detect(image, keypoints_masked, mask);
+  ExpectKeypointsEqual(Masked(keypoints_masked, mask), keypoints_masked);
+  EXPECT_GT(keypoints_masked.size(), Masked(keypoints, mask).size());
+
+  // The layers are reused without the mask.
+  std::vector<agast::KeyPoint> keypoints_unmasked;
+  limited_detector.detect(image, keypoints_unmasked);
+  ExpectKeypointsEqual(keypoints, keypoints_unmasked);
+}
+
+TEST(BriskFeatureDetection, TotalKeypointBudget) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  brisk::ScaleSpaceFeatureDetector<brisk::HarrisScoreCalculator>
+      detector(4, 0, 20, 2000);
+  std::vector<agast::KeyPoint> keypoints;
+  detector.detect(image, keypoints);
+  const size_t kBudget = 500;
+  ASSERT_GT(keypoints.size(), kBudget);
+
+  // The strongest keypoints of all layers, in their order.
+  std::vector<size_t> ranking(keypoints.size());
+  for (size_t k = 0; k < ranking.size(); ++k) {
+    ranking[k] = k;
+  }
+  std::stable_sort(ranking.begin(), ranking.end(),
+                   [&keypoints](size_t lhs, size_t rhs) {
+    return agast::KeyPointResponse(keypoints[lhs]) >
+        agast::KeyPointResponse(keypoints[rhs]);
+  });
+  ranking.resize(kBudget);
+  std::sort(ranking.begin(), ranking.end());
+  std::vector<agast::KeyPoint> expected;
+  for (size_t k : ranking) {
+    expected.push_back(keypoints[k]);
+  }
+
+  detector.SetMaxNumKptTotal(kBudget);
+  std::vector<agast::KeyPoint> keypoints_budget;
+  detector.detect(image, keypoints_budget);
+  ExpectKeypointsEqual(expected, keypoints_budget);
+}
+#endif  // __ARM_NEON
+
+TEST(BriskFeatureDetection, PreparedImageAst) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  brisk::BriskFeatureDetector detector(30, 3);
+  std::vector<agast::KeyPoint> keypoints, keypoints_prepared;
+  detector.detect(image, keypoints);
+  brisk::PreparedImage preparedImage(image);
+  detector.detect(preparedImage, keypoints_prepared);
+  ASSERT_FALSE(keypoints.empty());
+  ExpectKeypointsEqual(keypoints, keypoints_prepared);
+}
+
+TEST(BriskFeatureDetection, PreparedImageRoi) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  const cv::Mat roi = image(cv::Range(20, image.rows - 30),
+                            cv::Range(40, image.cols - 50));
+  ASSERT_FALSE(roi.isContinuous());
+  brisk::BriskFeatureDetector detector(30, 3);
+  std::vector<agast::KeyPoint> keypoints, keypoints_prepared;
+  detector.detect(roi, keypoints);
+  detector.detect(brisk::PreparedImage(roi), keypoints_prepared);
+  ASSERT_FALSE(keypoints.empty());
+  ExpectKeypointsEqual(keypoints, keypoints_prepared);
+}
+
+TEST(BriskFeatureDetection, MaskedAst) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  const cv::Mat mask = brisk::RobotMask(image.rows, image.cols);
+  brisk::BriskFeatureDetector detector(30, 3);
+  std::vector<agast::KeyPoint> keypoints, keypoints_masked;
+  detector.detect(image, keypoints);
+  detector.detect(image, keypoints_masked, mask);
+  ASSERT_FALSE(keypoints_masked.empty());
+  ExpectKeypointsEqual(Masked(keypoints, mask), keypoints_masked);
+
+  // Same on the layers of a prepared image and with parallel layers.
+  brisk::PreparedImage preparedImage(image);
+  std::vector<agast::KeyPoint> keypoints_prepared;
+  detector.detect(preparedImage, keypoints_prepared, mask);
+  ExpectKeypointsEqual(keypoints_masked, keypoints_prepared);
+  detector.SetNumThreads(3);
+  std::vector<agast::KeyPoint> keypoints_parallel;
+  detector.detect(image, keypoints_parallel, mask);
+  ExpectKeypointsEqual(keypoints_masked, keypoints_parallel);
+
+  // The mask does not stick to the scale space.
+  detector.SetNumThreads(1);
+  detector.SetPersistentScaleSpace(true);
+  detector.detect(image, keypoints_masked, mask);
+  detector.detect(image, keypoints_masked);
+  ExpectKeypointsEqual(keypoints, keypoints_masked);
+}
+
+TEST(BriskFeatureDetection, MaskDownsampling) {
+  cv::Mat mask = cv::Mat::zeros(9, 12, CV_8UC1);
+  mask.at<unsigned char>(4, 7) = 1;
+  cv::Mat half(4, 6, CV_8UC1);
+  brisk::HalfsampleMask(mask, half);
+  cv::Mat twothird(6, 8, CV_8UC1);
+  brisk::TwothirdsampleMask(mask, twothird);
+  cv::Mat dilated(9, 12, CV_8UC1);
+  brisk::DilateMask(mask, 2, dilated);
+  for (int y = 0; y < mask.rows; ++y) {
+    for (int x = 0; x < mask.cols; ++x) {
+      if (y < half.rows && x < half.cols) {
+        EXPECT_EQ(y == 2 && x == 3 ? 255 : 0, half.at<unsigned char>(y, x));
+      }
+      // Source pixel 4 lies under destination pixels 2 and 3, pixel 7 under
+      // 4 and 5.
+      if (y < twothird.rows && x < twothird.cols) {
+        const bool valid = (y == 2 || y == 3) && (x == 4 || x == 5);
+        EXPECT_EQ(valid ? 255 : 0, twothird.at<unsigned char>(y, x));
+      }
+      const bool near = std::abs(y - 4) <= 2 && std::abs(x - 7) <= 2;
+      EXPECT_EQ(near ? 255 : 0, dilated.at<unsigned char>(y, x));
+    }
+  }
+}
+
+TEST(BriskFeatureDetection, ParallelPyramid) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  brisk::BriskFeatureDetector detector(30, 4);
+  std::vector<agast::KeyPoint> keypoints;
+  detector.detect(image, keypoints);
+  ASSERT_FALSE(keypoints.empty());
+
+  detector.SetNumThreads(4);
+  std::vector<agast::KeyPoint> keypoints_parallel, keypoints_prepared;
+  detector.detect(image, keypoints_parallel);
+  ExpectKeypointsEqual(keypoints, keypoints_parallel);
+  brisk::PreparedImage preparedImage(image);
+  detector.detect(preparedImage, keypoints_prepared);
+  ExpectKeypointsEqual(keypoints, keypoints_prepared);
+}
+
+TEST(BriskFeatureDetection, ParallelComputeScale) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  brisk::BriskFeatureDetector detector(30, 4);
+  std::vector<agast::KeyPoint> keypoints;
+  detector.detect(image, keypoints);
+  ASSERT_FALSE(keypoints.empty());
+  std::vector<agast::KeyPoint> keypoints_parallel = keypoints;
+  detector.ComputeScale(image, keypoints);
+  detector.SetNumThreads(4);
+  detector.ComputeScale(image, keypoints_parallel);
+  ExpectKeypointsEqual(keypoints, keypoints_parallel);
+}
+
+TEST(BriskFeatureDetection, HarrisScoreStripes) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  // Odd sizes and a last stripe of less than 16 columns of SIMD leftover.
+  const cv::Mat odd = image(cv::Range(3, image.rows - 2),
+                            cv::Range(5, image.cols - 6)).clone();
+  for (const cv::Mat* src : {static_cast<const cv::Mat*>(&image), &odd}) {
+    cv::Mat scores, scores_stripes;
+    brisk::HarrisScoresSSE(*src, scores);
+    for (size_t threads : {2, 3, 4, 64}) {
+      brisk::HarrisScoresSSE(*src, scores_stripes, threads);
+      ASSERT_EQ(scores.rows, scores_stripes.rows);
+      ASSERT_EQ(scores.cols, scores_stripes.cols);
+      EXPECT_EQ(0, memcmp(scores.data, scores_stripes.data,
+                          scores.rows * scores.cols * sizeof(int)));
+    }
+  }
+
+  // Repeated calls reuse the scores and the row buffer.
+  cv::Mat scores, scores_reused;
+  brisk::HarrisScoresSSE(image, scores);
+  brisk::HarrisScoresBuffer buffer;
+  brisk::HarrisScoresSSE(odd, scores_reused, 2, brisk::TaskRunner(), &buffer);
+  brisk::HarrisScoresSSE(image, scores_reused, 2, brisk::TaskRunner(),
+                         &buffer);
+  const unsigned char* const scores_data = scores_reused.data;
+  const int16_t* const buffer_data = buffer.data();
+  brisk::HarrisScoresSSE(image, scores_reused, 2, brisk::TaskRunner(),
+                         &buffer);
+  EXPECT_EQ(scores_data, scores_reused.data);
+  EXPECT_EQ(buffer_data, buffer.data());
+  EXPECT_EQ(0, memcmp(scores.data, scores_reused.data,
+                      scores.rows * scores.cols * sizeof(int)));
+
+  brisk::ScaleSpaceFeatureDetector<brisk::HarrisScoreCalculator> detector(
+      2, 0, 10, 100000);
+  std::vector<agast::KeyPoint> keypoints, keypoints_parallel;
+  detector.detect(image, keypoints);
+  ASSERT_FALSE(keypoints.empty());
+  detector.SetNumThreads(4);
+  detector.detect(image, keypoints_parallel);
+  ExpectKeypointsEqual(keypoints, keypoints_parallel);
+}
+
+TEST(BriskFeatureDetection, LazyHarrisScores) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  // Keypoints of octave 0 as if they were tracked from the last frame.
+  brisk::ScaleSpaceFeatureDetector<brisk::HarrisScoreCalculator> detector(
+      0, 0, 10, 100000);
+  std::vector<agast::KeyPoint> tracked;
+  detector.detect(image, tracked);
+  ASSERT_GT(tracked.size(), 100u);
+
+  // Refining them needs the scores around them only.
+  brisk::ScaleSpaceLayer<brisk::HarrisScoreCalculator> dense_layer,
+      lazy_layer;
+  std::vector<agast::KeyPoint> refined_dense = tracked;
+  std::vector<agast::KeyPoint> refined_lazy = tracked;
+  dense_layer.Create(image, true);
+  dense_layer.SetMaxNumKpt(tracked.size());
+  dense_layer.DetectScaleSpaceMaxima(refined_dense, false, true, true);
+  lazy_layer.Create(image, false);
+  lazy_layer.SetMaxNumKpt(tracked.size());
+  lazy_layer.DetectScaleSpaceMaxima(refined_lazy, false, true, true);
+  ASSERT_FALSE(refined_dense.empty());
+  ExpectKeypointsEqual(refined_dense, refined_lazy);
+
+  // Detecting on lazy scores computes all of them.
+  std::vector<agast::KeyPoint> detected_dense, detected_lazy;
+  dense_layer.Create(image, true);
+  dense_layer.DetectScaleSpaceMaxima(detected_dense);
+  lazy_layer.Create(image, false);
+  lazy_layer.DetectScaleSpaceMaxima(detected_lazy);
+  ASSERT_FALSE(detected_dense.empty());
+  ExpectKeypointsEqual(detected_dense, detected_lazy);
+}
+
+TEST(BriskFeatureDetection, OastRowBands) {
+  cv::Mat tile = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(tile.empty());
+  // Tile the image to a size with many bands.
+  const int kTiles = 3;
+  cv::Mat image(tile.rows * kTiles, tile.cols * kTiles, CV_8UC1);
+  cv::Mat thrmap(image.rows, image.cols, CV_8UC1);
+  for (int y = 0; y < image.rows; ++y) {
+    for (int x = 0; x < image.cols; ++x) {
+      image.data[y * image.cols + x] =
+          tile.data[(y % tile.rows) * tile.cols + x % tile.cols];
+      thrmap.data[y * image.cols + x] = 10 + (x * 7 + y * 13) % 140;
+    }
+  }
+
+  agast::OastDetector9_16 detector(image.cols, image.rows, 30);
+  detector.set_threshold(30);
+  for (const cv::Mat* map : {static_cast<const cv::Mat*>(nullptr),
+                             static_cast<const cv::Mat*>(&thrmap)}) {
+    std::vector<agast::KeyPoint> corners, corners_bands;
+    detector.set_numThreads(1);
+    detector.detect(image.data, corners, map);
+    ASSERT_FALSE(corners.empty());
+    detector.set_numThreads(4);
+    detector.detect(image.data, corners_bands, map);
+    ExpectKeypointsEqual(corners, corners_bands);
+  }
+}
+
+TEST(BriskFeatureDetection, LayerReset) {
+  cv::Mat image1 = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  cv::Mat image2 = cv::imread("./test_data/img2.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image1.empty());
+  ASSERT_EQ(image1.rows, image2.rows);
+  ASSERT_EQ(image1.cols, image2.cols);
+  brisk::BriskLayer layer;
+  layer.ResetCopy(image1, 230, 10);
+  brisk::BriskLayer derived(layer, brisk::BriskLayer::CommonParams::HALFSAMPLE,
+                            230, 10);
+  std::vector<agast::KeyPoint> points;
+  derived.GetAgastPoints(30, &points);
+  const unsigned char* image_data = layer.img().data;
+  const unsigned char* derived_data = derived.img().data;
+  const unsigned char* scores_data = derived.scores().data;
+  const unsigned char* thrmap_data = derived.thrmap().data;
+
+  // Resetting with equally sized images gives the layers of a fresh
+  // construction in the same buffers.
+  layer.ResetCopy(image2, 230, 10);
+  derived.Reset(layer, brisk::BriskLayer::CommonParams::HALFSAMPLE, 230, 10);
+  points.clear();
+  derived.GetAgastPoints(30, &points);
+  EXPECT_EQ(image_data, layer.img().data);
+  EXPECT_EQ(derived_data, derived.img().data);
+  EXPECT_EQ(scores_data, derived.scores().data);
+  EXPECT_EQ(thrmap_data, derived.thrmap().data);
+
+  brisk::BriskLayer fresh(image2.clone(), 230, 10);
+  brisk::BriskLayer fresh_derived(
+      fresh, brisk::BriskLayer::CommonParams::HALFSAMPLE, 230, 10);
+  std::vector<agast::KeyPoint> fresh_points;
+  fresh_derived.GetAgastPoints(30, &fresh_points);
+  ExpectKeypointsEqual(fresh_points, points);
+  const size_t size = derived.rows() * derived.cols();
+  EXPECT_EQ(0, memcmp(fresh_derived.img().data, derived.img().data, size));
+  EXPECT_EQ(0, memcmp(fresh_derived.scores().data, derived.scores().data,
+                      size));
+  EXPECT_EQ(0, memcmp(fresh_derived.thrmap().data, derived.thrmap().data,
+                      size));
+}
+
+TEST(BriskFeatureDetection, PersistentScaleSpace) {
+  cv::Mat image1 = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  cv::Mat image2 = cv::imread("./test_data/img2.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image1.empty());
+  ASSERT_FALSE(image2.empty());
+  // A differently sized frame in between.
+  cv::Mat image3 = image1(cv::Range(0, image1.rows / 2),
+                          cv::Range(0, image1.cols / 2)).clone();
+  brisk::BriskFeatureDetector detector(30, 4);
+  brisk::BriskFeatureDetector persistent_detector(30, 4);
+  persistent_detector.SetPersistentScaleSpace(true);
+  for (const cv::Mat* image : {&image1, &image2, &image3, &image1, &image2}) {
+    std::vector<agast::KeyPoint> keypoints, keypoints_persistent;
+    detector.detect(*image, keypoints);
+    persistent_detector.detect(*image, keypoints_persistent);
+    ASSERT_FALSE(keypoints.empty());
+    ExpectKeypointsEqual(keypoints, keypoints_persistent);
+  }
+}
+
+TEST(BriskFeatureDetection, BorrowedImages) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  // Non-continuous images are copied.
+  cv::Mat roi = image(cv::Range(10, image.rows - 10),
+                      cv::Range(10, image.cols - 10));
+  brisk::BriskFeatureDetector detector(30, 4);
+  brisk::BriskFeatureDetector borrowing_detector(30, 4);
+  borrowing_detector.SetBorrowImages(true);
+  for (bool persistent : {false, true}) {
+    borrowing_detector.SetPersistentScaleSpace(persistent);
+    for (const cv::Mat* input : {&image, &roi}) {
+      std::vector<agast::KeyPoint> keypoints, keypoints_borrowed;
+      detector.detect(*input, keypoints);
+      borrowing_detector.detect(*input, keypoints_borrowed);
+      ASSERT_FALSE(keypoints.empty());
+      ExpectKeypointsEqual(keypoints, keypoints_borrowed);
+    }
+  }
+}
+
+TEST(BriskFeatureDetection, TargetNumKeypoints) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  // A darker, low contrast version of the frame.
+  cv::Mat dim = image.clone();
+  for (int i = 0; i < dim.rows * dim.cols; ++i) {
+    dim.data[i] = 20 + dim.data[i] / 4;
+  }
+  const size_t kMinKeypoints = 300;
+  const size_t kMaxKeypoints = 600;
+  brisk::BriskFeatureDetector detector(5, 4);
+  detector.SetTargetNumKeypoints(kMinKeypoints, kMaxKeypoints);
+  for (const cv::Mat* frame : {&image, &dim}) {
+    size_t num_keypoints = 0;
+    // Converges within a few frames and then stays in the band.
+    for (int i = 0; i < 15; ++i) {
+      std::vector<agast::KeyPoint> keypoints;
+      detector.detect(*frame, keypoints);
+      EXPECT_LE(keypoints.size(), kMaxKeypoints);
+      num_keypoints = keypoints.size();
+    }
+    EXPECT_GE(num_keypoints, kMinKeypoints);
+    // The capped keypoints are the strongest ones at this threshold.
+    brisk::BriskFeatureDetector fixed_detector(detector.GetThreshold(), 4);
+    std::vector<agast::KeyPoint> keypoints, keypoints_fixed;
+    fixed_detector.detect(*frame, keypoints_fixed);
+    const int threshold = detector.GetThreshold();
+    detector.detect(*frame, keypoints);
+    EXPECT_EQ(threshold, detector.GetThreshold());
+    ASSERT_LE(keypoints.size(), keypoints_fixed.size());
+    float min_response = 1e9f;
+    for (const agast::KeyPoint& keypoint : keypoints) {
+      min_response = std::min(min_response,
+                               agast::KeyPointResponse(keypoint));
+    }
+    size_t num_stronger = 0;
+    for (const agast::KeyPoint& keypoint : keypoints_fixed) {
+      if (agast::KeyPointResponse(keypoint) > min_response) {
+        ++num_stronger;
+      }
+    }
+    EXPECT_LE(num_stronger, keypoints.size());
+  }
+}
+
+TEST(BriskFeatureDetection, AssigningThresholdRestartsAdaptation) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  brisk::BriskFeatureDetector detector(5, 4);
+  detector.SetTargetNumKeypoints(300, 600);
+  std::vector<agast::KeyPoint> keypoints;
+  for (int i = 0; i < 5; ++i) {
+    detector.detect(image, keypoints);
+  }
+  EXPECT_NE(5, detector.GetThreshold());
+
+  // The next detection uses the assigned threshold, and the adaptation goes
+  // on from there.
+  detector.threshold = 200;
+  EXPECT_EQ(200, detector.GetThreshold());
+  brisk::BriskFeatureDetector fixed_detector(200, 4);
+  std::vector<agast::KeyPoint> keypoints_fixed;
+  fixed_detector.detect(image, keypoints_fixed);
+  detector.detect(image, keypoints);
+  ExpectKeypointsEqual(keypoints_fixed, keypoints);
+  ASSERT_LT(keypoints.size(), 300u);
+  EXPECT_LT(detector.GetThreshold(), 200);
+}
+
+TEST(BriskFeatureDetection, CopiesDoNotShareState) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  brisk::BriskFeatureDetector detector(5, 4);
+  detector.SetTargetNumKeypoints(300, 600);
+  detector.SetPersistentScaleSpace(true);
+  std::vector<agast::KeyPoint> keypoints;
+  detector.detect(image, keypoints);
+  const int threshold = detector.GetThreshold();
+
+  // The copy continues from the threshold of the original.
+  brisk::BriskFeatureDetector copy(detector);
+  EXPECT_EQ(threshold, copy.GetThreshold());
+  std::vector<agast::KeyPoint> keypoints_copy;
+  for (int i = 0; i < 5; ++i) {
+    copy.detect(image, keypoints_copy);
+  }
+  EXPECT_NE(threshold, copy.GetThreshold());
+  EXPECT_EQ(threshold, detector.GetThreshold());
+
+  // And so does an assigned one, which also keeps the persistent mode.
+  brisk::BriskFeatureDetector assigned(30, 4);
+  assigned = detector;
+  EXPECT_EQ(threshold, assigned.GetThreshold());
+  detector.detect(image, keypoints);
+  assigned.detect(image, keypoints_copy);
+  ExpectKeypointsEqual(keypoints, keypoints_copy);
+  EXPECT_EQ(detector.GetThreshold(), assigned.GetThreshold());
+}
+
+TEST(BriskFeatureDetection, GridMatchesWholeImage) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  const cv::Mat mask = brisk::RobotMask(image.rows, image.cols);
+  // At a fixed threshold, the cells find almost all keypoints of the whole
+  // image, and hardly any others.
+  brisk::BriskFeatureDetector detector(30, 3);
+  brisk::GridFeatureDetector grid(3, 2, 30, 3);
+  for (const cv::Mat& detection_mask : {cv::Mat(), mask}) {
+    std::vector<agast::KeyPoint> keypoints, keypoints_grid;
+    detector.detect(image, keypoints, detection_mask);
+    grid.detect(image, keypoints_grid, detection_mask);
+    ASSERT_FALSE(keypoints_grid.empty());
+    std::set<std::tuple<int, int, int> > positions;
+    for (const agast::KeyPoint& keypoint : keypoints) {
+      positions.insert(RoundedKeypoint(keypoint));
+    }
+    size_t num_matching = 0;
+    for (const agast::KeyPoint& keypoint : keypoints_grid) {
+      num_matching += positions.count(RoundedKeypoint(keypoint));
+    }
+    EXPECT_GT(num_matching, keypoints.size() * 97 / 100);
+    EXPECT_GT(num_matching, keypoints_grid.size() * 97 / 100);
+
+    std::vector<agast::KeyPoint> keypoints_parallel;
+    grid.SetNumThreads(4);
+    grid.detect(image, keypoints_parallel, detection_mask);
+    grid.SetNumThreads(1);
+    ExpectKeypointsEqual(keypoints_grid, keypoints_parallel);
+  }
+}
+
+TEST(BriskFeatureDetection, GridTargetNumKeypoints) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  const size_t kCells = 4;
+  const size_t kMinKeypoints = 400;
+  const size_t kMaxKeypoints = 800;
+  brisk::GridFeatureDetector grid(kCells, kCells, 30, 3);
+  grid.SetTargetNumKeypoints(kMinKeypoints, kMaxKeypoints);
+  grid.SetNumThreads(4);
+  // The thresholds of the cells adapt over the frames.
+  std::vector<agast::KeyPoint> keypoints;
+  for (int i = 0; i < 15; ++i) {
+    grid.detect(image, keypoints);
+  }
+  EXPECT_LE(keypoints.size(), kMaxKeypoints);
+  EXPECT_GE(keypoints.size(), kMinKeypoints * 3 / 4);
+  // Every cell contributes its share, at a threshold of its own.
+  std::vector<size_t> counts(kCells * kCells, 0);
+  for (const agast::KeyPoint& keypoint : keypoints) {
+    const size_t cellX = agast::KeyPointX(keypoint) * kCells / image.cols;
+    const size_t cellY = agast::KeyPointY(keypoint) * kCells / image.rows;
+    ++counts[cellY * kCells + cellX];
+  }
+  int min_threshold = 255;
+  int max_threshold = 0;
+  for (size_t cellY = 0; cellY < kCells; ++cellY) {
+    for (size_t cellX = 0; cellX < kCells; ++cellX) {
+      EXPECT_GE(counts[cellY * kCells + cellX],
+                kMinKeypoints / (kCells * kCells) / 2);
+      EXPECT_LE(counts[cellY * kCells + cellX],
+                kMaxKeypoints / (kCells * kCells) * 2);
+      min_threshold = std::min(min_threshold, grid.GetThreshold(cellX, cellY));
+      max_threshold = std::max(max_threshold, grid.GetThreshold(cellX, cellY));
+    }
+  }
+  EXPECT_LT(min_threshold, max_threshold);
+}
+
+namespace {
+// Corners of the decision tree, SSE2 and AVX2 segment tests.
+void ExpectOastSimdMatchesTree(const cv::Mat& image, const cv::Mat* thrmap,
+                               int threshold, const cv::Mat* mask = nullptr) {
+  agast::OastDetector9_16 detector(image.cols, image.rows, threshold);
+  detector.set_threshold(threshold, 120, 50);
+  detector.set_mask(mask != nullptr ? mask->data : nullptr);
+  std::vector<agast::KeyPoint> corners, corners_sse2, corners_avx2;
+  detector.set_useSimd(false);
+  detector.detect(image.data, corners, thrmap);
+  detector.set_useSimd(true);
+  agast::internal::SetSegmentTestAvx2Enabled(false);
+  detector.detect(image.data, corners_sse2, thrmap);
+  agast::internal::SetSegmentTestAvx2Enabled(true);
+  detector.detect(image.data, corners_avx2, thrmap);
+  ExpectKeypointsEqual(corners, corners_sse2);
+  ExpectKeypointsEqual(corners, corners_avx2);
+}
+}  // namespace
+
+TEST(BriskFeatureDetection, OastSimdMatchesTree) {
+  if (!agast::internal::HasSimdSegmentTest()) {
+    return;
+  }
+  for (const std::string& file : {"./test_data/img1.pgm",
+                                  "./test_data/img2.pgm"}) {
+    cv::Mat image = cv::imread(file, cv::IMREAD_GRAYSCALE);
+    ASSERT_FALSE(image.empty());
+    cv::Mat thrmap(image.rows, image.cols, CV_8UC1);
+    std::srand(42);
+    for (int i = 0; i < image.rows * image.cols; ++i) {
+      thrmap.data[i] = std::rand() % 256;
+    }
+    const cv::Mat mask = brisk::RobotMask(image.rows, image.cols);
+    for (int threshold : {0, 10, 30, 60, 255}) {
+      ExpectOastSimdMatchesTree(image, nullptr, threshold);
+      ExpectOastSimdMatchesTree(image, &thrmap, threshold);
+      ExpectOastSimdMatchesTree(image, &thrmap, threshold, &mask);
+    }
+  }
+  // Noise has many corners. The widths exercise the overlapping last block
+  // of each row and the fallbacks for narrow images.
+  for (int width : {20, 22, 23, 30, 37, 38, 50, 101}) {
+    cv::Mat image(40, width, CV_8UC1);
+    cv::Mat thrmap(40, width, CV_8UC1);
+    for (int i = 0; i < image.rows * image.cols; ++i) {
+      image.data[i] = std::rand() % 256;
+      thrmap.data[i] = std::rand() % 256;
+    }
+    cv::Mat mask(40, width, CV_8UC1);
+    for (int i = 0; i < mask.rows * mask.cols; ++i) {
+      mask.data[i] = (i / 7) % 3 == 0 ? 0 : 1 + std::rand() % 255;
+    }
+    ExpectOastSimdMatchesTree(image, nullptr, 20);
+    ExpectOastSimdMatchesTree(image, &thrmap, 20);
+    ExpectOastSimdMatchesTree(image, &thrmap, 20, &mask);
+  }
+}
+
+TEST(BriskFeatureDetection, OastMask) {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(image.empty());
+  const cv::Mat mask = brisk::RobotMask(image.rows, image.cols);
+  for (bool useSimd : {false, true}) {
+    agast::OastDetector9_16 detector(image.cols, image.rows, 30);
+    detector.set_useSimd(useSimd);
+    std::vector<agast::KeyPoint> corners, corners_masked;
+    detector.detect(image.data, corners);
+    detector.set_mask(mask.data);
+    detector.detect(image.data, corners_masked);
+    ASSERT_FALSE(corners_masked.empty());
+    ExpectKeypointsEqual(Masked(corners, mask), corners_masked);
+    detector.set_mask(nullptr);
+    detector.detect(image.data, corners_masked);
+    ExpectKeypointsEqual(corners, corners_masked);
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,277 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <agast/glog.h>
+#include <brisk/brisk.h>
+#include <brisk/internal/cpu-features.h>
+#include <brisk/internal/harris-scores.h>
+#include <brisk/internal/vectorized-filters.h>
+#include <gtest/gtest.h>
+
+#ifndef TEST
+#define TEST(a, b) void Test_##a##_##b()
+#endif
+
+#ifdef __ARM_NEON
+// Harris not implemented, so test not possible.
+#else
+namespace {
+class CovarEntries : public brisk::HarrisScoreCalculator {
+ public:
+  using brisk::HarrisScoreCalculator::GetCovarEntries;
+};
+
+void ExpectMatsEqual(const cv::Mat& expected, const cv::Mat& actual) {
+  ASSERT_EQ(expected.type(), actual.type());
+  ASSERT_EQ(expected.rows, actual.rows);
+  ASSERT_EQ(expected.cols, actual.cols);
+  const size_t row_bytes = expected.cols * expected.elemSize();
+  for (int y = 0; y < expected.rows; ++y) {
+    ASSERT_EQ(0, memcmp(expected.ptr(y), actual.ptr(y), row_bytes))
+        << "Row " << y << " of " << expected.rows << "x" << expected.cols;
+  }
+}
+
+cv::Mat RandomImage(int rows, int cols, int type) {
+  cv::Mat image(rows, cols, type);
+  for (int y = 0; y < rows; ++y) {
+    for (int x = 0; x < cols; ++x) {
+      switch (type) {
+        case CV_8UC1:
+          image.at<unsigned char>(y, x) = std::rand() % 256;
+          break;
+        case CV_16SC1:
+          image.at<int16_t>(y, x) = std::rand() % 65536 - 32768;
+          break;
+        default:
+          image.at<float>(y, x) = (std::rand() % 20001 - 10000) * 0.37f;
+      }
+    }
+  }
+  return image;
+}
+
+// Image sizes around the block widths of the SSE and AVX2 kernels.
+std::vector<cv::Mat> TestImages(int type, int min_cols) {
+  std::vector<cv::Mat> images;
+  std::srand(42);
+  for (int cols = min_cols; cols < 70; ++cols) {
+    images.push_back(RandomImage(3 + cols % 7, cols, type));
+  }
+  images.push_back(RandomImage(97, 645, type));
+  return images;
+}
+
+cv::Mat LoadImage() {
+  cv::Mat image = cv::imread("./test_data/img1.pgm", cv::IMREAD_GRAYSCALE);
+  CHECK(!image.empty());
+  return image;
+}
+
+void PrintAvx2Support() {
+  if (!brisk::CpuSupportsAvx2()) {
+    std::cout << "AVX2 not supported, comparing the reference only."
+        << std::endl;
+  }
+}
+}  // namespace
+
+TEST(HarrisKernels, ScoresAvx2MatchesSse) {
+  PrintAvx2Support();
+  std::vector<cv::Mat> images = TestImages(CV_8UC1, 18);
+  images.push_back(LoadImage());
+  for (const cv::Mat& image : images) {
+    cv::Mat scores_sse, scores_avx2;
+    brisk::SetAvx2Enabled(false);
+    brisk::HarrisScoresSSE(image, scores_sse);
+    brisk::SetAvx2Enabled(true);
+    brisk::HarrisScoresSSE(image, scores_avx2);
+    ExpectMatsEqual(scores_sse, scores_avx2);
+  }
+}
+
+TEST(HarrisKernels, ScoresBlockMatchesDense) {
+  std::vector<cv::Mat> images = TestImages(CV_8UC1, 18);
+  images.push_back(LoadImage());
+  std::srand(3);
+  for (const cv::Mat& image : images) {
+    cv::Mat scores;
+    brisk::HarrisScoresSSE(image, scores);
+    // Blocks of all sizes, also at the borders.
+    cv::Mat blocks(image.rows, image.cols, CV_32S);
+    const int block_size = 1 + std::rand() % brisk::kHarrisScoresMaxBlock;
+    for (int y = 0; y < image.rows; y += block_size) {
+      for (int x = 0; x < image.cols; x += block_size) {
+        brisk::HarrisScoresBlock(image, x, y,
+                                 std::min(x + block_size, image.cols),
+                                 std::min(y + block_size, image.rows),
+                                 &blocks);
+      }
+    }
+    ExpectMatsEqual(scores, blocks);
+  }
+}
+
+TEST(HarrisKernels, NarrowImagesMatchBlocks) {
+  std::srand(5);
+  for (int cols = 5; cols <= 20; ++cols) {
+    const cv::Mat image = RandomImage(14, cols, CV_8UC1);
+    cv::Mat blocks(image.rows, image.cols, CV_32S);
+    brisk::HarrisScoresBlock(image, 0, 0, image.cols, image.rows, &blocks);
+    for (bool avx2 : {false, true}) {
+      brisk::SetAvx2Enabled(avx2);
+      cv::Mat scores;
+      brisk::HarrisScoresSSE(image, scores);
+      ExpectMatsEqual(blocks, scores);
+    }
+  }
+}
+
+TEST(HarrisKernels, BilinearScoresMatchScore) {
+  PrintAvx2Support();
+  const cv::Mat image = LoadImage();
+  brisk::HarrisScoreCalculator calculator;
+  calculator.SetImage(image);
+
+  // Where the 3d nonmax suppression of the 2d maxima of a dense frame
+  // samples the layer above, and random points, also outside the image.
+  std::vector<brisk::HarrisScoreCalculator::PointWithScore> maxima;
+  calculator.Get2dMaxima(maxima, 0);
+  ASSERT_GT(maxima.size(), 10000u);
+  std::vector<double> u, v;
+  for (const brisk::HarrisScoreCalculator::PointWithScore& point : maxima) {
+    u.push_back(2.0 / 3.0 * (point.x - 0.25));
+    v.push_back(2.0 / 3.0 * (point.y - 0.25));
+  }
+  std::srand(11);
+  for (int i = 0; i < 1001; ++i) {
+    u.push_back((std::rand() % (20 * image.cols + 200) - 100) * 0.05);
+    v.push_back((std::rand() % (20 * image.rows + 200) - 100) * 0.05);
+  }
+  const size_t n = u.size();
+  std::vector<double> expected(n), sse(n), avx2(n);
+  for (size_t i = 0; i < n; ++i) {
+    expected[i] = calculator.Score(u[i], v[i]);
+  }
+  brisk::SetAvx2Enabled(false);
+  calculator.Scores(&u[0], &v[0], n, &sse[0]);
+  brisk::SetAvx2Enabled(true);
+  calculator.Scores(&u[0], &v[0], n, &avx2[0]);
+  for (size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(expected[i], sse[i]) << u[i] << ", " << v[i];
+    ASSERT_EQ(expected[i], avx2[i]) << u[i] << ", " << v[i];
+  }
+}
+
+TEST(HarrisKernels, CovarEntriesAvx2MatchesSse) {
+  PrintAvx2Support();
+  std::vector<cv::Mat> images = TestImages(CV_8UC1, 3);
+  images.push_back(LoadImage());
+  for (const cv::Mat& image : images) {
+    cv::Mat dxdx_sse, dydy_sse, dxdy_sse, dxdx_avx2, dydy_avx2, dxdy_avx2;
+    brisk::SetAvx2Enabled(false);
+    CovarEntries::GetCovarEntries(image, dxdx_sse, dydy_sse, dxdy_sse);
+    brisk::SetAvx2Enabled(true);
+    CovarEntries::GetCovarEntries(image, dxdx_avx2, dydy_avx2, dxdy_avx2);
+    ExpectMatsEqual(dxdx_sse, dxdx_avx2);
+    ExpectMatsEqual(dydy_sse, dydy_avx2);
+    ExpectMatsEqual(dxdy_sse, dxdy_avx2);
+  }
+}
+
+TEST(HarrisKernels, Filter2DAvx2MatchesSse) {
+  PrintAvx2Support();
+  cv::Mat kernel8(3, 3, CV_8SC1);
+  cv::Mat kernel16(3, 3, CV_16SC1);
+  std::srand(7);
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 3; ++x) {
+      kernel8.at<char>(y, x) = std::rand() % 21 - 10;
+      kernel16.at<int16_t>(y, x) = std::rand() % 21 - 10;
+    }
+  }
+  kernel8.at<char>(1, 1) = 0;
+  kernel16.at<int16_t>(1, 1) = 0;
+
+  for (int type : {CV_8UC1, CV_16SC1}) {
+    cv::Mat& kernel = type == CV_8UC1 ? kernel8 : kernel16;
+    std::vector<cv::Mat> images = TestImages(type, 3);
+    for (cv::Mat& image : images) {
+      cv::Mat filtered_sse, filtered_avx2;
+      brisk::SetAvx2Enabled(false);
+      Filter2D<3, 3>(image, filtered_sse, kernel);
+      brisk::SetAvx2Enabled(true);
+      Filter2D<3, 3>(image, filtered_avx2, kernel);
+      ExpectMatsEqual(filtered_sse, filtered_avx2);
+    }
+  }
+}
+
+TEST(HarrisKernels, GaussAvx2MatchesSse) {
+  PrintAvx2Support();
+  for (int type : {CV_16SC1, CV_32FC1}) {
+    std::vector<cv::Mat> images = TestImages(type, 3);
+    for (cv::Mat& image : images) {
+      cv::Mat filtered_sse, filtered_avx2;
+      brisk::SetAvx2Enabled(false);
+      if (type == CV_16SC1) {
+        brisk::FilterGauss3by316S(image, filtered_sse);
+      } else {
+        brisk::FilterGauss3by332F(image, filtered_sse);
+      }
+      brisk::SetAvx2Enabled(true);
+      if (type == CV_16SC1) {
+        brisk::FilterGauss3by316S(image, filtered_avx2);
+      } else {
+        brisk::FilterGauss3by332F(image, filtered_avx2);
+      }
+      ExpectMatsEqual(filtered_sse, filtered_avx2);
+    }
+  }
+}
+#endif  // __ARM_NEON
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
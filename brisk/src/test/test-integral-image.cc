@@ -35,6 +35,8 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <vector>
+
 #include <agast/glog.h>
 #include <agast/wrap-opencv.h>
 #include <gtest/gtest.h>
@@ -98,6 +100,44 @@ TEST(Brisk, IntegralImage8bit) {
   }
 }
 
+TEST(Brisk, IntegralImage16bit) {
+  std::string imagepath = "./test_data/img1.pgm";
+  cv::Mat src_img = cv::imread(imagepath, cv::IMREAD_GRAYSCALE);
+  ASSERT_FALSE(src_img.empty());
+  // Close to full range, so the sums wrap around.
+  cv::Mat src_img16(src_img.rows, src_img.cols, CV_16UC1);
+  for (int row = 0; row < src_img.rows; ++row) {
+    for (int col = 0; col < src_img.cols; ++col) {
+      src_img16.at<uint16_t>(row, col) =
+          src_img.at<unsigned char>(row, col) * 257 + (row + col) % 7;
+    }
+  }
+
+  agast::Mat integral;
+  brisk::IntegralImage16(src_img16, &integral);
+  ASSERT_EQ(src_img.rows + 1, integral.rows);
+  ASSERT_EQ(src_img.cols + 1, integral.cols);
+
+  int errors = 0;
+  const int kMaxErrors = 10;
+  std::vector<uint32_t> column_sums(src_img.cols + 1, 0);
+  for (int row = 0; row < integral.rows; ++row) {
+    uint32_t row_sum = 0;
+    for (int col = 0; col < integral.cols; ++col) {
+      if (row > 0 && col > 0) {
+        row_sum += src_img16.at<uint16_t>(row - 1, col - 1);
+        column_sums[col] += row_sum;
+      }
+      const uint32_t expected = row > 0 ? column_sums[col] : 0;
+      EXPECT_EQ(expected, static_cast<uint32_t>(integral.at<int>(row, col)));
+      if (expected != static_cast<uint32_t>(integral.at<int>(row, col))) {
+        ++errors;
+        CHECK_LT(errors, kMaxErrors);
+      }
+    }
+  }
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,219 @@
+/*
+ Copyright (C) 2013  The Autonomous Systems Lab, ETH Zurich,
+ Stefan Leutenegger and Simon Lynen.
+
+ BRISK - Binary Robust Invariant Scalable Keypoints
+ Reference implementation of
+ [1] Stefan Leutenegger,Margarita Chli and Roland Siegwart, BRISK:
+ Binary Robust Invariant Scalable Keypoints, in Proceedings of
+ the IEEE International Conference on Computer Vision (ICCV2011).
+
+ This file is part of BRISK.
+
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+     * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+     * Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+     * Neither the name of the <organization> nor the
+       names of its contributors may be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __ARM_NEON
+#include <immintrin.h>
+#endif  // __ARM_NEON
+#include <stdint.h>
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include <brisk/internal/vectorized-filters.h>
+
+namespace brisk {
+#ifdef __ARM_NEON
+  // Not implemented.
+#else
+namespace {
+__attribute__((target("avx2")))
+inline __m256i Load16S(const agast::Mat& src, int row, int col) {
+  return _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(&src.at<int16_t>(row, col)));
+}
+
+__attribute__((target("avx2")))
+inline void Store16S(agast::Mat& dst, int row, int col,  // NOLINT
+                     __m256i value) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(&dst.at<int16_t>(row, col)),
+                      value);
+}
+
+// The SSE filters step by eight columns up to a multiple of eight and finish
+// with the eight columns ending at cols - 2. Together, that is every start
+// column in [0, cols - 2). Here, the last sixteen columns overlap instead.
+inline int LastColumn16S(int j, int cols) {
+  return std::min(j, cols - 2 - 16);
+}
+}  // namespace
+
+__attribute__((target("avx2")))
+void Filter2D8UAvx2(const agast::Mat& src, agast::Mat& dst,  // NOLINT
+                    const agast::Mat& kernel, int X, int Y) {
+  CHECK_EQ(kernel.type(), CV_8S);
+  CHECK_EQ(Y, kernel.rows);
+  CHECK_EQ(X, kernel.cols);
+  const int cx = X / 2;
+  const int cy = Y / 2;
+
+  // Destination will be 16 bit.
+  dst = agast::Mat::zeros(src.rows, src.cols, CV_16S);
+  const unsigned int maxJ = ((src.cols - 2) / 16) * 16;
+  const unsigned int maxI = src.rows - 2;
+  const unsigned int stride = src.cols;
+
+  for (unsigned int i = 0; i < maxI; ++i) {
+    bool end = false;
+    for (unsigned int j = 0; j < maxJ;) {
+      __m256i result = _mm256_setzero_si256();
+      // Enter convolution with kernel.
+      for (int x = 0; x < X; ++x) {
+        for (int y = 0; y < Y; ++y) {
+          const char m = kernel.at<char>(y, x);
+          if (m == 0)
+            continue;
+          const unsigned char* p = src.data + (stride * (i + y)) + x + j;
+          const __m256i i0 = _mm256_cvtepu8_epi16(
+              _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+          result = _mm256_add_epi16(
+              result, _mm256_mullo_epi16(i0, _mm256_set1_epi16(m)));
+        }
+      }
+      Store16S(dst, i + cy, j + cx, result);
+
+      // Take care about end.
+      j += 16;
+      if (j >= maxJ && !end) {
+        j = stride - 2 - 16;
+        end = true;
+      }
+    }
+  }
+}
+
+__attribute__((target("avx2")))
+void Filter2D16SAvx2(const agast::Mat& src, agast::Mat& dst,  // NOLINT
+                     const agast::Mat& kernel, int X, int Y) {
+  CHECK_EQ(kernel.type(), CV_16S);
+  CHECK_EQ(Y, kernel.rows);
+  CHECK_EQ(X, kernel.cols);
+  CHECK_GE(src.cols, 18);
+  const int cx = X / 2;
+  const int cy = Y / 2;
+
+  // Destination will be 16 bit.
+  dst = agast::Mat::zeros(src.rows, src.cols, CV_16S);
+  const int maxI = src.rows - 2;
+  const int cols = src.cols;
+
+  for (int i = 0; i < maxI; ++i) {
+    for (int j = 0; j < cols - 2; j += 16) {
+      j = LastColumn16S(j, cols);
+      __m256i result = _mm256_setzero_si256();
+      // Enter convolution with kernel.
+      for (int x = 0; x < X; ++x) {
+        for (int y = 0; y < Y; ++y) {
+          const char m = kernel.at<int16_t>(y, x);
+          if (m == 0)
+            continue;
+          result = _mm256_add_epi16(
+              result, _mm256_mullo_epi16(Load16S(src, i + y, j + x),
+                                         _mm256_set1_epi16(m)));
+        }
+      }
+      Store16S(dst, i + cy, j + cx, result);
+    }
+  }
+}
+
+__attribute__((target("avx2")))
+void FilterGauss3by316SAvx2(const agast::Mat& src, agast::Mat& dst) {  // NOLINT
+  CHECK_GE(src.cols, 18);
+  // Dest will be 16 bit.
+  dst = agast::Mat::zeros(src.rows, src.cols, CV_16S);
+  const int maxI = src.rows - 2;
+  const int cols = src.cols;
+
+  for (int i = 0; i < maxI; ++i) {
+    for (int j = 0; j < cols - 2; j += 16) {
+      j = LastColumn16S(j, cols);
+      // The corners with weight 1, the edges with 2 and the center with 4.
+      const __m256i corners = _mm256_add_epi16(
+          _mm256_add_epi16(Load16S(src, i, j), Load16S(src, i + 2, j)),
+          _mm256_add_epi16(Load16S(src, i, j + 2),
+                           Load16S(src, i + 2, j + 2)));
+      const __m256i edges = _mm256_add_epi16(
+          _mm256_add_epi16(Load16S(src, i + 1, j), Load16S(src, i, j + 1)),
+          _mm256_add_epi16(Load16S(src, i + 1, j + 2),
+                           Load16S(src, i + 2, j + 1)));
+      const __m256i result = _mm256_add_epi16(
+          _mm256_add_epi16(corners, _mm256_slli_epi16(edges, 1)),
+          _mm256_slli_epi16(Load16S(src, i + 1, j + 1), 2));
+      Store16S(dst, i + 1, j + 1, result);
+    }
+  }
+}
+
+__attribute__((target("avx2")))
+void FilterGauss3by332FAvx2(const agast::Mat& src, agast::Mat& dst) {  // NOLINT
+  // Destination will be 32 bit float.
+  dst = agast::Mat::zeros(src.rows, src.cols, CV_32F);
+  const unsigned int maxJ = ((src.cols - 2) / 8) * 8;
+  const unsigned int maxI = src.rows - 2;
+  const unsigned int stride = src.cols;
+  const __m256 sixteenth = _mm256_set1_ps(0.0625);
+
+  for (unsigned int i = 0; i < maxI; ++i) {
+    // Like the SSE filter, this only keeps the sum of the edge pixels of the
+    // kernel, divided by 16.
+    unsigned int j = 0;
+    for (; j < maxJ; j += 8) {
+      __m256 result2 = _mm256_add_ps(
+          _mm256_loadu_ps(&src.at<float>(i, j + 1)),
+          _mm256_loadu_ps(&src.at<float>(i + 1, j)));
+      result2 = _mm256_add_ps(result2,
+                              _mm256_loadu_ps(&src.at<float>(i + 1, j + 2)));
+      result2 = _mm256_add_ps(result2,
+                              _mm256_loadu_ps(&src.at<float>(i + 2, j + 1)));
+      _mm256_storeu_ps(&dst.at<float>(i + 1, j + 1),
+                       _mm256_mul_ps(result2, sixteenth));
+    }
+    // The SSE filter only does its last four columns if they start before
+    // maxJ.
+    j = stride - 2 - 4;
+    if (maxJ > 0 && j < maxJ) {
+      __m128 result2 = _mm_add_ps(_mm_loadu_ps(&src.at<float>(i, j + 1)),
+                                  _mm_loadu_ps(&src.at<float>(i + 1, j)));
+      result2 = _mm_add_ps(result2, _mm_loadu_ps(&src.at<float>(i + 1, j + 2)));
+      result2 = _mm_add_ps(result2, _mm_loadu_ps(&src.at<float>(i + 2, j + 1)));
+      _mm_storeu_ps(&dst.at<float>(i + 1, j + 1),
+                    _mm_mul_ps(result2, _mm256_castps256_ps128(sixteenth)));
+    }
+  }
+}
+#endif  // __ARM_NEON
+}  // namespace brisk
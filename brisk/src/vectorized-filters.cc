@@ -45,6 +45,7 @@
 #endif  // __ARM_NEON
 #include <stdint.h>
 
+#include <brisk/internal/cpu-features.h>
 #include <brisk/internal/vectorized-filters.h>
 
 namespace brisk {
@@ -52,6 +53,10 @@ namespace brisk {
   // Not implemented.
 #else
 void FilterGauss3by316S(agast::Mat& src, agast::Mat& dst) {  // NOLINT
+  if (CpuSupportsAvx2() && src.cols >= 18) {
+    FilterGauss3by316SAvx2(src, dst);
+    return;
+  }
   // Sanity check.
   const unsigned int X = 3;
   const unsigned int Y = 3;
@@ -125,6 +130,10 @@ void FilterGauss3by316S(agast::Mat& src, agast::Mat& dst) {  // NOLINT
   // Not implemented.
 #else
 void FilterGauss3by332F(agast::Mat& src, agast::Mat& dst) {  // NOLINT
+  if (CpuSupportsAvx2()) {
+    FilterGauss3by332FAvx2(src, dst);
+    return;
+  }
   // Sanity check.
   static const unsigned int X = 3;
   static const unsigned int Y = 3;